@@ -29,16 +29,25 @@
 
 #include <epan/packet.h>
 #include <epan/exceptions.h>
+#include <epan/export_object.h>
 #include <epan/strutil.h>
 #include <epan/expert.h>
 #include <epan/prefs.h>
 #include <epan/decode_as.h>
 #include <epan/to_str.h>
 #include <epan/proto_data.h>
+#include <epan/reassemble.h>
+#include <epan/tap.h>
+#include <epan/stats_tree.h>
+#include <epan/rtd_table.h>
+#include <epan/srt_table.h>
+#include <epan/topic_match.h>
 #include <wsutil/str_util.h>
 #include <epan/uat.h>
 #include "packet-tcp.h"
 #include "packet-tls.h"
+#include "packet-protobuf.h"
+#include "packet-amqp.h"
 
 
 void proto_register_amqp(void);
@@ -47,22 +56,43 @@ void proto_reg_handoff_amqp(void);
 
 #define AMQP_PORT   5672
 static guint amqps_port = 5671; /* AMQP over SSL/TLS */
+/* largest content body that is reassembled before subdissection */
+static guint amqp_max_body_reassembly = 16 * 1024 * 1024;
+/* keep a summary of decoded frames for passes that build no tree */
+static gboolean amqp_cache_frame_summaries = TRUE;
+/* unacked deliveries tracked per connection, 0 for no limit */
+static guint amqp_max_unacked_deliveries = 0;
 
 /*
  * This dissector handles AMQP 0-9, 0-10 and 1.0. The conversation structure
  * contains the version being run - it's only really reliably detected at
  * protocol init. If this dissector starts in the middle of a conversation
  * it will try to figure it out, but conversation start is the best.
+ *
+ * A conversation captured from the middle usually starts in the middle of
+ * a frame. Until a direction is in sync, its segments are scanned for a
+ * frame boundary, see amqp_find_frame_boundary.
  */
 
-/* #define AMQP_V0_8           1 */
-#define AMQP_V0_9           2
-/* #define AMQP_V0_91          3 */
-#define AMQP_V0_10          4
-#define AMQP_V1_0           5
+/* Synchronisation of a direction of the conversation to the frame boundaries */
+#define AMQP_SYNC_NONE       0  /* nothing seen yet */
+#define AMQP_SYNC_SEARCHING  1  /* looking for a frame boundary */
+#define AMQP_SYNC_OK         2  /* in sync */
+
 typedef struct {
     guint8 version;
+    guint8 sync[2];        /* AMQP_SYNC_* by direction */
+    wmem_tree_t *resyncs;  /* maps frame number to amqp_resync_point */
     wmem_map_t *channels; /* maps channel_num to amqp_channel_t */
+    wmem_map_t *links_1_0; /* maps direction, channel and handle to amqp_1_0_link */
+    wmem_map_t *sessions_1_0; /* maps direction and channel to amqp_1_0_session */
+    wmem_map_t *sessions_0_10; /* maps direction and channel to amqp_0_10_session */
+    wmem_map_t *consumers; /* maps consumer tag to queue name */
+    wmem_map_t *auto_ack;  /* consumer tags of the consumers that need no acks */
+    guint32 body_msg_seq; /* last reassembly id given to a content body */
+    guint64 unacked;      /* deliveries waiting for an ack in all delivery windows */
+    guint64 window_slots; /* entries of all delivery windows, acked or not */
+    guint32 sessions_1_0_count; /* distinct sessions in sessions_1_0 */
 } amqp_conv;
 
 static dissector_table_t version_table;
@@ -75,46 +105,273 @@ struct amqp_delivery {
     guint64 delivery_tag;          /* message number or delivery tag */
     guint32 msg_framenum;          /* basic.publish or basic.deliver frame */
     guint32 ack_framenum;          /* basic.ack or basic.nack frame */
-    amqp_delivery *prev;
+    char *exchange;                /* exchange the message was published to */
+    char *routing_key;             /* routing key of the message */
+    const char *queue;             /* queue the message was consumed from */
+    gboolean published;            /* basic.publish rather than basic.deliver */
+    gboolean queue_unacked;        /* counted in the unacked messages of its queue */
+    nstime_t msg_time;             /* time of the basic.publish or basic.deliver */
+    amqp_delivery *prev;           /* next delivery acked by the same frame */
+    guint32 evicted;               /* older unacked deliveries no longer tracked
+                                      when this one was recorded */
 };
 
+/*
+ * Deliveries sent in one direction of a channel, ordered by delivery tag.
+ * The broker and the publisher both number messages with increasing tags,
+ * so new deliveries are always appended; acked deliveries stay in the array
+ * and 'head' is advanced past them. A single ack is a binary search over
+ * [head, count), a cumulative ack consumes entries from 'head'.
+ */
+typedef struct {
+    wmem_array_t *deliveries;      /* array of amqp_delivery* */
+    guint head;                    /* index of the oldest unacked delivery */
+} amqp_delivery_window;
+
+/* Deliveries left unacked on the channels closed by a channel.close-ok or
+ * connection.close-ok, set on the first pass */
+typedef struct {
+    guint64 unacked;
+} amqp_close_summary;
+
+/* Frame boundary found in a segment of a direction that was not in sync,
+ * set on the first pass */
+typedef struct {
+    guint32 raw_offset;                  /* raw offset of the segment */
+    guint32 skip;                        /* octets before the first frame */
+} amqp_resync_point;
+
 typedef struct {
     char *type;        /* content type */
     char *encoding;    /* content encoding. Not used in subdissector now */
 } amqp_content_params;
 
+/*
+ * Content sent in one direction of a channel: the method announcing a
+ * message, its content header and its body frames. A channel used for
+ * both publishing and consuming carries two of them at once.
+ */
+typedef struct {
+    amqp_content_params *content_params; /* parameters of content */
+    guint64 body_size;                   /* body size from the last content header */
+    guint64 body_received;               /* body octets seen since the content header */
+    guint32 body_msg_id;                 /* reassembly id of the current content body */
+    char *exchange;                      /* exchange of the last published or delivered message */
+    char *routing_key;                   /* routing key of the last published or delivered message */
+    amqp_tap_info_t *pending_tap;        /* message event completed by the next content header */
+    amqp_tap_info_t *msg_tap;            /* message event of the content that follows */
+} amqp_channel_content;
+
 typedef struct _amqp_channel_t {
     amqp_conv *conn;
     gboolean confirms;                   /* true if publisher confirms are enabled */
     guint16 channel_num;                 /* channel number */
     guint64 publish_count;               /* number of messages published so far */
-    amqp_delivery *last_delivery1;       /* list of unacked messages on tcp flow1 */
-    amqp_delivery *last_delivery2;       /* list of unacked messages on tcp flow2 */
-    amqp_content_params *content_params; /* parameters of content */
+    amqp_delivery_window unacked1;       /* unacked messages on tcp flow1 */
+    amqp_delivery_window unacked2;       /* unacked messages on tcp flow2 */
+    amqp_channel_content content1;       /* content sent on tcp flow1 */
+    amqp_channel_content content2;       /* content sent on tcp flow2 */
+    char *queue;                         /* queue of the last basic.consume or basic.get */
+    gboolean no_ack;                     /* the last basic.consume or basic.get needs no ack */
+    char *queue_op;                      /* queue of the last queue.purge or queue.delete */
 } amqp_channel_t;
 
+/* Per-frame record of a content body frame or an AMQP 1.0 transfer,
+ * set on the first pass */
+typedef struct {
+    guint32 msg_id;                      /* reassembly id, 0 if not reassembled */
+    guint32 frag_offset;                 /* offset of this frame in the body */
+    gboolean last;                       /* this frame completes the body */
+    char *content_type;                  /* content type from the content header */
+    char *topic;                         /* routing key, or exchange if there is none */
+    gboolean whole;                      /* this frame carries the whole body */
+    const amqp_tap_info_t *msg;          /* publish or delivery of the body, NULL if unknown */
+} amqp_body_frag;
+
+/* Complete message body passed to the export object tap */
+typedef struct {
+    const char *exchange;                /* exchange, or "to" address of an AMQP 1.0 message */
+    const char *routing_key;             /* routing key, or subject or target of an AMQP 1.0 message */
+    const char *content_type;
+    const char *delivery_tag;            /* NULL if unknown */
+    const guint8 *payload;
+    guint32 payload_len;
+} amqp_eo_t;
+
+/*
+ * Flow control state of an AMQP 1.0 link, shared by the handles both peers
+ * attached it with. Credit is counted in deliveries: the receiver allows
+ * deliveries up to credit_base + link_credit, the sender has sent up to
+ * delivery_count.
+ */
+typedef struct {
+    gboolean attached[2];                /* attach seen from each direction */
+    gboolean has_sender_dir;
+    guint    sender_dir;                 /* direction transfers are sent in */
+    gboolean has_delivery_count;
+    guint32  delivery_count;             /* sender's delivery-count */
+    gboolean has_credit;
+    guint32  credit_base;                /* delivery-count the credit was granted at */
+    guint32  link_credit;                /* credit granted by the last receiver flow */
+    gboolean in_delivery;                /* last transfer had more=true */
+    guint32  blocked_frame;              /* frame the credit ran out in, 0 if not blocked */
+    nstime_t blocked_since;
+    char    *source_address;             /* address of the source terminus, NULL if unknown */
+    char    *target_address;             /* address of the target terminus, NULL if unknown */
+} amqp_1_0_link_flow;
+
+/* AMQP 1.0 link, i.e. a handle within a session */
+typedef struct {
+    guint32 delivery_id;                 /* delivery being transferred */
+    guint32 msg_id;                      /* its reassembly id, 0 if none in progress */
+    guint32 received;                    /* message octets received so far */
+    amqp_1_0_link_flow *flow;            /* flow control state, NULL if not tracked yet */
+    gboolean own_flow;                   /* flow is not shared through the session, the
+                                            attach was not captured */
+} amqp_1_0_link;
+
+/*
+ * Flow control state of an AMQP 1.0 session, shared by the channels both
+ * peers began it on. Arrays are indexed by the direction transfers are sent
+ * in; the window of a direction is granted by the flows of the other one.
+ */
+typedef struct {
+    gboolean has_next_outgoing_id[2];
+    guint32  next_outgoing_id[2];        /* transfer-id of the next transfer */
+    gboolean has_window[2];
+    guint32  window_base[2];             /* next-incoming-id the window was granted at */
+    guint32  incoming_window[2];         /* window granted by the last flow or begin */
+    gboolean has_begin_window[2];        /* begin window waiting for the peer's begin */
+    guint32  begin_window[2];
+    guint32  blocked_frame[2];           /* frame the window ran out in, 0 if not blocked */
+    nstime_t blocked_since[2];
+    wmem_map_t *links;                   /* maps link name to amqp_1_0_link_flow */
+    wmem_map_t *unsettled;               /* maps delivery-id of an unsettled transfer from the
+                                            broker to the queue it counts in, NULL if none */
+} amqp_1_0_session;
+
+/* flags of amqp_1_0_flow_info */
+#define AMQP_1_0_FLOW_INFO_NO_CREDIT        0x01 /* transfer sent without link credit */
+#define AMQP_1_0_FLOW_INFO_CREDIT_EXHAUSTED 0x02 /* transfer used the last link credit */
+#define AMQP_1_0_FLOW_INFO_CREDIT_STARVED   0x04 /* flow granted no link credit */
+#define AMQP_1_0_FLOW_INFO_WINDOW_EXCEEDED  0x08 /* transfer sent outside the session window */
+#define AMQP_1_0_FLOW_INFO_WINDOW_EXHAUSTED 0x10 /* transfer used the last of the window */
+#define AMQP_1_0_FLOW_INFO_WINDOW_CLOSED    0x20 /* flow granted no session window */
+
+/* Per-frame record of the flow control state after an AMQP 1.0 flow or
+ * transfer, set on the first pass */
+typedef struct {
+    guint32  flags;
+    gboolean has_link_credit;
+    gint64   link_credit;                /* remaining link credit */
+    gboolean has_session_window;
+    gint64   session_window;             /* remaining session window */
+    guint32  link_blocked_frame;         /* frame the link ran out of credit in */
+    nstime_t link_blocked_time;          /* time the link was blocked on credit */
+    guint32  session_blocked_frame;      /* frame the session window ran out in */
+    nstime_t session_blocked_time;       /* time the session was blocked on its window */
+} amqp_1_0_flow_info;
+
+/*
+ * AMQP 0-10 numbers commands implicitly: the first command a peer sends on
+ * a session has the id set by session.command-point, 0 right after attaching,
+ * and each further command takes the next id. The receiver reports the ids
+ * it has completed in session.completed and answers some commands with an
+ * execution.result that names the command-id.
+ */
+typedef struct _amqp_0_10_command amqp_0_10_command;
+
+struct _amqp_0_10_command {
+    guint32 command_id;
+    guint8 amqp_class;
+    guint8 method;
+    guint32 command_framenum;            /* frame the command was sent in */
+    nstime_t command_time;
+    guint32 completed_framenum;          /* session.completed frame, 0 if not completed */
+    guint32 result_framenum;             /* execution.result frame, 0 if none */
+    amqp_0_10_command *next_completed;   /* next command completed by the same frame */
+};
+
+/*
+ * Commands sent in one direction of an AMQP 0-10 session. Ids are
+ * consecutive from base_id, so a command is found by indexing; completed
+ * commands stay in the array and 'head' is advanced past them, which keeps
+ * the cumulative sets of session.completed cheap.
+ */
+typedef struct {
+    gboolean numbering;                  /* attach or command-point seen, ids are known */
+    guint32 next_id;                     /* id of the next command */
+    guint32 base_id;                     /* id of the first command in commands */
+    wmem_array_t *commands;              /* array of amqp_0_10_command* */
+    guint head;                          /* index of the oldest uncompleted command */
+} amqp_0_10_session;
+
+/* Per-frame record of an AMQP 0-10 command or session.completed,
+ * set on the first pass */
+typedef struct {
+    amqp_0_10_command *command;          /* command sent in this frame */
+    amqp_0_10_command *result_for;       /* command answered by this execution.result */
+    amqp_0_10_command *completed;        /* first command completed by this frame */
+} amqp_0_10_command_info;
+
+/* Data section of an AMQP 1.0 message */
+typedef struct {
+    guint32 offset;                      /* offset of the binary in the message */
+    guint32 length;
+} amqp_1_0_data_section;
+
+/* Summary of an AMQP 1.0 transfer, see amqp_use_frame_summary */
+typedef struct {
+    guint32 args_length;                 /* length of the transfer performative */
+    const char *topic;                   /* address or subject of the completed message */
+    wmem_array_t *sections;              /* amqp_1_0_data_section of the completed message */
+} amqp_1_0_transfer_summary;
+
+typedef struct {
+    guint32 handle;
+    guint32 delivery_id;
+    gboolean has_delivery_id;
+    gboolean settled;
+    gboolean more;
+    gboolean aborted;
+} amqp_1_0_transfer_fields;
+
+typedef struct {
+    gboolean receiver;                   /* role of the peer sending the disposition */
+    guint32 first;
+    guint32 last;                        /* first if the disposition has no last */
+    gboolean settled;
+    guint64 outcome;                     /* descriptor code of the delivery state */
+    gboolean has_outcome;
+} amqp_1_0_disposition_fields;
+
 typedef struct _amqp_message_decode_t {
   guint   match_criteria;
   char   *topic_pattern;
-  GRegex *topic_regex;
   guint   msg_decoding;
   char   *payload_proto_name;
   dissector_handle_t payload_proto;
   char *topic_more_info;
+  protobuf_message_type_t *protobuf_type; /* resolved "message," type of protobuf */
 } amqp_message_decode_t;
 
-#define MATCH_CRITERIA_EQUAL        0
-#define MATCH_CRITERIA_CONTAINS     1
-#define MATCH_CRITERIA_STARTS_WITH  2
-#define MATCH_CRITERIA_ENDS_WITH    3
-#define MATCH_CRITERIA_REGEX        4
+
+/* pinfo->pool proto data keys */
+#define AMQP_PACKET_DATA_TOPIC      0   /* topic of the AMQP 1.0 message being dissected */
+#define AMQP_PACKET_DATA_TO         1   /* "to" address of the AMQP 1.0 message being dissected */
+
+/* File scope proto data of proto_amqp is keyed by the raw offset of a frame;
+ * the summary of a frame uses its raw offset with the top bit set, the
+ * queues it changed with the next bit */
+#define AMQP_FRAME_SUMMARY_KEY(tvb) (0x80000000 | (guint32)tvb_raw_offset(tvb))
+#define AMQP_QUEUE_SAMPLE_KEY(tvb)  (0x40000000 | (guint32)tvb_raw_offset(tvb))
 
 static const value_string match_criteria[] = {
-  { MATCH_CRITERIA_EQUAL,       "Equal to" },
-  { MATCH_CRITERIA_CONTAINS,    "Contains" },
-  { MATCH_CRITERIA_STARTS_WITH, "Starts with" },
-  { MATCH_CRITERIA_ENDS_WITH,   "Ends with" },
-  { MATCH_CRITERIA_REGEX,       "Regular Expression" },
+  { TOPIC_MATCH_EQUAL,       "Equal to" },
+  { TOPIC_MATCH_CONTAINS,    "Contains" },
+  { TOPIC_MATCH_STARTS_WITH, "Starts with" },
+  { TOPIC_MATCH_ENDS_WITH,   "Ends with" },
+  { TOPIC_MATCH_REGEX,       "Regular Expression" },
   { 0, NULL }
 };
 
@@ -280,6 +537,43 @@ static const value_string msg_decoding[] = {
 #define AMQP_1_0_AMQP_END         0x17
 #define AMQP_1_0_AMQP_CLOSE       0x18
 
+/* positions of transfer fields used for reassembly and the tap */
+#define AMQP_1_0_TRANSFER_HANDLE      0
+#define AMQP_1_0_TRANSFER_DELIVERY_ID 1
+#define AMQP_1_0_TRANSFER_DELIVERY_TAG 2
+#define AMQP_1_0_TRANSFER_SETTLED     4
+#define AMQP_1_0_TRANSFER_MORE        5
+#define AMQP_1_0_TRANSFER_ABORTED     9
+
+/* positions of begin, attach and flow fields used for flow control analysis */
+#define AMQP_1_0_BEGIN_REMOTE_CHANNEL    0
+#define AMQP_1_0_BEGIN_NEXT_OUTGOING_ID  1
+#define AMQP_1_0_BEGIN_INCOMING_WINDOW   2
+#define AMQP_1_0_ATTACH_NAME             0
+#define AMQP_1_0_ATTACH_HANDLE           1
+#define AMQP_1_0_ATTACH_ROLE             2
+#define AMQP_1_0_ATTACH_SOURCE           5
+#define AMQP_1_0_ATTACH_TARGET           6
+#define AMQP_1_0_ATTACH_INIT_DELIVERY_COUNT 9
+#define AMQP_1_0_FLOW_NEXT_INCOMING_ID   0
+#define AMQP_1_0_FLOW_INCOMING_WINDOW    1
+#define AMQP_1_0_FLOW_NEXT_OUTGOING_ID   2
+#define AMQP_1_0_FLOW_HANDLE             4
+#define AMQP_1_0_FLOW_DELIVERY_COUNT     5
+#define AMQP_1_0_FLOW_LINK_CREDIT        6
+
+/* positions of properties fields used for exporting messages */
+#define AMQP_1_0_PROPERTIES_TO           2
+#define AMQP_1_0_PROPERTIES_SUBJECT      3
+#define AMQP_1_0_PROPERTIES_CONTENT_TYPE 6
+
+/* positions of disposition fields used for the tap */
+#define AMQP_1_0_DISPOSITION_ROLE     0
+#define AMQP_1_0_DISPOSITION_FIRST    1
+#define AMQP_1_0_DISPOSITION_LAST     2
+#define AMQP_1_0_DISPOSITION_SETTLED  3
+#define AMQP_1_0_DISPOSITION_STATE    4
+
 #define AMQP_1_0_SASL_MECHANISMS 0x40
 #define AMQP_1_0_SASL_INIT       0x41
 #define AMQP_1_0_SASL_CHALLENGE  0x42
@@ -331,6 +625,12 @@ static const value_string msg_decoding[] = {
 #define AMQP_0_10_FRAME_HEADER   2
 #define AMQP_0_10_FRAME_BODY     3
 
+/* Frame position bits */
+#define AMQP_0_10_FIRST_SEGMENT  0x08
+#define AMQP_0_10_LAST_SEGMENT   0x04
+#define AMQP_0_10_FIRST_FRAME    0x02
+#define AMQP_0_10_LAST_FRAME     0x01
+
 #define AMQP_0_10_TYPE_STR16     0x95
 #define AMQP_0_10_TYPE_MAP       0xa8
 #define AMQP_0_10_TYPE_LIST      0xa9
@@ -459,12 +759,18 @@ static guint
 dissect_amqp_0_9_field_value(tvbuff_t *tvb, packet_info *pinfo, int offset, guint length,
                              const char *name, proto_tree *field_table_tree);
 
+static guint
+amqp_0_9_field_value_length(tvbuff_t *tvb, int offset, guint length);
+
 static void
 dissect_amqp_0_10_struct32(tvbuff_t *tvb, packet_info *pinfo, proto_item *ti);
 
 static amqp_channel_t*
 get_conversation_channel(conversation_t *conv, guint16 channel_num);
 
+static amqp_channel_content*
+get_channel_content(amqp_channel_t *channel, packet_info *pinfo);
+
 static void
 record_msg_delivery(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
     guint64 delivery_tag);
@@ -481,9 +787,36 @@ static void
 record_delivery_ack_c(conversation_t *conv, amqp_channel_t *channel,
     tvbuff_t *tvb, packet_info *pinfo, guint64 delivery_tag, gboolean multiple);
 
+static guint64
+delivery_window_release(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn,
+    amqp_delivery_window *window);
+
 static void
 generate_msg_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *prop_tree);
 
+static void
+dissect_amqp_0_9_content_body(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree,
+    guint16 channel_num, guint length);
+
+static void
+record_msg_topic(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    amqp_tap_event_t event, const guint8 *exchange, const guint8 *routing_key,
+    const char *queue);
+
+static void
+record_msg_queue_unacked(tvbuff_t *tvb, packet_info *pinfo, gboolean unacked);
+
+static void
+record_consumer(packet_info *pinfo, guint16 channel_num,
+    const guint8 *queue, const guint8 *consumer_tag, gboolean no_ack);
+
+static void
+tap_amqp_0_9_settled(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    amqp_tap_event_t event, guint64 delivery_tag, gboolean multiple);
+
+static gboolean
+find_data_dissector(tvbuff_t *msg_tvb, packet_info *pinfo, proto_tree *item, const char *topic);
+
 static void
 generate_ack_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *prop_tree);
 
@@ -722,6 +1055,11 @@ static int proto_amqpv0_9 = -1;
 static int proto_amqpv0_10 = -1;
 static int proto_amqpv1_0 = -1;
 
+static int amqp_tap = -1;
+static int amqp_srt_tap = -1;
+static int amqp_expert_tap = -1;
+static int amqp_eo_tap = -1;
+
 /* 1.0 handles */
 
 static int hf_amqp_1_0_size = -1;
@@ -1463,6 +1801,7 @@ static int hf_amqp_method_confirm_select_nowait = -1;
 static int hf_amqp_field = -1;
 static int hf_amqp_field_timestamp = -1;
 static int hf_amqp_field_byte_array = -1;
+static int hf_amqp_continuation_data = -1;
 static int hf_amqp_header_class_id = -1;
 static int hf_amqp_header_weight = -1;
 static int hf_amqp_header_body_size = -1;
@@ -1512,6 +1851,36 @@ static int hf_amqp_init_version_minor = -1;
 static int hf_amqp_init_version_revision = -1;
 static int hf_amqp_message_in = -1;
 static int hf_amqp_ack_in = -1;
+static int hf_amqp_ack_time = -1;
+static int hf_amqp_unacked_at_close = -1;
+static int hf_amqp_queue_state = -1;
+static int hf_amqp_queue_state_ready = -1;
+static int hf_amqp_queue_state_unacked = -1;
+static int hf_amqp_queue_state_depth = -1;
+static int hf_amqp_queue_state_consumers = -1;
+static int hf_amqp_1_0_link_credit_left = -1;
+static int hf_amqp_1_0_link_blocked_in = -1;
+static int hf_amqp_1_0_link_blocked_time = -1;
+static int hf_amqp_1_0_session_window_left = -1;
+static int hf_amqp_1_0_session_blocked_in = -1;
+static int hf_amqp_1_0_session_blocked_time = -1;
+static int hf_amqp_0_10_command_id = -1;
+static int hf_amqp_0_10_command_completed_in = -1;
+static int hf_amqp_0_10_command_result_in = -1;
+static int hf_amqp_0_10_command_in = -1;
+static int hf_amqp_0_10_command_time = -1;
+static int hf_amqp_0_10_completed_command = -1;
+static int hf_amqp_fragments = -1;
+static int hf_amqp_fragment = -1;
+static int hf_amqp_fragment_overlap = -1;
+static int hf_amqp_fragment_overlap_conflicts = -1;
+static int hf_amqp_fragment_multiple_tails = -1;
+static int hf_amqp_fragment_too_long_fragment = -1;
+static int hf_amqp_fragment_error = -1;
+static int hf_amqp_fragment_count = -1;
+static int hf_amqp_reassembled_in = -1;
+static int hf_amqp_reassembled_length = -1;
+static int hf_amqp_reassembled_data = -1;
 static int hf_amqp_method_connection_start_server_properties_size = -1;
 static int hf_amqp_0_10_method_connection_start_mechanisms_size = -1;
 static int hf_amqp_0_10_method_connection_start_locales_size = -1;
@@ -1541,15 +1910,48 @@ static gint ett_amqp_0_10_struct = -1;
 static gint ett_amqp_1_0_list = -1;
 static gint ett_amqp_1_0_array = -1;
 static gint ett_amqp_1_0_map = -1;
+static gint ett_amqp_0_10_completed_command = -1;
+static gint ett_amqp_fragment = -1;
+static gint ett_amqp_fragments = -1;
+static gint ett_amqp_queue_state = -1;
+
+static const fragment_items amqp_frag_items = {
+    &ett_amqp_fragment,
+    &ett_amqp_fragments,
+    &hf_amqp_fragments,
+    &hf_amqp_fragment,
+    &hf_amqp_fragment_overlap,
+    &hf_amqp_fragment_overlap_conflicts,
+    &hf_amqp_fragment_multiple_tails,
+    &hf_amqp_fragment_too_long_fragment,
+    &hf_amqp_fragment_error,
+    &hf_amqp_fragment_count,
+    &hf_amqp_reassembled_in,
+    &hf_amqp_reassembled_length,
+    &hf_amqp_reassembled_data,
+    "Message fragments"
+};
+
+static reassembly_table amqp_reassembly_table;
 
 static expert_field ei_amqp_connection_error = EI_INIT;
 static expert_field ei_amqp_channel_error = EI_INIT;
 static expert_field ei_amqp_message_undeliverable = EI_INIT;
+static expert_field ei_amqp_deliveries_untracked = EI_INIT;
+static expert_field ei_amqp_1_0_no_link_credit = EI_INIT;
+static expert_field ei_amqp_1_0_link_credit_exhausted = EI_INIT;
+static expert_field ei_amqp_1_0_link_credit_starved = EI_INIT;
+static expert_field ei_amqp_1_0_link_blocked = EI_INIT;
+static expert_field ei_amqp_1_0_session_window_exceeded = EI_INIT;
+static expert_field ei_amqp_1_0_session_window_exhausted = EI_INIT;
+static expert_field ei_amqp_1_0_session_window_closed = EI_INIT;
+static expert_field ei_amqp_1_0_session_blocked = EI_INIT;
 static expert_field ei_amqp_bad_flag_value = EI_INIT;
 static expert_field ei_amqp_unknown_stream_method = EI_INIT;
 static expert_field ei_amqp_unknown_basic_method = EI_INIT;
 static expert_field ei_amqp_unknown_frame_type = EI_INIT;
 static expert_field ei_amqp_field_short = EI_INIT;
+static expert_field ei_amqp_resync = EI_INIT;
 static expert_field ei_amqp_bad_length = EI_INIT;
 static expert_field ei_amqp_unknown_command_class = EI_INIT;
 static expert_field ei_amqp_unknown_tunnel_method = EI_INIT;
@@ -1573,6 +1975,7 @@ static expert_field ei_amqp_size_exceeds_65K = EI_INIT;
 static expert_field ei_amqp_array_type_unknown = EI_INIT;
 
 static dissector_handle_t amqp_tcp_handle = NULL;
+static dissector_handle_t protobuf_message_type_handle = NULL;
 
 static amqp_message_decode_t *amqp_message_decodes;
 static guint num_amqp_message_decodes;
@@ -1588,6 +1991,7 @@ static void *amqp_message_decode_copy_cb(void *dest, const void *orig, size_t le
   d->payload_proto_name = g_strdup(o->payload_proto_name);
   d->payload_proto = o->payload_proto;
   d->topic_more_info = g_strdup(o->topic_more_info);
+  d->protobuf_type = o->protobuf_type;
 
   return d;
 }
@@ -1614,14 +2018,16 @@ static gboolean amqp_message_decode_update_cb(void *record, char **error)
     return FALSE;
   }
 
-  if (u->match_criteria == MATCH_CRITERIA_REGEX)
+  if (!topic_match_check_pattern(u->match_criteria, u->topic_pattern, error))
   {
-    u->topic_regex = g_regex_new(u->topic_pattern, (GRegexCompileFlags) G_REGEX_OPTIMIZE, (GRegexMatchFlags) 0, NULL);
-    if (!u->topic_regex)
-    {
-      //*error = ws_strdup_printf("Invalid regex: %s", u->topic_pattern);
-      return FALSE;
-    }
+    return FALSE;
+  }
+
+  /* protobuf is passed the message type once resolved rather than as a string */
+  u->protobuf_type = NULL;
+  if (g_strcmp0(u->payload_proto_name, "protobuf") == 0 && g_str_has_prefix(u->topic_more_info, "message,"))
+  {
+    u->protobuf_type = protobuf_find_message_type(u->topic_more_info + strlen("message,"));
   }
 
 
@@ -1633,20 +2039,45 @@ static void amqp_message_decode_free_cb(void *record)
   amqp_message_decode_t *u = (amqp_message_decode_t *)record;
 
   g_free(u->topic_pattern);
-  if (u->topic_regex)
-  {
-    g_regex_unref(u->topic_regex);
-  }
   g_free(u->payload_proto_name);
   g_free(u->topic_more_info);
 }
 
-UAT_VS_DEF(message_decode, match_criteria, amqp_message_decode_t, guint, MATCH_CRITERIA_EQUAL, "Equal to")
+UAT_VS_DEF(message_decode, match_criteria, amqp_message_decode_t, guint, TOPIC_MATCH_EQUAL, "Equal to")
 UAT_CSTRING_CB_DEF(message_decode, topic_pattern, amqp_message_decode_t)
 UAT_VS_DEF(message_decode, msg_decoding, amqp_message_decode_t, guint, MSG_DECODING_NONE, "none")
 UAT_PROTO_DEF(message_decode, payload_proto, payload_proto, payload_proto_name, amqp_message_decode_t)
 UAT_CSTRING_CB_DEF(message_decode, topic_more_info, amqp_message_decode_t)
 
+/* message decode table compiled for lookups, rebuilt whenever the table changes */
+static topic_matcher_t *amqp_decode_matcher;
+
+static void
+amqp_message_decode_post_update_cb(void)
+{
+    guint i;
+
+    topic_matcher_free(amqp_decode_matcher);
+    amqp_decode_matcher = topic_matcher_new();
+    for (i = 0; i < num_amqp_message_decodes; i++)
+        topic_matcher_add(amqp_decode_matcher, amqp_message_decodes[i].match_criteria,
+                          amqp_message_decodes[i].topic_pattern);
+    topic_matcher_compile(amqp_decode_matcher);
+}
+
+/* Returns the first entry of the message decode table matching topic */
+static amqp_message_decode_t *
+find_message_decode(const char *topic)
+{
+    guint idx;
+
+    if (num_amqp_message_decodes == 0 ||
+        !topic_matcher_lookup(amqp_decode_matcher, topic, &idx) || idx >= num_amqp_message_decodes)
+        return NULL;
+
+    return &amqp_message_decodes[idx];
+}
+
 
 
 
@@ -1887,6 +2318,29 @@ static const value_string amqp_0_10_stream_methods [] = {
     {0, NULL}
 };
 
+/* Method names by class code */
+static const value_string *amqp_0_10_methods_by_class [] = {
+    NULL,
+    amqp_0_10_connection_methods,
+    amqp_0_10_session_methods,
+    amqp_0_10_execution_methods,
+    amqp_0_10_message_methods,
+    amqp_0_10_tx_methods,
+    amqp_0_10_dtx_methods,
+    amqp_0_10_exchange_methods,
+    amqp_0_10_queue_methods,
+    amqp_0_10_file_methods,
+    amqp_0_10_stream_methods
+};
+
+static const char *
+amqp_0_10_method_name(guint8 amqp_class, guint8 method)
+{
+    if (amqp_class >= G_N_ELEMENTS(amqp_0_10_methods_by_class) || !amqp_0_10_methods_by_class[amqp_class])
+        return "<invalid method>";
+    return val_to_str_const(method, amqp_0_10_methods_by_class[amqp_class], "<invalid method>");
+}
+
 static const value_string amqp_0_10_method_connection_close_reply_codes [] = {
     {200,   "normal"},
     {320,   "connection-forced"},
@@ -2402,6 +2856,188 @@ get_amqp_0_9_message_len(packet_info *pinfo _U_, tvbuff_t *tvb,
 }
 
 
+/* Return values of amqp_check_frame besides the frame length */
+#define AMQP_FRAME_INVALID     0
+#define AMQP_FRAME_TRUNCATED  -1
+
+/* Number of consecutive frames that must check out before a frame boundary
+ * found by scanning is trusted */
+#define AMQP_RESYNC_FRAMES     3
+
+/* Checks the invariants of a frame header of the version. Returns the frame
+ * length, AMQP_FRAME_INVALID, or AMQP_FRAME_TRUNCATED if the header looks
+ * right as far as it was captured but the frame does not end in the tvb. */
+
+static gint
+amqp_check_frame(tvbuff_t *tvb, guint offset, guint8 version)
+{
+    guint remaining;
+    guint32 length;
+    guint doff;
+    guint8 code;
+
+    remaining = tvb_captured_length_remaining(tvb, offset);
+    switch (version) {
+    case AMQP_V0_9:
+        /* type, channel, size, payload and the frame end octet */
+        if (remaining < 7)
+            return AMQP_FRAME_TRUNCATED;
+        if (tvb_get_guint8(tvb, offset) < AMQP_0_9_FRAME_TYPE_METHOD ||
+            tvb_get_guint8(tvb, offset) > AMQP_0_9_FRAME_TYPE_HEARTBEAT)
+            return AMQP_FRAME_INVALID;
+        length = tvb_get_ntohl(tvb, offset + 3);
+        if (remaining < 8 || length > remaining - 8)
+            return AMQP_FRAME_TRUNCATED;
+        if (tvb_get_guint8(tvb, offset + 7 + length) != 0xCE)
+            return AMQP_FRAME_INVALID;
+        return length + 8;
+
+    case AMQP_V0_10:
+        /* format and reserved bits, segment type, size, a reserved octet,
+         * track and channel, and four more reserved octets */
+        if (remaining < 12)
+            return AMQP_FRAME_TRUNCATED;
+        if ((tvb_get_guint8(tvb, offset) & 0xf0) != 0 ||
+            tvb_get_guint8(tvb, offset + 1) > AMQP_0_10_FRAME_BODY ||
+            tvb_get_guint8(tvb, offset + 4) != 0 ||
+            tvb_get_guint8(tvb, offset + 5) > 1 ||
+            tvb_get_ntohl(tvb, offset + 8) != 0)
+            return AMQP_FRAME_INVALID;
+        length = tvb_get_ntohs(tvb, offset + 2);
+        if (length < 12)
+            return AMQP_FRAME_INVALID;
+        if (length > remaining)
+            return AMQP_FRAME_TRUNCATED;
+        return length;
+
+    case AMQP_V1_0:
+        /* size, data offset in 4 octet words, type and the frame body,
+         * which starts with a described performative */
+        if (remaining < 8)
+            return AMQP_FRAME_TRUNCATED;
+        length = tvb_get_ntohl(tvb, offset);
+        doff = tvb_get_guint8(tvb, offset + 4);
+        if (length < 8 || doff < 2 || doff * 4 > length ||
+            tvb_get_guint8(tvb, offset + 5) > AMQP_1_0_SASL_FRAME)
+            return AMQP_FRAME_INVALID;
+        if (length > doff * 4) {
+            if (remaining < doff * 4 + 2)
+                return AMQP_FRAME_TRUNCATED;
+            code = tvb_get_guint8(tvb, offset + doff * 4 + 1);
+            /* descriptor constructor, then ulong0, smallulong or ulong */
+            if (tvb_get_guint8(tvb, offset + doff * 4) != 0x00 ||
+                (code != 0x44 && code != 0x53 && code != 0x80))
+                return AMQP_FRAME_INVALID;
+        }
+        if (length > remaining)
+            return AMQP_FRAME_TRUNCATED;
+        return length;
+    }
+    return AMQP_FRAME_INVALID;
+}
+
+/* Returns TRUE if a frame of the version starts at the offset, i.e. it is
+ * followed by enough valid frames, or by valid frames up to the end of the
+ * tvb, the last of which may be cut off. */
+
+static gboolean
+amqp_is_frame_boundary(tvbuff_t *tvb, guint offset, guint8 version)
+{
+    guint frames = 0;
+    gint length;
+
+    while (frames < AMQP_RESYNC_FRAMES) {
+        if (offset >= tvb_captured_length(tvb))
+            return frames > 0;
+        length = amqp_check_frame(tvb, offset, version);
+        if (length == AMQP_FRAME_INVALID)
+            return FALSE;
+        if (length == AMQP_FRAME_TRUNCATED)
+            return frames > 0;
+        offset += length;
+        frames++;
+    }
+    return TRUE;
+}
+
+/* Looks for the first frame boundary in a segment of a direction that is
+ * not in sync. Returns its offset, or the length of the segment if there is
+ * none. If the version is not known yet, all versions are tried and the
+ * one that matched is recorded in the conversation. */
+
+static guint
+amqp_find_frame_boundary(tvbuff_t *tvb, amqp_conv *conn)
+{
+    static const guint8 versions[] = { AMQP_V0_9, AMQP_V1_0, AMQP_V0_10 };
+    guint length;
+    guint offset;
+    guint i;
+
+    length = tvb_captured_length(tvb);
+    for (offset = 0; offset < length; offset++) {
+        for (i = 0; i < G_N_ELEMENTS(versions); i++) {
+            if (conn->version != 0 && conn->version != versions[i])
+                continue;
+            if (amqp_is_frame_boundary(tvb, offset, versions[i])) {
+                conn->version = versions[i];
+                return offset;
+            }
+        }
+    }
+    return length;
+}
+
+/* Returns the number of octets at the start of the segment that belong to a
+ * frame which started before the capture. On the first pass the direction
+ * is synchronised, and the result recorded so the second pass does not have
+ * to scan again. */
+
+static guint
+amqp_resync(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, guint dir)
+{
+    amqp_resync_point *resync;
+
+    if (PINFO_FD_VISITED(pinfo)) {
+        resync = (amqp_resync_point *)wmem_tree_lookup32(conn->resyncs, pinfo->num);
+        if (resync && resync->raw_offset == (guint32)tvb_raw_offset(tvb))
+            return resync->skip;
+        return 0;
+    }
+
+    if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
+        /* protocol header, the peer answers from the start too */
+        conn->sync[dir] = AMQP_SYNC_OK;
+        if (conn->sync[!dir] == AMQP_SYNC_NONE)
+            conn->sync[!dir] = AMQP_SYNC_OK;
+        return 0;
+    }
+    if (conn->sync[dir] == AMQP_SYNC_OK)
+        return 0;
+
+    conn->sync[dir] = AMQP_SYNC_SEARCHING;
+    resync = wmem_new(wmem_file_scope(), amqp_resync_point);
+    resync->raw_offset = (guint32)tvb_raw_offset(tvb);
+    resync->skip = amqp_find_frame_boundary(tvb, conn);
+    if (resync->skip < tvb_captured_length(tvb))
+        conn->sync[dir] = AMQP_SYNC_OK;
+    if (resync->skip > 0)
+        wmem_tree_insert32(conn->resyncs, pinfo->num, resync);
+    return resync->skip;
+}
+
+/* Returns TRUE if the entries of an AMQP 0-9 field table have to be decoded,
+ * i.e. if a tree is being built or a filter refers to one of their fields.
+ * Otherwise the entries are only measured, which is much cheaper for
+ * the large headers tables some clients send. */
+
+static gboolean
+amqp_0_9_field_table_wanted(proto_tree *field_table_tree)
+{
+    return proto_field_is_referenced(field_table_tree, hf_amqp_field) ||
+        proto_field_is_referenced(field_table_tree, hf_amqp_field_timestamp) ||
+        proto_field_is_referenced(field_table_tree, hf_amqp_field_byte_array);
+}
+
 /*  Dissection routine for AMQP 0-9 field tables  */
 
 static void
@@ -2411,8 +3047,10 @@ dissect_amqp_0_9_field_table(tvbuff_t *tvb, packet_info *pinfo, int offset, guin
     guint       namelen, vallen;
     const char *name;
     int         field_start;
+    gboolean    decode;
 
     field_table_tree = proto_item_add_subtree(item, ett_amqp);
+    decode = amqp_0_9_field_table_wanted(field_table_tree);
 
     while (length != 0) {
         field_start = offset;
@@ -2421,11 +3059,15 @@ dissect_amqp_0_9_field_table(tvbuff_t *tvb, packet_info *pinfo, int offset, guin
         length -= 1;
         if (length < namelen)
             goto too_short;
-        name = (char*) tvb_get_string_enc(wmem_packet_scope(), tvb, offset, namelen, ENC_UTF_8|ENC_NA);
         offset += namelen;
         length -= namelen;
 
-        vallen = dissect_amqp_0_9_field_value(tvb, pinfo, offset, length, name, field_table_tree);
+        if (decode) {
+            name = (char*) tvb_get_string_enc(wmem_packet_scope(), tvb, field_start + 1, namelen, ENC_UTF_8|ENC_NA);
+            vallen = dissect_amqp_0_9_field_value(tvb, pinfo, offset, length, name, field_table_tree);
+        } else {
+            vallen = amqp_0_9_field_value_length(tvb, offset, length);
+        }
         if(vallen == 0)
             goto too_short;
         offset += vallen;
@@ -2447,15 +3089,21 @@ dissect_amqp_0_9_field_array(tvbuff_t *tvb, packet_info *pinfo, int offset, guin
     int         field_start, idx;
     guint       vallen;
     const char *name;
+    gboolean    decode;
 
     field_table_tree = proto_item_add_subtree(item, ett_amqp);
+    decode = amqp_0_9_field_table_wanted(field_table_tree);
     idx = 0;
 
     while (length != 0) {
         field_start = offset;
-        name = wmem_strdup_printf(wmem_packet_scope(), "[%i]", idx);
 
-        vallen = dissect_amqp_0_9_field_value(tvb, pinfo, offset, length, name, field_table_tree);
+        if (decode) {
+            name = wmem_strdup_printf(wmem_packet_scope(), "[%i]", idx);
+            vallen = dissect_amqp_0_9_field_value(tvb, pinfo, offset, length, name, field_table_tree);
+        } else {
+            vallen = amqp_0_9_field_value_length(tvb, offset, length);
+        }
         if(vallen == 0)
             goto too_short;
         offset += vallen;
@@ -2503,6 +3151,64 @@ too_short:
  * who follows the 0-9-1 spec for this bit.
  */
 
+/* Returns the length of an AMQP 0-9 field value without decoding it, or 0 if
+ * the value is too short. Nested tables and arrays are skipped as a whole. */
+
+static guint
+amqp_0_9_field_value_length(tvbuff_t *tvb, int offset, guint length)
+{
+    guint vallen;
+
+    if (length < 1)
+        return 0; /* too short */
+    length -= 1;
+    switch (tvb_get_guint8(tvb, offset)) {
+    case 'V':
+        vallen = 0;
+        break;
+    case 't': /* boolean */
+    case 'b': /* signed 8-bit */
+    case 'B': /* unsigned 8-bit */
+        vallen = 1;
+        break;
+    case 's': /* signed 16-bit */
+    case 'u': /* unsigned 16-bit */
+        vallen = 2;
+        break;
+    case 'I': /* signed 32-bit */
+    case 'i': /* unsigned 32-bit */
+    case 'f': /* 32-bit float */
+        vallen = 4;
+        break;
+    case 'D': /* decimal */
+        vallen = 5;
+        break;
+    case 'T': /* timestamp (u64) */
+    case 'l': /* signed 64-bit */
+    case 'd': /* 64-bit float */
+        vallen = 8;
+        break;
+    case 'S': /* long string */
+    case 'F': /* nested table */
+    case 'A': /* array */
+    case 'x': /* byte array */
+        if (length < 4)
+            return 0; /* too short */
+        vallen = tvb_get_ntohl(tvb, offset + 1);
+        if (length - 4 < vallen)
+            return 0; /* too short */
+        vallen += 4;
+        break;
+    default:
+        /* unknown type, dissected without a value */
+        vallen = 0;
+        break;
+    }
+    if (length < vallen)
+        return 0; /* too short */
+    return 1 + vallen;
+}
+
 static guint
 dissect_amqp_0_9_field_value(tvbuff_t *tvb, packet_info *pinfo, int offset, guint length,
                              const char *name, proto_tree *field_table_tree)
@@ -6358,2456 +7064,3708 @@ dissect_amqp_1_0_array(tvbuff_t *tvb,
     return offset-orig_offset;
 }
 
-/* decodes AMQP 1.0 AMQP performative (open, attach, transfer or so)
- * arguments:
- *   tvb, offset, length, amqp_tree, pinfo: obvious
- *   method_name: what to print to col_append_str method in dissect_amqp_1_0_frame
- */
-static void
-dissect_amqp_1_0_AMQP_frame(tvbuff_t *tvb,
-                            proto_item *amqp_item,
-                            packet_info *pinfo)
+/* Returns the encoded size of the AMQP 1.0 primitive value at offset,
+ * constructor included. The size follows from the subcategory of the
+ * format code. */
+static guint
+amqp_1_0_primitive_length(tvbuff_t *tvb, guint offset)
+{
+    guint8 code = tvb_get_guint8(tvb, offset);
+
+    switch (code >> 4) {
+    case 0x4:
+        return 1;
+    case 0x5:
+        return 2;
+    case 0x6:
+        return 3;
+    case 0x7:
+        return 5;
+    case 0x8:
+        return 9;
+    case 0x9:
+        return 17;
+    case 0xa:
+    case 0xc:
+    case 0xe:
+        return 2 + tvb_get_guint8(tvb, offset + 1);
+    case 0xb:
+    case 0xd:
+    case 0xf:
+        return 5 + tvb_get_ntohl(tvb, offset + 1);
+    default:
+        THROW(ReportedBoundsError);
+    }
+    return 0;
+}
+
+/* Same as amqp_1_0_primitive_length, for a value that may be described */
+static guint
+amqp_1_0_value_length(tvbuff_t *tvb, guint offset)
 {
-    proto_item  *args_tree;
-    guint32     arg_length = 0;
-    guint32     method;
-    gint        offset = 0;
-    proto_item* ti;
+    guint start = offset;
 
-    args_tree = proto_item_add_subtree(amqp_item, ett_args);
+    while (tvb_get_guint8(tvb, offset) == AMQP_1_0_TYPE_DESCRIPTOR_CONSTRUCTOR) {
+        offset += 1;
+        /* a descriptor is never described itself */
+        if (tvb_get_guint8(tvb, offset) == AMQP_1_0_TYPE_DESCRIPTOR_CONSTRUCTOR)
+            THROW(ReportedBoundsError);
+        offset += amqp_1_0_primitive_length(tvb, offset);
+    }
+    return offset - start + amqp_1_0_primitive_length(tvb, offset);
+}
 
-    if (tvb_reported_length(tvb) == 0) { /* empty keepalive sent */
-        col_append_fstr(pinfo->cinfo, COL_INFO, "(empty)");
-        col_set_fence(pinfo->cinfo, COL_INFO);
-        return;
+static gboolean
+amqp_1_0_get_uint(tvbuff_t *tvb, guint offset, guint32 *value)
+{
+    switch (tvb_get_guint8(tvb, offset)) {
+    case 0x43: /* uint0 */
+        *value = 0;
+        return TRUE;
+    case 0x50: /* ubyte */
+    case 0x52: /* smalluint */
+        *value = tvb_get_guint8(tvb, offset + 1);
+        return TRUE;
+    case 0x60: /* ushort */
+        *value = tvb_get_ntohs(tvb, offset + 1);
+        return TRUE;
+    case 0x70: /* uint */
+        *value = tvb_get_ntohl(tvb, offset + 1);
+        return TRUE;
+    default:
+        return FALSE;
     }
+}
 
-    ti = proto_tree_add_item_ret_uint(args_tree, hf_amqp_1_0_amqp_performative, tvb, offset+2, 1, ENC_BIG_ENDIAN, &method);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "%s ", val_to_str_const(method, amqp_1_0_AMQP_performatives, "<invalid AMQP performative>"));
-    col_set_fence(pinfo->cinfo, COL_INFO);
+static gboolean
+amqp_1_0_get_boolean(tvbuff_t *tvb, guint offset)
+{
+    switch (tvb_get_guint8(tvb, offset)) {
+    case 0x41: /* true */
+        return TRUE;
+    case 0x56: /* boolean */
+        return tvb_get_guint8(tvb, offset + 1) != 0;
+    default:
+        return FALSE;
+    }
+}
 
-    offset += 3;    /* descriptor-constructor & fixed_one length & AMQP performative code */
-    switch(method) {
-        case AMQP_1_0_AMQP_OPEN:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    10, amqp_1_0_amqp_open_items, NULL);
+/* Returns the number of elements of the list at *offset and moves *offset
+ * to its first element. Returns 0 for list0 or if there is no list. */
+static guint32
+amqp_1_0_get_list_count(tvbuff_t *tvb, guint *offset)
+{
+    guint32 count;
+
+    switch (tvb_get_guint8(tvb, *offset)) {
+    case AMQP_1_0_TYPE_LIST8:
+        count = tvb_get_guint8(tvb, *offset + 2);
+        *offset += 3;
+        return count;
+    case AMQP_1_0_TYPE_LIST32:
+        count = tvb_get_ntohl(tvb, *offset + 5);
+        *offset += 9;
+        return count;
+    default:
+        return 0;
+    }
+}
+
+/* Reads the descriptor code of the described value at offset */
+static gboolean
+amqp_1_0_get_descriptor_code(tvbuff_t *tvb, guint offset, guint64 *code)
+{
+    if (tvb_get_guint8(tvb, offset) != AMQP_1_0_TYPE_DESCRIPTOR_CONSTRUCTOR)
+        return FALSE;
+
+    switch (tvb_get_guint8(tvb, offset + 1)) {
+    case 0x44: /* ulong0 */
+        *code = 0;
+        return TRUE;
+    case 0x53: /* smallulong */
+        *code = tvb_get_guint8(tvb, offset + 2);
+        return TRUE;
+    case 0x80: /* ulong */
+        *code = tvb_get_ntoh64(tvb, offset + 2);
+        return TRUE;
+    default:
+        /* symbolic descriptor */
+        return FALSE;
+    }
+}
+
+/* Reads the address of the source or target terminus at offset, the first
+ * field of the described list. Returns NULL if there is none. */
+static char *
+amqp_1_0_get_terminus_address(tvbuff_t *tvb, guint offset)
+{
+    if (tvb_get_guint8(tvb, offset) != AMQP_1_0_TYPE_DESCRIPTOR_CONSTRUCTOR)
+        return NULL;
+    offset += 1;
+    offset += amqp_1_0_primitive_length(tvb, offset);
+    if (amqp_1_0_get_list_count(tvb, &offset) == 0)
+        return NULL;
+
+    switch (tvb_get_guint8(tvb, offset)) {
+    case 0xa1: /* str8-utf8 */
+    case 0xa3: /* sym8 */
+        return (char *)tvb_get_string_enc(wmem_file_scope(), tvb, offset + 2,
+            tvb_get_guint8(tvb, offset + 1), ENC_UTF_8);
+    case 0xb1: /* str32-utf8 */
+    case 0xb3: /* sym32 */
+        return (char *)tvb_get_string_enc(wmem_file_scope(), tvb, offset + 5,
+            tvb_get_ntohl(tvb, offset + 1), ENC_UTF_8);
+    default:
+        return NULL;
+    }
+}
+
+/* Reads the fields of a transfer performative that matter for reassembly
+ * and the tap. offset points to the list that follows the performative
+ * descriptor. */
+static void
+get_amqp_1_0_transfer_fields(tvbuff_t *tvb, guint offset, amqp_1_0_transfer_fields *fields)
+{
+    guint32 count;
+    guint32 i;
+
+    fields->handle = 0;
+    fields->delivery_id = 0;
+    fields->has_delivery_id = FALSE;
+    fields->settled = FALSE;
+    fields->more = FALSE;
+    fields->aborted = FALSE;
+    count = amqp_1_0_get_list_count(tvb, &offset);
+
+    for (i = 0; i < count && i <= AMQP_1_0_TRANSFER_ABORTED; i++) {
+        switch (i) {
+        case AMQP_1_0_TRANSFER_HANDLE:
+            amqp_1_0_get_uint(tvb, offset, &fields->handle);
             break;
-        case AMQP_1_0_AMQP_BEGIN:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    8, amqp_1_0_amqp_begin_items, NULL);
-            break;
-        case AMQP_1_0_AMQP_ATTACH:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    14, amqp_1_0_amqp_attach_items, NULL);
+        case AMQP_1_0_TRANSFER_DELIVERY_ID:
+            fields->has_delivery_id = amqp_1_0_get_uint(tvb, offset, &fields->delivery_id);
             break;
-        case AMQP_1_0_AMQP_FLOW:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    11, amqp_1_0_amqp_flow_items, NULL);
-            break;
-        case AMQP_1_0_AMQP_TRANSFER:
-            arg_length = dissect_amqp_1_0_list(tvb,
-                                               pinfo,
-                                               offset,
-                                               args_tree,
-                                               hf_amqp_method_arguments,
-                                               11, amqp_1_0_amqp_transfer_items, NULL);
-
-            /* now decode message header, annotations, properties and data */
-            while ((arg_length > 0) && (tvb_reported_length_remaining(tvb, offset + arg_length) > 0)) {
-                offset += arg_length;
-                get_amqp_1_0_type_value_formatter(tvb,
-                                                    pinfo,
-                                                    offset,
-                                                    hf_amqp_1_0_list, /* dynamic item */
-                                                    NULL,
-                                                    &arg_length,
-                                                    args_tree);
-            }
+        case AMQP_1_0_TRANSFER_SETTLED:
+            fields->settled = amqp_1_0_get_boolean(tvb, offset);
             break;
-        case AMQP_1_0_AMQP_DISPOSITION:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    6, amqp_1_0_amqp_disposition_items, NULL);
+        case AMQP_1_0_TRANSFER_MORE:
+            fields->more = amqp_1_0_get_boolean(tvb, offset);
             break;
-        case AMQP_1_0_AMQP_DETACH:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    3, amqp_1_0_amqp_detach_items, NULL);
-            break;
-        case AMQP_1_0_AMQP_END:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    1, amqp_1_0_amqp_end_items, NULL);
-            break;
-        case AMQP_1_0_AMQP_CLOSE:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    1, amqp_1_0_amqp_close_items, NULL);
+        case AMQP_1_0_TRANSFER_ABORTED:
+            fields->aborted = amqp_1_0_get_boolean(tvb, offset);
             break;
         default:
-            expert_add_info_format(pinfo,
-                                   ti,
-                                   &ei_amqp_unknown_amqp_command,
-                                   "Unknown AMQP performative %d",
-                                   method);
+            break;
+        }
+        offset += amqp_1_0_value_length(tvb, offset);
     }
 }
 
-/* decodes AMQP 1.0 SASL methods (mechanisms offer, challenge, response,..)
- * arguments: see dissect_amqp_1_0_AMQP_frame
- */
+/* Reads the fields of a disposition performative that tell which deliveries
+ * it settles and how. offset points to the list that follows the
+ * performative descriptor. */
 static void
-dissect_amqp_1_0_SASL_frame(tvbuff_t *tvb,
-                            proto_item *amqp_item,
-                            packet_info *pinfo)
-{
-    proto_item  *args_tree;
-    guint32     method;
-    gint        offset = 0;
-    proto_item *ti;
-
-    args_tree = proto_item_add_subtree(amqp_item, ett_args);
-    ti = proto_tree_add_item_ret_uint(args_tree, hf_amqp_1_0_sasl_method, tvb, offset+2, 1, ENC_BIG_ENDIAN, &method);
-
-    col_append_fstr(pinfo->cinfo, COL_INFO, "%s ", val_to_str_const(method, amqp_1_0_SASL_methods, "<invalid SASL method>"));
-    col_set_fence(pinfo->cinfo, COL_INFO);
-
-    offset += 3; /* descriptor-constructor & fixed_one length & SASL method code */
-    switch(method) {
-        case AMQP_1_0_SASL_MECHANISMS:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    1, amqp_1_0_sasl_mechanisms_items, NULL);
+get_amqp_1_0_disposition_fields(tvbuff_t *tvb, guint offset, amqp_1_0_disposition_fields *fields)
+{
+    gboolean has_last = FALSE;
+    guint32 count;
+    guint32 i;
+
+    memset(fields, 0, sizeof(*fields));
+    count = amqp_1_0_get_list_count(tvb, &offset);
+    for (i = 0; i < count && i <= AMQP_1_0_DISPOSITION_STATE; i++) {
+        switch (i) {
+        case AMQP_1_0_DISPOSITION_ROLE:
+            fields->receiver = amqp_1_0_get_boolean(tvb, offset);
             break;
-        case AMQP_1_0_SASL_INIT:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    3, amqp_1_0_sasl_init_items, NULL);
+        case AMQP_1_0_DISPOSITION_FIRST:
+            amqp_1_0_get_uint(tvb, offset, &fields->first);
             break;
-         case AMQP_1_0_SASL_CHALLENGE:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    1, amqp_1_0_sasl_challenge_items, NULL);
+        case AMQP_1_0_DISPOSITION_LAST:
+            has_last = amqp_1_0_get_uint(tvb, offset, &fields->last);
             break;
-        case AMQP_1_0_SASL_RESPONSE:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    1, amqp_1_0_sasl_response_items, NULL);
+        case AMQP_1_0_DISPOSITION_SETTLED:
+            fields->settled = amqp_1_0_get_boolean(tvb, offset);
             break;
-        case AMQP_1_0_SASL_OUTCOME:
-            dissect_amqp_1_0_list(tvb,
-                                    pinfo,
-                                    offset,
-                                    args_tree,
-                                    hf_amqp_method_arguments,
-                                    2, amqp_1_0_sasl_outcome_items, NULL);
+        case AMQP_1_0_DISPOSITION_STATE:
+            fields->has_outcome = amqp_1_0_get_descriptor_code(tvb, offset, &fields->outcome);
             break;
         default:
-            expert_add_info_format(pinfo,
-                                   ti,
-                                   &ei_amqp_unknown_sasl_command,
-                                   "Unknown SASL command %d",
-                                   method);
+            break;
+        }
+        offset += amqp_1_0_value_length(tvb, offset);
     }
+    if (!has_last)
+        fields->last = fields->first;
 }
 
-static int
-dissect_amqp_1_0_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
+/*
+ * Tells whether this pass may take a frame from the summary the first pass
+ * cached rather than decode it again. Passes that build a tree want the
+ * decoded fields, and expert infos are only raised by decoding.
+ */
+static gboolean
+amqp_use_frame_summary(packet_info *pinfo, proto_tree *tree)
 {
-    proto_item  *ti, *size_item;
-    proto_tree  *amqp_tree;
-    guint8      frame_type;
-    guint32     length;
-    guint       offset;
-    tvbuff_t    *next_tvb;
+    return amqp_cache_frame_summaries && tree == NULL && PINFO_FD_VISITED(pinfo) &&
+        !have_tap_listener(amqp_expert_tap);
+}
 
-    col_clear(pinfo->cinfo, COL_INFO);
+/* Tells whether a frame was sent by the client rather than by the broker,
+ * from the server port seen in the TCP handshake or else the AMQP port */
+static gboolean
+amqp_sent_to_broker(packet_info *pinfo)
+{
+    struct tcp_analysis *tcpd;
 
-    /*  Heuristic - protocol initialisation frame starts with 'AMQP' followed by 0x0  */
-    if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
-        guint8         proto_major;
-        guint8         proto_minor;
-        guint8         proto_revision;
+    tcpd = get_tcp_conversation_data(NULL, pinfo);
+    if (tcpd && tcpd->server_port != 0)
+        return pinfo->destport == tcpd->server_port;
+    return pinfo->destport == pinfo->match_uint;
+}
 
-        proto_major    = tvb_get_guint8(tvb, 5);
-        proto_minor    = tvb_get_guint8(tvb, 6);
-        proto_revision = tvb_get_guint8(tvb, 7);
-        col_append_fstr(pinfo->cinfo, COL_INFO, "Protocol-Header%s %d-%d-%d ",
-                                  (tvb_get_guint8(tvb, 4)==0x2) ? "(TLS)" : "", /* frame type = 2 => TLS */
-                                  proto_major,
-                                  proto_minor,
-                                  proto_revision);
-        col_set_fence(pinfo->cinfo, COL_INFO);
+/* Approximate memory held to track the channels, deliveries, sessions and
+ * links of a connection, not counting the per-frame records. Only known
+ * on the first pass. */
+static guint64
+amqp_tap_state_size(packet_info *pinfo)
+{
+    amqp_conv *conn;
 
-        if (tree) {
-            ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
-            amqp_tree = proto_item_add_subtree(ti, ett_amqp_init);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_protocol,         tvb, 0, 4, ENC_ASCII|ENC_NA);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_id,               tvb, 4, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_version_major,    tvb, 5, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_version_minor,    tvb, 6, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_version_revision, tvb, 7, 1, ENC_BIG_ENDIAN);
-        }
-        return 8;
-    }
+    if (PINFO_FD_VISITED(pinfo))
+        return 0;
+    conn = (amqp_conv *)conversation_get_proto_data(find_or_create_conversation(pinfo), proto_amqp);
+    if (!conn)
+        return 0;
 
-    /* Protocol frame */
+    return sizeof(amqp_conv) +
+        wmem_map_size(conn->channels) * sizeof(amqp_channel_t) +
+        conn->window_slots * sizeof(amqp_delivery *) +
+        conn->unacked * sizeof(amqp_delivery) +
+        conn->sessions_1_0_count * sizeof(amqp_1_0_session) +
+        wmem_map_size(conn->links_1_0) * (sizeof(guint64) + sizeof(amqp_1_0_link) + sizeof(amqp_1_0_link_flow));
+}
 
-    /* frame header */
-    ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
-    amqp_tree = proto_item_add_subtree(ti, ett_amqp);
-    size_item = proto_tree_add_item_ret_uint(amqp_tree, hf_amqp_1_0_size, tvb, 0, 4, ENC_BIG_ENDIAN, &length);
-    proto_tree_add_item(amqp_tree, hf_amqp_1_0_doff, tvb, 4, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(amqp_tree, hf_amqp_1_0_type, tvb, 5, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(amqp_tree, hf_amqp_channel,  tvb, 6, 2, ENC_BIG_ENDIAN);
+/*
+ * Queue depth estimation. The state of each queue is counted on the first
+ * pass from the messages routed to it and the deliveries and acks of its
+ * consumers, across all connections of the capture:
+ * - ready messages wait for a consumer, they are the consumer lag,
+ * - unacked messages were delivered and not yet acked, nacked or rejected,
+ * and the depth of the queue is both, as brokers report it. Unacked
+ * messages are ready again once their channel or session is closed, or
+ * basic.recover requeues them.
+ *
+ * Messages published to an exchange are routed along the queue.bind seen
+ * for it. AMQP 1.0 messages count in the queue named by their "to" address,
+ * or else by the address of their link at the broker.
+ * The message count of queue.declare-ok, basic.get-ok, basic.get-empty,
+ * queue.purge-ok and queue.delete-ok replaces the estimated ready messages;
+ * before one of them the estimate counts from 0 at the start of the
+ * capture and may go negative. Queues are told apart by name only.
+ */
 
-    offset     = 4*tvb_get_guint8(tvb,4); /* i.e. 4*DOFF */
-    frame_type = tvb_get_guint8(tvb, 5);
-    if (length < offset) {
-        expert_add_info(pinfo, size_item, &ei_amqp_bad_length);
-        return 8;
-    }
+/* An exchange with the queues bound to it */
+typedef struct {
+    gboolean fanout;                     /* binding keys are ignored */
+    gboolean topic;                      /* binding keys are patterns, else compared exactly */
+    wmem_list_t *bindings;               /* amqp_binding */
+} amqp_exchange;
 
-    if (length > (guint32)tvb_reported_length_remaining(tvb, offset))
-    {
-        next_tvb = tvb_new_subset_remaining(tvb, offset);
-    }
-    else
-    {
-        next_tvb = tvb_new_subset_length(tvb, offset, length);
-    }
+typedef struct {
+    char *queue;
+    char *binding_key;
+} amqp_binding;
 
-    switch(frame_type) {
-    case AMQP_1_0_AMQP_FRAME:
-        dissect_amqp_1_0_AMQP_frame(next_tvb, amqp_tree, pinfo);
-        break;
-    case AMQP_1_0_SASL_FRAME:
-        dissect_amqp_1_0_SASL_frame(next_tvb, amqp_tree, pinfo);
-        break;
-    case AMQP_1_0_TLS_FRAME:
-        /* should not occur, this is handled in '(tvb_memeql(tvb, 0, "AMQP", 4) == 0)' test above */
-        break;
-    default:
-        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %d", frame_type);
-    }
+/* Per-frame record of the queues a frame changed, with their state after
+ * it, set on the first pass */
+typedef struct {
+    guint count;
+    amqp_tap_queue_t *queues;
+} amqp_queue_sample;
 
-    return tvb_reported_length(tvb);
-}
+static wmem_map_t *amqp_queues;          /* maps queue name to amqp_tap_queue_t */
+static wmem_map_t *amqp_exchanges;       /* maps exchange name to amqp_exchange */
 
-static int
-dissect_amqp_0_10_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
+static amqp_tap_queue_t *
+amqp_queue_get(const char *name)
 {
-    proto_item *ti;
-    proto_item *amqp_tree = NULL;
-    guint8      frame_type;
-    guint16     length;
-    guint32     struct_length;
-    guint       offset;
-    tvbuff_t   *next_tvb;
-
-    /*  Heuristic - protocol initialisation frame starts with 'AMQP'  */
-    if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
-        guint8         proto_major;
-        guint8         proto_minor;
-
-        proto_major = tvb_get_guint8(tvb, 6);
-        proto_minor = tvb_get_guint8(tvb, 7);
-        col_append_fstr(pinfo->cinfo, COL_INFO, "Protocol-Header %d-%d ",
-                                  proto_major,
-                                  proto_minor);
-        col_set_fence(pinfo->cinfo, COL_INFO);
+    amqp_tap_queue_t *queue;
 
-        if (tree) {
-            ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
-            amqp_tree = proto_item_add_subtree(ti, ett_amqp_init);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_protocol,      tvb, 0, 4, ENC_ASCII|ENC_NA);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_id_major,      tvb, 4, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_id_minor,      tvb, 5, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_version_major, tvb, 6, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(amqp_tree, hf_amqp_init_version_minor, tvb, 7, 1, ENC_BIG_ENDIAN);
-        }
-        return 8;
+    queue = (amqp_tap_queue_t *)wmem_map_lookup(amqp_queues, name);
+    if (!queue) {
+        queue = wmem_new0(wmem_file_scope(), amqp_tap_queue_t);
+        queue->name = wmem_strdup(wmem_file_scope(), name);
+        queue->consumers = -1;
+        wmem_map_insert(amqp_queues, (gpointer)queue->name, queue);
     }
+    return queue;
+}
 
-    /* Protocol frame */
-    if (tree) {
-        ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
-        amqp_tree = proto_item_add_subtree(ti, ett_amqp);
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_format,   tvb, 0, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_position, tvb, 0, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_type,     tvb, 1, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_size,     tvb, 2, 2, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_track,    tvb, 5, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_channel,       tvb, 6, 2, ENC_BIG_ENDIAN);
-        proto_tree_add_item(amqp_tree, hf_amqp_reserved,      tvb, 8, 4, ENC_BIG_ENDIAN);
-    }
-
-    frame_type = tvb_get_guint8(tvb, 1);
-    length     = tvb_get_ntohs(tvb, 2);
-    offset     = 12;
-    next_tvb = tvb_new_subset_remaining(tvb, offset);
-
-    switch(frame_type) {
-    case AMQP_0_10_FRAME_COMMAND:
-        /* Fall through */
-    case AMQP_0_10_FRAME_CONTROL:
-        proto_tree_add_item(amqp_tree, hf_amqp_0_10_class, tvb, offset+0, 1, ENC_BIG_ENDIAN);
-        switch(tvb_get_guint8(tvb, offset + 0)) {
-        case AMQP_0_10_CLASS_CONNECTION:
-            dissect_amqp_0_10_connection(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_SESSION:
-            dissect_amqp_0_10_session(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_EXECUTION:
-            dissect_amqp_0_10_execution(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_MESSAGE:
-            dissect_amqp_0_10_message(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_TX:
-            dissect_amqp_0_10_tx(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_DTX:
-            dissect_amqp_0_10_dtx(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_EXCHANGE:
-            dissect_amqp_0_10_exchange(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_QUEUE:
-            dissect_amqp_0_10_queue(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_FILE:
-            dissect_amqp_0_10_file(next_tvb, pinfo, amqp_tree);
-            break;
-        case AMQP_0_10_CLASS_STREAM:
-            dissect_amqp_0_10_stream(next_tvb, pinfo, amqp_tree);
-            break;
-        default:
-            expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_command_class, "Unknown command/control class %d", tvb_get_guint8(tvb, offset + 0));
-        }
-        break;
-
-    case AMQP_0_10_FRAME_HEADER:
-        col_append_str(pinfo->cinfo, COL_INFO, "header ");
-        col_set_fence(pinfo->cinfo, COL_INFO);
-        while (tvb_reported_length_remaining(tvb, offset) > 0)
-        {
-            struct_length = amqp_0_10_get_32bit_size_new(amqp_tree, pinfo, tvb, hf_amqp_0_10_struct32_size, offset);
-            offset += 4;
+/* Records the state of a queue after this frame changed it */
+static void
+amqp_queue_record(tvbuff_t *tvb, packet_info *pinfo, const amqp_tap_queue_t *queue)
+{
+    amqp_queue_sample *sample;
+    guint i;
 
-            ti = proto_tree_add_item(amqp_tree,
-                                     hf_amqp_0_10_struct32,
-                                     tvb, offset, 2, ENC_BIG_ENDIAN);
-            proto_item_set_len(ti, struct_length);
-            if (struct_length > (guint32)tvb_reported_length_remaining(tvb, offset))
-            {
-                next_tvb = tvb_new_subset_remaining(tvb, offset);
-            }
-            else
-            {
-                next_tvb = tvb_new_subset_length(tvb, offset, struct_length);
-            }
-            dissect_amqp_0_10_struct32(next_tvb, pinfo, ti);
-            offset += struct_length;
+    sample = (amqp_queue_sample *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_QUEUE_SAMPLE_KEY(tvb));
+    if (!sample) {
+        sample = wmem_new0(wmem_file_scope(), amqp_queue_sample);
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, AMQP_QUEUE_SAMPLE_KEY(tvb), sample);
+    }
+    for (i = 0; i < sample->count; i++) {
+        if (sample->queues[i].name == queue->name) {
+            sample->queues[i] = *queue;
+            return;
         }
-        break;
-
-    case AMQP_0_10_FRAME_BODY:
-        col_append_str(pinfo->cinfo, COL_INFO, "message-body ");
-        col_set_fence(pinfo->cinfo, COL_INFO);
-        proto_tree_add_item(amqp_tree,
-                            hf_amqp_0_10_message_body,
-                            tvb, offset, length - 12, ENC_NA);
-        break;
-
-    default:
-        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %d", frame_type);
     }
-
-    return tvb_reported_length(tvb);
+    sample->queues = (amqp_tap_queue_t *)wmem_realloc(wmem_file_scope(), sample->queues,
+        (sample->count + 1) * sizeof(amqp_tap_queue_t));
+    sample->queues[sample->count++] = *queue;
 }
 
+/* Adds to the ready and unacked messages of a queue */
+static void
+amqp_queue_update(tvbuff_t *tvb, packet_info *pinfo, const char *name, gint64 ready, gint64 unacked)
+{
+    amqp_tap_queue_t *queue;
 
-/*  Dissection routine for method Connection.Start                        */
+    if (!name)
+        return;
+    queue = amqp_queue_get(name);
+    queue->ready += ready;
+    queue->unacked += unacked;
+    amqp_queue_record(tvb, pinfo, queue);
+}
 
-static int
-dissect_amqp_0_9_method_connection_start(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* Sets the ready messages of a queue to the count reported by the broker */
+static void
+amqp_queue_anchor(tvbuff_t *tvb, packet_info *pinfo, const char *name, guint32 message_count)
 {
-    proto_item *ti;
+    amqp_tap_queue_t *queue;
 
-    /*  version-major (octet)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_start_version_major,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-    offset += 1;
+    if (!name)
+        return;
+    queue = amqp_queue_get(name);
+    queue->ready = message_count;
+    queue->anchored = TRUE;
+    amqp_queue_record(tvb, pinfo, queue);
+}
 
-    /*  version-minor (octet)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_start_version_minor,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-    offset += 1;
+/* Takes the deliveries an ack, nack or reject settled out of the unacked
+ * messages of their queues; requeued ones are ready again */
+static void
+amqp_queue_settle(tvbuff_t *tvb, packet_info *pinfo, gboolean requeue)
+{
+    amqp_delivery *delivery;
 
-    /*  server-properties (table)  */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_connection_start_server_properties,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    for (; delivery != NULL; delivery = delivery->prev) {
+        if (delivery->queue_unacked)
+            amqp_queue_update(tvb, pinfo, delivery->queue, requeue ? 1 : 0, -1);
+    }
+}
 
-    /*  mechanisms (longstr)     */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_start_mechanisms,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+/* Tells whether a routing key matches the binding key of a topic exchange,
+ * where * stands for one word and # for zero or more words */
+static gboolean
+amqp_topic_matches(const char *binding_key, const char *routing_key)
+{
+    const char *bdot = strchr(binding_key, '.');
+    const char *rdot;
+    size_t blen = bdot ? (size_t)(bdot - binding_key) : strlen(binding_key);
+    size_t rlen;
 
-    /*  locales (longstr)        */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_start_locales,
-                        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    if (blen == 1 && binding_key[0] == '#') {
+        if (!bdot)
+            return TRUE;
+        for (;;) {
+            if (amqp_topic_matches(bdot + 1, routing_key))
+                return TRUE;
+            rdot = strchr(routing_key, '.');
+            if (!rdot)
+                return FALSE;
+            routing_key = rdot + 1;
+        }
+    }
 
-    return offset;
+    rdot = strchr(routing_key, '.');
+    rlen = rdot ? (size_t)(rdot - routing_key) : strlen(routing_key);
+    if (!(blen == 1 && binding_key[0] == '*') &&
+        (blen != rlen || strncmp(binding_key, routing_key, blen) != 0))
+        return FALSE;
+    if (!rdot)
+        return !bdot || strcmp(bdot + 1, "#") == 0;
+    if (!bdot)
+        return FALSE;
+    return amqp_topic_matches(bdot + 1, rdot + 1);
 }
 
-/*  Dissection routine for method Connection.Start-Ok                     */
-
-static int
-dissect_amqp_0_9_method_connection_start_ok(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+static gboolean
+amqp_queue_in_sample(tvbuff_t *tvb, packet_info *pinfo, const char *name)
 {
-    proto_item *ti;
+    amqp_queue_sample *sample;
+    guint i;
 
-    /*  client-properties (table)  */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_connection_start_ok_client_properties,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    sample = (amqp_queue_sample *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_QUEUE_SAMPLE_KEY(tvb));
+    for (i = 0; sample && i < sample->count; i++) {
+        if (strcmp(sample->queues[i].name, name) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
 
-    /*  mechanism (shortstr)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_start_ok_mechanism,
-        tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN);
-    offset += (1 + tvb_get_guint8(tvb, offset));
+/* Counts a message published to an exchange in the queues it is routed to.
+ * The default exchange routes to the queue named by the routing key.
+ * Binding keys are matched as patterns on topic exchanges and compared
+ * exactly on the others, including exchanges whose type was not seen; the
+ * arguments of headers exchanges and exchange to exchange bindings are not
+ * followed. */
+static void
+amqp_queue_publish(tvbuff_t *tvb, packet_info *pinfo, const char *exchange, const char *routing_key)
+{
+    amqp_exchange *ex;
+    wmem_list_frame_t *frame;
 
-    /*  response (longstr)       */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_start_ok_response,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += (4 + tvb_get_ntohl(tvb, offset));
+    if (!exchange || !routing_key)
+        return;
+    if (!*exchange) {
+        amqp_queue_update(tvb, pinfo, routing_key, 1, 0);
+        return;
+    }
 
-    /*  locale (shortstr)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_start_ok_locale,
-        tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN);
-    offset += (1 + tvb_get_guint8(tvb, offset));
+    ex = (amqp_exchange *)wmem_map_lookup(amqp_exchanges, exchange);
+    if (!ex)
+        return;
+    for (frame = wmem_list_head(ex->bindings); frame; frame = wmem_list_frame_next(frame)) {
+        amqp_binding *binding = (amqp_binding *)wmem_list_frame_data(frame);
 
-    return offset;
+        /* a queue bound several times gets the message once */
+        if ((ex->fanout ||
+             (ex->topic ? amqp_topic_matches(binding->binding_key, routing_key) :
+                          strcmp(binding->binding_key, routing_key) == 0)) &&
+            !amqp_queue_in_sample(tvb, pinfo, binding->queue))
+            amqp_queue_update(tvb, pinfo, binding->queue, 1, 0);
+    }
 }
 
-/*  Dissection routine for method Connection.Secure                       */
-
-static int
-dissect_amqp_0_9_method_connection_secure(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static amqp_exchange *
+amqp_exchange_get(const char *name)
 {
-    /*  challenge (longstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_secure_challenge,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += (4 + tvb_get_ntohl(tvb, offset));
+    amqp_exchange *ex;
 
-    return offset;
+    ex = (amqp_exchange *)wmem_map_lookup(amqp_exchanges, name);
+    if (!ex) {
+        ex = wmem_new0(wmem_file_scope(), amqp_exchange);
+        ex->bindings = wmem_list_new(wmem_file_scope());
+        /* the fanout and topic exchanges every broker predeclares */
+        ex->fanout = strcmp(name, "amq.fanout") == 0;
+        ex->topic = strcmp(name, "amq.topic") == 0;
+        wmem_map_insert(amqp_exchanges, wmem_strdup(wmem_file_scope(), name), ex);
+    }
+    return ex;
 }
 
-/*  Dissection routine for method Connection.Secure-Ok                    */
-
-static int
-dissect_amqp_0_9_method_connection_secure_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Adds or removes a binding of a queue to an exchange */
+static void
+amqp_queue_bind(const char *queue, const char *exchange, const char *binding_key, gboolean bind)
 {
-    /*  response (longstr)       */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_secure_ok_response,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += (4 + tvb_get_ntohl(tvb, offset));
+    amqp_exchange *ex;
+    amqp_binding *binding;
+    wmem_list_frame_t *frame;
 
-    return offset;
+    if (!queue || !exchange || !binding_key)
+        return;
+    ex = amqp_exchange_get(exchange);
+    for (frame = wmem_list_head(ex->bindings); frame; frame = wmem_list_frame_next(frame)) {
+        binding = (amqp_binding *)wmem_list_frame_data(frame);
+        if (strcmp(binding->queue, queue) == 0 && strcmp(binding->binding_key, binding_key) == 0) {
+            if (!bind)
+                wmem_list_remove_frame(ex->bindings, frame);
+            return;
+        }
+    }
+    if (!bind)
+        return;
+    binding = wmem_new(wmem_file_scope(), amqp_binding);
+    binding->queue = wmem_strdup(wmem_file_scope(), queue);
+    binding->binding_key = wmem_strdup(wmem_file_scope(), binding_key);
+    wmem_list_append(ex->bindings, binding);
 }
 
-/*  Dissection routine for method Connection.Tune                         */
-
-static int
-dissect_amqp_0_9_method_connection_tune(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Shows the estimated state of the queues this frame changed */
+static void
+amqp_queue_add_sample(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 {
-    /*  channel-max (short)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_tune_channel_max,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    amqp_queue_sample *sample;
+    proto_item *ti;
+    proto_item *pi;
+    proto_tree *queue_tree;
+    guint i;
 
-    /*  frame-max (long)         */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_tune_frame_max,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+    if (!tree)
+        return;
+    sample = (amqp_queue_sample *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_QUEUE_SAMPLE_KEY(tvb));
+    if (!sample)
+        return;
 
-    /*  heartbeat (short)        */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_tune_heartbeat,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    for (i = 0; i < sample->count; i++) {
+        const amqp_tap_queue_t *queue = &sample->queues[i];
 
-    return offset;
+        ti = proto_tree_add_string(tree, hf_amqp_queue_state, tvb, 0, 0, queue->name);
+        proto_item_set_generated(ti);
+        if (!queue->anchored)
+            proto_item_append_text(ti, " (no message count seen from the broker)");
+        queue_tree = proto_item_add_subtree(ti, ett_amqp_queue_state);
+        pi = proto_tree_add_int64(queue_tree, hf_amqp_queue_state_ready, tvb, 0, 0, queue->ready);
+        proto_item_set_generated(pi);
+        pi = proto_tree_add_int64(queue_tree, hf_amqp_queue_state_unacked, tvb, 0, 0, queue->unacked);
+        proto_item_set_generated(pi);
+        pi = proto_tree_add_int64(queue_tree, hf_amqp_queue_state_depth, tvb, 0, 0,
+            queue->ready + queue->unacked);
+        proto_item_set_generated(pi);
+        if (queue->consumers >= 0) {
+            pi = proto_tree_add_uint(queue_tree, hf_amqp_queue_state_consumers, tvb, 0, 0,
+                (guint32)queue->consumers);
+            proto_item_set_generated(pi);
+        }
+    }
 }
 
-/*  Dissection routine for method Connection.Tune-Ok                      */
+/* Passes the estimated state of the queues this frame changed to the tap */
+static void
+amqp_tap_add_queues(tvbuff_t *tvb, packet_info *pinfo, amqp_tap_info_t *tap)
+{
+    amqp_queue_sample *sample;
 
-static int
-dissect_amqp_0_9_method_connection_tune_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+    sample = (amqp_queue_sample *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_QUEUE_SAMPLE_KEY(tvb));
+    if (sample) {
+        tap->queue_count = sample->count;
+        tap->queues = sample->queues;
+    }
+}
+
+/* Reports the queues a frame changed without a message event to the tap */
+static void
+tap_amqp_queues(tvbuff_t *tvb, packet_info *pinfo, int version, amqp_tap_event_t event,
+    guint16 channel_num)
 {
-    /*  channel-max (short)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_tune_ok_channel_max,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    amqp_tap_info_t *tap;
 
-    /*  frame-max (long)         */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_tune_ok_frame_max,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+    if (!have_tap_listener(amqp_tap))
+        return;
 
-    /*  heartbeat (short)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_tune_ok_heartbeat,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    tap = wmem_new0(pinfo->pool, amqp_tap_info_t);
+    tap->version = version;
+    tap->event = event;
+    tap->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    tap->channel = channel_num;
+    amqp_tap_add_queues(tvb, pinfo, tap);
+    if (tap->queue_count == 0)
+        return;
+    tap->queue = tap->queues[0].name;
+    tap_queue_packet(amqp_tap, pinfo, tap);
+}
 
-    return offset;
+/* Reports a message count the broker gave for a queue to the tap */
+static void
+tap_amqp_0_9_queue_count(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num)
+{
+    tap_amqp_queues(tvb, pinfo, AMQP_V0_9, AMQP_TAP_QUEUE_COUNT, channel_num);
 }
 
-/*  Dissection routine for method Connection.Open                         */
+/* Reports the queues the unacked messages of a closed channel or session
+ * went back to, to the tap */
+static void
+tap_amqp_requeue(tvbuff_t *tvb, packet_info *pinfo, int version, guint16 channel_num)
+{
+    tap_amqp_queues(tvb, pinfo, version, AMQP_TAP_REQUEUE, channel_num);
+}
 
-static int
-dissect_amqp_0_9_method_connection_open(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* Reports a complete AMQP 1.0 message to the tap */
+static void
+tap_amqp_1_0_transfer(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    guint list_offset, tvbuff_t *msg_tvb)
 {
-    const guint8* vhost;
-    /*  virtual-host (shortstr)  */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_connection_open_virtual_host,
-        tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN, wmem_packet_scope(), &vhost);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "vhost=%s ", vhost);
-    offset += (1 + tvb_get_guint8(tvb, offset));
+    amqp_1_0_transfer_fields fields;
+    amqp_tap_info_t *tap;
 
-    /*  capabilities (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_open_capabilities,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    if (!have_tap_listener(amqp_tap))
+        return;
 
-    /*  insist (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_open_insist,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    get_amqp_1_0_transfer_fields(tvb, list_offset, &fields);
 
-    return offset;
+    tap = wmem_new0(pinfo->pool, amqp_tap_info_t);
+    tap->version = AMQP_V1_0;
+    tap->event = amqp_sent_to_broker(pinfo) ? AMQP_TAP_PUBLISH : AMQP_TAP_DELIVER;
+    tap->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    tap->channel = channel_num;
+    tap->routing_key = (const gchar *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC);
+    tap->body_size = tvb_reported_length(msg_tvb);
+    tap->delivery_tag = fields.delivery_id;
+    tap->settled = fields.settled;
+    tap->state_size = amqp_tap_state_size(pinfo);
+    amqp_tap_add_queues(tvb, pinfo, tap);
+    tap_queue_packet(amqp_tap, pinfo, tap);
 }
 
-/*  Dissection routine for method Connection.Open-Ok                      */
-
-static int
-dissect_amqp_0_9_method_connection_open_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Reports a disposition with a terminal outcome to the tap */
+static void
+tap_amqp_1_0_disposition(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    guint offset)
 {
-    /*  known-hosts (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_open_ok_known_hosts,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    return offset;
-}
+    amqp_tap_info_t *tap;
+    amqp_1_0_disposition_fields fields;
 
-/*  Dissection routine for method Connection.Redirect                     */
-
-static int
-dissect_amqp_0_9_method_connection_redirect(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  host (shortstr)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_redirect_host,
-        tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN);
-    offset += (1 + tvb_get_guint8(tvb, offset));
+    if (!have_tap_listener(amqp_tap))
+        return;
 
-    /*  known-hosts (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_redirect_known_hosts,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    get_amqp_1_0_disposition_fields(tvb, offset, &fields);
+    if (!fields.has_outcome)
+        return;
 
-    return offset;
+    tap = wmem_new0(pinfo->pool, amqp_tap_info_t);
+    switch (fields.outcome) {
+    case AMQP_1_0_AMQP_TYPE_ACCEPTED:
+        tap->event = AMQP_TAP_ACK;
+        break;
+    case AMQP_1_0_AMQP_TYPE_REJECTED:
+        tap->event = AMQP_TAP_REJECT;
+        break;
+    case AMQP_1_0_AMQP_TYPE_RELEASED:
+    case AMQP_1_0_AMQP_TYPE_MODIFIED:
+        tap->event = AMQP_TAP_NACK;
+        break;
+    default:
+        /* received, or a transactional state */
+        return;
+    }
+    tap->version = AMQP_V1_0;
+    tap->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    tap->channel = channel_num;
+    tap->delivery_tag = fields.last;
+    tap->multiple = fields.last != fields.first;
+    tap->settled = fields.settled;
+    tap->state_size = amqp_tap_state_size(pinfo);
+    amqp_tap_add_queues(tvb, pinfo, tap);
+    tap_queue_packet(amqp_tap, pinfo, tap);
 }
 
-/*  Dissection routine for method Connection.Close                        */
+/* Locates the bytes of the binary, string or symbol at offset */
+static gboolean
+amqp_1_0_get_variable(tvbuff_t *tvb, guint offset, guint *data_offset, guint32 *length)
+{
+    switch (tvb_get_guint8(tvb, offset) >> 4) {
+    case 0xa:
+        *length = tvb_get_guint8(tvb, offset + 1);
+        *data_offset = offset + 2;
+        return TRUE;
+    case 0xb:
+        *length = tvb_get_ntohl(tvb, offset + 1);
+        *data_offset = offset + 5;
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
 
-static int
-dissect_amqp_0_9_method_connection_close(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* Fills in the export object record of a message from its sections: the
+ * address, subject and content type of the properties, and the body of the
+ * data sections or of a binary or string amqp-value */
+static gboolean
+amqp_1_0_get_eo_sections(tvbuff_t *msg_tvb, packet_info *pinfo, amqp_eo_t *eo_info)
 {
-    proto_item *tf_code;
-    const guint8* reply;
+    wmem_array_t *payload = NULL;
+    guint offset = 0;
+    guint value_offset;
+    guint data_offset;
+    guint32 length;
+    guint32 count;
+    guint32 i;
+    guint64 code;
+
+    while (tvb_reported_length_remaining(msg_tvb, offset) > 0) {
+        if (amqp_1_0_get_descriptor_code(msg_tvb, offset, &code)) {
+            value_offset = offset + 1 + amqp_1_0_primitive_length(msg_tvb, offset + 1);
+            switch (code) {
+            case AMQP_1_0_AMQP_TYPE_PROPERTIES:
+                count = amqp_1_0_get_list_count(msg_tvb, &value_offset);
+                for (i = 0; i < count && i <= AMQP_1_0_PROPERTIES_CONTENT_TYPE; i++) {
+                    if ((i == AMQP_1_0_PROPERTIES_TO || i == AMQP_1_0_PROPERTIES_SUBJECT ||
+                         i == AMQP_1_0_PROPERTIES_CONTENT_TYPE) &&
+                        amqp_1_0_get_variable(msg_tvb, value_offset, &data_offset, &length)) {
+                        const char *str = (const char *)tvb_get_string_enc(pinfo->pool, msg_tvb,
+                            data_offset, length, ENC_UTF_8);
+
+                        if (i == AMQP_1_0_PROPERTIES_TO)
+                            eo_info->exchange = str;
+                        else if (i == AMQP_1_0_PROPERTIES_SUBJECT)
+                            eo_info->routing_key = str;
+                        else
+                            eo_info->content_type = str;
+                    }
+                    value_offset += amqp_1_0_value_length(msg_tvb, value_offset);
+                }
+                break;
+            case AMQP_1_0_AMQP_TYPE_DATA:
+            case AMQP_1_0_AMQP_TYPE_AMQP_VALUE:
+                if (amqp_1_0_get_variable(msg_tvb, value_offset, &data_offset, &length)) {
+                    if (!payload)
+                        payload = wmem_array_new(pinfo->pool, 1);
+                    wmem_array_append(payload, tvb_get_ptr(msg_tvb, data_offset, length), length);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        offset += amqp_1_0_value_length(msg_tvb, offset);
+    }
 
-    /*  reply-code (short)       */
-    tf_code = proto_tree_add_item(args_tree, hf_amqp_0_9_method_connection_close_reply_code,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    if (tvb_get_ntohs(tvb, offset) > 200)
-        expert_add_info(pinfo, tf_code, &ei_amqp_connection_error);
-    offset += 2;
+    if (!payload)
+        return FALSE;
+    eo_info->payload = (const guint8 *)wmem_array_get_raw(payload);
+    eo_info->payload_len = wmem_array_get_count(payload);
+    return TRUE;
+}
 
-    /*  reply-text (shortstr)    */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_connection_close_reply_text,
-        tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN, wmem_packet_scope(), &reply);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "reply=%s ", reply);
-    offset += (1 + tvb_get_guint8(tvb, offset));
+/* Passes a complete AMQP 1.0 message to the export object tap */
+static void
+eo_amqp_1_0_transfer(tvbuff_t *tvb, packet_info *pinfo, guint list_offset, tvbuff_t *msg_tvb)
+{
+    amqp_eo_t *eo_info;
+    volatile gboolean has_body = FALSE;
+    guint data_offset;
+    guint32 length;
+    guint32 count;
+    guint32 i;
 
-    /*  class-id (short)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_close_class_id,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    if (!have_tap_listener(amqp_eo_tap))
+        return;
 
-    /*  method-id (short)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_close_method_id,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    eo_info = wmem_new0(pinfo->pool, amqp_eo_t);
+    TRY {
+        count = amqp_1_0_get_list_count(tvb, &list_offset);
+        for (i = 0; i < count && i <= AMQP_1_0_TRANSFER_DELIVERY_TAG; i++) {
+            if (i == AMQP_1_0_TRANSFER_DELIVERY_TAG &&
+                amqp_1_0_get_variable(tvb, list_offset, &data_offset, &length))
+                eo_info->delivery_tag = tvb_bytes_to_str(pinfo->pool, tvb, data_offset, length);
+            list_offset += amqp_1_0_value_length(tvb, list_offset);
+        }
+        has_body = amqp_1_0_get_eo_sections(msg_tvb, pinfo, eo_info);
+    }
+    CATCH_BOUNDS_ERRORS {
+        /* the dissection reports the malformed message */
+        has_body = FALSE;
+    }
+    ENDTRY;
 
-    return offset;
+    if (!has_body)
+        return;
+    if (!eo_info->routing_key)
+        eo_info->routing_key = (const char *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC);
+    tap_queue_packet(amqp_eo_tap, pinfo, eo_info);
 }
 
-/*  Dissection routine for method Connection.Close-Ok                     */
-
-static int
-dissect_amqp_0_9_method_connection_close_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
+/* Direction of a frame. Channel numbers and link handles are chosen
+ * independently by each peer, so they are only unique with it. */
+static guint
+amqp_1_0_direction(struct tcp_analysis *tcpd)
 {
-    return offset;
+    return tcpd->fwd == &(tcpd->flow1) ? 1 : 0;
 }
 
-/*  Dissection routine for method Connection.Blocked                      */
-
-static int
-dissect_amqp_0_9_method_connection_blocked(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static amqp_1_0_link *
+amqp_1_0_get_link(amqp_conv *conn, guint dir, guint16 channel_num, guint32 handle)
 {
-    /*  reason (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_connection_blocked_reason,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    return offset;
-}
+    amqp_1_0_link *link;
+    guint64 link_key;
 
-/*  Dissection routine for method Connection.Unblocked                    */
+    link_key = ((guint64)dir << 48) | ((guint64)channel_num << 32) | handle;
+    link = (amqp_1_0_link *)wmem_map_lookup(conn->links_1_0, &link_key);
+    if (!link) {
+        guint64 *key = wmem_new(wmem_file_scope(), guint64);
 
-static int
-dissect_amqp_0_9_method_connection_unblocked(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+        *key = link_key;
+        link = wmem_new0(wmem_file_scope(), amqp_1_0_link);
+        wmem_map_insert(conn->links_1_0, key, link);
+    }
+    return link;
 }
 
-/*  Dissection routine for method Channel.Open                            */
-
-static int
-dissect_amqp_0_9_method_channel_open(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Starts tracking a session on a channel, replacing any previous one */
+static amqp_1_0_session *
+amqp_1_0_new_session(amqp_conv *conn, guint dir, guint16 channel_num)
 {
-    /*  out-of-band (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_open_out_of_band,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    amqp_1_0_session *session;
 
-    return offset;
+    session = wmem_new0(wmem_file_scope(), amqp_1_0_session);
+    session->links = wmem_map_new(wmem_file_scope(), g_str_hash, g_str_equal);
+    wmem_map_insert(conn->sessions_1_0, GUINT_TO_POINTER((dir << 16) | channel_num), session);
+    conn->sessions_1_0_count++;
+    return session;
 }
 
-/*  Dissection routine for method Channel.Open-Ok                         */
-
-static int
-dissect_amqp_0_9_method_channel_open_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static amqp_1_0_session *
+amqp_1_0_get_session(amqp_conv *conn, guint dir, guint16 channel_num)
 {
-    /*  channel-id (longstr)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_open_ok_channel_id,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    amqp_1_0_session *session;
 
-    return offset;
+    session = (amqp_1_0_session *)wmem_map_lookup(conn->sessions_1_0,
+        GUINT_TO_POINTER((dir << 16) | channel_num));
+    if (!session)
+        session = amqp_1_0_new_session(conn, dir, channel_num);
+    return session;
 }
 
-/*  Dissection routine for method Channel.Flow                            */
+typedef struct {
+    const amqp_1_0_session *session;
+    gboolean found;
+} amqp_1_0_session_lookup;
 
-static int
-dissect_amqp_0_9_method_channel_flow(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_1_0_find_session(gpointer key _U_, gpointer value, gpointer user_data)
 {
-    /*  active (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_flow_active,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    amqp_1_0_session_lookup *lookup = (amqp_1_0_session_lookup *)user_data;
 
-    return offset;
+    if (value == lookup->session)
+        lookup->found = TRUE;
 }
 
-/*  Dissection routine for method Channel.Flow-Ok                         */
-
-static int
-dissect_amqp_0_9_method_channel_flow_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Frees a session no channel refers to any more, with the flow state of
+ * the links attached in it. The broker requeues the deliveries left
+ * unsettled, so they are ready again in their queues. */
+static void
+amqp_1_0_free_session(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, amqp_1_0_session *session)
 {
-    /*  active (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_flow_ok_active,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
-}
+    amqp_1_0_session_lookup lookup = { session, FALSE };
+    wmem_list_t *names;
+    wmem_list_frame_t *frame;
 
-/*  Dissection routine for method Channel.Close                           */
+    wmem_map_foreach(conn->sessions_1_0, amqp_1_0_find_session, &lookup);
+    if (lookup.found)
+        return;
 
-static int
-dissect_amqp_0_9_method_channel_close(guint16 channel_num, tvbuff_t *tvb,
-    packet_info *pinfo, int offset, proto_tree *args_tree)
-{
-    proto_item *tf_code;
-    const guint8* reply;
+    names = wmem_map_get_keys(pinfo->pool, session->links);
+    for (frame = wmem_list_head(names); frame; frame = wmem_list_frame_next(frame)) {
+        char *name = (char *)wmem_list_frame_data(frame);
 
-    /*  reply-code (short)       */
-    tf_code = proto_tree_add_item(args_tree, hf_amqp_method_channel_close_reply_code,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    if (tvb_get_ntohs(tvb, offset) > 200)
-        expert_add_info(pinfo, tf_code, &ei_amqp_channel_error);
-    offset += 2;
+        wmem_free(wmem_file_scope(), wmem_map_remove(session->links, name));
+        wmem_free(wmem_file_scope(), name);
+    }
+    if (session->unsettled) {
+        names = wmem_map_get_keys(pinfo->pool, session->unsettled);
+        for (frame = wmem_list_head(names); frame; frame = wmem_list_frame_next(frame))
+            amqp_queue_update(tvb, pinfo,
+                (const char *)wmem_map_remove(session->unsettled, wmem_list_frame_data(frame)), 1, -1);
+    }
+    wmem_free(wmem_file_scope(), session);
+    conn->sessions_1_0_count--;
+}
 
-    /*  reply-text (shortstr)    */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_channel_close_reply_text,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &reply);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "reply=%s ", reply);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+/*
+ * Releases the state of the links a peer attached on a channel once it
+ * ends the session, and of the session once both peers have ended it, so
+ * that connections which open and end many sessions do not accumulate it.
+ * The per-frame records of the session are kept. With all_channels the
+ * whole connection is closed.
+ */
+static void
+amqp_1_0_release_sessions(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, guint dir,
+    guint16 channel_num, gboolean all_channels)
+{
+    guint64 prefix = ((guint64)dir << 16) | channel_num;
+    wmem_list_t *keys;
+    wmem_list_frame_t *frame;
+    amqp_1_0_session *session;
+
+    keys = wmem_map_get_keys(pinfo->pool, conn->links_1_0);
+    for (frame = wmem_list_head(keys); frame; frame = wmem_list_frame_next(frame)) {
+        guint64 *key = (guint64 *)wmem_list_frame_data(frame);
+        amqp_1_0_link *link;
+
+        if (!all_channels && (*key >> 32) != prefix)
+            continue;
+        link = (amqp_1_0_link *)wmem_map_remove(conn->links_1_0, key);
+        if (link->own_flow)
+            wmem_free(wmem_file_scope(), link->flow);
+        wmem_free(wmem_file_scope(), link);
+        wmem_free(wmem_file_scope(), key);
+    }
+
+    if (!all_channels) {
+        session = (amqp_1_0_session *)wmem_map_remove(conn->sessions_1_0, GUINT_TO_POINTER((guint32)prefix));
+        if (session)
+            amqp_1_0_free_session(tvb, pinfo, conn, session);
+        return;
+    }
 
-    /*  class-id (short)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_close_class_id,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    keys = wmem_map_get_keys(pinfo->pool, conn->sessions_1_0);
+    for (frame = wmem_list_head(keys); frame; frame = wmem_list_frame_next(frame)) {
+        session = (amqp_1_0_session *)wmem_map_remove(conn->sessions_1_0, wmem_list_frame_data(frame));
+        amqp_1_0_free_session(tvb, pinfo, conn, session);
+    }
+}
 
-    /*  method-id (short)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_close_method_id,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+/* Counts a complete AMQP 1.0 message in the queue named by its "to"
+ * address, or else by the address of its link at the broker: the target
+ * of links to the broker, the source of links from it. The message is
+ * ready once sent to the broker, unacked once the broker sends it on
+ * unsettled. */
+static void
+amqp_1_0_queue_transfer(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num, guint list_offset)
+{
+    conversation_t *conv;
+    amqp_conv *conn;
+    struct tcp_analysis *tcpd;
+    amqp_1_0_transfer_fields fields;
+    amqp_1_0_session *session;
+    amqp_1_0_link_flow *flow;
+    gboolean to_broker;
+    guint dir;
+    const char *address;
 
-    /* delete channel */
-    if(!PINFO_FD_VISITED(pinfo))
-    {
-        conversation_t *conv;
-        amqp_conv *conn;
+    conv = find_or_create_conversation(pinfo);
+    conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+    tcpd = get_tcp_conversation_data(conv, pinfo);
+    if (!conn || !tcpd)
+        return;
+    dir = amqp_1_0_direction(tcpd);
+    to_broker = amqp_sent_to_broker(pinfo);
+    get_amqp_1_0_transfer_fields(tvb, list_offset, &fields);
 
-        conv = find_or_create_conversation(pinfo);
-        conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
-        if (conn)
-            wmem_map_remove(conn->channels, GUINT_TO_POINTER((guint32)channel_num));
+    address = (const char *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TO);
+    if (!address) {
+        flow = amqp_1_0_get_link(conn, dir, channel_num, fields.handle)->flow;
+        if (flow)
+            address = to_broker ? flow->target_address : flow->source_address;
+    }
+    if (!address)
+        return;
+    if (to_broker) {
+        amqp_queue_update(tvb, pinfo, address, 1, 0);
+        return;
     }
 
-    return offset;
-}
-
-/*  Dissection routine for method Channel.Close-Ok                        */
+    amqp_queue_update(tvb, pinfo, address, -1, fields.settled ? 0 : 1);
+    if (fields.settled || !fields.has_delivery_id)
+        return;
 
-static int
-dissect_amqp_0_9_method_channel_close_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    session = amqp_1_0_get_session(conn, dir, channel_num);
+    if (!session->unsettled)
+        session->unsettled = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+    wmem_map_insert(session->unsettled, GUINT_TO_POINTER(fields.delivery_id),
+        (gpointer)amqp_queue_get(address)->name);
 }
 
-/*  Dissection routine for method Channel.Resume                          */
-
-static int
-dissect_amqp_0_9_method_channel_resume(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Takes the deliveries a consumer settled with a disposition out of the
+ * unacked messages of their queues; released or modified ones are ready
+ * again */
+static void
+amqp_1_0_queue_disposition(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num, guint list_offset)
 {
-    /*  channel-id (longstr)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_channel_resume_channel_id,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    conversation_t *conv;
+    amqp_conv *conn;
+    struct tcp_analysis *tcpd;
+    amqp_1_0_disposition_fields fields;
+    amqp_1_0_session *session;
+    gboolean requeue;
+    const char *queue;
+    guint32 span;
 
-    return offset;
-}
+    if (!amqp_sent_to_broker(pinfo))
+        return;
+    get_amqp_1_0_disposition_fields(tvb, list_offset, &fields);
+    if (!fields.receiver || !fields.has_outcome)
+        return;
+    switch (fields.outcome) {
+    case AMQP_1_0_AMQP_TYPE_ACCEPTED:
+    case AMQP_1_0_AMQP_TYPE_REJECTED:
+        requeue = FALSE;
+        break;
+    case AMQP_1_0_AMQP_TYPE_RELEASED:
+    case AMQP_1_0_AMQP_TYPE_MODIFIED:
+        requeue = TRUE;
+        break;
+    default:
+        return;
+    }
 
-/*  Dissection routine for method Channel.Ping                            */
+    conv = find_or_create_conversation(pinfo);
+    conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+    tcpd = get_tcp_conversation_data(conv, pinfo);
+    if (!conn || !tcpd)
+        return;
+    session = (amqp_1_0_session *)wmem_map_lookup(conn->sessions_1_0,
+        GUINT_TO_POINTER((amqp_1_0_direction(tcpd) << 16) | channel_num));
+    if (!session || !session->unsettled)
+        return;
 
-static int
-dissect_amqp_0_9_method_channel_ping(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+    /* delivery-ids are serial numbers; walk the shorter of the range and
+     * the unsettled deliveries */
+    span = fields.last - fields.first;
+    if (span < wmem_map_size(session->unsettled)) {
+        guint32 id = fields.first;
+
+        do {
+            queue = (const char *)wmem_map_remove(session->unsettled, GUINT_TO_POINTER(id));
+            if (queue)
+                amqp_queue_update(tvb, pinfo, queue, requeue ? 1 : 0, -1);
+        } while (id++ != fields.last);
+    } else {
+        wmem_list_t *ids;
+        wmem_list_frame_t *frame;
 
-/*  Dissection routine for method Channel.Pong                            */
+        ids = wmem_map_get_keys(pinfo->pool, session->unsettled);
+        for (frame = wmem_list_head(ids); frame; frame = wmem_list_frame_next(frame)) {
+            guint32 id = GPOINTER_TO_UINT(wmem_list_frame_data(frame));
 
-static int
-dissect_amqp_0_9_method_channel_pong(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+            if (id - fields.first > span)
+                continue;
+            queue = (const char *)wmem_map_remove(session->unsettled, GUINT_TO_POINTER(id));
+            amqp_queue_update(tvb, pinfo, queue, requeue ? 1 : 0, -1);
+        }
+    }
 }
 
-/*  Dissection routine for method Channel.Ok                              */
-
-static int
-dissect_amqp_0_9_method_channel_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
+/* Session window left to transfers sent in direction dir. Transfer-ids are
+ * serial numbers; a window granted ahead of the transfers seen counts from
+ * the transfers seen. */
+static gint64
+amqp_1_0_session_window(const amqp_1_0_session *session, guint dir)
 {
-    return offset;
-}
+    gint32 used;
 
-/*  Dissection routine for method Access.Request                          */
+    used = (gint32)(session->next_outgoing_id[dir] - session->window_base[dir]);
+    return (gint64)session->incoming_window[dir] - MAX(used, 0);
+}
 
-static int
-dissect_amqp_0_9_method_access_request(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Link credit left to the sender, counted in deliveries */
+static gint64
+amqp_1_0_link_credit(const amqp_1_0_link_flow *flow)
 {
-    /*  realm (shortstr)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_realm,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    gint32 used;
 
-    /*  exclusive (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_exclusive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  passive (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_passive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    used = (gint32)(flow->delivery_count - flow->credit_base);
+    return (gint64)flow->link_credit - MAX(used, 0);
+}
 
-    /*  active (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_active,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static void
+amqp_1_0_track_begin(tvbuff_t *tvb, amqp_conv *conn, guint dir, guint16 channel_num,
+    guint offset)
+{
+    amqp_1_0_session *session = NULL;
+    guint32 count;
+    guint32 i;
+    guint32 remote_channel = 0;
+    guint32 next_outgoing_id = 0;
+    guint32 incoming_window = 0;
+    gboolean has_remote_channel = FALSE;
+    gboolean has_next_outgoing_id = FALSE;
+    gboolean has_incoming_window = FALSE;
+    guint d;
+
+    count = amqp_1_0_get_list_count(tvb, &offset);
+    for (i = 0; i < count && i <= AMQP_1_0_BEGIN_INCOMING_WINDOW; i++) {
+        switch (i) {
+        case AMQP_1_0_BEGIN_REMOTE_CHANNEL:
+            has_remote_channel = amqp_1_0_get_uint(tvb, offset, &remote_channel);
+            break;
+        case AMQP_1_0_BEGIN_NEXT_OUTGOING_ID:
+            has_next_outgoing_id = amqp_1_0_get_uint(tvb, offset, &next_outgoing_id);
+            break;
+        case AMQP_1_0_BEGIN_INCOMING_WINDOW:
+            has_incoming_window = amqp_1_0_get_uint(tvb, offset, &incoming_window);
+            break;
+        default:
+            break;
+        }
+        offset += amqp_1_0_value_length(tvb, offset);
+    }
 
-    /*  write (bit)              */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_write,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    if (has_remote_channel && remote_channel <= G_MAXUINT16) {
+        /* the answer to the peer's begin, both channels carry one session */
+        session = (amqp_1_0_session *)wmem_map_lookup(conn->sessions_1_0,
+            GUINT_TO_POINTER(((!dir) << 16) | remote_channel));
+        if (session)
+            wmem_map_insert(conn->sessions_1_0, GUINT_TO_POINTER((dir << 16) | channel_num), session);
+    }
+    if (!session)
+        session = amqp_1_0_new_session(conn, dir, channel_num);
 
-    /*  read (bit)               */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_read,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    if (has_next_outgoing_id) {
+        session->has_next_outgoing_id[dir] = TRUE;
+        session->next_outgoing_id[dir] = next_outgoing_id;
+    }
+    if (has_incoming_window) {
+        session->has_begin_window[!dir] = TRUE;
+        session->begin_window[!dir] = incoming_window;
+    }
 
-    return offset;
+    /* a begin window counts from the peer's next-outgoing-id, which is
+     * only known once both begins have been seen */
+    for (d = 0; d < 2; d++) {
+        if (session->has_begin_window[d] && session->has_next_outgoing_id[d] &&
+            !session->has_window[d]) {
+            session->has_window[d] = TRUE;
+            session->window_base[d] = session->next_outgoing_id[d];
+            session->incoming_window[d] = session->begin_window[d];
+        }
+    }
 }
 
-/*  Dissection routine for method Access.Request-Ok                       */
+static void
+amqp_1_0_track_attach(tvbuff_t *tvb, amqp_conv *conn, guint dir, guint16 channel_num,
+    guint offset)
+{
+    amqp_1_0_session *session;
+    amqp_1_0_link_flow *flow;
+    guint32 count;
+    guint32 i;
+    char *name = NULL;
+    guint32 handle = 0;
+    gboolean has_handle = FALSE;
+    gboolean receiver = FALSE;
+    guint32 init_delivery_count = 0;
+    gboolean has_init_delivery_count = FALSE;
+    char *source_address = NULL;
+    char *target_address = NULL;
+
+    count = amqp_1_0_get_list_count(tvb, &offset);
+    for (i = 0; i < count && i <= AMQP_1_0_ATTACH_INIT_DELIVERY_COUNT; i++) {
+        switch (i) {
+        case AMQP_1_0_ATTACH_NAME:
+            if (tvb_get_guint8(tvb, offset) == 0xa1) /* str8-utf8 */
+                name = (char *)tvb_get_string_enc(wmem_file_scope(), tvb, offset + 2,
+                    tvb_get_guint8(tvb, offset + 1), ENC_UTF_8);
+            else if (tvb_get_guint8(tvb, offset) == 0xb1) /* str32-utf8 */
+                name = (char *)tvb_get_string_enc(wmem_file_scope(), tvb, offset + 5,
+                    tvb_get_ntohl(tvb, offset + 1), ENC_UTF_8);
+            break;
+        case AMQP_1_0_ATTACH_HANDLE:
+            has_handle = amqp_1_0_get_uint(tvb, offset, &handle);
+            break;
+        case AMQP_1_0_ATTACH_ROLE:
+            receiver = amqp_1_0_get_boolean(tvb, offset);
+            break;
+        case AMQP_1_0_ATTACH_SOURCE:
+            source_address = amqp_1_0_get_terminus_address(tvb, offset);
+            break;
+        case AMQP_1_0_ATTACH_TARGET:
+            target_address = amqp_1_0_get_terminus_address(tvb, offset);
+            break;
+        case AMQP_1_0_ATTACH_INIT_DELIVERY_COUNT:
+            has_init_delivery_count = amqp_1_0_get_uint(tvb, offset, &init_delivery_count);
+            break;
+        default:
+            break;
+        }
+        offset += amqp_1_0_value_length(tvb, offset);
+    }
+    if (!name || !has_handle)
+        return;
 
-static int
-dissect_amqp_0_9_method_access_request_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_access_request_ok_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    /* both ends attach a link with the same name, each with its own handle */
+    session = amqp_1_0_get_session(conn, dir, channel_num);
+    flow = (amqp_1_0_link_flow *)wmem_map_lookup(session->links, name);
+    if (!flow || flow->attached[dir]) {
+        flow = wmem_new0(wmem_file_scope(), amqp_1_0_link_flow);
+        /* a link attached again keeps the name already in the map */
+        if (wmem_map_insert(session->links, name, flow))
+            wmem_free(wmem_file_scope(), name);
+    } else {
+        wmem_free(wmem_file_scope(), name);
+    }
+    flow->attached[dir] = TRUE;
+    flow->has_sender_dir = TRUE;
+    flow->sender_dir = receiver ? !dir : dir;
+    if (!receiver && has_init_delivery_count && !flow->has_delivery_count) {
+        flow->has_delivery_count = TRUE;
+        flow->delivery_count = init_delivery_count;
+    }
+    /* the attach of the broker may fill in a dynamic address */
+    if (source_address)
+        flow->source_address = source_address;
+    if (target_address)
+        flow->target_address = target_address;
+    amqp_1_0_get_link(conn, dir, channel_num, handle)->flow = flow;
+}
+
+static amqp_1_0_flow_info *
+amqp_1_0_track_flow(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, guint dir,
+    guint16 channel_num, guint offset)
+{
+    amqp_1_0_flow_info *info;
+    amqp_1_0_session *session;
+    guint32 count;
+    guint32 i;
+    guint32 next_incoming_id = 0;
+    guint32 incoming_window = 0;
+    guint32 next_outgoing_id = 0;
+    guint32 handle = 0;
+    guint32 delivery_count = 0;
+    guint32 link_credit = 0;
+    gboolean has_next_incoming_id = FALSE;
+    gboolean has_incoming_window = FALSE;
+    gboolean has_next_outgoing_id = FALSE;
+    gboolean has_handle = FALSE;
+    gboolean has_delivery_count = FALSE;
+    gboolean has_link_credit = FALSE;
+    guint peer = !dir;
+
+    count = amqp_1_0_get_list_count(tvb, &offset);
+    for (i = 0; i < count && i <= AMQP_1_0_FLOW_LINK_CREDIT; i++) {
+        switch (i) {
+        case AMQP_1_0_FLOW_NEXT_INCOMING_ID:
+            has_next_incoming_id = amqp_1_0_get_uint(tvb, offset, &next_incoming_id);
+            break;
+        case AMQP_1_0_FLOW_INCOMING_WINDOW:
+            has_incoming_window = amqp_1_0_get_uint(tvb, offset, &incoming_window);
+            break;
+        case AMQP_1_0_FLOW_NEXT_OUTGOING_ID:
+            has_next_outgoing_id = amqp_1_0_get_uint(tvb, offset, &next_outgoing_id);
+            break;
+        case AMQP_1_0_FLOW_HANDLE:
+            has_handle = amqp_1_0_get_uint(tvb, offset, &handle);
+            break;
+        case AMQP_1_0_FLOW_DELIVERY_COUNT:
+            has_delivery_count = amqp_1_0_get_uint(tvb, offset, &delivery_count);
+            break;
+        case AMQP_1_0_FLOW_LINK_CREDIT:
+            has_link_credit = amqp_1_0_get_uint(tvb, offset, &link_credit);
+            break;
+        default:
+            break;
+        }
+        offset += amqp_1_0_value_length(tvb, offset);
+    }
 
-    return offset;
-}
+    info = wmem_new0(wmem_file_scope(), amqp_1_0_flow_info);
+    session = amqp_1_0_get_session(conn, dir, channel_num);
+    if (has_next_outgoing_id) {
+        session->has_next_outgoing_id[dir] = TRUE;
+        session->next_outgoing_id[dir] = next_outgoing_id;
+    }
 
-/*  Dissection routine for method Exchange.Declare                        */
+    /* the incoming window limits the transfers of the peer */
+    if (has_incoming_window) {
+        if (!has_next_incoming_id && session->has_next_outgoing_id[peer]) {
+            /* the peer's begin was not seen by the sender of the flow yet */
+            has_next_incoming_id = TRUE;
+            next_incoming_id = session->next_outgoing_id[peer];
+        }
+        if (has_next_incoming_id) {
+            if (!session->has_next_outgoing_id[peer]) {
+                /* the session began before the capture */
+                session->has_next_outgoing_id[peer] = TRUE;
+                session->next_outgoing_id[peer] = next_incoming_id;
+            }
+            session->has_window[peer] = TRUE;
+            session->window_base[peer] = next_incoming_id;
+            session->incoming_window[peer] = incoming_window;
+
+            info->has_session_window = TRUE;
+            info->session_window = amqp_1_0_session_window(session, peer);
+            if (info->session_window <= 0) {
+                info->flags |= AMQP_1_0_FLOW_INFO_WINDOW_CLOSED;
+                if (!session->blocked_frame[peer]) {
+                    session->blocked_frame[peer] = pinfo->num;
+                    session->blocked_since[peer] = pinfo->abs_ts;
+                }
+            } else if (session->blocked_frame[peer]) {
+                info->session_blocked_frame = session->blocked_frame[peer];
+                nstime_delta(&info->session_blocked_time, &pinfo->abs_ts, &session->blocked_since[peer]);
+                session->blocked_frame[peer] = 0;
+            }
+        }
+    }
 
-static int
-dissect_amqp_0_9_method_exchange_declare(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    proto_item *ti;
-    const guint8* exchange;
+    if (has_handle) {
+        amqp_1_0_link_flow *flow;
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+        flow = amqp_1_0_get_link(conn, dir, channel_num, handle)->flow;
+        if (!flow || !flow->has_sender_dir) {
+            /* attach not captured, the direction of the link is unknown */
+        } else if (flow->sender_dir == dir) {
+            if (has_delivery_count) {
+                flow->has_delivery_count = TRUE;
+                flow->delivery_count = delivery_count;
+            }
+        } else if (has_link_credit) {
+            /* credit is granted relative to the sender's delivery-count as
+             * last seen by the receiver, or to the initial one */
+            if (!has_delivery_count && flow->has_delivery_count) {
+                has_delivery_count = TRUE;
+                delivery_count = flow->delivery_count;
+            }
+            if (has_delivery_count) {
+                if (!flow->has_delivery_count) {
+                    flow->has_delivery_count = TRUE;
+                    flow->delivery_count = delivery_count;
+                }
+                flow->has_credit = TRUE;
+                flow->credit_base = delivery_count;
+                flow->link_credit = link_credit;
+
+                info->has_link_credit = TRUE;
+                info->link_credit = amqp_1_0_link_credit(flow);
+                if (info->link_credit <= 0) {
+                    info->flags |= AMQP_1_0_FLOW_INFO_CREDIT_STARVED;
+                    if (!flow->blocked_frame) {
+                        flow->blocked_frame = pinfo->num;
+                        flow->blocked_since = pinfo->abs_ts;
+                    }
+                } else if (flow->blocked_frame) {
+                    info->link_blocked_frame = flow->blocked_frame;
+                    nstime_delta(&info->link_blocked_time, &pinfo->abs_ts, &flow->blocked_since);
+                    flow->blocked_frame = 0;
+                }
+            }
+        }
+    }
 
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_exchange_declare_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &exchange);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", exchange);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    return info;
+}
 
-    /*  type (shortstr)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_type,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static amqp_1_0_flow_info *
+amqp_1_0_track_transfer(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, guint dir,
+    guint16 channel_num, guint offset)
+{
+    amqp_1_0_flow_info *info;
+    amqp_1_0_session *session;
+    amqp_1_0_link_flow *flow;
+    amqp_1_0_link *link;
+    amqp_1_0_transfer_fields fields;
+    gint64 remaining;
 
-    /*  passive (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_passive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    get_amqp_1_0_transfer_fields(tvb, offset, &fields);
 
-    /*  durable (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_durable,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    info = wmem_new0(wmem_file_scope(), amqp_1_0_flow_info);
+    session = amqp_1_0_get_session(conn, dir, channel_num);
+    if (session->has_next_outgoing_id[dir]) {
+        /* every transfer frame takes one transfer-id of the window */
+        if (session->has_window[dir]) {
+            remaining = amqp_1_0_session_window(session, dir);
+            if (remaining <= 0)
+                info->flags |= AMQP_1_0_FLOW_INFO_WINDOW_EXCEEDED;
+            else if (remaining == 1)
+                info->flags |= AMQP_1_0_FLOW_INFO_WINDOW_EXHAUSTED;
+            if (remaining <= 1 && !session->blocked_frame[dir]) {
+                session->blocked_frame[dir] = pinfo->num;
+                session->blocked_since[dir] = pinfo->abs_ts;
+            }
+            info->has_session_window = TRUE;
+            info->session_window = remaining - 1;
+        }
+        session->next_outgoing_id[dir]++;
+    }
 
-    /*  auto-delete (bit)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_auto_delete,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    link = amqp_1_0_get_link(conn, dir, channel_num, fields.handle);
+    if (!link->flow) {
+        /* attach not captured, the link sends in this direction */
+        link->flow = wmem_new0(wmem_file_scope(), amqp_1_0_link_flow);
+        link->flow->has_sender_dir = TRUE;
+        link->flow->sender_dir = dir;
+        link->own_flow = TRUE;
+    }
+    flow = link->flow;
+    if (flow->sender_dir != dir)
+        return info;
 
-    /*  internal (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_internal,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    if (flow->in_delivery) {
+        /* the rest of a delivery takes no more credit */
+        if (flow->has_credit) {
+            info->has_link_credit = TRUE;
+            info->link_credit = amqp_1_0_link_credit(flow);
+        }
+    } else {
+        if (flow->has_credit) {
+            remaining = amqp_1_0_link_credit(flow);
+            if (remaining <= 0)
+                info->flags |= AMQP_1_0_FLOW_INFO_NO_CREDIT;
+            else if (remaining == 1)
+                info->flags |= AMQP_1_0_FLOW_INFO_CREDIT_EXHAUSTED;
+            if (remaining <= 1 && !flow->blocked_frame) {
+                flow->blocked_frame = pinfo->num;
+                flow->blocked_since = pinfo->abs_ts;
+            }
+            info->has_link_credit = TRUE;
+            info->link_credit = remaining - 1;
+        }
+        if (flow->has_delivery_count)
+            flow->delivery_count++;
+    }
+    flow->in_delivery = fields.more && !fields.aborted;
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    return info;
+}
 
-    offset += 1;
-    /*  arguments (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_exchange_declare_arguments,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+/*
+ * Follows the session windows and link credit of AMQP 1.0 sessions on the
+ * first pass, and records the state after each flow and transfer for
+ * amqp_1_0_add_flow_info.
+ */
+static void
+amqp_1_0_track_flow_control(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    guint32 method, guint offset)
+{
+    conversation_t *conv;
+    amqp_conv *conn;
+    struct tcp_analysis *tcpd;
+    amqp_1_0_flow_info *info = NULL;
+    guint dir;
 
-    return offset;
-}
+    conv = find_or_create_conversation(pinfo);
+    conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+    tcpd = get_tcp_conversation_data(conv, pinfo);
+    if (!conn || !tcpd)
+        return;
+    dir = amqp_1_0_direction(tcpd);
 
-/*  Dissection routine for method Exchange.Declare-Ok                     */
+    switch (method) {
+    case AMQP_1_0_AMQP_BEGIN:
+        amqp_1_0_track_begin(tvb, conn, dir, channel_num, offset);
+        break;
+    case AMQP_1_0_AMQP_ATTACH:
+        amqp_1_0_track_attach(tvb, conn, dir, channel_num, offset);
+        break;
+    case AMQP_1_0_AMQP_FLOW:
+        info = amqp_1_0_track_flow(tvb, pinfo, conn, dir, channel_num, offset);
+        break;
+    case AMQP_1_0_AMQP_TRANSFER:
+        info = amqp_1_0_track_transfer(tvb, pinfo, conn, dir, channel_num, offset);
+        break;
+    case AMQP_1_0_AMQP_END:
+        amqp_1_0_release_sessions(tvb, pinfo, conn, dir, channel_num, FALSE);
+        break;
+    case AMQP_1_0_AMQP_CLOSE:
+        amqp_1_0_release_sessions(tvb, pinfo, conn, dir, channel_num, TRUE);
+        break;
+    default:
+        break;
+    }
 
-static int
-dissect_amqp_0_9_method_exchange_declare_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    /* keyed by the v1.0 protocol, transfers use the AMQP key for reassembly */
+    if (info)
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_amqpv1_0, (guint32)tvb_raw_offset(tvb), info);
 }
 
-/*  Dissection routine for method Exchange.Bind                           */
-
-static int
-dissect_amqp_0_9_method_exchange_bind(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* Adds the flow control state recorded for a flow or transfer */
+static void
+amqp_1_0_add_flow_info(tvbuff_t *tvb, packet_info *pinfo, proto_tree *args_tree)
 {
-    proto_item *ti;
-    const guint8* str;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_declare_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    amqp_1_0_flow_info *info;
+    proto_item *pi;
 
-    /*  destination (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_exchange_bind_destination,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "dx=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  source (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_exchange_bind_source,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "sx=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_exchange_bind_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "bk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_bind_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-    offset += 1;
+    info = (amqp_1_0_flow_info *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqpv1_0,
+        (guint32)tvb_raw_offset(tvb));
+    if (!info)
+        return;
 
-    /*  arguments (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_exchange_bind_arguments,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    if (info->has_link_credit) {
+        pi = proto_tree_add_int64(args_tree, hf_amqp_1_0_link_credit_left, tvb, 0, 0, info->link_credit);
+        proto_item_set_generated(pi);
+        if (info->flags & AMQP_1_0_FLOW_INFO_NO_CREDIT)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_no_link_credit);
+        if (info->flags & AMQP_1_0_FLOW_INFO_CREDIT_EXHAUSTED)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_link_credit_exhausted);
+        if (info->flags & AMQP_1_0_FLOW_INFO_CREDIT_STARVED)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_link_credit_starved);
+    }
+    if (info->link_blocked_frame) {
+        pi = proto_tree_add_uint(args_tree, hf_amqp_1_0_link_blocked_in, tvb, 0, 0, info->link_blocked_frame);
+        proto_item_set_generated(pi);
+        pi = proto_tree_add_time(args_tree, hf_amqp_1_0_link_blocked_time, tvb, 0, 0, &info->link_blocked_time);
+        proto_item_set_generated(pi);
+        expert_add_info_format(pinfo, pi, &ei_amqp_1_0_link_blocked,
+            "Link was blocked on credit for %s seconds",
+            rel_time_to_secs_str(pinfo->pool, &info->link_blocked_time));
+    }
 
-    return offset;
+    if (info->has_session_window) {
+        pi = proto_tree_add_int64(args_tree, hf_amqp_1_0_session_window_left, tvb, 0, 0, info->session_window);
+        proto_item_set_generated(pi);
+        if (info->flags & AMQP_1_0_FLOW_INFO_WINDOW_EXCEEDED)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_session_window_exceeded);
+        if (info->flags & AMQP_1_0_FLOW_INFO_WINDOW_EXHAUSTED)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_session_window_exhausted);
+        if (info->flags & AMQP_1_0_FLOW_INFO_WINDOW_CLOSED)
+            expert_add_info(pinfo, pi, &ei_amqp_1_0_session_window_closed);
+    }
+    if (info->session_blocked_frame) {
+        pi = proto_tree_add_uint(args_tree, hf_amqp_1_0_session_blocked_in, tvb, 0, 0, info->session_blocked_frame);
+        proto_item_set_generated(pi);
+        pi = proto_tree_add_time(args_tree, hf_amqp_1_0_session_blocked_time, tvb, 0, 0, &info->session_blocked_time);
+        proto_item_set_generated(pi);
+        expert_add_info_format(pinfo, pi, &ei_amqp_1_0_session_blocked,
+            "Session was blocked on its window for %s seconds",
+            rel_time_to_secs_str(pinfo->pool, &info->session_blocked_time));
+    }
 }
 
-/*  Dissection routine for method Exchange.Bind-Ok                        */
-
-static int
-dissect_amqp_0_9_method_exchange_bind_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
+/*
+ * Large messages are split over several transfers of the same delivery with
+ * more=true. Collects the message sections that follow the transfer
+ * performative, keyed by session channel, link handle and delivery-id, and
+ * returns a tvb with the whole message in the transfer that completes it.
+ * Returns NULL in the other transfers of a split message.
+ */
+static tvbuff_t *
+amqp_1_0_reassemble_transfer(tvbuff_t *tvb, packet_info *pinfo, proto_tree *args_tree,
+    guint16 channel_num, guint list_offset, guint payload_offset)
 {
-    return offset;
-}
+    amqp_body_frag *frag;
+    tvbuff_t       *msg_tvb = NULL;
+    guint           length;
 
-/*  Dissection routine for method Exchange.Delete                         */
+    length = tvb_reported_length_remaining(tvb, payload_offset);
+    frag = (amqp_body_frag *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if (!frag) {
+        conversation_t *conv;
+        amqp_conv *conn;
+        struct tcp_analysis *tcpd;
+        amqp_1_0_transfer_fields fields;
+        amqp_1_0_link *link;
 
-static int
-dissect_amqp_0_9_method_exchange_delete(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    const guint8* exchange;
+        conv = find_or_create_conversation(pinfo);
+        conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+        tcpd = get_tcp_conversation_data(conv, pinfo);
+        if (!conn || !tcpd)
+            return tvb_new_subset_remaining(tvb, payload_offset);
+
+        get_amqp_1_0_transfer_fields(tvb, list_offset, &fields);
+
+        link = amqp_1_0_get_link(conn, amqp_1_0_direction(tcpd), channel_num, fields.handle);
+
+        /* a different delivery-id means the rest of the previous delivery
+         * was not captured */
+        if (link->msg_id && fields.has_delivery_id && fields.delivery_id != link->delivery_id)
+            link->msg_id = 0;
+        if (!link->msg_id && fields.more && !fields.aborted &&
+            length <= amqp_max_body_reassembly) {
+            link->msg_id = ++conn->body_msg_seq;
+            link->delivery_id = fields.delivery_id;
+            link->received = 0;
+        }
+
+        frag = wmem_new0(wmem_file_scope(), amqp_body_frag);
+        if (link->msg_id && !fields.aborted) {
+            frag->msg_id = link->msg_id;
+            frag->frag_offset = link->received;
+            frag->last = !fields.more;
+            link->received += length;
+            if (link->received > amqp_max_body_reassembly) {
+                /* too big, dissect the transfers one by one */
+                frag->msg_id = 0;
+                link->msg_id = 0;
+            }
+        }
+        if (frag->last || fields.aborted)
+            link->msg_id = 0;
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_delete_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, (guint32)tvb_raw_offset(tvb), frag);
+    }
 
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_exchange_delete_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &exchange);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", exchange);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    if (frag->msg_id) {
+        fragment_head *fd_head;
+        gboolean save_fragmented = pinfo->fragmented;
 
-    /*  if-unused (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_delete_if_unused,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        /* on later passes this only looks up the completed message */
+        pinfo->fragmented = TRUE;
+        fd_head = fragment_add_check(&amqp_reassembly_table, tvb, payload_offset, pinfo,
+            frag->msg_id, NULL, frag->frag_offset, length, !frag->last);
+        if (frag->last) {
+            msg_tvb = process_reassembled_data(tvb, payload_offset, pinfo,
+                "Reassembled AMQP Message", fd_head, &amqp_frag_items, NULL, args_tree);
+        } else if (fd_head && fd_head->reassembled_in != 0) {
+            proto_item *pi;
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_exchange_delete_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+            pi = proto_tree_add_uint(args_tree, hf_amqp_reassembled_in,
+                tvb, 0, 0, fd_head->reassembled_in);
+            proto_item_set_generated(pi);
+        }
+        pinfo->fragmented = save_fragmented;
+    } else {
+        msg_tvb = tvb_new_subset_remaining(tvb, payload_offset);
+    }
 
-    return offset;
+    return msg_tvb;
 }
 
-/*  Dissection routine for method Exchange.Delete-Ok                      */
+/* Adds a section of a completed message to the summary of its transfer if
+ * it is a data section, i.e. one passed to find_data_dissector */
+static void
+amqp_1_0_summarize_section(tvbuff_t *msg_tvb, guint offset, amqp_1_0_transfer_summary *summary)
+{
+    amqp_1_0_data_section section;
+    int hf_amqp_type = hf_amqp_1_0_list;
+    const char *name = NULL;
+    guint32 subtype_count = 0;
+    int * const *subtypes = NULL;
+    guint type_length;
+    int code;
+
+    code = get_amqp_1_0_type_formatter(msg_tvb, offset, &hf_amqp_type, &name,
+                                       &subtype_count, &subtypes, &type_length);
+    if (hf_amqp_type != hf_amqp_1_0_data)
+        return;
+    offset += type_length;
 
-static int
-dissect_amqp_0_9_method_exchange_delete_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    switch (code & 0xf0) {
+    case 0xa0: /* variable-one */
+        section.length = tvb_get_guint8(msg_tvb, offset);
+        section.offset = offset + 1;
+        break;
+    case 0xb0: /* variable-four */
+        section.length = tvb_get_ntohl(msg_tvb, offset);
+        section.offset = offset + 4;
+        break;
+    default:
+        return;
+    }
+    if (!summary->sections)
+        summary->sections = wmem_array_new(wmem_file_scope(), sizeof(amqp_1_0_data_section));
+    wmem_array_append_one(summary->sections, section);
 }
 
-/*  Dissection routine for method Queue.Declare                           */
+/*
+ * Dissects a transfer from its summary, see amqp_use_frame_summary. Only the
+ * data sections of a completed message are passed on to the message decode
+ * table, and the tap gets the topic found by the first pass.
+ */
+static gboolean
+amqp_1_0_transfer_from_summary(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    guint offset)
+{
+    amqp_1_0_transfer_summary *summary;
+    amqp_1_0_data_section *section;
+    tvbuff_t *msg_tvb;
+    guint i;
+
+    summary = (amqp_1_0_transfer_summary *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_FRAME_SUMMARY_KEY(tvb));
+    if (!summary)
+        return FALSE;
+
+    if ((summary->args_length == 0) || (tvb_reported_length_remaining(tvb, offset + summary->args_length) <= 0))
+        return TRUE;
+    msg_tvb = amqp_1_0_reassemble_transfer(tvb, pinfo, NULL, channel_num,
+                                           offset, offset + summary->args_length);
+    if (msg_tvb == NULL)
+        return TRUE;
+
+    p_remove_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC);
+    if (summary->topic)
+        p_add_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC, (void *)summary->topic);
+    if (summary->sections) {
+        for (i = 0; i < wmem_array_get_count(summary->sections); i++) {
+            section = (amqp_1_0_data_section *)wmem_array_index(summary->sections, i);
+            find_data_dissector(tvb_new_subset_length_caplen(msg_tvb, section->offset,
+                                    section->length, section->length),
+                                pinfo, NULL, summary->topic);
+        }
+    }
+    tap_amqp_1_0_transfer(tvb, pinfo, channel_num, offset, msg_tvb);
+    eo_amqp_1_0_transfer(tvb, pinfo, offset, msg_tvb);
+    return TRUE;
+}
 
-static int
-dissect_amqp_0_9_method_queue_declare(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* decodes AMQP 1.0 AMQP performative (open, attach, transfer or so)
+ * arguments:
+ *   tvb, offset, length, amqp_tree, pinfo: obvious
+ *   channel_num: session channel from the frame header
+ *   method_name: what to print to col_append_str method in dissect_amqp_1_0_frame
+ */
+static void
+dissect_amqp_1_0_AMQP_frame(tvbuff_t *tvb,
+                            proto_item *amqp_item,
+                            packet_info *pinfo,
+                            guint16 channel_num)
 {
-    proto_item *ti;
-    const guint8* queue;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_declare_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  passive (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_passive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  durable (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_durable,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  exclusive (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_exclusive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_item  *args_tree;
+    guint32     arg_length = 0;
+    guint32     method;
+    gint        offset = 0;
+    gint        list_offset;
+    proto_item* ti;
+    tvbuff_t    *msg_tvb;
+    amqp_1_0_transfer_summary *summary = NULL;
 
-    /*  auto-delete (bit)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_auto_delete,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    args_tree = proto_item_add_subtree(amqp_item, ett_args);
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    if (tvb_reported_length(tvb) == 0) { /* empty keepalive sent */
+        col_append_fstr(pinfo->cinfo, COL_INFO, "(empty)");
+        col_set_fence(pinfo->cinfo, COL_INFO);
+        return;
+    }
 
-    offset += 1;
-    /*  arguments (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_queue_declare_arguments,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    ti = proto_tree_add_item_ret_uint(args_tree, hf_amqp_1_0_amqp_performative, tvb, offset+2, 1, ENC_BIG_ENDIAN, &method);
+    col_append_fstr(pinfo->cinfo, COL_INFO, "%s ", val_to_str_const(method, amqp_1_0_AMQP_performatives, "<invalid AMQP performative>"));
+    col_set_fence(pinfo->cinfo, COL_INFO);
 
-    return offset;
-}
+    offset += 3;    /* descriptor-constructor & fixed_one length & AMQP performative code */
+    list_offset = offset;
+    if (!PINFO_FD_VISITED(pinfo))
+        amqp_1_0_track_flow_control(tvb, pinfo, channel_num, method, list_offset);
 
-/*  Dissection routine for method Queue.Declare-Ok                        */
+    /* a pass without a tree only needs the arguments the taps look at */
+    if (amqp_use_frame_summary(pinfo, amqp_item)) {
+        switch (method) {
+        case AMQP_1_0_AMQP_TRANSFER:
+            if (!amqp_1_0_transfer_from_summary(tvb, pinfo, channel_num, list_offset))
+                break;
+            amqp_1_0_add_flow_info(tvb, pinfo, args_tree);
+            return;
+        case AMQP_1_0_AMQP_DISPOSITION:
+            tap_amqp_1_0_disposition(tvb, pinfo, channel_num, list_offset);
+            /* Fall through */
+        case AMQP_1_0_AMQP_OPEN:
+        case AMQP_1_0_AMQP_BEGIN:
+        case AMQP_1_0_AMQP_ATTACH:
+        case AMQP_1_0_AMQP_FLOW:
+        case AMQP_1_0_AMQP_DETACH:
+            amqp_1_0_add_flow_info(tvb, pinfo, args_tree);
+            return;
+        case AMQP_1_0_AMQP_END:
+        case AMQP_1_0_AMQP_CLOSE:
+            tap_amqp_requeue(tvb, pinfo, AMQP_V1_0, channel_num);
+            amqp_1_0_add_flow_info(tvb, pinfo, args_tree);
+            return;
+        default:
+            break;
+        }
+    }
 
-static int
-dissect_amqp_0_9_method_queue_declare_ok(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    const guint8* queue;
+    switch(method) {
+        case AMQP_1_0_AMQP_OPEN:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    10, amqp_1_0_amqp_open_items, NULL);
+            break;
+        case AMQP_1_0_AMQP_BEGIN:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    8, amqp_1_0_amqp_begin_items, NULL);
+            break;
+        case AMQP_1_0_AMQP_ATTACH:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    14, amqp_1_0_amqp_attach_items, NULL);
+            break;
+        case AMQP_1_0_AMQP_FLOW:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    11, amqp_1_0_amqp_flow_items, NULL);
+            break;
+        case AMQP_1_0_AMQP_TRANSFER:
+            arg_length = dissect_amqp_1_0_list(tvb,
+                                               pinfo,
+                                               offset,
+                                               args_tree,
+                                               hf_amqp_method_arguments,
+                                               11, amqp_1_0_amqp_transfer_items, NULL);
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_declare_ok_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+            if (!PINFO_FD_VISITED(pinfo) && amqp_cache_frame_summaries) {
+                summary = wmem_new0(wmem_file_scope(), amqp_1_0_transfer_summary);
+                summary->args_length = arg_length;
+                p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, AMQP_FRAME_SUMMARY_KEY(tvb), summary);
+            }
 
-    /*  message-count (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_ok_message_count,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+            if ((arg_length == 0) || (tvb_reported_length_remaining(tvb, offset + arg_length) <= 0))
+                break;
 
-    /*  consumer-count (long)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_declare_ok_consumer_count,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+            /* now decode message header, annotations, properties and data,
+             * once the whole message has been transferred */
+            msg_tvb = amqp_1_0_reassemble_transfer(tvb, pinfo, args_tree, channel_num,
+                                                   offset, offset + arg_length);
+            if (msg_tvb == NULL)
+                break;
+            p_remove_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC);
+            p_remove_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TO);
+            offset = 0;
+            arg_length = 0;
+            do {
+                offset += arg_length;
+                if (summary)
+                    amqp_1_0_summarize_section(msg_tvb, offset, summary);
+                get_amqp_1_0_type_value_formatter(msg_tvb,
+                                                    pinfo,
+                                                    offset,
+                                                    hf_amqp_1_0_list, /* dynamic item */
+                                                    NULL,
+                                                    &arg_length,
+                                                    args_tree);
+            } while ((arg_length > 0) && (tvb_reported_length_remaining(msg_tvb, offset + arg_length) > 0));
+            if (summary)
+                summary->topic = wmem_strdup(wmem_file_scope(),
+                    (const char *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC));
+            if (!PINFO_FD_VISITED(pinfo))
+                amqp_1_0_queue_transfer(tvb, pinfo, channel_num, list_offset);
+            amqp_queue_add_sample(tvb, pinfo, args_tree);
+            tap_amqp_1_0_transfer(tvb, pinfo, channel_num, list_offset, msg_tvb);
+            eo_amqp_1_0_transfer(tvb, pinfo, list_offset, msg_tvb);
+            break;
+        case AMQP_1_0_AMQP_DISPOSITION:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    6, amqp_1_0_amqp_disposition_items, NULL);
+            if (!PINFO_FD_VISITED(pinfo))
+                amqp_1_0_queue_disposition(tvb, pinfo, channel_num, offset);
+            amqp_queue_add_sample(tvb, pinfo, args_tree);
+            tap_amqp_1_0_disposition(tvb, pinfo, channel_num, offset);
+            break;
+        case AMQP_1_0_AMQP_DETACH:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    3, amqp_1_0_amqp_detach_items, NULL);
+            break;
+        case AMQP_1_0_AMQP_END:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    1, amqp_1_0_amqp_end_items, NULL);
+            amqp_queue_add_sample(tvb, pinfo, args_tree);
+            tap_amqp_requeue(tvb, pinfo, AMQP_V1_0, channel_num);
+            break;
+        case AMQP_1_0_AMQP_CLOSE:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    1, amqp_1_0_amqp_close_items, NULL);
+            amqp_queue_add_sample(tvb, pinfo, args_tree);
+            tap_amqp_requeue(tvb, pinfo, AMQP_V1_0, channel_num);
+            break;
+        default:
+            expert_add_info_format(pinfo,
+                                   ti,
+                                   &ei_amqp_unknown_amqp_command,
+                                   "Unknown AMQP performative %d",
+                                   method);
+    }
 
-    return offset;
+    amqp_1_0_add_flow_info(tvb, pinfo, args_tree);
 }
 
-/*  Dissection routine for method Queue.Bind                              */
-
-static int
-dissect_amqp_0_9_method_queue_bind(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/* decodes AMQP 1.0 SASL methods (mechanisms offer, challenge, response,..)
+ * arguments: see dissect_amqp_1_0_AMQP_frame
+ */
+static void
+dissect_amqp_1_0_SASL_frame(tvbuff_t *tvb,
+                            proto_item *amqp_item,
+                            packet_info *pinfo)
 {
+    proto_item  *args_tree;
+    guint32     method;
+    gint        offset = 0;
     proto_item *ti;
-    const guint8* str;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_bind_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_bind_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_bind_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_bind_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "bk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_bind_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    offset += 1;
-    /*  arguments (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_queue_bind_arguments,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
-
-    return offset;
-}
+    args_tree = proto_item_add_subtree(amqp_item, ett_args);
+    ti = proto_tree_add_item_ret_uint(args_tree, hf_amqp_1_0_sasl_method, tvb, offset+2, 1, ENC_BIG_ENDIAN, &method);
 
-/*  Dissection routine for method Queue.Bind-Ok                           */
+    col_append_fstr(pinfo->cinfo, COL_INFO, "%s ", val_to_str_const(method, amqp_1_0_SASL_methods, "<invalid SASL method>"));
+    col_set_fence(pinfo->cinfo, COL_INFO);
 
-static int
-dissect_amqp_0_9_method_queue_bind_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    offset += 3; /* descriptor-constructor & fixed_one length & SASL method code */
+    switch(method) {
+        case AMQP_1_0_SASL_MECHANISMS:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    1, amqp_1_0_sasl_mechanisms_items, NULL);
+            break;
+        case AMQP_1_0_SASL_INIT:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    3, amqp_1_0_sasl_init_items, NULL);
+            break;
+         case AMQP_1_0_SASL_CHALLENGE:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    1, amqp_1_0_sasl_challenge_items, NULL);
+            break;
+        case AMQP_1_0_SASL_RESPONSE:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    1, amqp_1_0_sasl_response_items, NULL);
+            break;
+        case AMQP_1_0_SASL_OUTCOME:
+            dissect_amqp_1_0_list(tvb,
+                                    pinfo,
+                                    offset,
+                                    args_tree,
+                                    hf_amqp_method_arguments,
+                                    2, amqp_1_0_sasl_outcome_items, NULL);
+            break;
+        default:
+            expert_add_info_format(pinfo,
+                                   ti,
+                                   &ei_amqp_unknown_sasl_command,
+                                   "Unknown SASL command %d",
+                                   method);
+    }
 }
 
-/*  Dissection routine for method Queue.Unbind                            */
-
 static int
-dissect_amqp_0_9_method_queue_unbind(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+dissect_amqp_1_0_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
 {
-    proto_item *ti;
-    const guint8* str;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_unbind_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    proto_item  *ti, *size_item;
+    proto_tree  *amqp_tree;
+    guint8      frame_type;
+    guint32     length;
+    guint       offset;
+    tvbuff_t    *next_tvb;
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_unbind_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_unbind_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_unbind_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "rk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  arguments (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_queue_unbind_arguments,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    col_clear(pinfo->cinfo, COL_INFO);
 
-    return offset;
-}
+    /*  Heuristic - protocol initialisation frame starts with 'AMQP' followed by 0x0  */
+    if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
+        guint8         proto_major;
+        guint8         proto_minor;
+        guint8         proto_revision;
 
-/*  Dissection routine for method Queue.Unbind-Ok                         */
+        proto_major    = tvb_get_guint8(tvb, 5);
+        proto_minor    = tvb_get_guint8(tvb, 6);
+        proto_revision = tvb_get_guint8(tvb, 7);
+        col_append_fstr(pinfo->cinfo, COL_INFO, "Protocol-Header%s %d-%d-%d ",
+                                  (tvb_get_guint8(tvb, 4)==0x2) ? "(TLS)" : "", /* frame type = 2 => TLS */
+                                  proto_major,
+                                  proto_minor,
+                                  proto_revision);
+        col_set_fence(pinfo->cinfo, COL_INFO);
 
-static int
-dissect_amqp_0_9_method_queue_unbind_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+        if (tree) {
+            ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
+            amqp_tree = proto_item_add_subtree(ti, ett_amqp_init);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_protocol,         tvb, 0, 4, ENC_ASCII|ENC_NA);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_id,               tvb, 4, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_version_major,    tvb, 5, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_version_minor,    tvb, 6, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_version_revision, tvb, 7, 1, ENC_BIG_ENDIAN);
+        }
+        return 8;
+    }
 
-/*  Dissection routine for method Queue.Purge                             */
+    /* Protocol frame */
 
-static int
-dissect_amqp_0_9_method_queue_purge(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    const guint8* queue;
+    /* frame header */
+    ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
+    amqp_tree = proto_item_add_subtree(ti, ett_amqp);
+    size_item = proto_tree_add_item_ret_uint(amqp_tree, hf_amqp_1_0_size, tvb, 0, 4, ENC_BIG_ENDIAN, &length);
+    proto_tree_add_item(amqp_tree, hf_amqp_1_0_doff, tvb, 4, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item(amqp_tree, hf_amqp_1_0_type, tvb, 5, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item(amqp_tree, hf_amqp_channel,  tvb, 6, 2, ENC_BIG_ENDIAN);
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_purge_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    offset     = 4*tvb_get_guint8(tvb,4); /* i.e. 4*DOFF */
+    frame_type = tvb_get_guint8(tvb, 5);
+    if (length < offset) {
+        expert_add_info(pinfo, size_item, &ei_amqp_bad_length);
+        return 8;
+    }
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_purge_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    if (length > (guint32)tvb_reported_length_remaining(tvb, offset))
+    {
+        next_tvb = tvb_new_subset_remaining(tvb, offset);
+    }
+    else
+    {
+        next_tvb = tvb_new_subset_length(tvb, offset, length);
+    }
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_purge_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    switch(frame_type) {
+    case AMQP_1_0_AMQP_FRAME:
+        dissect_amqp_1_0_AMQP_frame(next_tvb, amqp_tree, pinfo, tvb_get_ntohs(tvb, 6));
+        break;
+    case AMQP_1_0_SASL_FRAME:
+        dissect_amqp_1_0_SASL_frame(next_tvb, amqp_tree, pinfo);
+        break;
+    case AMQP_1_0_TLS_FRAME:
+        /* should not occur, this is handled in '(tvb_memeql(tvb, 0, "AMQP", 4) == 0)' test above */
+        break;
+    default:
+        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %d", frame_type);
+    }
 
-    return offset;
+    return tvb_reported_length(tvb);
 }
 
-/*  Dissection routine for method Queue.Purge-Ok                          */
-
-static int
-dissect_amqp_0_9_method_queue_purge_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static amqp_0_10_session *
+amqp_0_10_get_session(amqp_conv *conn, guint dir, guint16 channel_num)
 {
-    /*  message-count (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_purge_ok_message_count,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+    amqp_0_10_session *session;
 
-    return offset;
+    session = (amqp_0_10_session *)wmem_map_lookup(conn->sessions_0_10,
+        GUINT_TO_POINTER((dir << 16) | channel_num));
+    if (!session) {
+        session = wmem_new0(wmem_file_scope(), amqp_0_10_session);
+        wmem_map_insert(conn->sessions_0_10, GUINT_TO_POINTER((dir << 16) | channel_num), session);
+    }
+    return session;
 }
 
-/*  Dissection routine for method Queue.Delete                            */
-
-static int
-dissect_amqp_0_9_method_queue_delete(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+static amqp_0_10_command *
+amqp_0_10_session_get(amqp_0_10_session *session, guint idx)
 {
-    const guint8* queue;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_delete_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_queue_delete_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  if-unused (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_delete_if_unused,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  if-empty (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_delete_if_empty,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_delete_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
+    return *(amqp_0_10_command **)wmem_array_index(session->commands, idx);
 }
 
-/*  Dissection routine for method Queue.Delete-Ok                         */
-
-static int
-dissect_amqp_0_9_method_queue_delete_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Numbers the following commands of a session from command_id. Commands
+ * sent before keep the ids they had. */
+static void
+amqp_0_10_set_command_point(amqp_0_10_session *session, guint32 command_id)
 {
-    /*  message-count (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_queue_delete_ok_message_count,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
-
-    return offset;
+    if (!session->commands || wmem_array_get_count(session->commands) > 0)
+        session->commands = wmem_array_new(wmem_file_scope(), sizeof(amqp_0_10_command *));
+    session->numbering = TRUE;
+    session->next_id = command_id;
+    session->base_id = command_id;
+    session->head = 0;
 }
 
-/*  Dissection routine for method Basic.Qos                               */
-
-static int
-dissect_amqp_0_9_method_basic_qos(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Looks up a command by its id, NULL if it was not seen */
+static amqp_0_10_command *
+amqp_0_10_find_command(amqp_0_10_session *session, guint32 command_id)
 {
-    /*  prefetch-size (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_qos_prefetch_size,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
-
-    /*  prefetch-count (short)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_qos_prefetch_count,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+    guint32 idx;
 
-    /*  global (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_qos_global,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
+    if (!session || !session->commands)
+        return NULL;
+    /* ids are serial numbers */
+    idx = command_id - session->base_id;
+    if (idx >= wmem_array_get_count(session->commands))
+        return NULL;
+    return amqp_0_10_session_get(session, idx);
 }
 
-/*  Dissection routine for method Basic.Qos-Ok                            */
+/*
+ * Completes the commands of the range [lo, hi] of a sequence-set, appending
+ * them to the list from *first to *last.
+ */
+static void
+amqp_0_10_complete_commands(amqp_0_10_session *session, packet_info *pinfo,
+    guint32 lo, guint32 hi, amqp_0_10_command **first, amqp_0_10_command **last)
+{
+    amqp_0_10_command *command;
+    guint count;
+    gint64 start;
+    gint64 end;
+    gint64 idx;
+
+    count = wmem_array_get_count(session->commands);
+    start = (gint32)(lo - session->base_id);
+    end = start + (guint32)(hi - lo);
+    start = MAX(start, (gint64)session->head);
+    end = MIN(end, (gint64)count - 1);
+
+    for (idx = start; idx <= end; idx++) {
+        command = amqp_0_10_session_get(session, (guint)idx);
+        if (command->completed_framenum)
+            continue;
+
+        command->completed_framenum = pinfo->num;
+        if (*last)
+            (*last)->next_completed = command;
+        else
+            *first = command;
+        *last = command;
+    }
 
-static int
-dissect_amqp_0_9_method_basic_qos_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    /* skip over commands completed out of order */
+    while (session->head < count && amqp_0_10_session_get(session, session->head)->completed_framenum)
+        session->head++;
 }
 
-/*  Dissection routine for method Basic.Consume                           */
-
-static int
-dissect_amqp_0_9_method_basic_consume(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+/*
+ * Follows the command-ids of AMQP 0-10 sessions on the first pass, and
+ * records which command a frame sends, answers or completes for
+ * amqp_0_10_add_command_info.
+ */
+static void
+amqp_0_10_track_command(tvbuff_t *tvb, packet_info *pinfo)
 {
-    proto_item *ti;
-    const guint8* queue;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_consume_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  no-local (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_no_local,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  no-ack (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_no_ack,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  exclusive (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_exclusive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    conversation_t *conv;
+    amqp_conv *conn;
+    struct tcp_analysis *tcpd;
+    amqp_0_10_session *session;
+    amqp_0_10_command *command;
+    amqp_0_10_command *first = NULL;
+    amqp_0_10_command *last = NULL;
+    amqp_0_10_command_info *info;
+    guint8 position;
+    guint8 frame_type;
+    guint8 amqp_class;
+    guint8 method;
+    guint16 channel_num;
+    guint dir;
+    guint offset;
+    guint end;
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    conv = find_or_create_conversation(pinfo);
+    conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+    tcpd = get_tcp_conversation_data(conv, pinfo);
+    if (!conn || !tcpd)
+        return;
+    dir = amqp_1_0_direction(tcpd);
 
-    offset += 1;
-    /*  filter (table)           */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_basic_consume_filter,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+    /* only the first frame of a control or command names the method */
+    if (tvb_captured_length(tvb) < 16)
+        return;
+    position = tvb_get_guint8(tvb, 0) & 0x0f;
+    frame_type = tvb_get_guint8(tvb, 1);
+    channel_num = tvb_get_ntohs(tvb, 6);
+    amqp_class = tvb_get_guint8(tvb, 12);
+    method = tvb_get_guint8(tvb, 13);
+    if ((position & (AMQP_0_10_FIRST_SEGMENT|AMQP_0_10_FIRST_FRAME)) != (AMQP_0_10_FIRST_SEGMENT|AMQP_0_10_FIRST_FRAME))
+        return;
 
-    return offset;
-}
+    if (frame_type == AMQP_0_10_FRAME_CONTROL) {
+        if (amqp_class != AMQP_0_10_CLASS_SESSION)
+            return;
 
-/*  Dissection routine for method Basic.Consume-Ok                        */
+        /* controls have the packing flags at offset 14, then the arguments */
+        switch (method) {
+        case AMQP_0_10_METHOD_SESSION_ATTACH:
+        case AMQP_0_10_METHOD_SESSION_ATTACHED:
+            amqp_0_10_set_command_point(amqp_0_10_get_session(conn, dir, channel_num), 0);
+            return;
+        case AMQP_0_10_METHOD_SESSION_COMMAND_POINT:
+            if ((tvb_get_guint8(tvb, 14) & 0x01) && tvb_captured_length(tvb) >= 20)
+                amqp_0_10_set_command_point(amqp_0_10_get_session(conn, dir, channel_num),
+                    tvb_get_ntohl(tvb, 16));
+            return;
+        case AMQP_0_10_METHOD_SESSION_COMPLETED:
+            /* completes commands sent in the other direction */
+            session = (amqp_0_10_session *)wmem_map_lookup(conn->sessions_0_10,
+                GUINT_TO_POINTER(((dir ^ 1) << 16) | channel_num));
+            if (!session || !session->commands || !(tvb_get_guint8(tvb, 14) & 0x01) ||
+                tvb_captured_length(tvb) < 18)
+                return;
+            offset = 18;
+            end = offset + tvb_get_ntohs(tvb, 16);
+            end = MIN(end, tvb_captured_length(tvb));
+            for (; offset + 8 <= end; offset += 8)
+                amqp_0_10_complete_commands(session, pinfo, tvb_get_ntohl(tvb, offset),
+                    tvb_get_ntohl(tvb, offset + 4), &first, &last);
+            if (!first)
+                return;
+            info = wmem_new0(wmem_file_scope(), amqp_0_10_command_info);
+            info->completed = first;
+            break;
+        default:
+            return;
+        }
+    }
+    else if (frame_type == AMQP_0_10_FRAME_COMMAND) {
+        session = amqp_0_10_get_session(conn, dir, channel_num);
+        if (!session->numbering)
+            return;
 
-static int
-dissect_amqp_0_9_method_basic_consume_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_consume_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+        command = wmem_new0(wmem_file_scope(), amqp_0_10_command);
+        command->command_id = session->next_id++;
+        command->amqp_class = amqp_class;
+        command->method = method;
+        command->command_framenum = pinfo->num;
+        command->command_time = pinfo->abs_ts;
+        wmem_array_append_one(session->commands, command);
+        info = wmem_new0(wmem_file_scope(), amqp_0_10_command_info);
+        info->command = command;
+
+        /* command-id is the first argument, after the session header at
+         * offset 14 and the packing flags at offset 16 */
+        if (amqp_class == AMQP_0_10_CLASS_EXECUTION && method == AMQP_0_10_METHOD_EXECUTION_RESULT &&
+            tvb_captured_length(tvb) >= 22 && (tvb_get_guint8(tvb, 16) & 0x01)) {
+            session = (amqp_0_10_session *)wmem_map_lookup(conn->sessions_0_10,
+                GUINT_TO_POINTER(((dir ^ 1) << 16) | channel_num));
+            command = amqp_0_10_find_command(session, tvb_get_ntohl(tvb, 18));
+            if (command && !command->result_framenum) {
+                command->result_framenum = pinfo->num;
+                info->result_for = command;
+            }
+        }
+    }
+    else {
+        return;
+    }
 
-    return offset;
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_amqpv0_10, (guint32)tvb_raw_offset(tvb), info);
 }
 
-/*  Dissection routine for method Basic.Cancel                            */
-
-static int
-dissect_amqp_0_9_method_basic_cancel(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Reports the commands completed by a session.completed to the SRT tap */
+static void
+tap_amqp_0_10_completed(packet_info *pinfo, guint16 channel_num, amqp_0_10_command *completed)
 {
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_cancel_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_cancel_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    amqp_srt_info_t *srt;
+    amqp_tap_command_t *commands;
+    amqp_0_10_command *command;
+    guint count = 0;
+    guint i;
 
-    return offset;
-}
-
-/*  Dissection routine for method Basic.Cancel-Ok                         */
+    if (!have_tap_listener(amqp_srt_tap))
+        return;
 
-static int
-dissect_amqp_0_9_method_basic_cancel_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_cancel_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    for (command = completed; command; command = command->next_completed)
+        count++;
+    commands = wmem_alloc_array(pinfo->pool, amqp_tap_command_t, count);
+    for (command = completed, i = 0; command; command = command->next_completed, i++) {
+        commands[i].command_id = command->command_id;
+        commands[i].amqp_class = command->amqp_class;
+        commands[i].method = command->method;
+        commands[i].command_framenum = command->command_framenum;
+        commands[i].command_time = command->command_time;
+    }
 
-    return offset;
+    srt = wmem_new0(pinfo->pool, amqp_srt_info_t);
+    srt->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    srt->channel = channel_num;
+    srt->command_count = count;
+    srt->commands = commands;
+    tap_queue_packet(amqp_srt_tap, pinfo, srt);
 }
 
-/*  Dissection routine for method Basic.Publish                           */
-
-static int
-dissect_amqp_0_9_method_basic_publish(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
+/* Adds the links recorded for an AMQP 0-10 command or session.completed */
+static void
+amqp_0_10_add_command_info(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree)
 {
-    amqp_delivery *delivery;
+    amqp_0_10_command_info *info;
+    amqp_0_10_command *command;
     proto_item *pi;
-    const guint8* str;
-
-    /* message number (long long) */
-    if(!PINFO_FD_VISITED(pinfo))
-    {
-        conversation_t *conv;
-        amqp_channel_t *channel;
+    proto_tree *command_tree;
+    nstime_t delta;
 
-        conv = find_or_create_conversation(pinfo);
-        channel = get_conversation_channel(conv, channel_num);
+    info = (amqp_0_10_command_info *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqpv0_10,
+        (guint32)tvb_raw_offset(tvb));
+    if (!info)
+        return;
 
-        record_msg_delivery_c(conv, channel, tvb, pinfo, ++channel->publish_count);
+    command = info->command;
+    if (command) {
+        pi = proto_tree_add_uint(amqp_tree, hf_amqp_0_10_command_id, tvb, 0, 0, command->command_id);
+        proto_item_set_generated(pi);
+        if (command->completed_framenum) {
+            pi = proto_tree_add_uint(amqp_tree, hf_amqp_0_10_command_completed_in, tvb, 0, 0,
+                command->completed_framenum);
+            proto_item_set_generated(pi);
+        }
+        if (command->result_framenum) {
+            pi = proto_tree_add_uint(amqp_tree, hf_amqp_0_10_command_result_in, tvb, 0, 0,
+                command->result_framenum);
+            proto_item_set_generated(pi);
+        }
     }
 
-    delivery = (amqp_delivery *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp,
-        (guint32)tvb_raw_offset(tvb));
-    if(delivery)
-    {
-        pi = proto_tree_add_uint64(args_tree, hf_amqp_method_basic_publish_number,
-            tvb, offset-2, 2, delivery->delivery_tag);
+    command = info->result_for;
+    if (command) {
+        pi = proto_tree_add_uint(amqp_tree, hf_amqp_0_10_command_in, tvb, 0, 0, command->command_framenum);
+        proto_item_set_generated(pi);
+        nstime_delta(&delta, &pinfo->abs_ts, &command->command_time);
+        pi = proto_tree_add_time(amqp_tree, hf_amqp_0_10_command_time, tvb, 0, 0, &delta);
         proto_item_set_generated(pi);
     }
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_publish_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_publish_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_publish_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "rk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  mandatory (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_publish_mandatory,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  immediate (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_publish_immediate,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
-}
-
-/*  Dissection routine for method Basic.Return                            */
-
-static int
-dissect_amqp_0_9_method_basic_return(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    proto_item *tf_code;
-
-    /*  reply-code (short)       */
-    tf_code = proto_tree_add_item(args_tree, hf_amqp_method_basic_return_reply_code,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    if (tvb_get_ntohs(tvb, offset) > 200)
-        expert_add_info(pinfo, tf_code, &ei_amqp_message_undeliverable);
-    offset += 2;
-
-    /*  reply-text (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_return_reply_text,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_return_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_return_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    return offset;
+    for (command = info->completed; command; command = command->next_completed) {
+        pi = proto_tree_add_uint_format_value(amqp_tree, hf_amqp_0_10_completed_command, tvb, 0, 0,
+            command->command_id, "%u (%s)", command->command_id,
+            amqp_0_10_method_name(command->amqp_class, command->method));
+        proto_item_set_generated(pi);
+        command_tree = proto_item_add_subtree(pi, ett_amqp_0_10_completed_command);
+        pi = proto_tree_add_uint(command_tree, hf_amqp_0_10_command_in, tvb, 0, 0, command->command_framenum);
+        proto_item_set_generated(pi);
+        nstime_delta(&delta, &pinfo->abs_ts, &command->command_time);
+        pi = proto_tree_add_time(command_tree, hf_amqp_0_10_command_time, tvb, 0, 0, &delta);
+        proto_item_set_generated(pi);
+    }
+    if (info->completed)
+        tap_amqp_0_10_completed(pinfo, tvb_get_ntohs(tvb, 6), info->completed);
 }
 
-/*  Dissection routine for method Basic.Deliver                           */
-
 static int
-dissect_amqp_0_9_method_basic_deliver(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
+dissect_amqp_0_10_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
 {
-    guint64 delivery_tag;
-    const guint8* str;
+    proto_item *ti;
+    proto_item *amqp_tree = NULL;
+    guint8      frame_type;
+    guint16     length;
+    guint32     struct_length;
+    guint       offset;
+    tvbuff_t   *next_tvb;
 
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_deliver_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /*  Heuristic - protocol initialisation frame starts with 'AMQP'  */
+    if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
+        guint8         proto_major;
+        guint8         proto_minor;
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_deliver_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    delivery_tag = tvb_get_ntoh64(tvb, offset);
-    offset += 8;
+        proto_major = tvb_get_guint8(tvb, 6);
+        proto_minor = tvb_get_guint8(tvb, 7);
+        col_append_fstr(pinfo->cinfo, COL_INFO, "Protocol-Header %d-%d ",
+                                  proto_major,
+                                  proto_minor);
+        col_set_fence(pinfo->cinfo, COL_INFO);
 
-    /*  redelivered (bit)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_deliver_redelivered,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        if (tree) {
+            ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
+            amqp_tree = proto_item_add_subtree(ti, ett_amqp_init);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_protocol,      tvb, 0, 4, ENC_ASCII|ENC_NA);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_id_major,      tvb, 4, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_id_minor,      tvb, 5, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_version_major, tvb, 6, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item(amqp_tree, hf_amqp_init_version_minor, tvb, 7, 1, ENC_BIG_ENDIAN);
+        }
+        return 8;
+    }
 
-    offset += 1;
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_deliver_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_deliver_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "rk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* Protocol frame */
+    if (tree) {
+        ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, -1, ENC_NA);
+        amqp_tree = proto_item_add_subtree(ti, ett_amqp);
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_format,   tvb, 0, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_position, tvb, 0, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_type,     tvb, 1, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_size,     tvb, 2, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_track,    tvb, 5, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_channel,       tvb, 6, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item(amqp_tree, hf_amqp_reserved,      tvb, 8, 4, ENC_BIG_ENDIAN);
+    }
 
-    if(!PINFO_FD_VISITED(pinfo))
-        record_msg_delivery(tvb, pinfo, channel_num, delivery_tag);
+    if (!PINFO_FD_VISITED(pinfo))
+        amqp_0_10_track_command(tvb, pinfo);
 
-    return offset;
-}
+    frame_type = tvb_get_guint8(tvb, 1);
+    length     = tvb_get_ntohs(tvb, 2);
+    offset     = 12;
+    next_tvb = tvb_new_subset_remaining(tvb, offset);
 
-/*  Dissection routine for method Basic.Get                               */
+    switch(frame_type) {
+    case AMQP_0_10_FRAME_COMMAND:
+        /* Fall through */
+    case AMQP_0_10_FRAME_CONTROL:
+        proto_tree_add_item(amqp_tree, hf_amqp_0_10_class, tvb, offset+0, 1, ENC_BIG_ENDIAN);
+        switch(tvb_get_guint8(tvb, offset + 0)) {
+        case AMQP_0_10_CLASS_CONNECTION:
+            dissect_amqp_0_10_connection(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_SESSION:
+            dissect_amqp_0_10_session(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_EXECUTION:
+            dissect_amqp_0_10_execution(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_MESSAGE:
+            dissect_amqp_0_10_message(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_TX:
+            dissect_amqp_0_10_tx(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_DTX:
+            dissect_amqp_0_10_dtx(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_EXCHANGE:
+            dissect_amqp_0_10_exchange(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_QUEUE:
+            dissect_amqp_0_10_queue(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_FILE:
+            dissect_amqp_0_10_file(next_tvb, pinfo, amqp_tree);
+            break;
+        case AMQP_0_10_CLASS_STREAM:
+            dissect_amqp_0_10_stream(next_tvb, pinfo, amqp_tree);
+            break;
+        default:
+            expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_command_class, "Unknown command/control class %d", tvb_get_guint8(tvb, offset + 0));
+        }
+        break;
 
-static int
-dissect_amqp_0_9_method_basic_get(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    const guint8* queue;
+    case AMQP_0_10_FRAME_HEADER:
+        col_append_str(pinfo->cinfo, COL_INFO, "header ");
+        col_set_fence(pinfo->cinfo, COL_INFO);
+        while (tvb_reported_length_remaining(tvb, offset) > 0)
+        {
+            struct_length = amqp_0_10_get_32bit_size_new(amqp_tree, pinfo, tvb, hf_amqp_0_10_struct32_size, offset);
+            offset += 4;
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+            ti = proto_tree_add_item(amqp_tree,
+                                     hf_amqp_0_10_struct32,
+                                     tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_item_set_len(ti, struct_length);
+            if (struct_length > (guint32)tvb_reported_length_remaining(tvb, offset))
+            {
+                next_tvb = tvb_new_subset_remaining(tvb, offset);
+            }
+            else
+            {
+                next_tvb = tvb_new_subset_length(tvb, offset, struct_length);
+            }
+            dissect_amqp_0_10_struct32(next_tvb, pinfo, ti);
+            offset += struct_length;
+        }
+        break;
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_get_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &queue);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "q=%s ", queue);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    case AMQP_0_10_FRAME_BODY:
+        col_append_str(pinfo->cinfo, COL_INFO, "message-body ");
+        col_set_fence(pinfo->cinfo, COL_INFO);
+        proto_tree_add_item(amqp_tree,
+                            hf_amqp_0_10_message_body,
+                            tvb, offset, length - 12, ENC_NA);
+        break;
 
-    /*  no-ack (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_no_ack,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    default:
+        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %d", frame_type);
+    }
 
-    return offset;
-}
+    amqp_0_10_add_command_info(tvb, pinfo, amqp_tree);
 
-/*  Dissection routine for method Basic.Get-Ok                            */
+    return tvb_reported_length(tvb);
+}
 
-static int
-dissect_amqp_0_9_method_basic_get_ok(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
-{
-    guint64 delivery_tag;
-    const guint8* str;
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_ok_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    delivery_tag = tvb_get_ntoh64(tvb, offset);
-    offset += 8;
+/*
+ * AMQP 0-9 methods are dissected from the tables below rather than by one
+ * routine per method. Each method lists its arguments in the order of the
+ * AMQP 0-9-1 specification, and dissect_amqp_0_9_method_args walks the
+ * list. Methods that change the conversation state have a hook that is
+ * called with the argument values once the arguments are in the tree.
+ * Supporting a new method, e.g. a broker extension, means adding a table.
+ */
 
-    /*  redelivered (bit)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_ok_redelivered,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+/* Types of method arguments */
+typedef enum {
+    AMQP_0_9_ARG_OCTET,
+    AMQP_0_9_ARG_SHORT,
+    AMQP_0_9_ARG_LONG,
+    AMQP_0_9_ARG_LONGLONG,
+    AMQP_0_9_ARG_BIT,               /* packed with the adjacent bits into one octet */
+    AMQP_0_9_ARG_SHORTSTR,          /* shortstr added as its value */
+    AMQP_0_9_ARG_SHORTSTR_COUNTED,  /* shortstr added as FT_UINT_STRING */
+    AMQP_0_9_ARG_LONGSTR,           /* longstr added as its value */
+    AMQP_0_9_ARG_LONGSTR_COUNTED,   /* longstr added as FT_UINT_BYTES */
+    AMQP_0_9_ARG_TABLE
+} amqp_0_9_arg_type_t;
 
-    offset += 1;
-    /*  exchange (shortstr)      */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_get_ok_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "x=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item_ret_string(args_tree, hf_amqp_method_basic_get_ok_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA, wmem_packet_scope(), &str);
-    col_append_fstr(pinfo->cinfo, COL_INFO, "rk=%s ", str);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  message-count (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_ok_message_count,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+typedef struct {
+    amqp_0_9_arg_type_t type;
+    int *hf;
+    const char *col_label;          /* shortstr shown as "label=value" in the Info column */
+    expert_field *ei_reply_code;    /* added if the short is a reply code above 200 */
+} amqp_0_9_arg_t;
+
+/* Value of a method argument, as passed to the method hook. Strings are
+ * only read for methods that have a hook. */
+typedef union {
+    guint64 num;                    /* octet, short, long, longlong and bit */
+    const guint8 *str;              /* shortstr */
+} amqp_0_9_arg_value_t;
+
+#define AMQP_0_9_MAX_METHOD_ARGS 16
+
+/* Summary of an AMQP 0-9 method or content header, see amqp_use_frame_summary */
+typedef struct {
+    amqp_0_9_arg_value_t *values;   /* method argument values, strings in file scope */
+    const char *content_type;       /* content-type of a basic content header, NULL if none */
+} amqp_0_9_frame_summary;
 
-    if(!PINFO_FD_VISITED(pinfo))
-        record_msg_delivery(tvb, pinfo, channel_num, delivery_tag);
+typedef void (*amqp_0_9_method_hook_t)(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset, proto_tree *args_tree, const amqp_0_9_arg_value_t *values);
 
-    return offset;
-}
+/* flags of amqp_0_9_method_t */
+#define AMQP_0_9_ACK_REFERENCE 0x01 /* a message, link to the frame that acks it */
+#define AMQP_0_9_MSG_REFERENCE 0x02 /* an ack, link to the frames of the messages */
 
-/*  Dissection routine for method Basic.Get-Empty                         */
+typedef struct {
+    guint16 method_id;
+    const amqp_0_9_arg_t *args;
+    guint num_args;
+    amqp_0_9_method_hook_t hook;
+    guint flags;
+} amqp_0_9_method_t;
 
-static int
-dissect_amqp_0_9_method_basic_get_empty(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+typedef struct {
+    guint16 class_id;
+    const char *name;               /* shown in the Info column */
+    const char *lower_name;         /* used in the unknown method expert info */
+    int *hf_method_id;
+    const value_string *method_names;
+    expert_field *ei_unknown_method;
+    const amqp_0_9_method_t *methods;
+    guint num_methods;
+} amqp_0_9_class_t;
+
+#define AMQP_0_9_ARGS(args) args, G_N_ELEMENTS(args)
+
+/* Adds the arguments of a method to the tree and fills in their values */
+static void
+dissect_amqp_0_9_method_args(tvbuff_t *tvb, packet_info *pinfo, int offset,
+    proto_tree *args_tree, const amqp_0_9_method_t *method, amqp_0_9_arg_value_t *values)
 {
-    /*  cluster-id (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_get_empty_cluster_id,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    const amqp_0_9_arg_t *arg;
+    proto_item *ti;
+    guint32 value;
+    guint32 length;
+    guint bits = 0;
+    guint i;
 
-    return offset;
-}
+    DISSECTOR_ASSERT(method->num_args <= AMQP_0_9_MAX_METHOD_ARGS);
 
-/*  Dissection routine for method Basic.Ack                               */
+    for (i = 0; i < method->num_args; i++) {
+        arg = &method->args[i];
 
-static int
-dissect_amqp_0_9_method_basic_ack(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
-{
-    guint64 delivery_tag;
-    int multiple;
+        /* a run of bits takes one octet, or more if it has more than 8 */
+        if (bits && (arg->type != AMQP_0_9_ARG_BIT || bits == 8)) {
+            offset += 1;
+            bits = 0;
+        }
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_ack_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    delivery_tag = tvb_get_ntoh64(tvb, offset);
-    offset += 8;
+        switch (arg->type) {
+        case AMQP_0_9_ARG_OCTET:
+            proto_tree_add_item_ret_uint(args_tree, *arg->hf, tvb, offset, 1, ENC_BIG_ENDIAN, &value);
+            values[i].num = value;
+            offset += 1;
+            break;
+        case AMQP_0_9_ARG_SHORT:
+            ti = proto_tree_add_item_ret_uint(args_tree, *arg->hf, tvb, offset, 2, ENC_BIG_ENDIAN, &value);
+            if (arg->ei_reply_code && value > 200)
+                expert_add_info(pinfo, ti, arg->ei_reply_code);
+            values[i].num = value;
+            offset += 2;
+            break;
+        case AMQP_0_9_ARG_LONG:
+            proto_tree_add_item_ret_uint(args_tree, *arg->hf, tvb, offset, 4, ENC_BIG_ENDIAN, &value);
+            values[i].num = value;
+            offset += 4;
+            break;
+        case AMQP_0_9_ARG_LONGLONG:
+            proto_tree_add_item_ret_uint64(args_tree, *arg->hf, tvb, offset, 8, ENC_BIG_ENDIAN, &values[i].num);
+            offset += 8;
+            break;
+        case AMQP_0_9_ARG_BIT:
+            /* the hf masks out the bit */
+            proto_tree_add_item(args_tree, *arg->hf, tvb, offset, 1, ENC_BIG_ENDIAN);
+            values[i].num = (tvb_get_guint8(tvb, offset) >> bits) & 0x01;
+            bits++;
+            break;
+        case AMQP_0_9_ARG_SHORTSTR:
+            length = tvb_get_guint8(tvb, offset);
+            values[i].str = NULL;
+            if (method->hook || arg->col_label)
+                proto_tree_add_item_ret_string(args_tree, *arg->hf, tvb, offset + 1, length,
+                    ENC_ASCII|ENC_NA, wmem_packet_scope(), &values[i].str);
+            else
+                proto_tree_add_item(args_tree, *arg->hf, tvb, offset + 1, length, ENC_ASCII|ENC_NA);
+            offset += 1 + length;
+            break;
+        case AMQP_0_9_ARG_SHORTSTR_COUNTED:
+            length = tvb_get_guint8(tvb, offset);
+            values[i].str = NULL;
+            if (method->hook || arg->col_label)
+                proto_tree_add_item_ret_string(args_tree, *arg->hf, tvb, offset, 1,
+                    ENC_ASCII|ENC_BIG_ENDIAN, wmem_packet_scope(), &values[i].str);
+            else
+                proto_tree_add_item(args_tree, *arg->hf, tvb, offset, 1, ENC_ASCII|ENC_BIG_ENDIAN);
+            offset += 1 + length;
+            break;
+        case AMQP_0_9_ARG_LONGSTR:
+            length = tvb_get_ntohl(tvb, offset);
+            proto_tree_add_item(args_tree, *arg->hf, tvb, offset + 4, length, ENC_NA);
+            offset += 4 + length;
+            break;
+        case AMQP_0_9_ARG_LONGSTR_COUNTED:
+            length = tvb_get_ntohl(tvb, offset);
+            proto_tree_add_item(args_tree, *arg->hf, tvb, offset, 4, ENC_BIG_ENDIAN);
+            offset += 4 + length;
+            break;
+        case AMQP_0_9_ARG_TABLE:
+            length = tvb_get_ntohl(tvb, offset);
+            ti = proto_tree_add_item(args_tree, *arg->hf, tvb, offset + 4, length, ENC_NA);
+            dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, length, ti);
+            offset += 4 + length;
+            break;
+        }
 
-    /*  multiple (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_ack_multiple,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-    multiple = tvb_get_guint8(tvb, offset) & 0x01;
+        if (arg->col_label)
+            col_append_fstr(pinfo->cinfo, COL_INFO, "%s=%s ", arg->col_label, values[i].str);
+    }
+}
 
-    if(!PINFO_FD_VISITED(pinfo))
-        record_delivery_ack(tvb, pinfo, channel_num, delivery_tag, multiple);
+/* Tells whether the hook or the Info column use the argument values of a method */
+static gboolean
+amqp_0_9_method_wants_values(const amqp_0_9_method_t *method)
+{
+    guint i;
 
-    return offset;
+    if (method->hook)
+        return TRUE;
+    for (i = 0; i < method->num_args; i++) {
+        if (method->args[i].col_label)
+            return TRUE;
+    }
+    return FALSE;
 }
 
-/*  Dissection routine for method Basic.Reject                            */
+/* Caches the argument values of a method for amqp_0_9_method_args_from_summary */
+static void
+amqp_0_9_summarize_method(tvbuff_t *tvb, packet_info *pinfo, const amqp_0_9_method_t *method,
+    const amqp_0_9_arg_value_t *values)
+{
+    amqp_0_9_frame_summary *summary;
+    guint i;
+
+    summary = wmem_new0(wmem_file_scope(), amqp_0_9_frame_summary);
+    summary->values = wmem_alloc0_array(wmem_file_scope(), amqp_0_9_arg_value_t, method->num_args);
+    for (i = 0; i < method->num_args; i++) {
+        switch (method->args[i].type) {
+        case AMQP_0_9_ARG_SHORTSTR:
+        case AMQP_0_9_ARG_SHORTSTR_COUNTED:
+            summary->values[i].str = (const guint8 *)wmem_strdup(wmem_file_scope(), (const char *)values[i].str);
+            break;
+        case AMQP_0_9_ARG_LONGSTR:
+        case AMQP_0_9_ARG_LONGSTR_COUNTED:
+        case AMQP_0_9_ARG_TABLE:
+            /* not read */
+            break;
+        default:
+            summary->values[i].num = values[i].num;
+            break;
+        }
+    }
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, AMQP_FRAME_SUMMARY_KEY(tvb), summary);
+}
 
-static int
-dissect_amqp_0_9_method_basic_reject(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
+/* Fills in the argument values of a method from its summary instead of
+ * dissect_amqp_0_9_method_args, for a pass without a tree. Returns FALSE
+ * if the method has to be dissected. */
+static gboolean
+amqp_0_9_method_args_from_summary(tvbuff_t *tvb, packet_info *pinfo,
+    const amqp_0_9_method_t *method, amqp_0_9_arg_value_t *values)
 {
-    guint64 delivery_tag;
+    amqp_0_9_frame_summary *summary;
+    guint i;
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_reject_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    delivery_tag = tvb_get_ntoh64(tvb, offset);
-    offset += 8;
+    if (!amqp_0_9_method_wants_values(method))
+        return TRUE;
 
-    /*  requeue (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_reject_requeue,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    if(!PINFO_FD_VISITED(pinfo))
-        record_delivery_ack(tvb, pinfo, channel_num, delivery_tag, FALSE);
+    summary = (amqp_0_9_frame_summary *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        AMQP_FRAME_SUMMARY_KEY(tvb));
+    if (!summary || !summary->values)
+        return FALSE;
 
-    return offset;
+    for (i = 0; i < method->num_args; i++) {
+        values[i] = summary->values[i];
+        if (method->args[i].col_label)
+            col_append_fstr(pinfo->cinfo, COL_INFO, "%s=%s ", method->args[i].col_label, values[i].str);
+    }
+    return TRUE;
 }
 
-/*  Dissection routine for method Basic.Recover-Async                     */
-
-static int
-dissect_amqp_0_9_method_basic_recover_async(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Caches the content type of a basic content header for the Info column */
+static void
+amqp_0_9_summarize_content_header(tvbuff_t *tvb, packet_info *pinfo)
 {
-    /*  requeue (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_recover_requeue,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    amqp_0_9_frame_summary *summary;
 
-    return offset;
+    summary = wmem_new0(wmem_file_scope(), amqp_0_9_frame_summary);
+    if (tvb_get_ntohs(tvb, 19) & 0x8000)
+        summary->content_type = (const char *)tvb_get_string_enc(wmem_file_scope(), tvb, 22,
+            tvb_get_guint8(tvb, 21), ENC_ASCII);
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, AMQP_FRAME_SUMMARY_KEY(tvb), summary);
 }
 
-/*  Dissection routine for method Basic.Recover                           */
+/*  Hooks of the methods that change the conversation state              */
 
-static int
-dissect_amqp_0_9_method_basic_recover(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+/* Frees the state of a closed channel. The deliveries it tracked are kept
+ * as per-frame records; returns how many were never acked. */
+static guint64
+release_channel(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn, amqp_channel_t *channel)
 {
-    /*  requeue (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_recover_requeue,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
-}
+    guint64 unacked;
 
-/*  Dissection routine for method Basic.Recover-Ok                        */
-
-static int
-dissect_amqp_0_9_method_basic_recover_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
+    unacked = delivery_window_release(tvb, pinfo, conn, &channel->unacked1) +
+        delivery_window_release(tvb, pinfo, conn, &channel->unacked2);
+    wmem_map_remove(conn->channels, GUINT_TO_POINTER((guint32)channel->channel_num));
+    /* the strings are referenced by the frames of the channel */
+    wmem_free(wmem_file_scope(), channel->content1.content_params);
+    wmem_free(wmem_file_scope(), channel->content2.content_params);
+    wmem_free(wmem_file_scope(), channel);
+    return unacked;
 }
 
-/*  Dissection routine for method Basic.Nack                              */
-
-static int
-dissect_amqp_0_9_method_basic_nack(guint16 channel_num,
-    tvbuff_t *tvb, packet_info *pinfo, int offset, proto_tree *args_tree)
+/* Releases one channel, or all channels of the connection, on the first
+ * pass and shows how many of their deliveries were left unacked */
+static void
+release_closed_channels(tvbuff_t *tvb, packet_info *pinfo, proto_tree *args_tree,
+    guint16 channel_num, gboolean all_channels)
 {
-    guint64 delivery_tag;
-    int multiple;
+    amqp_close_summary *summary;
+    proto_item *pi;
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_nack_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    delivery_tag = tvb_get_ntoh64(tvb, offset);
-    offset += 8;
+    if (!PINFO_FD_VISITED(pinfo)) {
+        amqp_conv *conn;
+        amqp_channel_t *channel;
 
-    /*  multiple (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_nack_multiple,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-    multiple = tvb_get_guint8(tvb, offset) & 0x01;
+        conn = (amqp_conv *)conversation_get_proto_data(find_or_create_conversation(pinfo), proto_amqp);
+        if (!conn)
+            return;
 
-    /*  requeue (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_basic_nack_requeue,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        summary = wmem_new0(wmem_file_scope(), amqp_close_summary);
+        if (all_channels) {
+            wmem_list_t *channels;
+            wmem_list_frame_t *frame;
 
-    if(!PINFO_FD_VISITED(pinfo))
-        record_delivery_ack(tvb, pinfo, channel_num, delivery_tag, multiple);
+            channels = wmem_map_get_keys(pinfo->pool, conn->channels);
+            for (frame = wmem_list_head(channels); frame; frame = wmem_list_frame_next(frame)) {
+                channel = (amqp_channel_t *)wmem_map_lookup(conn->channels, wmem_list_frame_data(frame));
+                summary->unacked += release_channel(tvb, pinfo, conn, channel);
+            }
+        } else {
+            channel = (amqp_channel_t *)wmem_map_lookup(conn->channels, GUINT_TO_POINTER((guint32)channel_num));
+            if (channel)
+                summary->unacked = release_channel(tvb, pinfo, conn, channel);
+        }
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, (guint32)tvb_raw_offset(tvb), summary);
+    }
 
-    return offset;
+    summary = (amqp_close_summary *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if (summary) {
+        pi = proto_tree_add_uint64(args_tree, hf_amqp_unacked_at_close, tvb, 0, 0, summary->unacked);
+        proto_item_set_generated(pi);
+    }
+    tap_amqp_requeue(tvb, pinfo, AMQP_V0_9, channel_num);
 }
 
-/*  Dissection routine for method File.Qos                                */
-
-static int
-dissect_amqp_0_9_method_file_qos(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_connection_close_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree, const amqp_0_9_arg_value_t *values _U_)
 {
-    /*  prefetch-size (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_qos_prefetch_size,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
-
-    /*  prefetch-count (short)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_qos_prefetch_count,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  global (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_qos_global,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    return offset;
+    release_closed_channels(tvb, pinfo, args_tree, channel_num, TRUE);
 }
 
-/*  Dissection routine for method File.Qos-Ok                             */
-
-static int
-dissect_amqp_0_9_method_file_qos_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
+static void
+amqp_0_9_channel_close_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree, const amqp_0_9_arg_value_t *values _U_)
 {
-    return offset;
+    release_closed_channels(tvb, pinfo, args_tree, channel_num, FALSE);
 }
 
-/*  Dissection routine for method File.Consume                            */
-
-static int
-dissect_amqp_0_9_method_file_consume(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_exchange_declare_hook(guint16 channel_num _U_, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    proto_item *ti;
-
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  queue (shortstr)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  no-local (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_no_local,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
-
-    /*  no-ack (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_no_ack,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    /* exchange, type */
+    if(!PINFO_FD_VISITED(pinfo) && values[1].str && values[2].str)
+    {
+        amqp_exchange *ex;
 
-    /*  exclusive (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_exclusive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        ex = amqp_exchange_get((const char *)values[1].str);
+        ex->fanout = strcmp((const char *)values[2].str, "fanout") == 0;
+        ex->topic = strcmp((const char *)values[2].str, "topic") == 0;
+    }
+}
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static void
+amqp_0_9_queue_declare_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* queue, message-count, consumer-count */
+    if(!PINFO_FD_VISITED(pinfo) && values[0].str)
+    {
+        amqp_tap_queue_t *queue;
 
-    offset += 1;
-    /*  filter (table)           */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_file_consume_filter,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+        queue = amqp_queue_get((const char *)values[0].str);
+        queue->consumers = (gint32)MIN(values[2].num, G_MAXINT32);
+        amqp_queue_anchor(tvb, pinfo, queue->name, (guint32)values[1].num);
+    }
+    tap_amqp_0_9_queue_count(tvb, pinfo, channel_num);
+}
 
-    return offset;
+static void
+amqp_0_9_queue_bind_hook(guint16 channel_num _U_, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* queue, exchange, routing-key */
+    if(!PINFO_FD_VISITED(pinfo))
+        amqp_queue_bind((const char *)values[1].str, (const char *)values[2].str,
+            (const char *)values[3].str, TRUE);
 }
 
-/*  Dissection routine for method File.Consume-Ok                         */
-
-static int
-dissect_amqp_0_9_method_file_consume_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_queue_unbind_hook(guint16 channel_num _U_, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_consume_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    return offset;
+    /* queue, exchange, routing-key */
+    if(!PINFO_FD_VISITED(pinfo))
+        amqp_queue_bind((const char *)values[1].str, (const char *)values[2].str,
+            (const char *)values[3].str, FALSE);
 }
 
-/*  Dissection routine for method File.Cancel                             */
-
-static int
-dissect_amqp_0_9_method_file_cancel(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_queue_op_hook(guint16 channel_num, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_cancel_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_cancel_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+    /* queue of queue.purge or queue.delete, for the -ok */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
 
-    return offset;
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        if (channel)
+            channel->queue_op = wmem_strdup(wmem_file_scope(), (const char *)values[1].str);
+    }
 }
 
-/*  Dissection routine for method File.Cancel-Ok                          */
-
-static int
-dissect_amqp_0_9_method_file_cancel_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_queue_purge_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values _U_)
 {
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_cancel_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* the message count is the number of messages purged */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
 
-    return offset;
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        if (channel)
+            amqp_queue_anchor(tvb, pinfo, channel->queue_op, 0);
+    }
+    tap_amqp_0_9_queue_count(tvb, pinfo, channel_num);
 }
 
-/*  Dissection routine for method File.Open                               */
-
-static int
-dissect_amqp_0_9_method_file_open(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_queue_delete_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values _U_)
 {
-    /*  identifier (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_open_identifier,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* the deleted queue holds nothing, its unacked messages are dropped */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
 
-    /*  content-size (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_open_content_size,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        if (channel && channel->queue_op) {
+            amqp_tap_queue_t *queue = amqp_queue_get(channel->queue_op);
 
-    return offset;
+            queue->unacked = 0;
+            queue->consumers = 0;
+            amqp_queue_anchor(tvb, pinfo, queue->name, 0);
+        }
+    }
+    tap_amqp_0_9_queue_count(tvb, pinfo, channel_num);
 }
 
-/*  Dissection routine for method File.Open-Ok                            */
-
-static int
-dissect_amqp_0_9_method_file_open_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_basic_consume_hook(guint16 channel_num, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  staged-size (longlong)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_open_ok_staged_size,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
-
-    return offset;
+    /* queue, consumer-tag, no-local, no-ack */
+    if(!PINFO_FD_VISITED(pinfo))
+        record_consumer(pinfo, channel_num, values[1].str, values[2].str, (gboolean)values[4].num);
 }
 
-/*  Dissection routine for method File.Stage                              */
-
-static int
-dissect_amqp_0_9_method_file_stage(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
+static void
+amqp_0_9_basic_consume_ok_hook(guint16 channel_num, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    return offset;
+    /* the broker names the consumer if basic.consume left the tag empty */
+    if(!PINFO_FD_VISITED(pinfo))
+        record_consumer(pinfo, channel_num, NULL, values[0].str, FALSE);
 }
 
-/*  Dissection routine for method File.Publish                            */
-
-static int
-dissect_amqp_0_9_method_file_publish(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_basic_publish_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset, proto_tree *args_tree, const amqp_0_9_arg_value_t *values)
 {
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    amqp_delivery *delivery;
+    proto_item *pi;
 
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* message number (long long) */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        conversation_t *conv;
+        amqp_channel_t *channel;
 
-    /*  mandatory (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_mandatory,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        conv = find_or_create_conversation(pinfo);
+        channel = get_conversation_channel(conv, channel_num);
 
-    /*  immediate (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_immediate,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        record_msg_delivery_c(conv, channel, tvb, pinfo, ++channel->publish_count);
+        amqp_queue_publish(tvb, pinfo, (const char *)values[1].str, (const char *)values[2].str);
+    }
 
-    offset += 1;
-    /*  identifier (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_publish_identifier,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if(delivery)
+    {
+        pi = proto_tree_add_uint64(args_tree, hf_amqp_method_basic_publish_number,
+            tvb, offset-2, 2, delivery->delivery_tag);
+        proto_item_set_generated(pi);
+    }
 
-    return offset;
+    /* exchange, routing-key */
+    record_msg_topic(tvb, pinfo, channel_num, AMQP_TAP_PUBLISH, values[1].str, values[2].str, NULL);
 }
 
-/*  Dissection routine for method File.Return                             */
-
-static int
-dissect_amqp_0_9_method_file_return(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_basic_return_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  reply-code (short)       */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_return_reply_code,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
-
-    /*  reply-text (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_return_reply_text,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
-
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_return_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* exchange, routing-key */
+    record_msg_topic(tvb, pinfo, channel_num, AMQP_TAP_RETURN, values[2].str, values[3].str, NULL);
+}
 
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_return_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static void
+amqp_0_9_basic_deliver_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* consumer-tag, delivery-tag, redelivered, exchange, routing-key */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_conv *conn;
+        const char *queue;
+        gboolean no_ack;
 
-    return offset;
+        record_msg_delivery(tvb, pinfo, channel_num, values[1].num);
+        conn = (amqp_conv *)conversation_get_proto_data(find_or_create_conversation(pinfo), proto_amqp);
+        queue = (const char *)wmem_map_lookup(conn->consumers, values[0].str);
+        no_ack = wmem_map_contains(conn->auto_ack, values[0].str);
+        amqp_queue_update(tvb, pinfo, queue, -1, no_ack ? 0 : 1);
+        record_msg_topic(tvb, pinfo, channel_num, AMQP_TAP_DELIVER, values[3].str, values[4].str, queue);
+        record_msg_queue_unacked(tvb, pinfo, queue && !no_ack);
+    }
 }
 
-/*  Dissection routine for method File.Deliver                            */
-
-static int
-dissect_amqp_0_9_method_file_deliver(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_basic_get_hook(guint16 channel_num, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+    /* queue, no-ack */
+    if(!PINFO_FD_VISITED(pinfo))
+        record_consumer(pinfo, channel_num, values[1].str, NULL, (gboolean)values[2].num);
+}
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
+static void
+amqp_0_9_basic_get_ok_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* delivery-tag, redelivered, exchange, routing-key, message-count */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
 
-    /*  redelivered (bit)        */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_redelivered,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        record_msg_delivery(tvb, pinfo, channel_num, values[0].num);
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        /* the message count leaves out the message got */
+        amqp_queue_anchor(tvb, pinfo, channel->queue, (guint32)values[4].num);
+        amqp_queue_update(tvb, pinfo, channel->queue, 0, channel->no_ack ? 0 : 1);
+        record_msg_topic(tvb, pinfo, channel_num, AMQP_TAP_DELIVER, values[2].str, values[3].str,
+            channel->queue);
+        record_msg_queue_unacked(tvb, pinfo, channel->queue && !channel->no_ack);
+    }
+}
 
-    offset += 1;
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static void
+amqp_0_9_basic_get_empty_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values _U_)
+{
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
 
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        if (channel)
+            amqp_queue_anchor(tvb, pinfo, channel->queue, 0);
+    }
+    tap_amqp_0_9_queue_count(tvb, pinfo, channel_num);
+}
 
-    /*  identifier (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_deliver_identifier,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static void
+amqp_0_9_basic_ack_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* delivery-tag, multiple */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        record_delivery_ack(tvb, pinfo, channel_num, values[0].num, (int)values[1].num);
+        amqp_queue_settle(tvb, pinfo, FALSE);
+    }
+    tap_amqp_0_9_settled(tvb, pinfo, channel_num, AMQP_TAP_ACK, values[0].num, (gboolean)values[1].num);
+}
 
-    return offset;
+static void
+amqp_0_9_basic_reject_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* delivery-tag, requeue */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        record_delivery_ack(tvb, pinfo, channel_num, values[0].num, FALSE);
+        amqp_queue_settle(tvb, pinfo, (gboolean)values[1].num);
+    }
+    tap_amqp_0_9_settled(tvb, pinfo, channel_num, AMQP_TAP_REJECT, values[0].num, FALSE);
 }
 
-/*  Dissection routine for method File.Ack                                */
+static void
+amqp_0_9_basic_nack_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
+{
+    /* delivery-tag, multiple, requeue */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        record_delivery_ack(tvb, pinfo, channel_num, values[0].num, (int)values[1].num);
+        amqp_queue_settle(tvb, pinfo, (gboolean)values[2].num);
+    }
+    tap_amqp_0_9_settled(tvb, pinfo, channel_num, AMQP_TAP_NACK, values[0].num, (gboolean)values[1].num);
+}
 
-static int
-dissect_amqp_0_9_method_file_ack(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
+static void
+amqp_0_9_basic_recover_hook(guint16 channel_num, tvbuff_t *tvb, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values)
 {
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_ack_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
+    /* requeue */
+    if (!values[0].num)
+        return;
+    /* the broker requeues the unacked deliveries it sent on the channel,
+     * whose delivery tags are not acked any more */
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        conversation_t *conv;
+        amqp_channel_t *channel;
+        struct tcp_analysis *tcpd;
 
-    /*  multiple (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_ack_multiple,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+        conv = find_or_create_conversation(pinfo);
+        channel = get_conversation_channel(conv, channel_num);
+        tcpd = get_tcp_conversation_data(conv, pinfo);
+        delivery_window_release(tvb, pinfo, channel->conn,
+            tcpd->fwd == &(tcpd->flow1) ? &channel->unacked2 : &channel->unacked1);
+    }
+    tap_amqp_requeue(tvb, pinfo, AMQP_V0_9, channel_num);
+}
 
-    return offset;
+static void
+amqp_0_9_confirm_select_ok_hook(guint16 channel_num, tvbuff_t *tvb _U_, packet_info *pinfo,
+    int offset _U_, proto_tree *args_tree _U_, const amqp_0_9_arg_value_t *values _U_)
+{
+    if(!PINFO_FD_VISITED(pinfo))
+    {
+        amqp_channel_t *channel;
+        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+        channel->confirms = TRUE;
+    }
 }
 
-/*  Dissection routine for method File.Reject                             */
+/*  Arguments of the methods                                             */
 
-static int
-dissect_amqp_0_9_method_file_reject(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_reject_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
+static const amqp_0_9_arg_t amqp_0_9_connection_start_args[] = {
+    { AMQP_0_9_ARG_OCTET,            &hf_amqp_method_connection_start_version_major, NULL, NULL },
+    { AMQP_0_9_ARG_OCTET,            &hf_amqp_method_connection_start_version_minor, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_connection_start_server_properties, NULL, NULL },
+    { AMQP_0_9_ARG_LONGSTR,          &hf_amqp_0_9_method_connection_start_mechanisms, NULL, NULL },
+    { AMQP_0_9_ARG_LONGSTR,          &hf_amqp_0_9_method_connection_start_locales, NULL, NULL },
+};
 
-    /*  requeue (bit)            */
-    proto_tree_add_item(args_tree, hf_amqp_method_file_reject_requeue,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_connection_start_ok_args[] = {
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_connection_start_ok_client_properties, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR_COUNTED, &hf_amqp_method_connection_start_ok_mechanism, NULL, NULL },
+    { AMQP_0_9_ARG_LONGSTR_COUNTED,  &hf_amqp_method_connection_start_ok_response, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR_COUNTED, &hf_amqp_method_connection_start_ok_locale, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_connection_secure_args[] = {
+    { AMQP_0_9_ARG_LONGSTR_COUNTED,  &hf_amqp_method_connection_secure_challenge, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Qos                              */
+static const amqp_0_9_arg_t amqp_0_9_connection_secure_ok_args[] = {
+    { AMQP_0_9_ARG_LONGSTR_COUNTED,  &hf_amqp_method_connection_secure_ok_response, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_qos(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  prefetch-size (long)     */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_qos_prefetch_size,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+static const amqp_0_9_arg_t amqp_0_9_connection_tune_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_connection_tune_channel_max, NULL, NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_0_9_method_connection_tune_frame_max, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_0_9_method_connection_tune_heartbeat, NULL, NULL },
+};
 
-    /*  prefetch-count (short)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_qos_prefetch_count,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+static const amqp_0_9_arg_t amqp_0_9_connection_tune_ok_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_connection_tune_ok_channel_max, NULL, NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_0_9_method_connection_tune_ok_frame_max, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_connection_tune_ok_heartbeat, NULL, NULL },
+};
 
-    /*  consume-rate (long)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_qos_consume_rate,
-        tvb, offset, 4, ENC_BIG_ENDIAN);
-    offset += 4;
+static const amqp_0_9_arg_t amqp_0_9_connection_open_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR_COUNTED, &hf_amqp_method_connection_open_virtual_host, "vhost", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_0_9_method_connection_open_capabilities, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_0_9_method_connection_open_insist, NULL, NULL },
+};
 
-    /*  global (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_qos_global,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_connection_open_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_0_9_method_connection_open_ok_known_hosts, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_connection_redirect_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR_COUNTED, &hf_amqp_method_connection_redirect_host, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_0_9_method_connection_redirect_known_hosts, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Qos-Ok                           */
+static const amqp_0_9_arg_t amqp_0_9_connection_close_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_0_9_method_connection_close_reply_code, NULL, &ei_amqp_connection_error },
+    { AMQP_0_9_ARG_SHORTSTR_COUNTED, &hf_amqp_method_connection_close_reply_text, "reply", NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_connection_close_class_id, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_connection_close_method_id, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_qos_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_connection_blocked_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_connection_blocked_reason, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Consume                          */
+static const amqp_0_9_arg_t amqp_0_9_channel_open_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_channel_open_out_of_band, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_consume(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    proto_item *ti;
+static const amqp_0_9_arg_t amqp_0_9_channel_open_ok_args[] = {
+    { AMQP_0_9_ARG_LONGSTR,          &hf_amqp_method_channel_open_ok_channel_id, NULL, NULL },
+};
 
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+static const amqp_0_9_arg_t amqp_0_9_channel_flow_args[] = {
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_channel_flow_active, NULL, NULL },
+};
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_channel_flow_ok_args[] = {
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_channel_flow_ok_active, NULL, NULL },
+};
 
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_channel_close_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_channel_close_reply_code, NULL, &ei_amqp_channel_error },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_channel_close_reply_text, "reply", NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_channel_close_class_id, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_channel_close_method_id, NULL, NULL },
+};
 
-    /*  no-local (bit)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_no_local,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_channel_resume_args[] = {
+    { AMQP_0_9_ARG_LONGSTR,          &hf_amqp_method_channel_resume_channel_id, NULL, NULL },
+};
 
-    /*  exclusive (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_exclusive,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_access_request_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_access_request_realm, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_access_request_exclusive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_access_request_passive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_access_request_active, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_access_request_write, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_access_request_read, NULL, NULL },
+};
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_access_request_ok_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_access_request_ok_ticket, NULL, NULL },
+};
 
-    offset += 1;
-    /*  filter (table)           */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_stream_consume_filter,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_exchange_declare_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_exchange_declare_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_declare_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_declare_type, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_declare_passive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_declare_durable, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_declare_auto_delete, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_declare_internal, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_declare_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_exchange_declare_arguments, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_exchange_bind_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_exchange_declare_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_bind_destination, "dx", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_bind_source, "sx", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_bind_routing_key, "bk", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_bind_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_exchange_bind_arguments, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Consume-Ok                       */
+static const amqp_0_9_arg_t amqp_0_9_exchange_delete_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_exchange_delete_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_exchange_delete_exchange, "x", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_delete_if_unused, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_exchange_delete_nowait, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_consume_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_consume_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_queue_declare_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_queue_declare_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_declare_queue, "q", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_declare_passive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_declare_durable, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_declare_exclusive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_declare_auto_delete, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_declare_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_queue_declare_arguments, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_queue_declare_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_declare_ok_queue, "q", NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_queue_declare_ok_message_count, NULL, NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_queue_declare_ok_consumer_count, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Cancel                           */
+static const amqp_0_9_arg_t amqp_0_9_queue_bind_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_queue_bind_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_bind_queue, "q", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_bind_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_bind_routing_key, "bk", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_bind_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_queue_bind_arguments, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_cancel(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_cancel_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_queue_unbind_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_queue_unbind_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_unbind_queue, "q", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_unbind_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_unbind_routing_key, "rk", NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_queue_unbind_arguments, NULL, NULL },
+};
 
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_cancel_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_queue_purge_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_queue_purge_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_purge_queue, "q", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_purge_nowait, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_queue_purge_ok_args[] = {
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_queue_purge_ok_message_count, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Cancel-Ok                        */
+static const amqp_0_9_arg_t amqp_0_9_queue_delete_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_queue_delete_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_queue_delete_queue, "q", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_delete_if_unused, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_delete_if_empty, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_queue_delete_nowait, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_cancel_ok(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_cancel_ok_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_queue_delete_ok_args[] = {
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_queue_delete_ok_message_count, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_basic_qos_args[] = {
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_basic_qos_prefetch_size, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_basic_qos_prefetch_count, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_qos_global, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Publish                          */
+static const amqp_0_9_arg_t amqp_0_9_basic_consume_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_basic_consume_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_consume_queue, "q", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_consume_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_consume_no_local, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_consume_no_ack, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_consume_exclusive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_consume_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_basic_consume_filter, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_publish(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  ticket (short)           */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_publish_ticket,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+static const amqp_0_9_arg_t amqp_0_9_basic_consume_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_consume_ok_consumer_tag, NULL, NULL },
+};
 
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_publish_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_cancel_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_cancel_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_cancel_nowait, NULL, NULL },
+};
 
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_publish_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_cancel_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_cancel_ok_consumer_tag, NULL, NULL },
+};
 
-    /*  mandatory (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_publish_mandatory,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_basic_publish_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_basic_publish_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_publish_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_publish_routing_key, "rk", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_publish_mandatory, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_publish_immediate, NULL, NULL },
+};
 
-    /*  immediate (bit)          */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_publish_immediate,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_arg_t amqp_0_9_basic_return_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_basic_return_reply_code, NULL, &ei_amqp_message_undeliverable },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_return_reply_text, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_return_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_return_routing_key, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_basic_deliver_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_deliver_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_basic_deliver_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_deliver_redelivered, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_deliver_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_deliver_routing_key, "rk", NULL },
+};
 
-/*  Dissection routine for method Stream.Return                           */
+static const amqp_0_9_arg_t amqp_0_9_basic_get_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_basic_get_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_get_queue, "q", NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_get_no_ack, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_return(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  reply-code (short)       */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_return_reply_code,
-        tvb, offset, 2, ENC_BIG_ENDIAN);
-    offset += 2;
+static const amqp_0_9_arg_t amqp_0_9_basic_get_ok_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_basic_get_ok_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_get_ok_redelivered, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_get_ok_exchange, "x", NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_get_ok_routing_key, "rk", NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_basic_get_ok_message_count, NULL, NULL },
+};
 
-    /*  reply-text (shortstr)    */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_return_reply_text,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_get_empty_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_basic_get_empty_cluster_id, NULL, NULL },
+};
 
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_return_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_ack_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_basic_ack_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_ack_multiple, NULL, NULL },
+};
 
-    /*  routing-key (shortstr)   */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_return_routing_key,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_reject_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_basic_reject_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_reject_requeue, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_basic_recover_async_args[] = {
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_recover_requeue, NULL, NULL },
+};
 
-/*  Dissection routine for method Stream.Deliver                          */
+static const amqp_0_9_arg_t amqp_0_9_basic_recover_args[] = {
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_recover_requeue, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_stream_deliver(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  consumer-tag (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_deliver_consumer_tag,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_basic_nack_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_basic_nack_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_nack_multiple, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_basic_nack_requeue, NULL, NULL },
+};
 
-    /*  delivery-tag (longlong)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_deliver_delivery_tag,
-        tvb, offset, 8, ENC_BIG_ENDIAN);
-    offset += 8;
+static const amqp_0_9_arg_t amqp_0_9_file_qos_args[] = {
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_file_qos_prefetch_size, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_file_qos_prefetch_count, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_qos_global, NULL, NULL },
+};
 
-    /*  exchange (shortstr)      */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_deliver_exchange,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_file_consume_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_file_consume_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_consume_queue, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_consume_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_consume_no_local, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_consume_no_ack, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_consume_exclusive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_consume_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_file_consume_filter, NULL, NULL },
+};
 
-    /*  queue (shortstr)         */
-    proto_tree_add_item(args_tree, hf_amqp_method_stream_deliver_queue,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_file_consume_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_consume_ok_consumer_tag, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_file_cancel_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_cancel_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_cancel_nowait, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Select                               */
+static const amqp_0_9_arg_t amqp_0_9_file_cancel_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_cancel_ok_consumer_tag, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_select(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_file_open_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_open_identifier, NULL, NULL },
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_file_open_content_size, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Select-Ok                            */
+static const amqp_0_9_arg_t amqp_0_9_file_open_ok_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_file_open_ok_staged_size, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_select_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_file_publish_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_file_publish_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_publish_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_publish_routing_key, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_publish_mandatory, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_publish_immediate, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_publish_identifier, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Commit                               */
+static const amqp_0_9_arg_t amqp_0_9_file_return_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_file_return_reply_code, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_return_reply_text, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_return_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_return_routing_key, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_commit(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_file_deliver_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_deliver_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_file_deliver_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_deliver_redelivered, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_deliver_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_deliver_routing_key, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_file_deliver_identifier, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Commit-Ok                            */
+static const amqp_0_9_arg_t amqp_0_9_file_ack_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_file_ack_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_ack_multiple, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_commit_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_file_reject_args[] = {
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_file_reject_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_file_reject_requeue, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Rollback                             */
+static const amqp_0_9_arg_t amqp_0_9_stream_qos_args[] = {
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_stream_qos_prefetch_size, NULL, NULL },
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_stream_qos_prefetch_count, NULL, NULL },
+    { AMQP_0_9_ARG_LONG,             &hf_amqp_method_stream_qos_consume_rate, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_qos_global, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_rollback(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_stream_consume_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_stream_consume_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_consume_queue, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_consume_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_consume_no_local, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_consume_exclusive, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_consume_nowait, NULL, NULL },
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_stream_consume_filter, NULL, NULL },
+};
 
-/*  Dissection routine for method Tx.Rollback-Ok                          */
+static const amqp_0_9_arg_t amqp_0_9_stream_consume_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_consume_ok_consumer_tag, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_tx_rollback_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_stream_cancel_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_cancel_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_cancel_nowait, NULL, NULL },
+};
 
-/*  Dissection routine for method Dtx.Select                              */
+static const amqp_0_9_arg_t amqp_0_9_stream_cancel_ok_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_cancel_ok_consumer_tag, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_dtx_select(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_stream_publish_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_stream_publish_ticket, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_publish_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_publish_routing_key, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_publish_mandatory, NULL, NULL },
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_stream_publish_immediate, NULL, NULL },
+};
 
-/*  Dissection routine for method Dtx.Select-Ok                           */
+static const amqp_0_9_arg_t amqp_0_9_stream_return_args[] = {
+    { AMQP_0_9_ARG_SHORT,            &hf_amqp_method_stream_return_reply_code, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_return_reply_text, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_return_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_return_routing_key, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_dtx_select_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_stream_deliver_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_deliver_consumer_tag, NULL, NULL },
+    { AMQP_0_9_ARG_LONGLONG,         &hf_amqp_method_stream_deliver_delivery_tag, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_deliver_exchange, NULL, NULL },
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_stream_deliver_queue, NULL, NULL },
+};
 
-/*  Dissection routine for method Dtx.Start                               */
+static const amqp_0_9_arg_t amqp_0_9_dtx_start_args[] = {
+    { AMQP_0_9_ARG_SHORTSTR,         &hf_amqp_method_dtx_start_dtx_identifier, NULL, NULL },
+};
 
-static int
-dissect_amqp_0_9_method_dtx_start(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  dtx-identifier (shortstr)  */
-    proto_tree_add_item(args_tree, hf_amqp_method_dtx_start_dtx_identifier,
-        tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
-    offset += 1 + tvb_get_guint8(tvb, offset);
+static const amqp_0_9_arg_t amqp_0_9_tunnel_request_args[] = {
+    { AMQP_0_9_ARG_TABLE,            &hf_amqp_method_tunnel_request_meta_data, NULL, NULL },
+};
 
-    return offset;
-}
+static const amqp_0_9_arg_t amqp_0_9_confirm_select_args[] = {
+    { AMQP_0_9_ARG_BIT,              &hf_amqp_method_confirm_select_nowait, NULL, NULL },
+};
 
-/*  Dissection routine for method Dtx.Start-Ok                            */
+static const amqp_0_9_method_t amqp_0_9_connection_methods[] = {
+    { AMQP_0_9_METHOD_CONNECTION_START, AMQP_0_9_ARGS(amqp_0_9_connection_start_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_START_OK, AMQP_0_9_ARGS(amqp_0_9_connection_start_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_SECURE, AMQP_0_9_ARGS(amqp_0_9_connection_secure_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_SECURE_OK, AMQP_0_9_ARGS(amqp_0_9_connection_secure_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_TUNE, AMQP_0_9_ARGS(amqp_0_9_connection_tune_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_TUNE_OK, AMQP_0_9_ARGS(amqp_0_9_connection_tune_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_OPEN, AMQP_0_9_ARGS(amqp_0_9_connection_open_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_OPEN_OK, AMQP_0_9_ARGS(amqp_0_9_connection_open_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_REDIRECT, AMQP_0_9_ARGS(amqp_0_9_connection_redirect_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_CLOSE, AMQP_0_9_ARGS(amqp_0_9_connection_close_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_CLOSE_OK, NULL, 0, amqp_0_9_connection_close_ok_hook, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_BLOCKED, AMQP_0_9_ARGS(amqp_0_9_connection_blocked_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONNECTION_UNBLOCKED, NULL, 0, NULL, 0 },
+};
 
-static int
-dissect_amqp_0_9_method_dtx_start_ok(tvbuff_t *tvb _U_,
-    int offset, proto_tree *args_tree _U_)
-{
-    return offset;
-}
+static const amqp_0_9_method_t amqp_0_9_channel_methods[] = {
+    { AMQP_0_9_METHOD_CHANNEL_OPEN, AMQP_0_9_ARGS(amqp_0_9_channel_open_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_OPEN_OK, AMQP_0_9_ARGS(amqp_0_9_channel_open_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_FLOW, AMQP_0_9_ARGS(amqp_0_9_channel_flow_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_FLOW_OK, AMQP_0_9_ARGS(amqp_0_9_channel_flow_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_CLOSE, AMQP_0_9_ARGS(amqp_0_9_channel_close_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_CLOSE_OK, NULL, 0, amqp_0_9_channel_close_ok_hook, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_RESUME, AMQP_0_9_ARGS(amqp_0_9_channel_resume_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_PING, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_PONG, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_CHANNEL_OK, NULL, 0, NULL, 0 },
+};
 
-/*  Dissection routine for method Tunnel.Request                          */
+static const amqp_0_9_method_t amqp_0_9_access_methods[] = {
+    { AMQP_0_9_METHOD_ACCESS_REQUEST, AMQP_0_9_ARGS(amqp_0_9_access_request_args), NULL, 0 },
+    { AMQP_0_9_METHOD_ACCESS_REQUEST_OK, AMQP_0_9_ARGS(amqp_0_9_access_request_ok_args), NULL, 0 },
+};
 
-static int
-dissect_amqp_0_9_method_tunnel_request(tvbuff_t *tvb, packet_info *pinfo,
-    int offset, proto_tree *args_tree)
-{
-    proto_item *ti;
+static const amqp_0_9_method_t amqp_0_9_exchange_methods[] = {
+    { AMQP_0_9_METHOD_EXCHANGE_DECLARE, AMQP_0_9_ARGS(amqp_0_9_exchange_declare_args), amqp_0_9_exchange_declare_hook, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_DECLARE_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_BIND, AMQP_0_9_ARGS(amqp_0_9_exchange_bind_args), NULL, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_BIND_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_DELETE, AMQP_0_9_ARGS(amqp_0_9_exchange_delete_args), NULL, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_DELETE_OK, NULL, 0, NULL, 0 },
+    /* the same arguments as bind and bind-ok */
+    { AMQP_0_9_METHOD_EXCHANGE_UNBIND, AMQP_0_9_ARGS(amqp_0_9_exchange_bind_args), NULL, 0 },
+    { AMQP_0_9_METHOD_EXCHANGE_UNBIND_OK, NULL, 0, NULL, 0 },
+};
 
-    /*  meta-data (table)        */
-    ti = proto_tree_add_item(
-        args_tree, hf_amqp_method_tunnel_request_meta_data,
-        tvb, offset + 4, tvb_get_ntohl(tvb, offset), ENC_NA);
-    dissect_amqp_0_9_field_table(tvb, pinfo, offset + 4, tvb_get_ntohl(tvb, offset), ti);
-    offset += 4 + tvb_get_ntohl(tvb, offset);
+static const amqp_0_9_method_t amqp_0_9_queue_methods[] = {
+    { AMQP_0_9_METHOD_QUEUE_DECLARE, AMQP_0_9_ARGS(amqp_0_9_queue_declare_args), NULL, 0 },
+    { AMQP_0_9_METHOD_QUEUE_DECLARE_OK, AMQP_0_9_ARGS(amqp_0_9_queue_declare_ok_args), amqp_0_9_queue_declare_ok_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_BIND, AMQP_0_9_ARGS(amqp_0_9_queue_bind_args), amqp_0_9_queue_bind_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_BIND_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_QUEUE_UNBIND, AMQP_0_9_ARGS(amqp_0_9_queue_unbind_args), amqp_0_9_queue_unbind_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_UNBIND_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_QUEUE_PURGE, AMQP_0_9_ARGS(amqp_0_9_queue_purge_args), amqp_0_9_queue_op_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_PURGE_OK, AMQP_0_9_ARGS(amqp_0_9_queue_purge_ok_args), amqp_0_9_queue_purge_ok_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_DELETE, AMQP_0_9_ARGS(amqp_0_9_queue_delete_args), amqp_0_9_queue_op_hook, 0 },
+    { AMQP_0_9_METHOD_QUEUE_DELETE_OK, AMQP_0_9_ARGS(amqp_0_9_queue_delete_ok_args), amqp_0_9_queue_delete_ok_hook, 0 },
+};
 
-    return offset;
-}
+static const amqp_0_9_method_t amqp_0_9_basic_methods[] = {
+    { AMQP_0_9_METHOD_BASIC_QOS, AMQP_0_9_ARGS(amqp_0_9_basic_qos_args), NULL, 0 },
+    { AMQP_0_9_METHOD_BASIC_QOS_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_BASIC_CONSUME, AMQP_0_9_ARGS(amqp_0_9_basic_consume_args), amqp_0_9_basic_consume_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_CONSUME_OK, AMQP_0_9_ARGS(amqp_0_9_basic_consume_ok_args), amqp_0_9_basic_consume_ok_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_CANCEL, AMQP_0_9_ARGS(amqp_0_9_basic_cancel_args), NULL, 0 },
+    { AMQP_0_9_METHOD_BASIC_CANCEL_OK, AMQP_0_9_ARGS(amqp_0_9_basic_cancel_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_BASIC_PUBLISH, AMQP_0_9_ARGS(amqp_0_9_basic_publish_args), amqp_0_9_basic_publish_hook, AMQP_0_9_ACK_REFERENCE },
+    { AMQP_0_9_METHOD_BASIC_RETURN, AMQP_0_9_ARGS(amqp_0_9_basic_return_args), amqp_0_9_basic_return_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_DELIVER, AMQP_0_9_ARGS(amqp_0_9_basic_deliver_args), amqp_0_9_basic_deliver_hook, AMQP_0_9_ACK_REFERENCE },
+    { AMQP_0_9_METHOD_BASIC_GET, AMQP_0_9_ARGS(amqp_0_9_basic_get_args), amqp_0_9_basic_get_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_GET_OK, AMQP_0_9_ARGS(amqp_0_9_basic_get_ok_args), amqp_0_9_basic_get_ok_hook, AMQP_0_9_ACK_REFERENCE },
+    { AMQP_0_9_METHOD_BASIC_GET_EMPTY, AMQP_0_9_ARGS(amqp_0_9_basic_get_empty_args), amqp_0_9_basic_get_empty_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_ACK, AMQP_0_9_ARGS(amqp_0_9_basic_ack_args), amqp_0_9_basic_ack_hook, AMQP_0_9_MSG_REFERENCE },
+    { AMQP_0_9_METHOD_BASIC_REJECT, AMQP_0_9_ARGS(amqp_0_9_basic_reject_args), amqp_0_9_basic_reject_hook, AMQP_0_9_MSG_REFERENCE },
+    { AMQP_0_9_METHOD_BASIC_RECOVER_ASYNC, AMQP_0_9_ARGS(amqp_0_9_basic_recover_async_args), amqp_0_9_basic_recover_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_RECOVER, AMQP_0_9_ARGS(amqp_0_9_basic_recover_args), amqp_0_9_basic_recover_hook, 0 },
+    { AMQP_0_9_METHOD_BASIC_RECOVER_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_BASIC_NACK, AMQP_0_9_ARGS(amqp_0_9_basic_nack_args), amqp_0_9_basic_nack_hook, AMQP_0_9_MSG_REFERENCE },
+};
 
-/*  Dissection routine for method Confirm.Select                          */
+static const amqp_0_9_method_t amqp_0_9_file_methods[] = {
+    { AMQP_0_9_METHOD_FILE_QOS, AMQP_0_9_ARGS(amqp_0_9_file_qos_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_QOS_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_CONSUME, AMQP_0_9_ARGS(amqp_0_9_file_consume_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_CONSUME_OK, AMQP_0_9_ARGS(amqp_0_9_file_consume_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_CANCEL, AMQP_0_9_ARGS(amqp_0_9_file_cancel_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_CANCEL_OK, AMQP_0_9_ARGS(amqp_0_9_file_cancel_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_OPEN, AMQP_0_9_ARGS(amqp_0_9_file_open_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_OPEN_OK, AMQP_0_9_ARGS(amqp_0_9_file_open_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_STAGE, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_PUBLISH, AMQP_0_9_ARGS(amqp_0_9_file_publish_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_RETURN, AMQP_0_9_ARGS(amqp_0_9_file_return_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_DELIVER, AMQP_0_9_ARGS(amqp_0_9_file_deliver_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_ACK, AMQP_0_9_ARGS(amqp_0_9_file_ack_args), NULL, 0 },
+    { AMQP_0_9_METHOD_FILE_REJECT, AMQP_0_9_ARGS(amqp_0_9_file_reject_args), NULL, 0 },
+};
 
-static int
-dissect_amqp_0_9_method_confirm_select(tvbuff_t *tvb,
-    int offset, proto_tree *args_tree)
-{
-    /*  nowait (bit)             */
-    proto_tree_add_item(args_tree, hf_amqp_method_confirm_select_nowait,
-        tvb, offset, 1, ENC_BIG_ENDIAN);
+static const amqp_0_9_method_t amqp_0_9_stream_methods[] = {
+    { AMQP_0_9_METHOD_STREAM_QOS, AMQP_0_9_ARGS(amqp_0_9_stream_qos_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_QOS_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_CONSUME, AMQP_0_9_ARGS(amqp_0_9_stream_consume_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_CONSUME_OK, AMQP_0_9_ARGS(amqp_0_9_stream_consume_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_CANCEL, AMQP_0_9_ARGS(amqp_0_9_stream_cancel_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_CANCEL_OK, AMQP_0_9_ARGS(amqp_0_9_stream_cancel_ok_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_PUBLISH, AMQP_0_9_ARGS(amqp_0_9_stream_publish_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_RETURN, AMQP_0_9_ARGS(amqp_0_9_stream_return_args), NULL, 0 },
+    { AMQP_0_9_METHOD_STREAM_DELIVER, AMQP_0_9_ARGS(amqp_0_9_stream_deliver_args), NULL, 0 },
+};
 
-    return offset;
-}
+static const amqp_0_9_method_t amqp_0_9_tx_methods[] = {
+    { AMQP_0_9_METHOD_TX_SELECT, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_TX_SELECT_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_TX_COMMIT, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_TX_COMMIT_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_TX_ROLLBACK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_TX_ROLLBACK_OK, NULL, 0, NULL, 0 },
+};
 
-/*  Dissection routine for method Confirm.Select-Ok                       */
+static const amqp_0_9_method_t amqp_0_9_dtx_methods[] = {
+    { AMQP_0_9_METHOD_DTX_SELECT, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_DTX_SELECT_OK, NULL, 0, NULL, 0 },
+    { AMQP_0_9_METHOD_DTX_START, AMQP_0_9_ARGS(amqp_0_9_dtx_start_args), NULL, 0 },
+    { AMQP_0_9_METHOD_DTX_START_OK, NULL, 0, NULL, 0 },
+};
 
-static int
-dissect_amqp_0_9_method_confirm_select_ok(guint16 channel_num,
-    tvbuff_t *tvb _U_, packet_info *pinfo, int offset, proto_tree *args_tree _U_)
-{
-    if(!PINFO_FD_VISITED(pinfo))
-    {
-        amqp_channel_t *channel;
-        channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
-        channel->confirms = TRUE;
-    }
+static const amqp_0_9_method_t amqp_0_9_tunnel_methods[] = {
+    { AMQP_0_9_METHOD_TUNNEL_REQUEST, AMQP_0_9_ARGS(amqp_0_9_tunnel_request_args), NULL, 0 },
+};
 
-    return offset;
-}
+static const amqp_0_9_method_t amqp_0_9_confirm_methods[] = {
+    { AMQP_0_9_METHOD_CONFIRM_SELECT, AMQP_0_9_ARGS(amqp_0_9_confirm_select_args), NULL, 0 },
+    { AMQP_0_9_METHOD_CONFIRM_SELECT_OK, NULL, 0, amqp_0_9_confirm_select_ok_hook, 0 },
+};
+
+static const amqp_0_9_class_t amqp_0_9_classes[] = {
+    { AMQP_0_9_CLASS_CONNECTION, "Connection", "connection", &hf_amqp_method_connection_method_id,
+        amqp_method_connection_methods, &ei_amqp_unknown_connection_method, AMQP_0_9_ARGS(amqp_0_9_connection_methods) },
+    { AMQP_0_9_CLASS_CHANNEL, "Channel", "channel", &hf_amqp_method_channel_method_id,
+        amqp_method_channel_methods, &ei_amqp_unknown_channel_method, AMQP_0_9_ARGS(amqp_0_9_channel_methods) },
+    { AMQP_0_9_CLASS_ACCESS, "Access", "access", &hf_amqp_method_access_method_id,
+        amqp_method_access_methods, &ei_amqp_unknown_access_method, AMQP_0_9_ARGS(amqp_0_9_access_methods) },
+    { AMQP_0_9_CLASS_EXCHANGE, "Exchange", "exchange", &hf_amqp_method_exchange_method_id,
+        amqp_method_exchange_methods, &ei_amqp_unknown_exchange_method, AMQP_0_9_ARGS(amqp_0_9_exchange_methods) },
+    { AMQP_0_9_CLASS_QUEUE, "Queue", "queue", &hf_amqp_method_queue_method_id,
+        amqp_method_queue_methods, &ei_amqp_unknown_queue_method, AMQP_0_9_ARGS(amqp_0_9_queue_methods) },
+    { AMQP_0_9_CLASS_BASIC, "Basic", "basic", &hf_amqp_method_basic_method_id,
+        amqp_method_basic_methods, &ei_amqp_unknown_basic_method, AMQP_0_9_ARGS(amqp_0_9_basic_methods) },
+    { AMQP_0_9_CLASS_FILE, "File", "file", &hf_amqp_method_file_method_id,
+        amqp_method_file_methods, &ei_amqp_unknown_file_method, AMQP_0_9_ARGS(amqp_0_9_file_methods) },
+    { AMQP_0_9_CLASS_STREAM, "Stream", "stream", &hf_amqp_method_stream_method_id,
+        amqp_method_stream_methods, &ei_amqp_unknown_stream_method, AMQP_0_9_ARGS(amqp_0_9_stream_methods) },
+    { AMQP_0_9_CLASS_TX, "Tx", "tx", &hf_amqp_method_tx_method_id,
+        amqp_method_tx_methods, &ei_amqp_unknown_tx_method, AMQP_0_9_ARGS(amqp_0_9_tx_methods) },
+    { AMQP_0_9_CLASS_DTX, "Dtx", "dtx", &hf_amqp_method_dtx_method_id,
+        amqp_method_dtx_methods, &ei_amqp_unknown_dtx_method, AMQP_0_9_ARGS(amqp_0_9_dtx_methods) },
+    { AMQP_0_9_CLASS_TUNNEL, "Tunnel", "tunnel", &hf_amqp_method_tunnel_method_id,
+        amqp_method_tunnel_methods, &ei_amqp_unknown_tunnel_method, AMQP_0_9_ARGS(amqp_0_9_tunnel_methods) },
+    { AMQP_0_9_CLASS_CONFIRM, "Confirm", "confirm", &hf_amqp_method_confirm_method_id,
+        amqp_method_confirm_methods, &ei_amqp_unknown_confirm_method, AMQP_0_9_ARGS(amqp_0_9_confirm_methods) },
+};
 
 
 /*  Dissection routine for content headers of class basic          */
@@ -8830,7 +10788,8 @@ dissect_amqp_0_9_content_header_basic(tvbuff_t *tvb, packet_info *pinfo,
         col_append_fstr(pinfo->cinfo, COL_INFO, "type=%s ", content);
 
         eh_ptr->type = ascii_strdown_inplace(
-            (char*)tvb_get_string_enc(wmem_file_scope(), tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII));
+            (char*)tvb_get_string_enc(PINFO_FD_VISITED(pinfo) ? pinfo->pool : wmem_file_scope(),
+                tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII));
 
         offset += 1 + tvb_get_guint8(tvb, offset);
     }
@@ -8842,7 +10801,8 @@ dissect_amqp_0_9_content_header_basic(tvbuff_t *tvb, packet_info *pinfo,
             tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII|ENC_NA);
 
         eh_ptr->encoding = ascii_strdown_inplace(
-            tvb_get_string_enc(wmem_file_scope(), tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII));
+            tvb_get_string_enc(PINFO_FD_VISITED(pinfo) ? pinfo->pool : wmem_file_scope(),
+                tvb, offset + 1, tvb_get_guint8(tvb, offset), ENC_ASCII));
 
         offset += 1 + tvb_get_guint8(tvb, offset);
     }
@@ -9165,9 +11125,14 @@ dissect_amqp_0_9_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void
     proto_item    *amqp_tree = NULL;
     proto_item    *args_tree;
     proto_item    *prop_tree;
+    amqp_tap_info_t *tap_info;
     guint          length;
     guint8         frame_type;
     guint16        channel_num, class_id, method_id;
+    const amqp_0_9_class_t  *method_class;
+    const amqp_0_9_method_t *method;
+    amqp_0_9_arg_value_t     values[AMQP_0_9_MAX_METHOD_ARGS];
+    guint          i;
 
     /*  Heuristic - protocol initialisation frame starts with 'AMQP'  */
     if (tvb_memeql(tvb, 0, "AMQP", 4) == 0) {
@@ -9211,591 +11176,54 @@ dissect_amqp_0_9_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void
         class_id = tvb_get_ntohs(tvb, 7);
         proto_tree_add_item(amqp_tree, hf_amqp_0_9_method_class_id,
                             tvb, 7, 2, ENC_BIG_ENDIAN);
-        switch (class_id) {
-        case AMQP_0_9_CLASS_CONNECTION:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_connection_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Connection.%s ",
-                            val_to_str( method_id, amqp_method_connection_methods, "Unknown (%u)"));
-            switch (method_id) {
-            case AMQP_0_9_METHOD_CONNECTION_START:
-                dissect_amqp_0_9_method_connection_start(tvb,
-                                                         pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_START_OK:
-                dissect_amqp_0_9_method_connection_start_ok(tvb,
-                                                            pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_SECURE:
-                dissect_amqp_0_9_method_connection_secure(tvb,
-                                                          11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_SECURE_OK:
-                dissect_amqp_0_9_method_connection_secure_ok(tvb,
-                                                             11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_TUNE:
-                dissect_amqp_0_9_method_connection_tune(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_TUNE_OK:
-                dissect_amqp_0_9_method_connection_tune_ok(tvb,
-                                                           11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_OPEN:
-                dissect_amqp_0_9_method_connection_open(tvb,
-                                                        pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_OPEN_OK:
-                dissect_amqp_0_9_method_connection_open_ok(tvb,
-                                                           11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_REDIRECT:
-                dissect_amqp_0_9_method_connection_redirect(tvb,
-                                                            11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_CLOSE:
-                dissect_amqp_0_9_method_connection_close(tvb,
-                                                         pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_CLOSE_OK:
-                dissect_amqp_0_9_method_connection_close_ok(tvb,
-                                                            11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_BLOCKED:
-                dissect_amqp_0_9_method_connection_blocked(tvb,
-                                                           11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CONNECTION_UNBLOCKED:
-                dissect_amqp_0_9_method_connection_unblocked(tvb,
-                                                             11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_connection_method, "Unknown connection method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_CHANNEL:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_channel_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Channel.%s ",
-                            val_to_str( method_id, amqp_method_channel_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_CHANNEL_OPEN:
-                dissect_amqp_0_9_method_channel_open(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_OPEN_OK:
-                dissect_amqp_0_9_method_channel_open_ok(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_FLOW:
-                dissect_amqp_0_9_method_channel_flow(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_FLOW_OK:
-                dissect_amqp_0_9_method_channel_flow_ok(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_CLOSE:
-                dissect_amqp_0_9_method_channel_close(channel_num, tvb,
-                                                      pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_CLOSE_OK:
-                dissect_amqp_0_9_method_channel_close_ok(tvb,
-                                                         11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_RESUME:
-                dissect_amqp_0_9_method_channel_resume(tvb,
-                                                       11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_PING:
-                dissect_amqp_0_9_method_channel_ping(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_PONG:
-                dissect_amqp_0_9_method_channel_pong(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_CHANNEL_OK:
-                dissect_amqp_0_9_method_channel_ok(tvb,
-                                                   11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_channel_method, "Unknown channel method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_ACCESS:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_access_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            switch (method_id) {
-            case AMQP_0_9_METHOD_ACCESS_REQUEST:
-                dissect_amqp_0_9_method_access_request(tvb,
-                                                       11, args_tree);
-                col_append_str(pinfo->cinfo, COL_INFO,
-                               "Access.Request ");
-                break;
-            case AMQP_0_9_METHOD_ACCESS_REQUEST_OK:
-                dissect_amqp_0_9_method_access_request_ok(tvb,
-                                                          11, args_tree);
-                col_append_str(pinfo->cinfo, COL_INFO,
-                               "Access.Request-Ok ");
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_access_method, "Unknown access method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_EXCHANGE:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_exchange_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Exchange.%s ",
-                            val_to_str( method_id, amqp_method_exchange_methods, "Unknown (%u)"));
-            switch (method_id) {
-            case AMQP_0_9_METHOD_EXCHANGE_DECLARE:
-                dissect_amqp_0_9_method_exchange_declare(tvb,
-                                                         pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_DECLARE_OK:
-                dissect_amqp_0_9_method_exchange_declare_ok(tvb,
-                                                            11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_BIND:
-                dissect_amqp_0_9_method_exchange_bind(tvb,
-                                                      pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_BIND_OK:
-                dissect_amqp_0_9_method_exchange_bind_ok(tvb,
-                                                         11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_DELETE:
-                dissect_amqp_0_9_method_exchange_delete(tvb,
-                                                        pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_DELETE_OK:
-                dissect_amqp_0_9_method_exchange_delete_ok(tvb,
-                                                           11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_UNBIND:
-                /* the same parameters as in bind */
-                dissect_amqp_0_9_method_exchange_bind(tvb,
-                                                      pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_EXCHANGE_UNBIND_OK:
-                /* the same parameters as in bind-ok */
-                dissect_amqp_0_9_method_exchange_bind_ok(tvb,
-                                                         11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_exchange_method, "Unknown exchange method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_QUEUE:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_queue_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Queue.%s ",
-                            val_to_str( method_id, amqp_method_queue_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_QUEUE_DECLARE:
-                dissect_amqp_0_9_method_queue_declare(tvb,
-                                                      pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_DECLARE_OK:
-                dissect_amqp_0_9_method_queue_declare_ok(tvb,
-                                                         pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_BIND:
-                dissect_amqp_0_9_method_queue_bind(tvb,
-                                                   pinfo, 11, args_tree);
+        method_class = NULL;
+        for (i = 0; i < G_N_ELEMENTS(amqp_0_9_classes); i++) {
+            if (amqp_0_9_classes[i].class_id == class_id) {
+                method_class = &amqp_0_9_classes[i];
                 break;
-            case AMQP_0_9_METHOD_QUEUE_BIND_OK:
-                dissect_amqp_0_9_method_queue_bind_ok(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_UNBIND:
-                dissect_amqp_0_9_method_queue_unbind(tvb,
-                                                     pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_UNBIND_OK:
-                dissect_amqp_0_9_method_queue_unbind_ok(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_PURGE:
-                dissect_amqp_0_9_method_queue_purge(tvb,
-                                                    pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_PURGE_OK:
-                dissect_amqp_0_9_method_queue_purge_ok(tvb,
-                                                       11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_DELETE:
-                dissect_amqp_0_9_method_queue_delete(tvb,
-                                                     pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_QUEUE_DELETE_OK:
-                dissect_amqp_0_9_method_queue_delete_ok(tvb,
-                                                        11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_queue_method, "Unknown queue method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_BASIC:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_basic_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Basic.%s ",
-                            val_to_str( method_id, amqp_method_basic_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_BASIC_QOS:
-                dissect_amqp_0_9_method_basic_qos(tvb,
-                                                  11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_QOS_OK:
-                dissect_amqp_0_9_method_basic_qos_ok(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_CONSUME:
-                dissect_amqp_0_9_method_basic_consume(tvb,
-                                                      pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_CONSUME_OK:
-                dissect_amqp_0_9_method_basic_consume_ok(tvb,
-                                                         11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_CANCEL:
-                dissect_amqp_0_9_method_basic_cancel(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_CANCEL_OK:
-                dissect_amqp_0_9_method_basic_cancel_ok(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_PUBLISH:
-                dissect_amqp_0_9_method_basic_publish(channel_num, tvb,
-                                                      pinfo, 11, args_tree);
-                generate_ack_reference(tvb, pinfo, amqp_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_RETURN:
-                dissect_amqp_0_9_method_basic_return(tvb,
-                                                     pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_DELIVER:
-                dissect_amqp_0_9_method_basic_deliver(channel_num, tvb,
-                                                      pinfo, 11, args_tree);
-                generate_ack_reference(tvb, pinfo, amqp_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_GET:
-                dissect_amqp_0_9_method_basic_get(tvb,
-                                                  pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_GET_OK:
-                dissect_amqp_0_9_method_basic_get_ok(channel_num, tvb,
-                                                     pinfo, 11, args_tree);
-                generate_ack_reference(tvb, pinfo, amqp_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_GET_EMPTY:
-                dissect_amqp_0_9_method_basic_get_empty(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_ACK:
-                dissect_amqp_0_9_method_basic_ack(channel_num, tvb,
-                                                  pinfo, 11, args_tree);
-                generate_msg_reference(tvb, pinfo, amqp_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_REJECT:
-                dissect_amqp_0_9_method_basic_reject(channel_num, tvb,
-                                                     pinfo, 11, args_tree);
-                generate_msg_reference(tvb, pinfo, amqp_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_RECOVER_ASYNC:
-                dissect_amqp_0_9_method_basic_recover_async(tvb,
-                                                            11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_RECOVER:
-                dissect_amqp_0_9_method_basic_recover(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_RECOVER_OK:
-                dissect_amqp_0_9_method_basic_recover_ok(tvb,
-                                                         11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_BASIC_NACK:
-                dissect_amqp_0_9_method_basic_nack(channel_num, tvb,
-                                                   pinfo, 11, args_tree);
-                generate_msg_reference(tvb, pinfo, amqp_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_basic_method, "Unknown basic method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_FILE:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_file_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "File.%s ",
-                            val_to_str( method_id, amqp_method_file_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_FILE_QOS:
-                dissect_amqp_0_9_method_file_qos(tvb,
-                                                 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_QOS_OK:
-                dissect_amqp_0_9_method_file_qos_ok(tvb,
-                                                    11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_CONSUME:
-                dissect_amqp_0_9_method_file_consume(tvb,
-                                                     pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_CONSUME_OK:
-                dissect_amqp_0_9_method_file_consume_ok(tvb,
-                                                        11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_CANCEL:
-                dissect_amqp_0_9_method_file_cancel(tvb,
-                                                    11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_CANCEL_OK:
-                dissect_amqp_0_9_method_file_cancel_ok(tvb,
-                                                       11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_OPEN:
-                dissect_amqp_0_9_method_file_open(tvb,
-                                                  11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_OPEN_OK:
-                dissect_amqp_0_9_method_file_open_ok(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_STAGE:
-                dissect_amqp_0_9_method_file_stage(tvb,
-                                                   11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_PUBLISH:
-                dissect_amqp_0_9_method_file_publish(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_RETURN:
-                dissect_amqp_0_9_method_file_return(tvb,
-                                                    11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_DELIVER:
-                dissect_amqp_0_9_method_file_deliver(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_ACK:
-                dissect_amqp_0_9_method_file_ack(tvb,
-                                                 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_FILE_REJECT:
-                dissect_amqp_0_9_method_file_reject(tvb,
-                                                    11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_file_method, "Unknown file method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_STREAM:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_stream_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Stream.%s ",
-                            val_to_str( method_id, amqp_method_stream_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_STREAM_QOS:
-                dissect_amqp_0_9_method_stream_qos(tvb,
-                                                   11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_QOS_OK:
-                dissect_amqp_0_9_method_stream_qos_ok(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_CONSUME:
-                dissect_amqp_0_9_method_stream_consume(tvb,
-                                                       pinfo, 11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_CONSUME_OK:
-                dissect_amqp_0_9_method_stream_consume_ok(tvb,
-                                                          11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_CANCEL:
-                dissect_amqp_0_9_method_stream_cancel(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_CANCEL_OK:
-                dissect_amqp_0_9_method_stream_cancel_ok(tvb,
-                                                         11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_PUBLISH:
-                dissect_amqp_0_9_method_stream_publish(tvb,
-                                                       11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_RETURN:
-                dissect_amqp_0_9_method_stream_return(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_STREAM_DELIVER:
-                dissect_amqp_0_9_method_stream_deliver(tvb,
-                                                       11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_stream_method, "Unknown stream method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_TX:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_tx_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Tx.%s ",
-                            val_to_str( method_id, amqp_method_tx_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_TX_SELECT:
-                dissect_amqp_0_9_method_tx_select(tvb,
-                                                  11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_TX_SELECT_OK:
-                dissect_amqp_0_9_method_tx_select_ok(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_TX_COMMIT:
-                dissect_amqp_0_9_method_tx_commit(tvb,
-                                                  11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_TX_COMMIT_OK:
-                dissect_amqp_0_9_method_tx_commit_ok(tvb,
-                                                     11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_TX_ROLLBACK:
-                dissect_amqp_0_9_method_tx_rollback(tvb,
-                                                    11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_TX_ROLLBACK_OK:
-                dissect_amqp_0_9_method_tx_rollback_ok(tvb,
-                                                       11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_tx_method, "Unknown tx method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_DTX:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_dtx_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-
-            col_append_fstr(pinfo->cinfo, COL_INFO, "Dtx.%s ",
-                            val_to_str( method_id, amqp_method_dtx_methods, "Unknown (%u)"));
-
-            switch (method_id) {
-            case AMQP_0_9_METHOD_DTX_SELECT:
-                dissect_amqp_0_9_method_dtx_select(tvb,
-                                                   11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_DTX_SELECT_OK:
-                dissect_amqp_0_9_method_dtx_select_ok(tvb,
-                                                      11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_DTX_START:
-                dissect_amqp_0_9_method_dtx_start(tvb,
-                                                  11, args_tree);
-                break;
-            case AMQP_0_9_METHOD_DTX_START_OK:
-                dissect_amqp_0_9_method_dtx_start_ok(tvb,
-                                                     11, args_tree);
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_dtx_method, "Unknown dtx method %u", method_id);
-            }
-            break;
-        case AMQP_0_9_CLASS_TUNNEL:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_tunnel_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            switch (method_id) {
-            case AMQP_0_9_METHOD_TUNNEL_REQUEST:
-                dissect_amqp_0_9_method_tunnel_request(tvb,
-                                                       pinfo, 11, args_tree);
-                col_append_str(pinfo->cinfo, COL_INFO,
-                               "Tunnel.Request ");
-                break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_tunnel_method, "Unknown tunnel method %u", method_id);
             }
+        }
+        if (!method_class) {
+            expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_method_class, "Unknown method class %u", class_id);
             break;
-        case AMQP_0_9_CLASS_CONFIRM:
-            method_id = tvb_get_ntohs(tvb, 9);
-            proto_tree_add_item(amqp_tree, hf_amqp_method_confirm_method_id,
-                                tvb, 9, 2, ENC_BIG_ENDIAN);
-            ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
-                                     tvb, 11, length - 4, ENC_NA);
-            args_tree = proto_item_add_subtree(ti, ett_args);
-            switch (method_id) {
-            case AMQP_0_9_METHOD_CONFIRM_SELECT:
-                dissect_amqp_0_9_method_confirm_select(tvb,
-                                                       11, args_tree);
-                col_append_str(pinfo->cinfo, COL_INFO,
-                               "Confirm.Select ");
-                break;
-            case AMQP_0_9_METHOD_CONFIRM_SELECT_OK:
-                dissect_amqp_0_9_method_confirm_select_ok(channel_num, tvb, pinfo,
-                                                          11, args_tree);
-                col_append_str(pinfo->cinfo, COL_INFO,
-                               "Confirm.Select-Ok ");
+        }
+
+        method_id = tvb_get_ntohs(tvb, 9);
+        proto_tree_add_item(amqp_tree, *method_class->hf_method_id,
+                            tvb, 9, 2, ENC_BIG_ENDIAN);
+        ti = proto_tree_add_item(amqp_tree, hf_amqp_method_arguments,
+                                 tvb, 11, length - 4, ENC_NA);
+        args_tree = proto_item_add_subtree(ti, ett_args);
+        col_append_fstr(pinfo->cinfo, COL_INFO, "%s.%s ", method_class->name,
+                        val_to_str(method_id, method_class->method_names, "Unknown (%u)"));
+
+        method = NULL;
+        for (i = 0; i < method_class->num_methods; i++) {
+            if (method_class->methods[i].method_id == method_id) {
+                method = &method_class->methods[i];
                 break;
-            default:
-                expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_confirm_method, "Unknown confirm method %u", method_id);
             }
+        }
+        if (!method) {
+            expert_add_info_format(pinfo, amqp_tree, method_class->ei_unknown_method,
+                                   "Unknown %s method %u", method_class->lower_name, method_id);
             break;
-        default:
-            expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_method_class, "Unknown method class %u", class_id);
         }
+
+        if (!amqp_use_frame_summary(pinfo, tree) ||
+            !amqp_0_9_method_args_from_summary(tvb, pinfo, method, values)) {
+            dissect_amqp_0_9_method_args(tvb, pinfo, 11, args_tree, method, values);
+            if (!PINFO_FD_VISITED(pinfo) && amqp_cache_frame_summaries &&
+                amqp_0_9_method_wants_values(method))
+                amqp_0_9_summarize_method(tvb, pinfo, method, values);
+        }
+        if (method->hook)
+            method->hook(channel_num, tvb, pinfo, 11, args_tree, values);
+        if (method->flags & AMQP_0_9_ACK_REFERENCE)
+            generate_ack_reference(tvb, pinfo, amqp_tree);
+        if (method->flags & AMQP_0_9_MSG_REFERENCE)
+            generate_msg_reference(tvb, pinfo, amqp_tree);
+        amqp_queue_add_sample(tvb, pinfo, amqp_tree);
         break;
     case AMQP_0_9_FRAME_TYPE_CONTENT_HEADER:
         class_id = tvb_get_ntohs(tvb, 7);
@@ -9811,14 +11239,56 @@ dissect_amqp_0_9_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void
                                  tvb, 21, length - 14, ENC_NA);
         prop_tree = proto_item_add_subtree(ti, ett_props);
         col_append_str(pinfo->cinfo, COL_INFO, "Content-Header ");
+        if (!PINFO_FD_VISITED(pinfo)) {
+            amqp_channel_content *content;
+            content = get_channel_content(get_conversation_channel(find_or_create_conversation(pinfo), channel_num), pinfo);
+            content->body_size = tvb_get_ntoh64(tvb, 11);
+            content->body_received = 0;
+            content->body_msg_id = 0;
+            if (content->pending_tap) {
+                content->pending_tap->body_size = content->body_size;
+                p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+                    (guint32)tvb_raw_offset(tvb), content->pending_tap);
+                content->pending_tap = NULL;
+            }
+        }
+        tap_info = (amqp_tap_info_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+            (guint32)tvb_raw_offset(tvb));
+        if (tap_info)
+            tap_queue_packet(amqp_tap, pinfo, tap_info);
+        if (class_id == AMQP_0_9_CLASS_BASIC && amqp_use_frame_summary(pinfo, tree)) {
+            amqp_0_9_frame_summary *summary;
+
+            summary = (amqp_0_9_frame_summary *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+                AMQP_FRAME_SUMMARY_KEY(tvb));
+            if (summary) {
+                if (summary->content_type)
+                    col_append_fstr(pinfo->cinfo, COL_INFO, "type=%s ", summary->content_type);
+                break;
+            }
+        }
         switch (class_id) {
         case AMQP_0_9_CLASS_BASIC: {
-                amqp_channel_t *channel;
-                channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
-                channel->content_params = wmem_new0(wmem_file_scope(), amqp_content_params);
+                amqp_content_params *content_params;
+
+                /* later passes only display the properties */
+                if (PINFO_FD_VISITED(pinfo)) {
+                    content_params = wmem_new0(pinfo->pool, amqp_content_params);
+                } else {
+                    amqp_channel_content *content;
+
+                    content = get_channel_content(get_conversation_channel(find_or_create_conversation(pinfo), channel_num), pinfo);
+                    if (!content->content_params)
+                        content->content_params = wmem_new(wmem_file_scope(), amqp_content_params);
+                    content_params = content->content_params;
+                    content_params->type = NULL;
+                    content_params->encoding = NULL;
+                }
 
                 dissect_amqp_0_9_content_header_basic(tvb,
-                                                      pinfo, 21, prop_tree, channel->content_params);
+                                                      pinfo, 21, prop_tree, content_params);
+                if (!PINFO_FD_VISITED(pinfo) && amqp_cache_frame_summaries)
+                    amqp_0_9_summarize_content_header(tvb, pinfo);
             }
             break;
         case AMQP_0_9_CLASS_FILE:
@@ -9842,29 +11312,271 @@ dissect_amqp_0_9_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void
                             tvb, 7, length, ENC_NA);
         col_append_str(pinfo->cinfo, COL_INFO, "Content-Body ");
 
-        /* try to find disscector for content */
+        dissect_amqp_0_9_content_body(tvb, pinfo, amqp_tree, channel_num, length);
+        break;
+    case AMQP_0_9_FRAME_TYPE_HEARTBEAT:
+        col_append_str(pinfo->cinfo, COL_INFO,
+                       "Heartbeat ");
+        break;
+    default:
+        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %u", frame_type);
+    }
+
+    col_set_fence(pinfo->cinfo, COL_INFO);
+    return tvb_reported_length(tvb);
+}
+
+/* Passes a complete content body to the export object tap */
+static void
+eo_amqp_0_9_body(packet_info *pinfo, const amqp_body_frag *frag, tvbuff_t *body_tvb)
+{
+    amqp_eo_t *eo_info;
+
+    if (!have_tap_listener(amqp_eo_tap))
+        return;
+
+    eo_info = wmem_new0(pinfo->pool, amqp_eo_t);
+    if (frag->msg) {
+        eo_info->exchange = frag->msg->exchange;
+        eo_info->routing_key = frag->msg->routing_key;
+        if (frag->msg->delivery_tag != 0)
+            eo_info->delivery_tag = wmem_strdup_printf(pinfo->pool, "%" G_GUINT64_FORMAT, frag->msg->delivery_tag);
+    }
+    eo_info->content_type = frag->content_type;
+    eo_info->payload_len = tvb_captured_length(body_tvb);
+    eo_info->payload = tvb_get_ptr(body_tvb, 0, eo_info->payload_len);
+    tap_queue_packet(amqp_eo_tap, pinfo, eo_info);
+}
+
+/*
+ * A message body larger than the negotiated frame-max is split over several
+ * content body frames. Collect them into one tvb and hand the whole body to
+ * the media type subdissector once, in the frame that completes it.
+ */
+static void
+dissect_amqp_0_9_content_body(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree,
+    guint16 channel_num, guint length)
+{
+    amqp_body_frag *frag;
+    tvbuff_t       *body_tvb = NULL;
+
+    frag = (amqp_body_frag *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if (!frag) {
+        conversation_t *conv;
         amqp_channel_t *channel;
-        tvbuff_t       *body_tvb;
-        amqp_content_params  *content_params;
+        amqp_channel_content *content;
 
-		channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
-		content_params = channel->content_params;
+        conv = find_or_create_conversation(pinfo);
+        channel = get_conversation_channel(conv, channel_num);
+        if (!channel)
+            return;
+        content = get_channel_content(channel, pinfo);
 
-        if (content_params != NULL && content_params->type != NULL) {
-            body_tvb = tvb_new_subset_length(tvb, 7, length);
-            dissector_try_string(media_type_subdissector_table, content_params->type, body_tvb, pinfo, amqp_tree, NULL);
+        frag = wmem_new0(wmem_file_scope(), amqp_body_frag);
+        if (content->content_params)
+            frag->content_type = content->content_params->type;
+        if (content->routing_key && content->routing_key[0] != '\0')
+            frag->topic = content->routing_key;
+        else
+            frag->topic = content->exchange;
+        frag->whole = content->body_received == 0 && length >= content->body_size;
+        frag->msg = content->msg_tap;
+
+        /* bodies that fit one frame or exceed the limit are not reassembled */
+        if (content->body_received == 0 &&
+            length < content->body_size &&
+            content->body_size <= amqp_max_body_reassembly) {
+            content->body_msg_id = ++channel->conn->body_msg_seq;
+        }
+        if (content->body_msg_id) {
+            frag->msg_id = content->body_msg_id;
+            frag->frag_offset = (guint32)content->body_received;
+            frag->last = content->body_received + length >= content->body_size;
+        }
+        content->body_received += length;
+        if (content->body_received >= content->body_size)
+            content->body_msg_id = 0;
+
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, (guint32)tvb_raw_offset(tvb), frag);
+    }
+
+    if (frag->msg_id) {
+        fragment_head *fd_head;
+        gboolean save_fragmented = pinfo->fragmented;
+
+        /* on later passes this only looks up the completed body */
+        pinfo->fragmented = TRUE;
+        fd_head = fragment_add_check(&amqp_reassembly_table, tvb, 7, pinfo,
+            frag->msg_id, NULL, frag->frag_offset, length, !frag->last);
+        if (frag->last) {
+            body_tvb = process_reassembled_data(tvb, 7, pinfo,
+                "Reassembled AMQP Content Body", fd_head, &amqp_frag_items, NULL, amqp_tree);
+        } else if (fd_head && fd_head->reassembled_in != 0) {
+            proto_item *pi;
+
+            pi = proto_tree_add_uint(amqp_tree, hf_amqp_reassembled_in,
+                tvb, 0, 0, fd_head->reassembled_in);
+            proto_item_set_generated(pi);
         }
-        break;
-    case AMQP_0_9_FRAME_TYPE_HEARTBEAT:
-        col_append_str(pinfo->cinfo, COL_INFO,
-                       "Heartbeat ");
-        break;
-    default:
-        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_unknown_frame_type, "Unknown frame type %u", frame_type);
+        pinfo->fragmented = save_fragmented;
+    } else {
+        body_tvb = tvb_new_subset_length(tvb, 7, length);
     }
 
-    col_set_fence(pinfo->cinfo, COL_INFO);
-    return tvb_reported_length(tvb);
+    if (body_tvb == NULL)
+        return;
+
+    /* bodies that are not reassembled are only exported if they are whole */
+    if (frag->msg_id || frag->whole)
+        eo_amqp_0_9_body(pinfo, frag, body_tvb);
+
+    /* try the message decode table first, then the content type */
+    if (find_data_dissector(body_tvb, pinfo, amqp_tree, frag->topic))
+        return;
+    if (frag->content_type) {
+        dissector_try_string(media_type_subdissector_table, frag->content_type, body_tvb, pinfo, amqp_tree, NULL);
+    }
+}
+
+/* Remembers where the message that the following content frames carry is
+ * routed, for the channel and for the delivery recorded in this frame.
+ * The tap record of the message is completed by the content header. */
+static void
+record_msg_topic(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    amqp_tap_event_t event, const guint8 *exchange, const guint8 *routing_key,
+    const char *queue)
+{
+    amqp_channel_t *channel;
+    amqp_channel_content *content;
+    amqp_delivery *delivery;
+    amqp_tap_info_t *tap;
+
+    if (PINFO_FD_VISITED(pinfo))
+        return;
+
+    channel = get_conversation_channel(find_or_create_conversation(pinfo), channel_num);
+    if (!channel)
+        return;
+    content = get_channel_content(channel, pinfo);
+    content->exchange = wmem_strdup(wmem_file_scope(), (const char *)exchange);
+    content->routing_key = wmem_strdup(wmem_file_scope(), (const char *)routing_key);
+
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if (delivery) {
+        delivery->exchange = content->exchange;
+        delivery->routing_key = content->routing_key;
+        delivery->queue = queue;
+        delivery->published = event == AMQP_TAP_PUBLISH;
+    }
+
+    tap = wmem_new0(wmem_file_scope(), amqp_tap_info_t);
+    tap->version = AMQP_V0_9;
+    tap->event = event;
+    tap->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    tap->channel = channel_num;
+    tap->exchange = content->exchange;
+    tap->routing_key = content->routing_key;
+    tap->queue = queue;
+    if (delivery)
+        tap->delivery_tag = delivery->delivery_tag;
+    tap->state_size = amqp_tap_state_size(pinfo);
+    amqp_tap_add_queues(tvb, pinfo, tap);
+    content->pending_tap = tap;
+    content->msg_tap = tap;
+}
+
+/* Notes whether the delivery of this frame counts in the unacked messages
+ * of its queue, so that settling or evicting it takes it out again */
+static void
+record_msg_queue_unacked(tvbuff_t *tvb, packet_info *pinfo, gboolean unacked)
+{
+    amqp_delivery *delivery;
+
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    if (delivery)
+        delivery->queue_unacked = unacked;
+}
+
+/* Remembers the queue a consumer reads from. basic.consume gives the queue
+ * and possibly an empty tag, basic.consume-ok the tag chosen by the broker
+ * and basic.get only the queue. no_ack goes with the queue. */
+static void
+record_consumer(packet_info *pinfo, guint16 channel_num,
+    const guint8 *queue, const guint8 *consumer_tag, gboolean no_ack)
+{
+    conversation_t *conv;
+    amqp_conv *conn;
+    amqp_channel_t *channel;
+
+    conv = find_or_create_conversation(pinfo);
+    conn = (amqp_conv *)conversation_get_proto_data(conv, proto_amqp);
+    channel = get_conversation_channel(conv, channel_num);
+    if (!channel)
+        return;
+
+    if (queue) {
+        channel->queue = wmem_strdup(wmem_file_scope(), (const char *)queue);
+        channel->no_ack = no_ack;
+    }
+    if (consumer_tag && *consumer_tag && channel->queue) {
+        char *tag = wmem_strdup(wmem_file_scope(), (const char *)consumer_tag);
+
+        wmem_map_insert(conn->consumers, tag, channel->queue);
+        if (channel->no_ack)
+            wmem_map_insert(conn->auto_ack, tag, tag);
+        else
+            wmem_map_remove(conn->auto_ack, tag);
+    }
+}
+
+/* Reports an ack, nack or reject to the tap, together with the deliveries
+ * it settled */
+static void
+tap_amqp_0_9_settled(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
+    amqp_tap_event_t event, guint64 delivery_tag, gboolean multiple)
+{
+    amqp_tap_info_t *tap;
+    amqp_tap_settled_t *settled;
+    amqp_delivery *first_acked;
+    amqp_delivery *delivery;
+    guint count = 0;
+    guint i;
+
+    if (!have_tap_listener(amqp_tap))
+        return;
+
+    first_acked = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb));
+    for (delivery = first_acked; delivery != NULL; delivery = delivery->prev)
+        count++;
+
+    settled = wmem_alloc_array(pinfo->pool, amqp_tap_settled_t, count);
+    for (i = 0, delivery = first_acked; delivery != NULL; i++, delivery = delivery->prev) {
+        settled[i].delivery_tag = delivery->delivery_tag;
+        settled[i].msg_framenum = delivery->msg_framenum;
+        nstime_delta(&settled[i].latency, &pinfo->abs_ts, &delivery->msg_time);
+        settled[i].exchange = delivery->exchange;
+        settled[i].routing_key = delivery->routing_key;
+        settled[i].queue = delivery->queue;
+        settled[i].confirm = delivery->published;
+    }
+
+    tap = wmem_new0(pinfo->pool, amqp_tap_info_t);
+    tap->version = AMQP_V0_9;
+    tap->event = event;
+    tap->stream = get_tcp_conversation_data(NULL, pinfo)->stream;
+    tap->channel = channel_num;
+    tap->delivery_tag = delivery_tag;
+    tap->multiple = multiple;
+    tap->settled = TRUE;
+    tap->settled_count = count;
+    tap->settled_msgs = settled;
+    tap->state_size = amqp_tap_state_size(pinfo);
+    amqp_tap_add_queues(tvb, pinfo, tap);
+    tap_queue_packet(amqp_tap, pinfo, tap);
 }
 
 static amqp_channel_t*
@@ -9890,6 +11602,16 @@ get_conversation_channel(conversation_t *conv, guint16 channel_num)
     return channel;
 }
 
+/* Content state of the direction the current frame is sent in */
+static amqp_channel_content*
+get_channel_content(amqp_channel_t *channel, packet_info *pinfo)
+{
+    struct tcp_analysis *tcpd;
+
+    tcpd = get_tcp_conversation_data(NULL, pinfo);
+    return tcpd->fwd == &(tcpd->flow1) ? &channel->content1 : &channel->content2;
+}
+
 static void
 record_msg_delivery(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
     guint64 delivery_tag)
@@ -9902,26 +11624,174 @@ record_msg_delivery(tvbuff_t *tvb, packet_info *pinfo, guint16 channel_num,
     record_msg_delivery_c(conv, channel, tvb, pinfo, delivery_tag);
 }
 
+static amqp_delivery *
+delivery_window_get(amqp_delivery_window *window, guint idx)
+{
+    return *(amqp_delivery **)wmem_array_index(window->deliveries, idx);
+}
+
+/* Returns the index of the first delivery in [head, count) whose tag is not
+ * less than delivery_tag, or count if there is none. */
+static guint
+delivery_window_lower_bound(amqp_delivery_window *window, guint64 delivery_tag)
+{
+    guint lo = window->head;
+    guint hi = wmem_array_get_count(window->deliveries);
+
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (delivery_window_get(window, mid)->delivery_tag < delivery_tag)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Moves the head of a window past the deliveries acked out of order, and
+ * drops the acked deliveries from the array once they make up most of it.
+ * They are still referenced by the frames they were acked in. */
+static void
+delivery_window_advance(amqp_conv *conn, amqp_delivery_window *window)
+{
+    guint count = wmem_array_get_count(window->deliveries);
+    wmem_array_t *deliveries;
+
+    while (window->head < count && delivery_window_get(window, window->head)->ack_framenum)
+        window->head++;
+
+    if (window->head < 64 || window->head < count / 2)
+        return;
+    deliveries = wmem_array_sized_new(wmem_file_scope(), sizeof(amqp_delivery *), count - window->head);
+    if (window->head < count)
+        wmem_array_append(deliveries, wmem_array_index(window->deliveries, window->head),
+            count - window->head);
+    wmem_destroy_array(window->deliveries);
+    window->deliveries = deliveries;
+    conn->window_slots -= window->head;
+    window->head = 0;
+}
+
+/* Forgets all deliveries of a window, returns the number of unacked ones.
+ * The broker requeues those, so they are ready again in their queues. */
+static guint64
+delivery_window_release(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn,
+    amqp_delivery_window *window)
+{
+    guint64 unacked = 0;
+    guint count;
+    guint idx;
+    amqp_delivery *delivery;
+
+    if (window->deliveries == NULL)
+        return 0;
+
+    count = wmem_array_get_count(window->deliveries);
+    for (idx = window->head; idx < count; idx++) {
+        delivery = delivery_window_get(window, idx);
+        if (delivery->ack_framenum)
+            continue;
+        unacked++;
+        if (delivery->queue_unacked)
+            amqp_queue_update(tvb, pinfo, delivery->queue, 1, -1);
+    }
+    conn->unacked -= unacked;
+    conn->window_slots -= count;
+    wmem_destroy_array(window->deliveries);
+    window->deliveries = NULL;
+    window->head = 0;
+    return unacked;
+}
+
+typedef struct {
+    amqp_delivery_window *window;
+    guint32 msg_framenum;
+} amqp_oldest_delivery;
+
+static void
+find_oldest_delivery(gpointer key _U_, gpointer value, gpointer user_data)
+{
+    amqp_channel_t *channel = (amqp_channel_t *)value;
+    amqp_oldest_delivery *oldest = (amqp_oldest_delivery *)user_data;
+    amqp_delivery_window *windows[2] = { &channel->unacked1, &channel->unacked2 };
+    amqp_delivery *delivery;
+    guint i;
+
+    for (i = 0; i < 2; i++) {
+        if (windows[i]->deliveries == NULL ||
+            windows[i]->head >= wmem_array_get_count(windows[i]->deliveries))
+            continue;
+        /* the head of a window is never acked */
+        delivery = delivery_window_get(windows[i], windows[i]->head);
+        if (!oldest->window || delivery->msg_framenum < oldest->msg_framenum) {
+            oldest->window = windows[i];
+            oldest->msg_framenum = delivery->msg_framenum;
+        }
+    }
+}
+
+/* Stops tracking the oldest unacked delivery of the connection, on any
+ * channel, to stay within amqp_max_unacked_deliveries. An ack for it will
+ * not be matched, so it no longer counts as unacked in its queue either. */
+static gboolean
+evict_oldest_delivery(tvbuff_t *tvb, packet_info *pinfo, amqp_conv *conn)
+{
+    amqp_oldest_delivery oldest = { NULL, 0 };
+    amqp_delivery *delivery;
+
+    wmem_map_foreach(conn->channels, find_oldest_delivery, &oldest);
+    if (!oldest.window)
+        return FALSE;
+
+    delivery = delivery_window_get(oldest.window, oldest.window->head);
+    if (delivery->queue_unacked)
+        amqp_queue_update(tvb, pinfo, delivery->queue, 0, -1);
+    oldest.window->head++;
+    conn->unacked--;
+    delivery_window_advance(conn, oldest.window);
+    return TRUE;
+}
+
 static void
 record_msg_delivery_c(conversation_t *conv, amqp_channel_t *channel,
     tvbuff_t *tvb, packet_info *pinfo, guint64 delivery_tag)
 {
     struct tcp_analysis *tcpd;
-    amqp_delivery **dptr;
+    amqp_conv *conn = channel->conn;
+    amqp_delivery_window *window;
     amqp_delivery *delivery;
+    guint count;
 
     tcpd = get_tcp_conversation_data(conv, pinfo);
     /* separate messages sent in each direction */
-    dptr = tcpd->fwd == &(tcpd->flow1) ? &channel->last_delivery1 : &channel->last_delivery2;
+    window = tcpd->fwd == &(tcpd->flow1) ? &channel->unacked1 : &channel->unacked2;
+
+    /* delivery tags only grow within a channel; a smaller tag means the
+     * channel was reopened and the outstanding deliveries are gone */
+    if (window->deliveries != NULL) {
+        count = wmem_array_get_count(window->deliveries);
+        if (count > 0 && delivery_window_get(window, count - 1)->delivery_tag >= delivery_tag)
+            delivery_window_release(tvb, pinfo, conn, window);
+    }
+    if (window->deliveries == NULL)
+        window->deliveries = wmem_array_new(wmem_file_scope(), sizeof(amqp_delivery *));
 
     delivery = wmem_new0(wmem_file_scope(), amqp_delivery);
     delivery->delivery_tag = delivery_tag;
     delivery->msg_framenum = pinfo->num;
-    /* append to the list of unacked deliveries */
-    delivery->prev = (*dptr);
-    (*dptr) = delivery;
+    delivery->msg_time = pinfo->abs_ts;
 
-    p_add_proto_data(pinfo->pool, pinfo, proto_amqp, (guint32)tvb_raw_offset(tvb), delivery);
+    /* append to the window of unacked deliveries */
+    wmem_array_append_one(window->deliveries, delivery);
+    conn->unacked++;
+    conn->window_slots++;
+
+    while (amqp_max_unacked_deliveries && conn->unacked > amqp_max_unacked_deliveries &&
+           evict_oldest_delivery(tvb, pinfo, conn))
+        delivery->evicted++;
+
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp, (guint32)tvb_raw_offset(tvb), delivery);
 }
 
 static void
@@ -9941,35 +11811,65 @@ record_delivery_ack_c(conversation_t *conv, amqp_channel_t *channel,
     tvbuff_t *tvb, packet_info *pinfo, guint64 delivery_tag, gboolean multiple)
 {
     struct tcp_analysis *tcpd;
-    amqp_delivery **dptr;
+    amqp_delivery_window *window;
+    amqp_delivery *first_acked = NULL;
     amqp_delivery *last_acked = NULL;
+    amqp_delivery *delivery;
+    guint count;
+    guint idx;
 
     tcpd = get_tcp_conversation_data(conv, pinfo);
     /* the basic.ack may be sent in both directions, but always opposite
      * to the basic.publish or basic.deliver */
-    dptr = tcpd->rev == &(tcpd->flow1) ? &channel->last_delivery1 : &channel->last_delivery2;
-    while(*dptr)
+    window = tcpd->rev == &(tcpd->flow1) ? &channel->unacked1 : &channel->unacked2;
+    if (window->deliveries == NULL)
+        return;
+
+    count = wmem_array_get_count(window->deliveries);
+    if (multiple)
+    {
+        /* acknowledge everything up to and including delivery_tag; the
+         * tag zero stands for all outstanding messages */
+        for (idx = window->head; idx < count; idx++)
+        {
+            delivery = delivery_window_get(window, idx);
+            if (delivery_tag != 0 && delivery->delivery_tag > delivery_tag)
+                break;
+            if (delivery->ack_framenum)
+                continue;
+
+            delivery->ack_framenum = pinfo->num;
+            channel->conn->unacked--;
+            /* append to the list of acked deliveries */
+            if (last_acked)
+                last_acked->prev = delivery;
+            else
+                first_acked = delivery;
+            last_acked = delivery;
+        }
+        window->head = idx;
+    }
+    else
     {
-        if((*dptr)->delivery_tag == delivery_tag)
+        idx = delivery_window_lower_bound(window, delivery_tag);
+        if (idx < count)
         {
-            do
+            delivery = delivery_window_get(window, idx);
+            if (delivery->delivery_tag == delivery_tag && !delivery->ack_framenum)
             {
-                amqp_delivery *delivery = (*dptr);
-                *dptr = delivery->prev; /* remove from the list of unacked */
-
                 delivery->ack_framenum = pinfo->num;
-                /* append to the list of acked deliveries */
-                delivery->prev = last_acked;
-                last_acked = delivery;
+                channel->conn->unacked--;
+                first_acked = last_acked = delivery;
             }
-            while(multiple && *dptr);
         }
-        else
-            dptr = &(*dptr)->prev; /* goto next */
     }
+    if (last_acked)
+        last_acked->prev = NULL;
+    /* skip over deliveries acked out of order */
+    delivery_window_advance(channel->conn, window);
 
-    p_add_proto_data(pinfo->pool, pinfo, proto_amqp,
-        (guint32)tvb_raw_offset(tvb), last_acked);
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_amqp,
+        (guint32)tvb_raw_offset(tvb), first_acked);
 }
 
 static void
@@ -9977,8 +11877,9 @@ generate_msg_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree)
 {
     amqp_delivery *delivery;
     proto_item *pi;
+    nstime_t delta;
 
-    delivery = (amqp_delivery *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp,
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
         (guint32)tvb_raw_offset(tvb));
     while(delivery != NULL)
     {
@@ -9987,6 +11888,10 @@ generate_msg_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree)
             pi = proto_tree_add_uint(amqp_tree, hf_amqp_message_in,
                 tvb, 0, 0, delivery->msg_framenum);
             proto_item_set_generated(pi);
+
+            nstime_delta(&delta, &pinfo->abs_ts, &delivery->msg_time);
+            pi = proto_tree_add_time(amqp_tree, hf_amqp_ack_time, tvb, 0, 0, &delta);
+            proto_item_set_generated(pi);
         }
 
         delivery = delivery->prev;
@@ -9998,7 +11903,7 @@ generate_ack_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree)
 {
     amqp_delivery *delivery;
 
-    delivery = (amqp_delivery *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp,
+    delivery = (amqp_delivery *)p_get_proto_data(wmem_file_scope(), pinfo, proto_amqp,
         (guint32)tvb_raw_offset(tvb));
     if(delivery && delivery->ack_framenum)
     {
@@ -10007,7 +11912,13 @@ generate_ack_reference(tvbuff_t *tvb, packet_info *pinfo, proto_tree *amqp_tree)
         pi = proto_tree_add_uint(amqp_tree, hf_amqp_ack_in, tvb, 0, 0, delivery->ack_framenum);
         proto_item_set_generated(pi);
     }
-
+    if(delivery && delivery->evicted)
+    {
+        expert_add_info_format(pinfo, amqp_tree, &ei_amqp_deliveries_untracked,
+                               "%u older unacked deliveries are no longer tracked, "
+                               "more than %u are unacked on the connection",
+                               delivery->evicted, amqp_max_unacked_deliveries);
+    }
 }
 
 /*  AMQP 1.0 Type Decoders  */
@@ -10318,62 +12229,24 @@ dissect_amqp_1_0_fixed(tvbuff_t *tvb, packet_info *pinfo _U_,
 }
 
 
-static void find_data_dissector(tvbuff_t *msg_tvb, packet_info *pinfo, proto_tree *item){
-    amqp_message_decode_t *message_decode_entry = NULL;
-    size_t topic_str_len = strlen("_telemetry/broker/trace/receive/v1");
-    size_t topic_pattern_len;
-    gboolean match_found = FALSE;
-
-    for (guint i = 0; i < num_amqp_message_decodes && !match_found; i++){
-    message_decode_entry = &amqp_message_decodes[i];
-    switch (message_decode_entry->match_criteria){
-      case MATCH_CRITERIA_EQUAL:
-        match_found = (strcmp("_telemetry/broker/trace/receive/v1", message_decode_entry->topic_pattern) == 0);
-        break;
-      case MATCH_CRITERIA_CONTAINS:
-
-        match_found = (strstr("_telemetry/broker/trace/receive/v1", message_decode_entry->topic_pattern) != NULL);
-        break;
-      case MATCH_CRITERIA_STARTS_WITH:
-
-        topic_pattern_len = strlen(message_decode_entry->topic_pattern);
-        match_found = ((topic_str_len >= topic_pattern_len) &&
-                       (strncmp("_telemetry/broker/trace/receive/v1", message_decode_entry->topic_pattern, topic_pattern_len) == 0));
-        break;
-
-      case MATCH_CRITERIA_ENDS_WITH:
-        topic_pattern_len = strlen(message_decode_entry->topic_pattern);
-        match_found = ((topic_str_len >= topic_pattern_len) &&
-                       (strcmp("_telemetry/broker/trace/receive/v1" + (topic_str_len - topic_pattern_len), message_decode_entry->topic_pattern) == 0));
-        break;
-
-      case MATCH_CRITERIA_REGEX:
-        if (message_decode_entry->topic_regex){
-          GMatchInfo *match_info = NULL;
-          /* DISSECTOR_ASSERT(g_utf8_validate(topic_str, -1, NULL)); */
-          g_regex_match(message_decode_entry->topic_regex, "_telemetry/broker/trace/receive/v1", (GRegexMatchFlags) 0, &match_info);
-          match_found = g_match_info_matches(match_info);
-          g_match_info_free(match_info);
-        }
-        break;
-      default:
-        /* Unknown match criteria */
-        break;
-    }
-
+/* Passes a message body to the protocol configured in the message decode
+ * table for its topic. Returns FALSE if no entry matches. */
+static gboolean
+find_data_dissector(tvbuff_t *msg_tvb, packet_info *pinfo, proto_tree *item, const char *topic)
+{
+    amqp_message_decode_t *message_decode_entry;
 
-    if (match_found){
-        //message_decode_entry->topic_more_info
-        //call_dissector_only(message_decode_entry->payload_proto, msg_tvb, pinfo, item, "message,solace.messaging.proto.broker.trace.receive.v1.SpanData");
-        //call_dissector(message_decode_entry->payload_proto, msg_tvb, pinfo, item);
-        call_dissector_only(message_decode_entry->payload_proto, msg_tvb, pinfo, item , message_decode_entry->topic_more_info);
-        
-    }
-  }
-  
-    
+    message_decode_entry = find_message_decode(topic);
+    if (message_decode_entry == NULL || message_decode_entry->payload_proto == NULL)
+        return FALSE;
 
+    if (message_decode_entry->protobuf_type)
+        return call_dissector_only(protobuf_message_type_handle, msg_tvb, pinfo, item,
+            message_decode_entry->protobuf_type) > 0;
+    call_dissector_only(message_decode_entry->payload_proto, msg_tvb, pinfo, item, message_decode_entry->topic_more_info);
+    return TRUE;
 }
+
 static int
 dissect_amqp_1_0_variable(tvbuff_t *tvb, packet_info *pinfo,
                           guint offset, guint length,
@@ -10396,7 +12269,21 @@ dissect_amqp_1_0_variable(tvbuff_t *tvb, packet_info *pinfo,
 
     if (hf_amqp_type == hf_amqp_1_0_data){
         tvbuff_t *msg_tvb = tvb_new_subset_length_caplen(tvb, offset, bin_length, bin_length);
-        find_data_dissector(msg_tvb, pinfo, item);
+        find_data_dissector(msg_tvb, pinfo, item,
+            (const char *)p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC));
+    }
+    else if (hf_amqp_type == hf_amqp_1_0_to_str ||
+             (hf_amqp_type == hf_amqp_1_0_subject &&
+              !p_get_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC))) {
+        /* the message address is the topic, or else its subject */
+        const guint8 *str = tvb_get_string_enc(pinfo->pool, tvb, offset, bin_length, ENC_UTF_8);
+
+        p_remove_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC);
+        p_add_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TOPIC, (void *)str);
+        if (hf_amqp_type == hf_amqp_1_0_to_str) {
+            p_remove_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TO);
+            p_add_proto_data(pinfo->pool, pinfo, proto_amqp, AMQP_PACKET_DATA_TO, (void *)str);
+        }
     }
     proto_tree_add_item(item, hf_amqp_type, tvb, offset, bin_length, ENC_NA);
     return length+bin_length;
@@ -10918,6 +12805,9 @@ dissect_amqp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data)
 {
     conversation_t *conv;
     amqp_conv *conn;
+    proto_item *ti;
+    tvbuff_t *next_tvb;
+    guint skip;
     //gboolean    msg_handled = FALSE;
 
     col_set_str(pinfo->cinfo, COL_PROTOCOL, "AMQP");
@@ -10936,25 +12826,306 @@ dissect_amqp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data)
     if (conn == NULL) {
         conn = wmem_new0(wmem_file_scope(), amqp_conv);
         conn->channels = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+        conn->links_1_0 = wmem_map_new(wmem_file_scope(), g_int64_hash, g_int64_equal);
+        conn->sessions_1_0 = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+        conn->sessions_0_10 = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+        conn->consumers = wmem_map_new(wmem_file_scope(), g_str_hash, g_str_equal);
+        conn->auto_ack = wmem_map_new(wmem_file_scope(), g_str_hash, g_str_equal);
+        conn->resyncs = wmem_tree_new(wmem_file_scope());
         conversation_add_proto_data(conv, proto_amqp, conn);
     }
-    check_amqp_version(tvb, conn);
+
+    skip = amqp_resync(tvb, pinfo, conn, amqp_1_0_direction(get_tcp_conversation_data(conv, pinfo)));
+    if (skip > 0) {
+        col_append_str(pinfo->cinfo, COL_INFO, "[Continuation] ");
+        ti = proto_tree_add_item(tree, proto_amqp, tvb, 0, skip, ENC_NA);
+        proto_tree_add_item(proto_item_add_subtree(ti, ett_amqp),
+            hf_amqp_continuation_data, tvb, 0, skip, ENC_NA);
+        expert_add_info(pinfo, ti, &ei_amqp_resync);
+        if (skip >= tvb_captured_length(tvb))
+            return tvb_captured_length(tvb);
+    }
+    next_tvb = tvb_new_subset_remaining(tvb, skip);
+
+    check_amqp_version(next_tvb, conn);
     /* Restore can_desegment to whatever TCP set it to before calling the
      * subdissector (which will decrement it a second time) in order for
      * tcp_dissect_pdus() to work as expected.
      */
     pinfo->can_desegment = pinfo->saved_can_desegment;
-    if (!dissector_try_uint_new(version_table, conn->version, tvb, pinfo, tree, FALSE, data))
+    if (!dissector_try_uint_new(version_table, conn->version, next_tvb, pinfo, tree, FALSE, data))
     {
         col_append_str(pinfo->cinfo, COL_INFO, "AMQP (unknown version)");
         col_set_fence(pinfo->cinfo, COL_INFO);
     }
+    /* tcp_dissect_pdus asks for more data relative to the frames */
+    if (pinfo->desegment_len)
+        pinfo->desegment_offset += skip;
 
 
 
     return tvb_captured_length(tvb);
 }
 
+/* AMQP/Messages stats tree */
+
+static const gchar *st_str_amqp_msgs = "AMQP Messages";
+static const gchar *st_str_amqp_published = "Published by Exchange";
+static const gchar *st_str_amqp_delivered = "Delivered by Queue";
+static const gchar *st_str_amqp_returned = "Returned by Exchange";
+static const gchar *st_str_amqp_acked = "Acked";
+static const gchar *st_str_amqp_nacked = "Nacked";
+static const gchar *st_str_amqp_rejected = "Rejected";
+static const gchar *st_str_amqp_latency = "Ack Latency (ms)";
+static const gchar *st_str_amqp_confirm_latency = "Publisher Confirms by Exchange";
+static const gchar *st_str_amqp_consumer_latency = "Consumer Acks by Queue";
+static const gchar *st_str_amqp_state = "Connection State (bytes)";
+
+static int st_node_amqp_msgs = -1;
+static int st_node_amqp_published = -1;
+static int st_node_amqp_delivered = -1;
+static int st_node_amqp_returned = -1;
+static int st_node_amqp_acked = -1;
+static int st_node_amqp_nacked = -1;
+static int st_node_amqp_rejected = -1;
+static int st_node_amqp_latency = -1;
+static int st_node_amqp_confirm_latency = -1;
+static int st_node_amqp_consumer_latency = -1;
+static int st_node_amqp_state = -1;
+
+static void
+amqp_stats_tree_init(stats_tree *st)
+{
+    st_node_amqp_msgs = stats_tree_create_node(st, st_str_amqp_msgs, 0, STAT_DT_INT, TRUE);
+    st_node_amqp_published = stats_tree_create_node(st, st_str_amqp_published, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_delivered = stats_tree_create_node(st, st_str_amqp_delivered, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_returned = stats_tree_create_node(st, st_str_amqp_returned, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_acked = stats_tree_create_node(st, st_str_amqp_acked, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_nacked = stats_tree_create_node(st, st_str_amqp_nacked, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_rejected = stats_tree_create_node(st, st_str_amqp_rejected, st_node_amqp_msgs, STAT_DT_INT, TRUE);
+    st_node_amqp_latency = stats_tree_create_node(st, st_str_amqp_latency, 0, STAT_DT_FLOAT, TRUE);
+    st_node_amqp_confirm_latency = stats_tree_create_node(st, st_str_amqp_confirm_latency, st_node_amqp_latency, STAT_DT_FLOAT, TRUE);
+    st_node_amqp_consumer_latency = stats_tree_create_node(st, st_str_amqp_consumer_latency, st_node_amqp_latency, STAT_DT_FLOAT, TRUE);
+    st_node_amqp_state = stats_tree_create_node(st, st_str_amqp_state, 0, STAT_DT_INT, FALSE);
+}
+
+static const gchar *
+amqp_stats_name(const gchar *name, const gchar *unknown)
+{
+    return (name && *name) ? name : unknown;
+}
+
+static void
+amqp_stats_tick_settled(stats_tree *st, const gchar *str_node, int node,
+    const amqp_tap_info_t *v)
+{
+    const gchar *queue;
+    guint i;
+
+    if (v->settled_count == 0) {
+        /* AMQP 1.0, or the acked deliveries were not captured */
+        tick_stat_node(st, st_str_amqp_msgs, 0, FALSE);
+        tick_stat_node(st, str_node, st_node_amqp_msgs, TRUE);
+        return;
+    }
+
+    for (i = 0; i < v->settled_count; i++) {
+        const amqp_tap_settled_t *msg = &v->settled_msgs[i];
+        gfloat latency = (gfloat)(msg->latency.secs*1000. + msg->latency.nsecs/1000000.0);
+
+        tick_stat_node(st, st_str_amqp_msgs, 0, FALSE);
+        tick_stat_node(st, str_node, st_node_amqp_msgs, TRUE);
+        if (msg->confirm) {
+            /* the broker confirmed a published message */
+            queue = amqp_stats_name(msg->exchange, "(default exchange)");
+            tick_stat_node(st, queue, node, FALSE);
+            avg_stat_node_add_value_float(st, st_str_amqp_latency, 0, TRUE, latency);
+            avg_stat_node_add_value_float(st, st_str_amqp_confirm_latency, st_node_amqp_latency, TRUE, latency);
+            avg_stat_node_add_value_float(st, queue, st_node_amqp_confirm_latency, FALSE, latency);
+        } else {
+            queue = amqp_stats_name(msg->queue, amqp_stats_name(msg->routing_key, "(unknown)"));
+            tick_stat_node(st, queue, node, FALSE);
+            avg_stat_node_add_value_float(st, st_str_amqp_latency, 0, TRUE, latency);
+            avg_stat_node_add_value_float(st, st_str_amqp_consumer_latency, st_node_amqp_latency, TRUE, latency);
+            avg_stat_node_add_value_float(st, queue, st_node_amqp_consumer_latency, FALSE, latency);
+        }
+    }
+}
+
+static tap_packet_status
+amqp_stats_tree_packet(stats_tree *st, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *p)
+{
+    const amqp_tap_info_t *v = (const amqp_tap_info_t *)p;
+    int node;
+
+    /* the maximum is the peak memory of the connection state */
+    if (v->state_size)
+        avg_stat_node_add_value_int(st, st_str_amqp_state, 0, FALSE, (gint)MIN(v->state_size, G_MAXINT));
+
+    switch (v->event) {
+    case AMQP_TAP_PUBLISH:
+        tick_stat_node(st, st_str_amqp_msgs, 0, FALSE);
+        tick_stat_node(st, st_str_amqp_published, st_node_amqp_msgs, TRUE);
+        if (v->version == AMQP_V1_0) {
+            /* AMQP 1.0 has no exchanges, only addresses */
+            tick_stat_node(st, amqp_stats_name(v->routing_key, "(no address)"), st_node_amqp_published, FALSE);
+        } else {
+            node = tick_stat_node(st, amqp_stats_name(v->exchange, "(default exchange)"), st_node_amqp_published, TRUE);
+            tick_stat_node(st, amqp_stats_name(v->routing_key, "(no routing key)"), node, FALSE);
+        }
+        break;
+    case AMQP_TAP_DELIVER:
+        tick_stat_node(st, st_str_amqp_msgs, 0, FALSE);
+        tick_stat_node(st, st_str_amqp_delivered, st_node_amqp_msgs, TRUE);
+        tick_stat_node(st, amqp_stats_name(v->queue, amqp_stats_name(v->routing_key, "(unknown)")),
+                       st_node_amqp_delivered, FALSE);
+        break;
+    case AMQP_TAP_RETURN:
+        tick_stat_node(st, st_str_amqp_msgs, 0, FALSE);
+        tick_stat_node(st, st_str_amqp_returned, st_node_amqp_msgs, TRUE);
+        node = tick_stat_node(st, amqp_stats_name(v->exchange, "(default exchange)"), st_node_amqp_returned, TRUE);
+        tick_stat_node(st, amqp_stats_name(v->routing_key, "(no routing key)"), node, FALSE);
+        break;
+    case AMQP_TAP_ACK:
+        amqp_stats_tick_settled(st, st_str_amqp_acked, st_node_amqp_acked, v);
+        break;
+    case AMQP_TAP_NACK:
+        amqp_stats_tick_settled(st, st_str_amqp_nacked, st_node_amqp_nacked, v);
+        break;
+    case AMQP_TAP_REJECT:
+        amqp_stats_tick_settled(st, st_str_amqp_rejected, st_node_amqp_rejected, v);
+        break;
+    default:
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    return TAP_PACKET_REDRAW;
+}
+
+/* AMQP ack latency RTD table */
+
+enum {
+    AMQP_RTD_OVERALL,
+    AMQP_RTD_CONFIRM,
+    AMQP_RTD_CONSUMER,
+    AMQP_RTD_NUM_TIMESTATS
+};
+
+static const value_string amqp_rtd_types[] = {
+    { AMQP_RTD_OVERALL,  "Overall" },
+    { AMQP_RTD_CONFIRM,  "Publisher Confirm" },
+    { AMQP_RTD_CONSUMER, "Consumer Ack" },
+    { 0, NULL }
+};
+
+static tap_packet_status
+amqpstat_packet(void *pas, packet_info *pinfo, epan_dissect_t *edt _U_, const void *pai)
+{
+    rtd_data_t *rtd_data = (rtd_data_t *)pas;
+    rtd_stat_table *as = &rtd_data->stat_table;
+    const amqp_tap_info_t *ai = (const amqp_tap_info_t *)pai;
+    guint i;
+
+    switch (ai->event) {
+    case AMQP_TAP_ACK:
+    case AMQP_TAP_NACK:
+    case AMQP_TAP_REJECT:
+        break;
+    default:
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    if (ai->version == AMQP_V0_9 && ai->settled_count == 0) {
+        /* no unacked message was seen */
+        as->time_stats[AMQP_RTD_OVERALL].disc_rsp_num++;
+        return TAP_PACKET_REDRAW;
+    }
+
+    for (i = 0; i < ai->settled_count; i++) {
+        const amqp_tap_settled_t *msg = &ai->settled_msgs[i];
+        int amqp_cat = msg->confirm ? AMQP_RTD_CONFIRM : AMQP_RTD_CONSUMER;
+
+        time_stat_update(&(as->time_stats[AMQP_RTD_OVERALL].rtd[0]), &msg->latency, pinfo);
+        time_stat_update(&(as->time_stats[amqp_cat].rtd[0]), &msg->latency, pinfo);
+    }
+
+    return TAP_PACKET_REDRAW;
+}
+
+/* AMQP 0-10 command completion SRT table, one row per class and command */
+
+#define AMQP_0_10_SRT_METHODS       16
+#define AMQP_0_10_SRT_NUM_PROCS     ((AMQP_0_10_CLASS_STREAM + 1) * AMQP_0_10_SRT_METHODS)
+
+static void
+amqpstat_srt_init(struct register_srt* srt _U_, GArray* srt_array)
+{
+    srt_stat_table *amqp_srt_table;
+    guint8 amqp_class;
+    guint8 method;
+
+    amqp_srt_table = init_srt_table("AMQP 0-10 Commands", NULL, srt_array, AMQP_0_10_SRT_NUM_PROCS, NULL, NULL, NULL);
+    for (amqp_class = 0; amqp_class <= AMQP_0_10_CLASS_STREAM; amqp_class++) {
+        for (method = 0; method < AMQP_0_10_SRT_METHODS; method++) {
+            init_srt_table_row(amqp_srt_table, amqp_class * AMQP_0_10_SRT_METHODS + method,
+                amqp_0_10_method_name(amqp_class, method));
+        }
+    }
+}
+
+static tap_packet_status
+amqpstat_srt_packet(void *pss, packet_info *pinfo, epan_dissect_t *edt _U_, const void *prv)
+{
+    srt_data_t *data = (srt_data_t *)pss;
+    srt_stat_table *amqp_srt_table;
+    const amqp_srt_info_t *srt = (const amqp_srt_info_t *)prv;
+    guint i;
+
+    amqp_srt_table = g_array_index(data->srt_array, srt_stat_table*, 0);
+
+    for (i = 0; i < srt->command_count; i++) {
+        const amqp_tap_command_t *command = &srt->commands[i];
+
+        if (command->amqp_class > AMQP_0_10_CLASS_STREAM || command->method >= AMQP_0_10_SRT_METHODS)
+            continue;
+        add_srt_table_data(amqp_srt_table, command->amqp_class * AMQP_0_10_SRT_METHODS + command->method,
+            &command->command_time, pinfo);
+    }
+
+    return TAP_PACKET_REDRAW;
+}
+
+static tap_packet_status
+amqp_eo_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    export_object_list_t *object_list = (export_object_list_t *)tapdata;
+    const amqp_eo_t *eo_info = (const amqp_eo_t *)data;
+    export_object_entry_t *entry;
+    const char *name;
+
+    if (!eo_info)
+        return TAP_PACKET_DONT_REDRAW;
+
+    /* named after the routing key, frame and delivery tag, so that the
+     * names are mostly unique among millions of messages */
+    name = eo_info->routing_key && eo_info->routing_key[0] != '\0' ? eo_info->routing_key : "message";
+
+    entry = g_new(export_object_entry_t, 1);
+    entry->pkt_num = pinfo->num;
+    entry->hostname = g_strdup(eo_info->exchange);
+    entry->content_type = g_strdup(eo_info->content_type);
+    if (eo_info->delivery_tag)
+        entry->filename = g_strdup_printf("%s-%u-%s", name, pinfo->num, eo_info->delivery_tag);
+    else
+        entry->filename = g_strdup_printf("%s-%u", name, pinfo->num);
+    entry->payload_len = eo_info->payload_len;
+    entry->payload_data = (guint8 *)g_memdup2(eo_info->payload, eo_info->payload_len);
+
+    object_list->add_entry(object_list->gui_data, entry);
+
+    return TAP_PACKET_REDRAW;
+}
+
 /*  Basic registration functions  */
 
 void
@@ -13278,6 +15449,10 @@ proto_register_amqp(void)
             "(timestamp)", "amqp.field.timestamp",
             FT_ABSOLUTE_TIME, ABSOLUTE_TIME_UTC, NULL, 0x0,
             NULL, HFILL}},
+        {&hf_amqp_continuation_data, {
+            "Continuation data", "amqp.continuation_data",
+            FT_BYTES, BASE_NONE, NULL, 0,
+            "Tail of a frame that started before the capture", HFILL}},
         {&hf_amqp_field_byte_array, {
             "(byte array)", "amqp.field.byte_array",
             FT_BYTES, BASE_NONE, NULL, 0,
@@ -13478,6 +15653,126 @@ proto_register_amqp(void)
             "Ack in frame", "amqp.ack_in",
             FT_FRAMENUM, BASE_NONE, NULL, 0,
             NULL, HFILL}},
+        {&hf_amqp_ack_time, {
+            "Time since message", "amqp.ack.time",
+            FT_RELATIVE_TIME, BASE_NONE, NULL, 0,
+            "The time between the basic.publish or basic.deliver and its ack", HFILL}},
+        {&hf_amqp_unacked_at_close, {
+            "Unacked deliveries", "amqp.unacked_at_close",
+            FT_UINT64, BASE_DEC, NULL, 0,
+            "Messages published or delivered on the closed channels that were never acked", HFILL}},
+        {&hf_amqp_queue_state, {
+            "Queue state", "amqp.queue_state",
+            FT_STRING, BASE_NONE, NULL, 0,
+            "Queue whose estimated state the frame changed", HFILL}},
+        {&hf_amqp_queue_state_ready, {
+            "Ready messages", "amqp.queue_state.ready",
+            FT_INT64, BASE_DEC, NULL, 0,
+            "Estimated number of messages waiting for a consumer, i.e. the consumer lag", HFILL}},
+        {&hf_amqp_queue_state_unacked, {
+            "Unacked messages", "amqp.queue_state.unacked",
+            FT_INT64, BASE_DEC, NULL, 0,
+            "Estimated number of messages delivered to consumers and not yet acked", HFILL}},
+        {&hf_amqp_queue_state_depth, {
+            "Queue depth", "amqp.queue_state.depth",
+            FT_INT64, BASE_DEC, NULL, 0,
+            "Estimated number of ready and unacked messages", HFILL}},
+        {&hf_amqp_queue_state_consumers, {
+            "Consumers", "amqp.queue_state.consumers",
+            FT_UINT32, BASE_DEC, NULL, 0,
+            "Consumer count of the last queue.declare-ok", HFILL}},
+        {&hf_amqp_1_0_link_credit_left, {
+            "Remaining link credit", "amqp.link.credit",
+            FT_INT64, BASE_DEC, NULL, 0,
+            "Deliveries the sender may still transfer on the link", HFILL}},
+        {&hf_amqp_1_0_link_blocked_in, {
+            "Blocked on credit since frame", "amqp.link.blocked_in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0,
+            "The frame the link ran out of credit in", HFILL}},
+        {&hf_amqp_0_10_command_id, {
+            "Command-id", "amqp.command.id",
+            FT_UINT32, BASE_DEC, NULL, 0,
+            "The implicit sequence number of the AMQP 0-10 command in its session", HFILL}},
+        {&hf_amqp_0_10_command_completed_in, {
+            "Completed in frame", "amqp.command.completed_in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0,
+            "The session.completed that completed this command", HFILL}},
+        {&hf_amqp_0_10_command_result_in, {
+            "Result in frame", "amqp.command.result_in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0,
+            "The execution.result answering this command", HFILL}},
+        {&hf_amqp_0_10_command_in, {
+            "Command in frame", "amqp.command.command_in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0,
+            NULL, HFILL}},
+        {&hf_amqp_0_10_command_time, {
+            "Time since command", "amqp.command.time",
+            FT_RELATIVE_TIME, BASE_NONE, NULL, 0,
+            "The time between the command and its completion or result", HFILL}},
+        {&hf_amqp_0_10_completed_command, {
+            "Completed command-id", "amqp.command.completed",
+            FT_UINT32, BASE_DEC, NULL, 0,
+            "A command completed by this session.completed", HFILL}},
+        {&hf_amqp_1_0_link_blocked_time, {
+            "Time blocked on credit", "amqp.link.blocked_time",
+            FT_RELATIVE_TIME, BASE_NONE, NULL, 0,
+            "The time the link had no credit before this flow", HFILL}},
+        {&hf_amqp_1_0_session_window_left, {
+            "Remaining session window", "amqp.session.window",
+            FT_INT64, BASE_DEC, NULL, 0,
+            "Transfer frames the sender may still send on the session", HFILL}},
+        {&hf_amqp_1_0_session_blocked_in, {
+            "Blocked on window since frame", "amqp.session.blocked_in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0,
+            "The frame the session incoming window ran out in", HFILL}},
+        {&hf_amqp_1_0_session_blocked_time, {
+            "Time blocked on window", "amqp.session.blocked_time",
+            FT_RELATIVE_TIME, BASE_NONE, NULL, 0,
+            "The time the session had no incoming window before this flow", HFILL}},
+        {&hf_amqp_fragments, {
+            "Message fragments", "amqp.fragments",
+            FT_NONE, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment, {
+            "Message fragment", "amqp.fragment",
+            FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_overlap, {
+            "Message fragment overlap", "amqp.fragment.overlap",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_overlap_conflicts, {
+            "Message fragment overlapping with conflicting data", "amqp.fragment.overlap.conflicts",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_multiple_tails, {
+            "Message has multiple tail fragments", "amqp.fragment.multiple_tails",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_too_long_fragment, {
+            "Message fragment too long", "amqp.fragment.too_long_fragment",
+            FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_error, {
+            "Message defragmentation error", "amqp.fragment.error",
+            FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_fragment_count, {
+            "Message fragment count", "amqp.fragment.count",
+            FT_UINT32, BASE_DEC, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_reassembled_in, {
+            "Reassembled in", "amqp.reassembled.in",
+            FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_reassembled_length, {
+            "Reassembled length", "amqp.reassembled.length",
+            FT_UINT32, BASE_DEC, NULL, 0x00,
+            NULL, HFILL}},
+        {&hf_amqp_reassembled_data, {
+            "Reassembled data", "amqp.reassembled.data",
+            FT_BYTES, BASE_NONE, NULL, 0x00,
+            NULL, HFILL}},
         {&hf_amqp_method_connection_start_server_properties_size, {
             "Size", "amqp.method.connection_start.server_properties.size",
             FT_UINT32, BASE_DEC, NULL, 0,
@@ -13558,16 +15853,30 @@ proto_register_amqp(void)
          &ett_amqp_0_10_struct,
          &ett_amqp_1_0_array,
          &ett_amqp_1_0_map,
-         &ett_amqp_1_0_list
+         &ett_amqp_1_0_list,
+         &ett_amqp_0_10_completed_command,
+         &ett_amqp_fragment,
+         &ett_amqp_fragments,
+         &ett_amqp_queue_state
     };
 
     static ei_register_info ei[] = {
         { &ei_amqp_connection_error, { "amqp.connection.error", PI_RESPONSE_CODE, PI_WARN, "Connection error", EXPFILL }},
         { &ei_amqp_channel_error, { "amqp.channel.error", PI_RESPONSE_CODE, PI_WARN, "Channel error", EXPFILL }},
         { &ei_amqp_message_undeliverable, { "amqp.message.undeliverable", PI_RESPONSE_CODE, PI_WARN, "Message was not delivered", EXPFILL }},
+        { &ei_amqp_deliveries_untracked, { "amqp.deliveries_untracked", PI_SEQUENCE, PI_NOTE, "Older unacked deliveries are no longer tracked", EXPFILL }},
+        { &ei_amqp_1_0_no_link_credit, { "amqp.link.no_credit", PI_SEQUENCE, PI_WARN, "Transfer sent without link credit", EXPFILL }},
+        { &ei_amqp_1_0_link_credit_exhausted, { "amqp.link.credit_exhausted", PI_SEQUENCE, PI_NOTE, "Link credit exhausted", EXPFILL }},
+        { &ei_amqp_1_0_link_credit_starved, { "amqp.link.credit_starved", PI_SEQUENCE, PI_WARN, "Receiver granted no link credit", EXPFILL }},
+        { &ei_amqp_1_0_link_blocked, { "amqp.link.blocked", PI_SEQUENCE, PI_NOTE, "Link was blocked on credit", EXPFILL }},
+        { &ei_amqp_1_0_session_window_exceeded, { "amqp.session.window_exceeded", PI_SEQUENCE, PI_WARN, "Transfer sent outside the session window", EXPFILL }},
+        { &ei_amqp_1_0_session_window_exhausted, { "amqp.session.window_exhausted", PI_SEQUENCE, PI_NOTE, "Session window exhausted", EXPFILL }},
+        { &ei_amqp_1_0_session_window_closed, { "amqp.session.window_closed", PI_SEQUENCE, PI_WARN, "Peer granted no session window", EXPFILL }},
+        { &ei_amqp_1_0_session_blocked, { "amqp.session.blocked", PI_SEQUENCE, PI_NOTE, "Session was blocked on its window", EXPFILL }},
         { &ei_amqp_bad_flag_value, { "amqp.bad_flag_value", PI_PROTOCOL, PI_WARN, "Bad flag value", EXPFILL }},
         { &ei_amqp_bad_length, { "amqp.bad_length", PI_MALFORMED, PI_ERROR, "Bad frame length", EXPFILL }},
         { &ei_amqp_field_short, { "amqp.field_short", PI_PROTOCOL, PI_ERROR, "Field is cut off by the end of the field table", EXPFILL }},
+        { &ei_amqp_resync, { "amqp.resync", PI_SEQUENCE, PI_NOTE, "Capture starts in the middle of the AMQP stream", EXPFILL }},
         { &ei_amqp_invalid_class_code, { "amqp.unknown.class_code", PI_PROTOCOL, PI_WARN, "Invalid class code", EXPFILL }},
         { &ei_amqp_unknown_command_class, { "amqp.unknown.command_class", PI_PROTOCOL, PI_ERROR, "Unknown command/control class", EXPFILL }},
         { &ei_amqp_unknown_frame_type, { "amqp.unknown.frame_type", PI_PROTOCOL, PI_ERROR, "Unknown frame type", EXPFILL }},
@@ -13615,7 +15924,7 @@ proto_register_amqp(void)
                                amqp_message_decode_copy_cb,
                                amqp_message_decode_update_cb,
                                amqp_message_decode_free_cb,
-                               NULL,
+                               amqp_message_decode_post_update_cb,
                                NULL,
                                amqp_message_decode_flds);
 
@@ -13645,6 +15954,8 @@ proto_register_amqp(void)
 
     version_table = register_dissector_table("amqp.version", "AMQP versions", proto_amqp, FT_UINT8, BASE_DEC);
 
+    reassembly_table_register(&amqp_reassembly_table, &addresses_ports_reassembly_table_functions);
+
     amqp_module = prefs_register_protocol(proto_amqp, proto_reg_handoff_amqp);
 
     prefs_register_uint_preference(amqp_module, "tls.port",
@@ -13654,12 +15965,46 @@ proto_register_amqp(void)
                                    10, &amqps_port);
     prefs_register_obsolete_preference(amqp_module, "ssl.port");
 
+    prefs_register_uint_preference(amqp_module, "max_body_reassembly",
+                                   "Maximum reassembled content body size",
+                                   "Content bodies split over several frames are reassembled "
+                                   "before being passed to the media type subdissector, up to "
+                                   "this size in bytes (0 to disable reassembly)",
+                                   10, &amqp_max_body_reassembly);
+
+    prefs_register_bool_preference(amqp_module, "cache_frame_summaries",
+                                   "Cache decoded frame summaries",
+                                   "Keep a summary of every decoded AMQP 0-9 and 1.0 frame, so "
+                                   "that refiltering, the packet list and most statistics do not "
+                                   "decode the frame arguments again. Costs some memory per frame",
+                                   &amqp_cache_frame_summaries);
+
+    prefs_register_uint_preference(amqp_module, "max_unacked_deliveries",
+                                   "Maximum unacked deliveries per connection",
+                                   "Deliveries waiting for an ack are tracked to link them to "
+                                   "their ack. Beyond this number on a connection the oldest "
+                                   "ones are no longer tracked, which bounds the memory used by "
+                                   "long live captures (0 for no limit)",
+                                   10, &amqp_max_unacked_deliveries);
+
     register_decode_as(&amqp_da);
 
     prefs_register_uat_preference(amqp_module, "message_decode_table",
                                 "Message Decoding",
                                 "A table that enumerates custom message decodes to be used for a certain topic",
                                 message_uat);
+
+    amqp_tap = register_tap("amqp"); /* AMQP statistics tap */
+    amqp_queues = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_str_hash, g_str_equal);
+    amqp_exchanges = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_str_hash, g_str_equal);
+    amqp_expert_tap = find_tap_id("expert");
+    stats_tree_register("amqp", "amqp", "AMQP/Messages", 0, amqp_stats_tree_packet, amqp_stats_tree_init, NULL);
+    register_rtd_table(proto_amqp, NULL, AMQP_RTD_NUM_TIMESTATS, 1, amqp_rtd_types, amqpstat_packet, NULL);
+    amqp_srt_tap = register_tap("amqp_srt"); /* AMQP 0-10 command completion tap */
+    register_srt_table(proto_amqp, "amqp_srt", 1, amqpstat_srt_packet, amqpstat_srt_init, NULL);
+    /* message bodies are exported complete, so tshark writes them as they come */
+    amqp_eo_tap = register_export_object(proto_amqp, amqp_eo_packet, NULL);
+    set_eo_streamable(proto_amqp);
 }
 
 void
@@ -13676,6 +16021,8 @@ proto_reg_handoff_amqp(void)
         dissector_add_uint("amqp.version", AMQP_V0_10, create_dissector_handle( dissect_amqpv0_10, proto_amqpv0_10 ));
         dissector_add_uint("amqp.version", AMQP_V1_0, create_dissector_handle( dissect_amqpv1_0, proto_amqpv1_0 ));
 
+        protobuf_message_type_handle = find_dissector_add_dependency("protobuf_message_type", proto_amqp);
+
         initialize = TRUE;
     }
 
@@ -0,0 +1,111 @@
+/* packet-amqp.h
+ * Definitions for the AMQP tap
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __PACKET_AMQP_H__
+#define __PACKET_AMQP_H__
+
+#include <epan/packet.h>
+
+/* AMQP versions, as stored in amqp_tap_info_t.version */
+/* #define AMQP_V0_8           1 */
+#define AMQP_V0_9           2
+/* #define AMQP_V0_91          3 */
+#define AMQP_V0_10          4
+#define AMQP_V1_0           5
+
+/* Message events reported to the "amqp" tap */
+typedef enum {
+    AMQP_TAP_PUBLISH,       /* basic.publish, or AMQP 1.0 transfer to the broker */
+    AMQP_TAP_DELIVER,       /* basic.deliver or basic.get-ok, or AMQP 1.0 transfer from the broker */
+    AMQP_TAP_ACK,           /* basic.ack, or AMQP 1.0 accepted disposition */
+    AMQP_TAP_NACK,          /* basic.nack, or AMQP 1.0 released or modified disposition */
+    AMQP_TAP_REJECT,        /* basic.reject, or AMQP 1.0 rejected disposition */
+    AMQP_TAP_RETURN,        /* basic.return */
+    AMQP_TAP_QUEUE_COUNT,   /* queue.declare-ok, queue.purge-ok, queue.delete-ok or basic.get-empty,
+                               the broker reported how many messages a queue holds */
+    AMQP_TAP_REQUEUE        /* channel.close-ok, connection.close-ok or basic.recover, or AMQP 1.0
+                               end or close, the broker requeued the unacked messages */
+} amqp_tap_event_t;
+
+/* Estimated state of a queue after a message event. Depth is ready plus
+ * unacked messages. */
+typedef struct _amqp_tap_queue_t {
+    const gchar *name;
+    gint64 ready;               /* messages waiting for a consumer, i.e. the consumer lag */
+    gint64 unacked;             /* messages delivered and not yet acked */
+    gint32 consumers;           /* consumer count of the last queue.declare-ok, -1 if unknown */
+    gboolean anchored;          /* ready counts from a message count reported by the broker,
+                                   rather than from 0 at the start of the capture */
+} amqp_tap_queue_t;
+
+/* A message settled by an ack, nack or reject */
+typedef struct _amqp_tap_settled_t {
+    guint64 delivery_tag;       /* delivery tag, message number or delivery-id */
+    guint32 msg_framenum;       /* frame of the publish or deliver, 0 if unknown */
+    nstime_t latency;           /* time since the publish or deliver */
+    const gchar *exchange;      /* exchange of the message, NULL if unknown */
+    const gchar *routing_key;   /* routing key of the message, NULL if unknown */
+    const gchar *queue;         /* queue the message was consumed from, NULL if unknown */
+    gboolean confirm;           /* publisher confirm rather than a consumer ack */
+} amqp_tap_settled_t;
+
+/* Used for AMQP statistics; one record per message event */
+typedef struct _amqp_tap_info_t {
+    guint8 version;             /* AMQP_V0_9, AMQP_V0_10 or AMQP_V1_0 */
+    amqp_tap_event_t event;
+    guint32 stream;             /* TCP stream index */
+    guint16 channel;
+    const gchar *exchange;      /* exchange, NULL for AMQP 1.0 */
+    const gchar *routing_key;   /* routing key, or AMQP 1.0 target address */
+    const gchar *queue;         /* queue a delivered message was consumed from, NULL if unknown */
+    guint64 body_size;          /* message size, 0 for acks */
+    guint64 delivery_tag;       /* delivery tag, message number or delivery-id */
+    gboolean multiple;          /* the ack settles every message up to delivery_tag */
+    gboolean settled;           /* the event settles the message(s) */
+    guint settled_count;        /* number of entries in settled_msgs */
+    const amqp_tap_settled_t *settled_msgs; /* messages settled by an ack, nack or reject */
+    guint64 state_size;         /* approximate memory held to track the connection, in bytes,
+                                   0 if not known (passes after the first) */
+    guint queue_count;          /* number of entries in queues */
+    const amqp_tap_queue_t *queues; /* estimated state of the queues the event changed */
+} amqp_tap_info_t;
+
+/* An AMQP 0-10 command completed by a session.completed */
+typedef struct _amqp_tap_command_t {
+    guint32 command_id;
+    guint8 amqp_class;          /* class code of the command */
+    guint8 method;              /* command code within the class */
+    guint32 command_framenum;   /* frame the command was sent in */
+    nstime_t command_time;      /* time the command was sent */
+} amqp_tap_command_t;
+
+/* Used for AMQP 0-10 service response time; one record per session.completed
+ * that completes commands */
+typedef struct _amqp_srt_info_t {
+    guint32 stream;             /* TCP stream index */
+    guint16 channel;
+    guint command_count;        /* number of entries in commands */
+    const amqp_tap_command_t *commands;
+} amqp_srt_info_t;
+
+#endif /* __PACKET_AMQP_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -1028,7 +1028,7 @@ dissect_dtls_record(tvbuff_t *tvb, packet_info *pinfo,
           ssl_debug_printf("%s: found handle %p (%s)\n", G_STRFUNC,
                            (void *)session->app_handle,
                            dissector_handle_get_dissector_name(session->app_handle));
-          ssl_print_data("decrypted app data", record->plain_data, record->data_len);
+          ssl_print_data("decrypted app data", tvb_get_ptr(decrypted, 0, record->data_len), record->data_len);
 
           if (have_tap_listener(exported_pdu_tap)) {
             export_pdu_packet(decrypted, pinfo, EXP_PDU_TAG_PROTO_NAME,
@@ -36,6 +36,7 @@
 #include <epan/expert.h>
 #include <epan/packet.h>
 #include <epan/strutil.h>
+#include <epan/topic_match.h>
 #include <epan/uat.h>
 #include "packet-tcp.h"
 #include "packet-tls.h"
@@ -187,7 +188,6 @@ typedef struct {
 typedef struct _mqtt_message_decode_t {
   guint   match_criteria;
   char   *topic_pattern;
-  GRegex *topic_regex;
   guint   msg_decoding;
   char   *payload_proto_name;
   dissector_handle_t payload_proto;
@@ -198,18 +198,13 @@ typedef struct _mqtt_properties_t {
   guint32       topic_alias;
 } mqtt_properties_t;
 
-#define MATCH_CRITERIA_EQUAL        0
-#define MATCH_CRITERIA_CONTAINS     1
-#define MATCH_CRITERIA_STARTS_WITH  2
-#define MATCH_CRITERIA_ENDS_WITH    3
-#define MATCH_CRITERIA_REGEX        4
-
 static const value_string match_criteria[] = {
-  { MATCH_CRITERIA_EQUAL,       "Equal to" },
-  { MATCH_CRITERIA_CONTAINS,    "Contains" },
-  { MATCH_CRITERIA_STARTS_WITH, "Starts with" },
-  { MATCH_CRITERIA_ENDS_WITH,   "Ends with" },
-  { MATCH_CRITERIA_REGEX,       "Regular Expression" },
+  { TOPIC_MATCH_EQUAL,       "Equal to" },
+  { TOPIC_MATCH_CONTAINS,    "Contains" },
+  { TOPIC_MATCH_STARTS_WITH, "Starts with" },
+  { TOPIC_MATCH_ENDS_WITH,   "Ends with" },
+  { TOPIC_MATCH_REGEX,       "Regular Expression" },
+  { TOPIC_MATCH_MQTT_FILTER, "Topic Filter" },
   { 0, NULL }
 };
 
@@ -655,14 +650,9 @@ static gboolean mqtt_message_decode_update_cb(void *record, char **error)
     return FALSE;
   }
 
-  if (u->match_criteria == MATCH_CRITERIA_REGEX)
+  if (!topic_match_check_pattern(u->match_criteria, u->topic_pattern, error))
   {
-    u->topic_regex = g_regex_new(u->topic_pattern, (GRegexCompileFlags) G_REGEX_OPTIMIZE, (GRegexMatchFlags) 0, NULL);
-    if (!u->topic_regex)
-    {
-      *error = g_strdup_printf("Invalid regex: %s", u->topic_pattern);
-      return FALSE;
-    }
+    return FALSE;
   }
 
   return TRUE;
@@ -673,14 +663,25 @@ static void mqtt_message_decode_free_cb(void *record)
   mqtt_message_decode_t *u = (mqtt_message_decode_t *)record;
 
   g_free(u->topic_pattern);
-  if (u->topic_regex)
+  g_free(u->payload_proto_name);
+}
+
+/* message decode table compiled for lookups, rebuilt whenever the table changes */
+static topic_matcher_t *mqtt_decode_matcher;
+
+static void mqtt_message_decode_post_update_cb(void)
+{
+  topic_matcher_free(mqtt_decode_matcher);
+  mqtt_decode_matcher = topic_matcher_new();
+  for (guint i = 0; i < num_mqtt_message_decodes; i++)
   {
-    g_regex_unref(u->topic_regex);
+    topic_matcher_add(mqtt_decode_matcher, mqtt_message_decodes[i].match_criteria,
+                      mqtt_message_decodes[i].topic_pattern);
   }
-  g_free(u->payload_proto_name);
+  topic_matcher_compile(mqtt_decode_matcher);
 }
 
-UAT_VS_DEF(message_decode, match_criteria, mqtt_message_decode_t, guint, MATCH_CRITERIA_EQUAL, "Equal to")
+UAT_VS_DEF(message_decode, match_criteria, mqtt_message_decode_t, guint, TOPIC_MATCH_EQUAL, "Equal to")
 UAT_CSTRING_CB_DEF(message_decode, topic_pattern, mqtt_message_decode_t)
 UAT_VS_DEF(message_decode, msg_decoding, mqtt_message_decode_t, guint, MSG_DECODING_NONE, "none")
 UAT_PROTO_DEF(message_decode, payload_proto, payload_proto, payload_proto_name, mqtt_message_decode_t)
@@ -688,51 +689,19 @@ UAT_PROTO_DEF(message_decode, payload_proto, payload_proto, payload_proto_name,
 static gboolean mqtt_user_decode_message(proto_tree *tree, proto_tree *mqtt_tree, packet_info *pinfo, const guint8 *topic_str, tvbuff_t *msg_tvb)
 {
   mqtt_message_decode_t *message_decode_entry = NULL;
-  size_t topic_str_len = strlen(topic_str);
-  size_t topic_pattern_len;
   gboolean match_found = FALSE;
+  guint idx;
 
-  if (topic_str_len == 0)
+  if (topic_str[0] == '\0')
   {
     /* No topic to match */
     return FALSE;
   }
 
-  for (guint i = 0; i < num_mqtt_message_decodes && !match_found; i++)
+  if (topic_matcher_lookup(mqtt_decode_matcher, (const char *)topic_str, &idx) && idx < num_mqtt_message_decodes)
   {
-    message_decode_entry = &mqtt_message_decodes[i];
-    switch (message_decode_entry->match_criteria)
-    {
-      case MATCH_CRITERIA_EQUAL:
-        match_found = (strcmp(topic_str, message_decode_entry->topic_pattern) == 0);
-        break;
-      case MATCH_CRITERIA_CONTAINS:
-        match_found = (strstr(topic_str, message_decode_entry->topic_pattern) != NULL);
-        break;
-      case MATCH_CRITERIA_STARTS_WITH:
-        topic_pattern_len = strlen(message_decode_entry->topic_pattern);
-        match_found = ((topic_str_len >= topic_pattern_len) &&
-                       (strncmp(topic_str, message_decode_entry->topic_pattern, topic_pattern_len) == 0));
-        break;
-      case MATCH_CRITERIA_ENDS_WITH:
-        topic_pattern_len = strlen(message_decode_entry->topic_pattern);
-        match_found = ((topic_str_len >= topic_pattern_len) &&
-                       (strcmp(topic_str + (topic_str_len - topic_pattern_len), message_decode_entry->topic_pattern) == 0));
-        break;
-      case MATCH_CRITERIA_REGEX:
-        if (message_decode_entry->topic_regex)
-        {
-          GMatchInfo *match_info = NULL;
-          /* DISSECTOR_ASSERT(g_utf8_validate(topic_str, -1, NULL)); */
-          g_regex_match(message_decode_entry->topic_regex, topic_str, (GRegexMatchFlags) 0, &match_info);
-          match_found = g_match_info_matches(match_info);
-          g_match_info_free(match_info);
-        }
-        break;
-      default:
-        /* Unknown match criteria */
-        break;
-    }
+    message_decode_entry = &mqtt_message_decodes[idx];
+    match_found = TRUE;
   }
 
   if (match_found)
@@ -1805,7 +1774,7 @@ void proto_register_mqtt(void)
                                mqtt_message_decode_copy_cb,
                                mqtt_message_decode_update_cb,
                                mqtt_message_decode_free_cb,
-                               NULL,
+                               mqtt_message_decode_post_update_cb,
                                NULL,
                                mqtt_message_decode_flds);
 
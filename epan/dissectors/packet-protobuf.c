@@ -151,6 +151,7 @@ static gboolean old_dissect_bytes_as_string = FALSE;
 static gboolean show_details = FALSE;
 static gboolean pbf_as_hf = FALSE; /* dissect protobuf fields as header fields of wireshark */
 static gboolean preload_protos = FALSE;
+static gboolean cache_protos = TRUE;
 
 enum add_default_value_policy_t {
     ADD_DEFAULT_VALUE_NONE,
@@ -183,6 +184,57 @@ typedef struct {
 
 static PbwDescriptorPool* pbw_pool = NULL;
 
+/* incremented each time pbw_pool is loaded, invalidating the descriptors cached in
+   protobuf_message_type_t */
+static guint pbw_pool_generation = 0;
+
+/* message type resolved once by a dissector that always asks for the same type */
+struct _protobuf_message_type_t {
+    gchar* name; /* full name of message type, like helloworld.HelloRequest */
+    const PbwDescriptor* desc; /* NULL if not found in the *.proto files */
+    guint generation; /* pbw_pool_generation when desc was found */
+};
+
+/* maps message type name to protobuf_message_type_t */
+static wmem_map_t* protobuf_message_types = NULL;
+
+/* everything needed to dissect a field, taken from its descriptor once instead of for each value */
+typedef struct {
+    const PbwFieldDescriptor* desc;
+    const gchar* name;
+    int number;
+    int type;
+    gboolean is_packed_repeated;
+    int hf_id; /* header field of this field if pbf_as_hf is set, or -1 */
+    dissector_handle_t subdissector; /* from protobuf_field_subdissector_table */
+    const PbwEnumDescriptor* enum_desc; /* only for PROTOBUF_TYPE_ENUM */
+    const PbwDescriptor* message_desc; /* only for PROTOBUF_TYPE_MESSAGE and PROTOBUF_TYPE_GROUP */
+    gboolean is_timestamp; /* message_desc is google.protobuf.Timestamp */
+} protobuf_field_plan_t;
+
+/* Compiled plan of a message type. It is built the first time the message type is dissected, after
+ * all dissectors have registered in protobuf_field_subdissector_table, and freed when the .proto files
+ * or the header fields are reloaded.
+ */
+typedef struct {
+    const gchar* full_name;
+    int hf_id; /* header field of this message if pbf_as_hf is set, or -1 */
+    int field_count;
+    protobuf_field_plan_t* fields; /* in the order of declaration */
+    /* if the field numbers are dense, fields_by_number is indexed by field number, otherwise
+     * fields_sorted is sorted by field number for binary search */
+    protobuf_field_plan_t** fields_by_number;
+    guint max_dense_number;
+    protobuf_field_plan_t** fields_sorted;
+} protobuf_message_plan_t;
+
+/* maps PbwDescriptor to protobuf_message_plan_t */
+static GHashTable* protobuf_message_plans = NULL;
+
+/* use a table indexed by field number if it is not much bigger than the number of fields */
+#define PROTOBUF_DENSE_FIELD_NUMBER_MIN     64
+#define PROTOBUF_DENSE_FIELD_NUMBER_FACTOR  4
+
 /* protobuf source files search paths */
 typedef struct {
     char* path; /* protobuf source files searching directory path */
@@ -361,11 +413,202 @@ tvb_get_protobuf_time(tvbuff_t* tvb, guint offset, guint maxlen, nstime_t* times
     return maxlen - len;
 }
 
+/* Decode all varints of a packed repeated field in one pass over its bytes.
+ * Return the number of varints stored in infos (which must have room for length entries),
+ * or -1 if the bytes are not a sequence of valid varints.
+ */
+static int
+protobuf_decode_packed_varints(const guint8* buf, guint start, guint length, protobuf_varint_tvb_info_t* infos)
+{
+    guint pos = 0;
+    guint i;
+    int count = 0;
+    guint64 value;
+    guint8 b;
+
+    while (pos < length) {
+        /* small values like enums and bools take one byte each, so take eight of them at once
+         * if none of the eight bytes has the continuation bit set */
+        while (pos + 8 <= length && (pletoh64(buf + pos) & G_GUINT64_CONSTANT(0x8080808080808080)) == 0) {
+            for (i = 0; i < 8; i++, count++) {
+                infos[count].offset = start + pos + i;
+                infos[count].length = 1;
+                infos[count].value = buf[pos + i];
+            }
+            pos += 8;
+        }
+
+        if (pos == length) {
+            break;
+        }
+
+        value = 0;
+        for (i = 0; ; i++) {
+            if (i == FT_VARINT_MAX_LEN || pos + i == length) {
+                return -1; /* too long or truncated */
+            }
+            b = buf[pos + i];
+            value |= (guint64)(b & 0x7F) << (i * 7);
+            if (b < 0x80) {
+                break;
+            }
+        }
+
+        infos[count].offset = start + pos;
+        infos[count].length = i + 1;
+        infos[count].value = value;
+        count++;
+        pos += i + 1;
+    }
+
+    return count;
+}
+
+static void
+protobuf_message_plan_free(gpointer data)
+{
+    protobuf_message_plan_t* plan = (protobuf_message_plan_t*) data;
+
+    g_free(plan->fields);
+    g_free(plan->fields_by_number);
+    g_free(plan->fields_sorted);
+    g_free(plan);
+}
+
+/* free the compiled plans, they are compiled again when the message types are dissected next time */
+static void
+protobuf_clear_message_plans(void)
+{
+    if (protobuf_message_plans) {
+        g_hash_table_remove_all(protobuf_message_plans);
+    }
+}
+
+static int
+protobuf_field_plan_compare(gconstpointer a, gconstpointer b)
+{
+    const protobuf_field_plan_t* fa = *(const protobuf_field_plan_t* const*) a;
+    const protobuf_field_plan_t* fb = *(const protobuf_field_plan_t* const*) b;
+
+    return (fa->number > fb->number) - (fa->number < fb->number);
+}
+
+/* get the header field id registered by update_header_fields(), or -1 */
+static int
+protobuf_lookup_hf_id(const gchar* full_name)
+{
+    int* hf_id_ptr;
+
+    if (!pbf_as_hf || pbf_hf_hash == NULL || full_name == NULL) {
+        return -1;
+    }
+    hf_id_ptr = (int*)g_hash_table_lookup(pbf_hf_hash, full_name);
+    return hf_id_ptr ? *hf_id_ptr : -1;
+}
+
+/* get the compiled plan of a message type, compile it if this type is dissected for the first time */
+static const protobuf_message_plan_t*
+protobuf_get_message_plan(const PbwDescriptor* message_desc)
+{
+    protobuf_message_plan_t* plan;
+    protobuf_field_plan_t* field;
+    const gchar* field_full_name;
+    const gchar* sub_message_name;
+    int i;
+    guint max_number = 0;
+
+    if (protobuf_message_plans == NULL) {
+        protobuf_message_plans = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, protobuf_message_plan_free);
+    }
+
+    plan = (protobuf_message_plan_t*) g_hash_table_lookup(protobuf_message_plans, message_desc);
+    if (plan) {
+        return plan;
+    }
+
+    plan = g_new0(protobuf_message_plan_t, 1);
+    plan->full_name = pbw_Descriptor_full_name(message_desc);
+    plan->hf_id = protobuf_lookup_hf_id(plan->full_name);
+    plan->field_count = pbw_Descriptor_field_count(message_desc);
+    plan->fields = g_new0(protobuf_field_plan_t, plan->field_count);
+
+    for (i = 0; i < plan->field_count; i++) {
+        field = &plan->fields[i];
+        field->desc = pbw_Descriptor_field(message_desc, i);
+        field->name = pbw_FieldDescriptor_name(field->desc);
+        field->number = pbw_FieldDescriptor_number(field->desc);
+        /* resolves the type of fields declared with message or enum type names */
+        field->type = pbw_FieldDescriptor_type(field->desc);
+        field->is_packed_repeated = pbw_FieldDescriptor_is_packed(field->desc)
+            && pbw_FieldDescriptor_is_repeated(field->desc);
+
+        field_full_name = pbw_FieldDescriptor_full_name(field->desc);
+        field->hf_id = protobuf_lookup_hf_id(field_full_name);
+        field->subdissector = field_full_name ? dissector_get_string_handle(protobuf_field_subdissector_table, field_full_name) : NULL;
+
+        if (field->type == PROTOBUF_TYPE_ENUM) {
+            field->enum_desc = pbw_FieldDescriptor_enum_type(field->desc);
+        } else if (field->type == PROTOBUF_TYPE_MESSAGE || field->type == PROTOBUF_TYPE_GROUP) {
+            field->message_desc = pbw_FieldDescriptor_message_type(field->desc);
+            sub_message_name = field->message_desc ? pbw_Descriptor_full_name(field->message_desc) : NULL;
+            field->is_timestamp = g_strcmp0(sub_message_name, "google.protobuf.Timestamp") == 0;
+        }
+
+        if (field->number > 0 && (guint)field->number > max_number) {
+            max_number = (guint)field->number;
+        }
+    }
+
+    if (max_number < PROTOBUF_DENSE_FIELD_NUMBER_MIN
+        || max_number <= (guint)plan->field_count * PROTOBUF_DENSE_FIELD_NUMBER_FACTOR) {
+        plan->max_dense_number = max_number;
+        plan->fields_by_number = g_new0(protobuf_field_plan_t*, max_number + 1);
+        for (i = 0; i < plan->field_count; i++) {
+            if (plan->fields[i].number >= 0) {
+                plan->fields_by_number[plan->fields[i].number] = &plan->fields[i];
+            }
+        }
+    } else {
+        plan->fields_sorted = g_new(protobuf_field_plan_t*, plan->field_count);
+        for (i = 0; i < plan->field_count; i++) {
+            plan->fields_sorted[i] = &plan->fields[i];
+        }
+        qsort(plan->fields_sorted, plan->field_count, sizeof(protobuf_field_plan_t*), protobuf_field_plan_compare);
+    }
+
+    g_hash_table_insert(protobuf_message_plans, (gpointer) message_desc, plan);
+    return plan;
+}
+
+/* like pbw_Descriptor_FindFieldByNumber(), but with the compiled plan */
+static const protobuf_field_plan_t*
+protobuf_find_field_plan(const protobuf_message_plan_t* plan, guint64 number)
+{
+    int low, high, mid;
+
+    if (plan->fields_by_number) {
+        return (number <= plan->max_dense_number) ? plan->fields_by_number[number] : NULL;
+    }
+
+    low = 0;
+    high = plan->field_count - 1;
+    while (low <= high) {
+        mid = low + (high - low) / 2;
+        if ((guint64)plan->fields_sorted[mid]->number == number) {
+            return plan->fields_sorted[mid];
+        } else if (plan->fields_sorted[mid]->number < 0 || (guint64)plan->fields_sorted[mid]->number < number) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return NULL;
+}
 
 /* declare first because it will be called by dissect_packed_repeated_field_values */
 static void
 protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset, guint length, packet_info *pinfo,
-    proto_item *ti_field, int field_type, const guint64 value, const gchar* prepend_text, const PbwFieldDescriptor* field_desc, gboolean is_top_level);
+    proto_item *ti_field, int field_type, const guint64 value, const gchar* prepend_text, const protobuf_field_plan_t* field_plan, gboolean is_top_level);
 
 static void
 dissect_protobuf_message(tvbuff_t *tvb, guint offset, guint length, packet_info *pinfo, proto_tree *protobuf_tree, const PbwDescriptor* message_desc, gboolean is_top_level);
@@ -378,15 +621,12 @@ dissect_protobuf_message(tvbuff_t *tvb, guint offset, guint length, packet_info
  */
 static guint
 dissect_packed_repeated_field_values(tvbuff_t *tvb, guint start, guint length, packet_info *pinfo,
-    proto_item *ti_field, int wire_type, int field_type, const gchar* prepend_text, const PbwFieldDescriptor* field_desc)
+    proto_item *ti_field, int wire_type, int field_type, const gchar* prepend_text, const protobuf_field_plan_t* field_plan)
 {
-    guint64 sub_value;
-    guint sub_value_length;
     guint offset = start;
-    protobuf_varint_tvb_info_t *info;
+    protobuf_varint_tvb_info_t *infos;
     guint max_offset = offset + length;
-    wmem_list_frame_t *lframe;
-    wmem_list_t* varint_list;
+    int i, count;
     int value_size = 0;
 
     if (prepend_text == NULL) {
@@ -412,36 +652,27 @@ dissect_packed_repeated_field_values(tvbuff_t *tvb, guint start, guint length, p
     case PROTOBUF_TYPE_SINT64:
     case PROTOBUF_TYPE_BOOL:
     case PROTOBUF_TYPE_ENUM:
-        varint_list = wmem_list_new(pinfo->pool);
-
-        /* try to test all can parsed as varint */
-        while (offset < max_offset) {
-            sub_value_length = tvb_get_varint(tvb, offset, max_offset - offset, &sub_value, ENC_VARINT_PROTOBUF);
-            if (sub_value_length == 0) {
-                /* not a valid packed repeated field */
-                wmem_destroy_list(varint_list);
-                return 0;
-            }
-
-            /* temporarily store varint info in the list */
-            info = wmem_new(pinfo->pool, protobuf_varint_tvb_info_t);
-            info->offset = offset;
-            info->length = sub_value_length;
-            info->value = sub_value;
-            wmem_list_append(varint_list, info);
+        if (length == 0) {
+            break;
+        }
 
-            offset += sub_value_length;
+        /* try to test all can parsed as varint, every varint takes at least one byte */
+        infos = wmem_alloc_array(pinfo->pool, protobuf_varint_tvb_info_t, length);
+        count = protobuf_decode_packed_varints(tvb_get_ptr(tvb, start, length), start, length, infos);
+        if (count < 0) {
+            /* not a valid packed repeated field */
+            wmem_free(pinfo->pool, infos);
+            return 0;
         }
 
         /* all parsed, we add varints into the packed-repeated subtree */
-        for (lframe = wmem_list_head(varint_list); lframe != NULL; lframe = wmem_list_frame_next(lframe)) {
-            info = (protobuf_varint_tvb_info_t*)wmem_list_frame_data(lframe);
-            protobuf_dissect_field_value(subtree, tvb, info->offset, info->length, pinfo,
-                ti_field, field_type, info->value, prepend_text, field_desc,  FALSE);
+        for (i = 0; i < count; i++) {
+            protobuf_dissect_field_value(subtree, tvb, infos[i].offset, infos[i].length, pinfo,
+                ti_field, field_type, infos[i].value, prepend_text, field_plan, FALSE);
             prepend_text = ",";
         }
 
-        wmem_destroy_list(varint_list);
+        wmem_free(pinfo->pool, infos);
         break;
 
     /* packed for 64-bit encoded types (fixed64, sfixed64, double) and 32-bit encoded types (fixed32, sfixed32, float) */
@@ -467,7 +698,7 @@ dissect_packed_repeated_field_values(tvbuff_t *tvb, guint start, guint length, p
             protobuf_dissect_field_value(subtree, tvb, offset, value_size, pinfo, ti_field, field_type,
                 (wire_type == PROTOBUF_WIRETYPE_FIXED32 ? tvb_get_guint32(tvb, offset, ENC_LITTLE_ENDIAN)
                     : tvb_get_guint64(tvb, offset, ENC_LITTLE_ENDIAN)),
-                prepend_text, field_desc, FALSE);
+                prepend_text, field_plan, FALSE);
             prepend_text = ",";
         }
 
@@ -485,7 +716,7 @@ dissect_packed_repeated_field_values(tvbuff_t *tvb, guint start, guint length, p
 /* Dissect field value based on a specific type. */
 static void
 protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset, guint length, packet_info *pinfo,
-    proto_item *ti_field, int field_type, const guint64 value, const gchar* prepend_text, const PbwFieldDescriptor* field_desc, gboolean is_top_level)
+    proto_item *ti_field, int field_type, const guint64 value, const gchar* prepend_text, const protobuf_field_plan_t* field_plan, gboolean is_top_level)
 {
     gdouble double_value;
     gfloat float_value;
@@ -498,20 +729,19 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
     const char* enum_value_name = NULL;
     const PbwDescriptor* sub_message_desc = NULL;
     const PbwEnumDescriptor* enum_desc = NULL;
-    int* hf_id_ptr = NULL;
-    const gchar* field_full_name = field_desc ? pbw_FieldDescriptor_full_name(field_desc) : NULL;
+    int hf_id = -1;
     proto_tree* field_tree = proto_item_get_subtree(ti_field);
     proto_tree* field_parent_tree = proto_tree_get_parent_tree(field_tree);
     proto_tree* pbf_tree = field_tree;
     nstime_t timestamp = { 0 };
-    dissector_handle_t field_dissector = field_full_name ? dissector_get_string_handle(protobuf_field_subdissector_table, field_full_name) : NULL;
+    dissector_handle_t field_dissector = field_plan ? field_plan->subdissector : NULL;
 
-    if (pbf_as_hf && field_full_name) {
-        hf_id_ptr = (int*)g_hash_table_lookup(pbf_hf_hash, field_full_name);
-        DISSECTOR_ASSERT_HINT(hf_id_ptr && (*hf_id_ptr) > 0, "hf must have been initialized properly");
+    if (pbf_as_hf && field_plan) {
+        hf_id = field_plan->hf_id;
+        DISSECTOR_ASSERT_HINT(hf_id > 0, "hf must have been initialized properly");
     }
 
-    if (pbf_as_hf && hf_id_ptr && !show_details) {
+    if (pbf_as_hf && hf_id > 0 && !show_details) {
         /* set ti_field (Field(x)) item hidden if there is header_field */
         proto_item_set_hidden(ti_field);
         pbf_tree = field_parent_tree;
@@ -530,8 +760,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%lf", double_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_double(pbf_tree, *hf_id_ptr, tvb, offset, length, double_value);
+        if (hf_id > 0) {
+            proto_tree_add_double(pbf_tree, hf_id, tvb, offset, length, double_value);
         }
         break;
 
@@ -542,8 +772,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%f", float_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_float(pbf_tree, *hf_id_ptr, tvb, offset, length, float_value);
+        if (hf_id > 0) {
+            proto_tree_add_float(pbf_tree, hf_id, tvb, offset, length, float_value);
         }
         break;
 
@@ -555,8 +785,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%" G_GINT64_MODIFIER "d", int64_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_int64(pbf_tree, *hf_id_ptr, tvb, offset, length, int64_value);
+        if (hf_id > 0) {
+            proto_tree_add_int64(pbf_tree, hf_id, tvb, offset, length, int64_value);
         }
         break;
 
@@ -567,8 +797,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%" G_GINT64_MODIFIER "u", value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_uint64(pbf_tree, *hf_id_ptr, tvb, offset, length, value);
+        if (hf_id > 0) {
+            proto_tree_add_uint64(pbf_tree, hf_id, tvb, offset, length, value);
         }
         break;
 
@@ -580,16 +810,16 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%d", int32_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_int(pbf_tree, *hf_id_ptr, tvb, offset, length, int32_value);
+        if (hf_id > 0) {
+            proto_tree_add_int(pbf_tree, hf_id, tvb, offset, length, int32_value);
         }
         break;
 
     case PROTOBUF_TYPE_ENUM:
         int32_value = (gint32) value;
         /* get the name of enum value */
-        if (field_desc) {
-            enum_desc = pbw_FieldDescriptor_enum_type(field_desc);
+        if (field_plan) {
+            enum_desc = field_plan->enum_desc;
             if (enum_desc) {
                 const PbwEnumValueDescriptor* enum_value_desc = pbw_EnumDescriptor_FindValueByNumber(enum_desc, int32_value);
                 if (enum_value_desc) {
@@ -611,8 +841,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
             }
 
         }
-        if (hf_id_ptr) {
-            proto_tree_add_int(pbf_tree, *hf_id_ptr, tvb, offset, length, int32_value);
+        if (hf_id > 0) {
+            proto_tree_add_int(pbf_tree, hf_id, tvb, offset, length, int32_value);
         }
         break;
 
@@ -623,8 +853,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%s", value ? "true" : "false");
         }
-        if (hf_id_ptr) {
-            proto_tree_add_boolean(pbf_tree, *hf_id_ptr, tvb, offset, length, (guint32)value);
+        if (hf_id > 0) {
+            proto_tree_add_boolean(pbf_tree, hf_id, tvb, offset, length, (guint32)value);
         }
         break;
 
@@ -633,18 +863,18 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
             if (!show_details) { /* don't show Value node if there is a subdissector for this field */
                 proto_item_set_hidden(proto_tree_get_parent(value_tree));
             }
-            if (dissect_bytes_as_string) { /* the type of *hf_id_ptr MUST be FT_STRING now */
-                if (hf_id_ptr) {
-                    ti = proto_tree_add_string_format_value(pbf_tree, *hf_id_ptr, tvb, offset, length, "", "(%u bytes)", length);
+            if (dissect_bytes_as_string) { /* the type of hf_id MUST be FT_STRING now */
+                if (hf_id > 0) {
+                    ti = proto_tree_add_string_format_value(pbf_tree, hf_id, tvb, offset, length, "", "(%u bytes)", length);
                 }
                 /* don't try to dissect bytes as string if there is a subdissector for this field */
                 break;
             }
         }
         if (!dissect_bytes_as_string) {
-            /* the type of *hf_id_ptr MUST be FT_BYTES now */
-            if (hf_id_ptr) {
-                ti = proto_tree_add_bytes_format_value(pbf_tree, *hf_id_ptr, tvb, offset, length, NULL, "(%u bytes)", length);
+            /* the type of hf_id MUST be FT_BYTES now */
+            if (hf_id > 0) {
+                ti = proto_tree_add_bytes_format_value(pbf_tree, hf_id, tvb, offset, length, NULL, "(%u bytes)", length);
             }
             break;
         }
@@ -657,32 +887,31 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%s", buf);
         }
-        if (hf_id_ptr) {
-            ti = proto_tree_add_item_ret_display_string(pbf_tree, *hf_id_ptr, tvb, offset, length, ENC_UTF_8|ENC_NA, pinfo->pool, &buf);
+        if (hf_id > 0) {
+            ti = proto_tree_add_item_ret_display_string(pbf_tree, hf_id, tvb, offset, length, ENC_UTF_8|ENC_NA, pinfo->pool, &buf);
         }
         break;
 
     case PROTOBUF_TYPE_GROUP: /* This feature is deprecated. GROUP is identical to Nested MESSAGE. */
     case PROTOBUF_TYPE_MESSAGE:
         subtree = field_tree;
-        if (field_desc) {
-            sub_message_desc = pbw_FieldDescriptor_message_type(field_desc);
+        if (field_plan) {
+            sub_message_desc = field_plan->message_desc;
             if (sub_message_desc == NULL) {
                 expert_add_info(pinfo, ti_field, &et_protobuf_message_type_not_found);
             }
         }
-        if (hf_id_ptr) {
-            if (sub_message_desc
-                && strcmp(pbw_Descriptor_full_name(sub_message_desc), "google.protobuf.Timestamp") == 0)
+        if (hf_id > 0) {
+            if (sub_message_desc && field_plan->is_timestamp)
             {   /* parse this field directly as timestamp */
                 if (tvb_get_protobuf_time(tvb, offset, length, &timestamp)) {
-                    ti = proto_tree_add_time(pbf_tree, *hf_id_ptr, tvb, offset, length, &timestamp);
+                    ti = proto_tree_add_time(pbf_tree, hf_id, tvb, offset, length, &timestamp);
                     subtree = proto_item_add_subtree(ti, ett_protobuf_message);
                 } else {
                     expert_add_info(pinfo, ti_field, &ei_protobuf_failed_parse_field);
                 }
             } else {
-                ti = proto_tree_add_bytes_format_value(pbf_tree, *hf_id_ptr, tvb, offset, length, NULL, "(%u bytes)", length);
+                ti = proto_tree_add_bytes_format_value(pbf_tree, hf_id, tvb, offset, length, NULL, "(%u bytes)", length);
                 subtree = proto_item_add_subtree(ti, ett_protobuf_message);
             }
         }
@@ -698,8 +927,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%u", (guint32)value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_uint(pbf_tree, *hf_id_ptr, tvb, offset, length, (guint32)value);
+        if (hf_id > 0) {
+            proto_tree_add_uint(pbf_tree, hf_id, tvb, offset, length, (guint32)value);
         }
         break;
 
@@ -710,8 +939,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%d", int32_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_int(pbf_tree, *hf_id_ptr, tvb, offset, length, int32_value);
+        if (hf_id > 0) {
+            proto_tree_add_int(pbf_tree, hf_id, tvb, offset, length, int32_value);
         }
         break;
 
@@ -722,8 +951,8 @@ protobuf_dissect_field_value(proto_tree *value_tree, tvbuff_t *tvb, guint offset
         if (is_top_level) {
             col_append_fstr(pinfo->cinfo, COL_INFO, "=%" G_GINT64_MODIFIER "d", int64_value);
         }
-        if (hf_id_ptr) {
-            proto_tree_add_int64(pbf_tree, *hf_id_ptr, tvb, offset, length, int64_value);
+        if (hf_id > 0) {
+            proto_tree_add_int64(pbf_tree, hf_id, tvb, offset, length, int64_value);
         }
         break;
 
@@ -771,7 +1000,7 @@ protobuf_try_dissect_field_value_on_multi_types(proto_tree *value_tree, tvbuff_t
 
 static guint
 dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_info *pinfo, proto_tree *protobuf_tree,
-    const PbwDescriptor* message_desc, gboolean is_top_level, const PbwFieldDescriptor** field_desc_ptr)
+    const protobuf_message_plan_t* message_plan, gboolean is_top_level, const protobuf_field_plan_t** field_plan_ptr)
 {
     guint64 tag_value; /* tag value = (field_number << 3) | wire_type */
     guint tag_length; /* how many bytes this tag has */
@@ -787,7 +1016,7 @@ dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_in
     const gchar* field_name = NULL;
     int field_type = -1;
     gboolean is_packed_repeated = FALSE;
-    const PbwFieldDescriptor* field_desc = NULL;
+    const protobuf_field_plan_t* field_plan = NULL;
 
     /* A protocol buffer message is a series of key-value pairs. The binary version of a message just uses
      * the field's number as the key. a wire type that provides just enough information to find the length of
@@ -819,15 +1048,14 @@ dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_in
     (*offset) += tag_length;
 
     /* try to find field_info first */
-    if (message_desc) {
-        /* find field descriptor according to field number from message descriptor */
-        field_desc = pbw_Descriptor_FindFieldByNumber(message_desc, (int) field_number);
-        if (field_desc) {
-            *field_desc_ptr = field_desc;
-            field_name = pbw_FieldDescriptor_name(field_desc);
-            field_type = pbw_FieldDescriptor_type(field_desc);
-            is_packed_repeated = pbw_FieldDescriptor_is_packed(field_desc)
-                && pbw_FieldDescriptor_is_repeated(field_desc);
+    if (message_plan) {
+        /* find field according to field number from the compiled plan of the message */
+        field_plan = protobuf_find_field_plan(message_plan, field_number);
+        if (field_plan) {
+            *field_plan_ptr = field_plan;
+            field_name = field_plan->name;
+            field_type = field_plan->type;
+            is_packed_repeated = field_plan->is_packed_repeated;
         }
     }
 
@@ -913,12 +1141,12 @@ dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_in
     /* add value subtree. we add uint value for numeric field or string for length-delimited at least. */
     value_tree = proto_item_add_subtree(ti_value, ett_protobuf_value);
 
-    if (field_desc) {
+    if (field_plan) {
         if (is_packed_repeated) {
             dissect_packed_repeated_field_values(tvb, *offset, value_length, pinfo, ti_field,
-                wire_type, field_type, "", field_desc);
+                wire_type, field_type, "", field_plan);
         } else {
-            protobuf_dissect_field_value(value_tree, tvb, *offset, value_length, pinfo, ti_field, field_type, value_uint64, "", field_desc,
+            protobuf_dissect_field_value(value_tree, tvb, *offset, value_length, pinfo, ti_field, field_type, value_uint64, "", field_plan,
                                          is_top_level);
         }
     } else {
@@ -939,7 +1167,7 @@ dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_in
         }
     }
 
-    if (field_desc && !show_details) {
+    if (field_plan && !show_details) {
         proto_item_set_hidden(ti_field_number);
         proto_item_set_hidden(ti_wire);
         proto_item_set_hidden(ti_value_length);
@@ -976,12 +1204,11 @@ dissect_one_protobuf_field(tvbuff_t *tvb, guint* offset, guint maxlen, packet_in
  */
 static void
 add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info* pinfo, proto_tree* message_tree,
-    const PbwDescriptor* message_desc, int* parsed_fields, int parsed_fields_count)
+    const protobuf_message_plan_t* message_plan, const gboolean* parsed_fields)
 {
     const PbwFieldDescriptor* field_desc;
-    const gchar* field_name, * field_full_name, * enum_value_name, * string_value;
-    int field_count = pbw_Descriptor_field_count(message_desc);
-    int field_type, i, j;
+    const gchar* field_name, * enum_value_name, * string_value;
+    int field_type, i;
     guint64 field_number;
     gboolean is_required;
     gboolean is_repeated;
@@ -989,7 +1216,7 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
     proto_item* ti_message = proto_tree_get_parent(message_tree);
     proto_item* ti_field, * ti_field_number, * ti_field_name, * ti_field_type, * ti_value, * ti_pbf;
     proto_tree* field_tree, * pbf_tree;
-    int* hf_id_ptr;
+    int hf_id;
     gdouble double_value;
     gfloat float_value;
     gint64 int64_value;
@@ -1000,10 +1227,10 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
     gint size;
     const PbwEnumValueDescriptor* enum_value_desc;
 
-    for (i = 0; i < field_count; i++) {
-        field_desc = pbw_Descriptor_field(message_desc, i);
-        field_number = (guint64) pbw_FieldDescriptor_number(field_desc);
-        field_type = pbw_FieldDescriptor_type(field_desc);
+    for (i = 0; i < message_plan->field_count; i++) {
+        field_desc = message_plan->fields[i].desc;
+        field_number = (guint64) message_plan->fields[i].number;
+        field_type = message_plan->fields[i].type;
         is_required = pbw_FieldDescriptor_is_required(field_desc);
         is_repeated = pbw_FieldDescriptor_is_repeated(field_desc);
         has_default_value = pbw_FieldDescriptor_has_default_value(field_desc);
@@ -1031,19 +1258,11 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             continue;
         }
 
-        /* check if it is parsed */
-        if (parsed_fields && parsed_fields_count > 0) {
-            for (j = 0; j < parsed_fields_count; j++) {
-                if ((guint64) parsed_fields[j] == field_number) {
-                    break;
-                }
-            }
-            if (j < parsed_fields_count) {
-                continue; /* this field is parsed */
-            }
+        if (parsed_fields[i]) {
+            continue; /* this field is parsed */
         }
 
-        field_name = pbw_FieldDescriptor_name(field_desc);
+        field_name = message_plan->fields[i].name;
 
         /* this field is not found in message payload */
         if (is_required) {
@@ -1051,8 +1270,6 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             continue;
         }
 
-        field_full_name = pbw_FieldDescriptor_full_name(field_desc);
-
         /* add common tree item for this field */
         field_tree = proto_tree_add_subtree_format(message_tree, tvb, offset, 0, ett_protobuf_field, &ti_field,
             "Field(%" G_GUINT64_FORMAT "): %s %s", field_number, field_name, "=");
@@ -1066,14 +1283,14 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
         ti_field_number = proto_tree_add_uint64_format(field_tree, hf_protobuf_field_number, tvb, offset, 0, field_number << 3, "Field Number: %" G_GUINT64_FORMAT, field_number);
         proto_item_set_generated(ti_field_number);
 
-        hf_id_ptr = NULL;
-        if (pbf_as_hf && field_full_name) {
-            hf_id_ptr = (int*)g_hash_table_lookup(pbf_hf_hash, field_full_name);
-            DISSECTOR_ASSERT_HINT(hf_id_ptr && (*hf_id_ptr) > 0, "hf must have been initialized properly");
+        hf_id = -1;
+        if (pbf_as_hf) {
+            hf_id = message_plan->fields[i].hf_id;
+            DISSECTOR_ASSERT_HINT(hf_id > 0, "hf must have been initialized properly");
         }
 
         pbf_tree = field_tree;
-        if (pbf_as_hf && hf_id_ptr && !show_details) {
+        if (pbf_as_hf && hf_id > 0 && !show_details) {
             /* set ti_field (Field(x)) item hidden if there is header_field */
             proto_item_set_hidden(ti_field);
             pbf_tree = message_tree;
@@ -1091,8 +1308,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             int32_value = pbw_FieldDescriptor_default_value_int32(field_desc);
             ti_value = proto_tree_add_int(field_tree, hf_protobuf_value_int32, tvb, offset, 0, int32_value);
             proto_item_append_text(ti_field, " %d", int32_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_int(pbf_tree, *hf_id_ptr, tvb, offset, 0, int32_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_int(pbf_tree, hf_id, tvb, offset, 0, int32_value);
             }
             break;
 
@@ -1102,8 +1319,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             int64_value = pbw_FieldDescriptor_default_value_int64(field_desc);
             ti_value = proto_tree_add_int64(field_tree, hf_protobuf_value_int64, tvb, offset, 0, int64_value);
             proto_item_append_text(ti_field, " %" G_GINT64_MODIFIER "d", int64_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_int64(pbf_tree, *hf_id_ptr, tvb, offset, 0, int64_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_int64(pbf_tree, hf_id, tvb, offset, 0, int64_value);
             }
             break;
 
@@ -1112,8 +1329,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             uint32_value = pbw_FieldDescriptor_default_value_uint32(field_desc);
             ti_value = proto_tree_add_uint(field_tree, hf_protobuf_value_uint32, tvb, offset, 0, uint32_value);
             proto_item_append_text(ti_field, " %u", uint32_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_uint(pbf_tree, *hf_id_ptr, tvb, offset, 0, uint32_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_uint(pbf_tree, hf_id, tvb, offset, 0, uint32_value);
             }
             break;
 
@@ -1122,8 +1339,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             uint64_value = pbw_FieldDescriptor_default_value_uint64(field_desc);
             ti_value = proto_tree_add_uint64(field_tree, hf_protobuf_value_uint64, tvb, offset, 0, uint64_value);
             proto_item_append_text(ti_field, " %" G_GINT64_MODIFIER "u", uint64_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_uint64(pbf_tree, *hf_id_ptr, tvb, offset, 0, uint64_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_uint64(pbf_tree, hf_id, tvb, offset, 0, uint64_value);
             }
             break;
 
@@ -1131,8 +1348,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             bool_value = pbw_FieldDescriptor_default_value_bool(field_desc);
             ti_value = proto_tree_add_boolean(field_tree, hf_protobuf_value_bool, tvb, offset, 0, bool_value);
             proto_item_append_text(ti_field, " %s", bool_value ? "true" : "false");
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_boolean(pbf_tree, *hf_id_ptr, tvb, offset, 0, bool_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_boolean(pbf_tree, hf_id, tvb, offset, 0, bool_value);
             }
             break;
 
@@ -1140,8 +1357,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             double_value = pbw_FieldDescriptor_default_value_double(field_desc);
             ti_value = proto_tree_add_double(field_tree, hf_protobuf_value_double, tvb, offset, 0, double_value);
             proto_item_append_text(ti_field, " %lf", double_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_double(pbf_tree, *hf_id_ptr, tvb, offset, 0, double_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_double(pbf_tree, hf_id, tvb, offset, 0, double_value);
             }
             break;
 
@@ -1149,8 +1366,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             float_value = pbw_FieldDescriptor_default_value_float(field_desc);
             ti_value = proto_tree_add_float(field_tree, hf_protobuf_value_float, tvb, offset, 0, float_value);
             proto_item_append_text(ti_field, " %f", float_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_float(pbf_tree, *hf_id_ptr, tvb, offset, 0, float_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_float(pbf_tree, hf_id, tvb, offset, 0, float_value);
             }
             break;
 
@@ -1160,9 +1377,9 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             if (!dissect_bytes_as_string) {
                 ti_value = proto_tree_add_bytes_with_length(field_tree, hf_protobuf_value_data, tvb, offset, 0, (const guint8*) string_value, size);
                 proto_item_append_text(ti_field, " (%d bytes)", size);
-                /* the type of *hf_id_ptr MUST be FT_BYTES now */
-                if (hf_id_ptr) {
-                    ti_pbf = proto_tree_add_bytes_with_length(pbf_tree, *hf_id_ptr, tvb, offset, 0, (const guint8*)string_value, size);
+                /* the type of hf_id MUST be FT_BYTES now */
+                if (hf_id > 0) {
+                    ti_pbf = proto_tree_add_bytes_with_length(pbf_tree, hf_id, tvb, offset, 0, (const guint8*)string_value, size);
                 }
                 break;
             }
@@ -1175,8 +1392,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
             DISSECTOR_ASSERT_HINT(has_default_value && string_value, "String field must have default value!");
             ti_value = proto_tree_add_string(field_tree, hf_protobuf_value_string, tvb, offset, 0, string_value);
             proto_item_append_text(ti_field, " %s", string_value);
-            if (hf_id_ptr) {
-                ti_pbf = proto_tree_add_string(pbf_tree, *hf_id_ptr, tvb, offset, 0, string_value);
+            if (hf_id > 0) {
+                ti_pbf = proto_tree_add_string(pbf_tree, hf_id, tvb, offset, 0, string_value);
             }
             break;
 
@@ -1192,8 +1409,8 @@ add_missing_fields_with_default_values(tvbuff_t* tvb, guint offset, packet_info*
                 } else {
                     proto_item_append_text(ti_field, " %d", int32_value);
                 }
-                if (hf_id_ptr) {
-                    ti_pbf = proto_tree_add_int(pbf_tree, *hf_id_ptr, tvb, offset, 0, int32_value);
+                if (hf_id > 0) {
+                    ti_pbf = proto_tree_add_int(pbf_tree, hf_id, tvb, offset, 0, int32_value);
                 }
                 break;
             } else {
@@ -1234,24 +1451,24 @@ dissect_protobuf_message(tvbuff_t *tvb, guint offset, guint length, packet_info
     proto_item *ti_message, *ti;
     const gchar* message_name = "<UNKNOWN> Message Type";
     guint max_offset = offset + length;
-    const PbwFieldDescriptor* field_desc;
-    int* parsed_fields = NULL; /* store parsed field numbers. end with NULL */
-    int parsed_fields_count = 0;
+    const protobuf_message_plan_t* message_plan = NULL;
+    const protobuf_field_plan_t* field_plan;
+    gboolean* parsed_fields = NULL; /* indexed like message_plan->fields */
     int field_count = 0;
 
     if (message_desc) {
-        message_name = pbw_Descriptor_full_name(message_desc);
-        field_count = pbw_Descriptor_field_count(message_desc);
+        message_plan = protobuf_get_message_plan(message_desc);
+        message_name = message_plan->full_name;
+        field_count = message_plan->field_count;
         if (add_default_value && field_count > 0) {
-            parsed_fields = wmem_alloc0_array(pinfo->pool, int, field_count);
+            parsed_fields = wmem_alloc0_array(pinfo->pool, gboolean, field_count);
         }
     }
 
-    if (pbf_as_hf && message_desc) {
+    if (pbf_as_hf && message_plan) {
         /* support filtering with message name as wireshark field name */
-        int *hf_id_ptr = (int*)g_hash_table_lookup(pbf_hf_hash, message_name);
-        DISSECTOR_ASSERT_HINT(hf_id_ptr && (*hf_id_ptr) > 0, "hf of message should initialized properly");
-        ti_message = proto_tree_add_item(protobuf_tree, *hf_id_ptr, tvb, offset, length, ENC_NA);
+        DISSECTOR_ASSERT_HINT(message_plan->hf_id > 0, "hf of message should initialized properly");
+        ti_message = proto_tree_add_item(protobuf_tree, message_plan->hf_id, tvb, offset, length, ENC_NA);
         proto_item_set_text(ti_message, "Message: %s", message_name);
 
         if (show_details) {
@@ -1287,18 +1504,18 @@ dissect_protobuf_message(tvbuff_t *tvb, guint offset, guint length, packet_info
     /* each time we dissect one protobuf field. */
     while (offset < max_offset)
     {
-        field_desc = NULL;
-        if (!dissect_one_protobuf_field(tvb, &offset, max_offset - offset, pinfo, message_tree, message_desc, is_top_level, &field_desc))
+        field_plan = NULL;
+        if (!dissect_one_protobuf_field(tvb, &offset, max_offset - offset, pinfo, message_tree, message_plan, is_top_level, &field_plan))
             break;
 
-        if (parsed_fields && field_desc) {
-            parsed_fields[parsed_fields_count++] = pbw_FieldDescriptor_number(field_desc);
+        if (parsed_fields && field_plan) {
+            parsed_fields[field_plan - message_plan->fields] = TRUE;
         }
     }
 
     /* add default values for missing fields */
     if (add_default_value && field_count > 0) {
-        add_missing_fields_with_default_values(tvb, offset, pinfo, message_tree, message_desc, parsed_fields, parsed_fields_count);
+        add_missing_fields_with_default_values(tvb, offset, pinfo, message_tree, message_plan, parsed_fields);
     }
 
     if (parsed_fields) {
@@ -1327,6 +1544,27 @@ find_message_type_by_udp_port(packet_info *pinfo)
     return NULL;
 }
 
+/* initialize only the first time the protobuf dissector is called */
+static void
+protobuf_load_on_first_call(void)
+{
+    if (!protobuf_dissector_called) {
+        protobuf_dissector_called = TRUE;
+        protobuf_reinit(PREFS_UPDATE_ALL);
+    }
+}
+
+static void
+protobuf_append_message_name(packet_info *pinfo, const PbwDescriptor* message_desc)
+{
+    if (message_desc) {
+        const char* message_full_name = pbw_Descriptor_full_name(message_desc);
+        if (message_full_name) {
+            col_append_fstr(pinfo->cinfo, COL_INFO, " %s", message_full_name);
+        }
+    }
+}
+
 static int
 dissect_protobuf(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
 {
@@ -1337,11 +1575,7 @@ dissect_protobuf(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     const PbwDescriptor* message_desc = NULL;
     const gchar* data_str = NULL;
 
-    /* initialize only the first time the protobuf dissector is called */
-    if (!protobuf_dissector_called) {
-        protobuf_dissector_called = TRUE;
-        protobuf_reinit(PREFS_UPDATE_ALL);
-    }
+    protobuf_load_on_first_call();
 
     /* may set col_set_str(pinfo->cinfo, COL_PROTOCOL, "PROTOBUF"); */
     col_append_str(pinfo->cinfo, COL_INFO, " (PROTOBUF)");
@@ -1412,12 +1646,7 @@ dissect_protobuf(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
                 }
             }
 
-            if (message_desc) {
-                const char* message_full_name = pbw_Descriptor_full_name(message_desc);
-                if (message_full_name) {
-                    col_append_fstr(pinfo->cinfo, COL_INFO, " %s", message_full_name);
-                }
-            }
+            protobuf_append_message_name(pinfo, message_desc);
         }
 
     } else if (pinfo->ptype == PT_UDP) {
@@ -1430,6 +1659,57 @@ dissect_protobuf(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     return tvb_captured_length(tvb);
 }
 
+protobuf_message_type_t*
+protobuf_find_message_type(const gchar* message_type_name)
+{
+    protobuf_message_type_t* message_type;
+
+    if (protobuf_message_types == NULL) {
+        protobuf_message_types = wmem_map_new(wmem_epan_scope(), g_str_hash, g_str_equal);
+    }
+
+    message_type = (protobuf_message_type_t*)wmem_map_lookup(protobuf_message_types, message_type_name);
+    if (message_type == NULL) {
+        message_type = wmem_new0(wmem_epan_scope(), protobuf_message_type_t);
+        message_type->name = wmem_strdup(wmem_epan_scope(), message_type_name);
+        wmem_map_insert(protobuf_message_types, message_type->name, message_type);
+    }
+    return message_type;
+}
+
+/* "protobuf_message_type" dissector, data is a protobuf_message_type_t* */
+static int
+dissect_protobuf_message_type(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
+{
+    protobuf_message_type_t* message_type = (protobuf_message_type_t*)data;
+    proto_item *ti;
+    proto_tree *protobuf_tree;
+
+    if (message_type == NULL) {
+        return 0;
+    }
+
+    protobuf_load_on_first_call();
+
+    /* look the type up only once per loading of the *.proto files */
+    if (message_type->generation != pbw_pool_generation) {
+        message_type->desc = pbw_DescriptorPool_FindMessageTypeByName(pbw_pool, message_type->name);
+        message_type->generation = pbw_pool_generation;
+    }
+
+    col_append_str(pinfo->cinfo, COL_INFO, " (PROTOBUF)");
+
+    ti = proto_tree_add_item(tree, proto_protobuf, tvb, 0, -1, ENC_NA);
+    protobuf_tree = proto_item_add_subtree(ti, ett_protobuf);
+    proto_item_append_text(ti, ": %s", message_type->name);
+    protobuf_append_message_name(pinfo, message_type->desc);
+
+    dissect_protobuf_message(tvb, 0, tvb_reported_length(tvb), pinfo,
+        protobuf_tree, message_type->desc, FALSE);
+
+    return tvb_captured_length(tvb);
+}
+
 static gboolean
 load_all_files_in_dir(PbwDescriptorPool* pool, const gchar* dir_path)
 {
@@ -1532,6 +1812,9 @@ deregister_header_fields(void)
         g_hash_table_destroy(pbf_hf_hash);
         pbf_hf_hash = NULL;
     }
+
+    /* the compiled plans refer to the header fields */
+    protobuf_clear_message_plans();
 }
 
 /* convert the names of the enum's values to value_string array */
@@ -1720,6 +2003,7 @@ protobuf_reinit(int target)
     const gchar* message_type;
     gboolean loading_completed = TRUE;
     size_t num_proto_paths;
+    char *cache_path;
 
     if (target & PREFS_UPDATE_PROTOBUF_UDP_MESSAGE_TYPES) {
         /* delete protobuf dissector from old udp ports */
@@ -1764,8 +2048,17 @@ protobuf_reinit(int target)
             source_paths[i + 2] = protobuf_search_paths[i].path;
         }
 
-        /* init DescriptorPool of protobuf */
+        /* init DescriptorPool of protobuf, the compiled plans refer to the old descriptors */
+        protobuf_clear_message_plans();
         pbw_reinit_DescriptorPool(&pbw_pool, (const char **)source_paths, buffer_error);
+        pbw_pool_generation++;
+
+        if (cache_protos) {
+            /* restore unchanged .proto files from the parse results of the last loading */
+            cache_path = get_persconffile_path("protobuf_cache", TRUE);
+            pbw_DescriptorPool_open_cache(pbw_pool, cache_path);
+            g_free(cache_path);
+        }
 
         /* load all .proto files in the marked search paths, we can invoke FindMethodByName etc later. */
         for (i = 0; i < num_proto_paths; ++i) {
@@ -1778,6 +2071,9 @@ protobuf_reinit(int target)
             }
         }
 
+        /* the profile directory may not exist yet, the files are parsed again next time */
+        pbw_DescriptorPool_save_cache(pbw_pool);
+
         g_free(source_paths[0]);
         g_free(source_paths[1]);
         g_free(source_paths);
@@ -1969,6 +2265,12 @@ proto_register_protobuf(void)
         " when the Protobuf dissector is called for the first time.",
         &preload_protos);
 
+    prefs_register_bool_preference(protobuf_module, "cache_protos",
+        "Cache parsed .proto files.",
+        "Keep the parse results of .proto files in the profile directory, so that only the files"
+        " changed since they were last loaded are parsed when Wireshark starts or the search paths change.",
+        &cache_protos);
+
     protobuf_search_paths_uat = uat_new("Protobuf Search Paths",
         sizeof(protobuf_search_path_t),
         "protobuf_search_paths",
@@ -2069,6 +2371,10 @@ proto_register_protobuf(void)
     expert_register_field_array(expert_protobuf, ei, array_length(ei));
 
     protobuf_handle = register_dissector("protobuf", dissect_protobuf, proto_protobuf);
+    register_dissector("protobuf_message_type", dissect_protobuf_message_type, proto_protobuf);
+
+    /* dissectors may have been added to protobuf_field_subdissector_table since the plans were compiled */
+    register_init_routine(protobuf_clear_message_plans);
 }
 
 void
@@ -31,6 +31,19 @@
 VALUE_STRING_ENUM(protobuf_wire_type);
 VALUE_STRING_ARRAY_GLOBAL_DCL(protobuf_wire_type);
 
+/* Message type of a dissector that always passes protobuf the same type, e.g.
+ * from a preference or UAT record. Resolving it once saves parsing the
+ * "message," message_type_name data string and looking up the name in the
+ * *.proto files for each packet. Handles are shared by name and stay valid
+ * until the program exits; the type is looked up again after the *.proto
+ * files were reloaded. */
+typedef struct _protobuf_message_type_t protobuf_message_type_t;
+
+/* Returns the handle of a message type like "helloworld.HelloRequest".
+ * Pass it as data to the "protobuf_message_type" dissector, which works like
+ * the "protobuf" dissector given "message," message_type_name as data. */
+protobuf_message_type_t* protobuf_find_message_type(const gchar* message_type_name);
+
 #endif
 
 /*
@@ -38,6 +38,7 @@
 #include <wsutil/report_message.h>
 #include <wsutil/pint.h>
 #include <wsutil/strtoi.h>
+#include <wsutil/tempfile.h>
 #include <wsutil/wsgcrypt.h>
 #include <wsutil/rsa.h>
 #include <wsutil/ws_assert.h>
@@ -5482,6 +5483,95 @@ tls_add_packet_info(gint proto, packet_info *pinfo, guint8 curr_layer_num_ssl)
     return pi;
 }
 
+/*
+ * Decrypted records are kept for the whole capture, so that later passes
+ * and refilters do not run the cipher again. Once more than
+ * ssl_record_cache_limit bytes are kept in memory, further records are
+ * appended to a temporary file and read back when their frame is dissected.
+ */
+static guint64 ssl_record_cache_limit;
+static guint64 ssl_record_cache_used;
+static int     ssl_record_spill_fd = -1;
+static gchar  *ssl_record_spill_name;
+static gint64  ssl_record_spill_size;
+
+void
+ssl_set_record_cache_limit(guint limit_kb)
+{
+    ssl_record_cache_limit = (guint64)limit_kb * 1024;
+}
+
+/* Appends the data of a record to the spill file, returns FALSE if it must
+ * be kept in memory. */
+static gboolean
+ssl_spill_record(SslRecordInfo *rec, const guchar *data, gint data_len)
+{
+    if (ssl_record_spill_fd == -1) {
+        GError *err = NULL;
+
+        ssl_record_spill_fd = create_tempfile(&ssl_record_spill_name, "wireshark_tls", NULL, &err);
+        if (ssl_record_spill_fd == -1) {
+            ssl_debug_printf("%s cannot create spill file: %s\n", G_STRFUNC, err->message);
+            g_clear_error(&err);
+            /* do not try again for every record */
+            ssl_record_cache_limit = 0;
+            return FALSE;
+        }
+    }
+
+    if (ws_lseek64(ssl_record_spill_fd, ssl_record_spill_size, SEEK_SET) == -1 ||
+        ws_write(ssl_record_spill_fd, data, data_len) != data_len) {
+        ssl_debug_printf("%s cannot write spill file: %s\n", G_STRFUNC, g_strerror(errno));
+        return FALSE;
+    }
+
+    rec->plain_data = NULL;
+    rec->spill_offset = ssl_record_spill_size;
+    ssl_record_spill_size += data_len;
+    return TRUE;
+}
+
+static void
+ssl_record_cache_cleanup(void)
+{
+    if (ssl_record_spill_fd != -1) {
+        ws_close(ssl_record_spill_fd);
+        ws_unlink(ssl_record_spill_name);
+        ssl_record_spill_fd = -1;
+    }
+    g_free(ssl_record_spill_name);
+    ssl_record_spill_name = NULL;
+    ssl_record_spill_size = 0;
+    ssl_record_cache_used = 0;
+}
+
+/**
+ * Returns the decrypted data of a record.
+ *
+ * @param scope The scope of the copy if the data is read back from the spill
+ * file, e.g. pinfo->pool.
+ * @param record The record.
+ * @return The data or NULL if the spill file could not be read.
+ */
+const guchar *
+ssl_get_record_data(wmem_allocator_t *scope, const SslRecordInfo *record)
+{
+    guchar *data;
+
+    if (record->plain_data || record->data_len == 0)
+        return record->plain_data;
+
+    data = (guchar *)wmem_alloc(scope, record->data_len);
+    if (ssl_record_spill_fd == -1 ||
+        ws_lseek64(ssl_record_spill_fd, record->spill_offset, SEEK_SET) == -1 ||
+        ws_read(ssl_record_spill_fd, data, record->data_len) != (int)record->data_len) {
+        ssl_debug_printf("%s cannot read spill file: %s\n", G_STRFUNC, g_strerror(errno));
+        wmem_free(scope, data);
+        return NULL;
+    }
+    return data;
+}
+
 /**
  * Remembers the decrypted TLS record fragment (TLSInnerPlaintext in TLS 1.3) to
  * avoid the need for a decoder in the second pass. Additionally, it remembers
@@ -5503,7 +5593,13 @@ ssl_add_record_info(gint proto, packet_info *pinfo, const guchar *data, gint dat
     SslPacketInfo *pi = tls_add_packet_info(proto, pinfo, curr_layer_num_ssl);
 
     rec = wmem_new(wmem_file_scope(), SslRecordInfo);
-    rec->plain_data = (guchar *)wmem_memdup(wmem_file_scope(), data, data_len);
+    if (ssl_record_cache_limit == 0 ||
+        ssl_record_cache_used + data_len <= ssl_record_cache_limit ||
+        !ssl_spill_record(rec, data, data_len)) {
+        rec->plain_data = (guchar *)wmem_memdup(wmem_file_scope(), data, data_len);
+        rec->spill_offset = -1;
+        ssl_record_cache_used += data_len;
+    }
     rec->data_len = data_len;
     rec->id = record_id;
     rec->type = type;
@@ -5536,9 +5632,13 @@ ssl_get_record_info(tvbuff_t *parent_tvb, int proto, packet_info *pinfo, gint re
 
     for (rec = pi->records; rec; rec = rec->next)
         if (rec->id == record_id) {
+            const guchar *data = ssl_get_record_data(pinfo->pool, rec);
+
+            if (!data && rec->data_len)
+                return NULL;
             *matched_record = rec;
             /* link new real_data_tvb with a parent tvb so it is freed when frame dissection is complete */
-            return tvb_new_child_real_data(parent_tvb, rec->plain_data, rec->data_len, rec->data_len);
+            return tvb_new_child_real_data(parent_tvb, data, rec->data_len, rec->data_len);
         }
 
     return NULL;
@@ -5586,6 +5686,9 @@ ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
     g_free(decrypted_data->data);
     g_free(compressed_data->data);
 
+    /* the records referring to the spill file are freed with the file scope */
+    ssl_record_cache_cleanup();
+
     /* close the previous keylog file now that the cache are cleared, this
      * allows the cache to be filled with the full keylog file contents. */
     if (*ssl_keylog_file) {
@@ -10525,6 +10628,14 @@ ssl_common_register_options(module_t *module, ssl_common_options_t *options, gbo
              "\n"
              "(All fields are in hex notation)",
              &(options->keylog_filename), FALSE);
+
+        prefs_register_uint_preference(module, "record_cache_limit",
+             "Decrypted data kept in memory (KB)",
+             "Decrypted records are kept so that the capture is not decrypted again when it is "
+             "dissected anew, e.g. on the second pass of TShark or when applying a display filter. "
+             "Once this amount of decrypted data is in memory, further records are written to a "
+             "temporary file. 0 keeps everything in memory.",
+             10, &(options->record_cache_limit));
 }
 
 void
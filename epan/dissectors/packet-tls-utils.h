@@ -405,7 +405,9 @@ typedef struct {
 } SslDigestAlgo;
 
 typedef struct _SslRecordInfo {
-    guchar *plain_data;     /**< Decrypted data. */
+    guchar *plain_data;     /**< Decrypted data, NULL if it was moved to the
+                                 spill file. Use ssl_get_record_data(). */
+    gint64  spill_offset;   /**< Offset of the decrypted data in the spill file. */
     guint   data_len;       /**< Length of decrypted data. */
     gint    id;             /**< Identifies the exact record within a frame
                                  (there can be multiple records in a frame). */
@@ -531,6 +533,7 @@ typedef struct _ssldecrypt_assoc_t {
 typedef struct ssl_common_options {
     const gchar        *psk;
     const gchar        *keylog_filename;
+    guint               record_cache_limit; /**< In KB, 0 for no limit. */
 } ssl_common_options_t;
 
 /** Map from something to a (pre-)master secret */
@@ -739,6 +742,14 @@ ssl_add_record_info(gint proto, packet_info *pinfo, const guchar *data, gint dat
 extern tvbuff_t*
 ssl_get_record_info(tvbuff_t *parent_tvb, gint proto, packet_info *pinfo, gint record_id, guint8 curr_layer_num_ssl, SslRecordInfo **matched_record);
 
+/* return the decrypted data of a record, read back into scope if it was spilled to disk */
+extern const guchar *
+ssl_get_record_data(wmem_allocator_t *scope, const SslRecordInfo *record);
+
+/* set the amount of decrypted data kept in memory before records are spilled to disk */
+extern void
+ssl_set_record_cache_limit(guint limit_kb);
+
 /* initialize/reset per capture state data (ssl sessions cache) */
 extern void
 ssl_common_init(ssl_master_key_map_t *master_key_map,
@@ -256,7 +256,7 @@ static StringInfo          ssl_compressed_data      = {NULL, 0};
 static StringInfo          ssl_decrypted_data       = {NULL, 0};
 static gint                ssl_decrypted_data_avail = 0;
 static FILE               *ssl_keylog_file          = NULL;
-static ssl_common_options_t ssl_options = { NULL, NULL};
+static ssl_common_options_t ssl_options = { NULL, NULL, 256 * 1024 };
 
 /* List of dissectors to call for TLS data */
 static heur_dissector_list_t ssl_heur_subdissector_list;
@@ -284,6 +284,7 @@ ssl_init(void)
 
     ssl_common_init(&ssl_master_key_map,
                     &ssl_decrypted_data, &ssl_compressed_data);
+    ssl_set_record_cache_limit(ssl_options.record_cache_limit);
     ssl_debug_flush();
 
     /* for "Export TLS Session Keys" */
@@ -420,6 +421,7 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
     follow_record_t * follow_record = NULL;
     const SslRecordInfo *appl_data = NULL;
     const SslPacketInfo *pi = (const SslPacketInfo*)ssl;
+    const guchar        *plain_data;
     show_stream_t        from = FROM_CLIENT;
 
     /* Skip packets without decrypted payload data. */
@@ -452,6 +454,9 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
            already been processed and must be skipped. */
         if (appl_data->seq < follow_info->bytes_written[from]) continue;
 
+        plain_data = ssl_get_record_data(pinfo->pool, appl_data);
+        if (!plain_data && appl_data->data_len) continue;
+
         /* Allocate a follow_record_t to hold the current appl_data
            instance's decrypted data. Even though it would be possible to
            consolidate multiple appl_data instances into a single record, it is
@@ -468,7 +473,7 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
 
         follow_record->data = g_byte_array_sized_new(appl_data->data_len);
         follow_record->data = g_byte_array_append(follow_record->data,
-                                              appl_data->plain_data,
+                                              plain_data,
                                               appl_data->data_len);
 
         /* Add the record to the follow_info structure. */
@@ -1710,7 +1715,7 @@ dissect_ssl_payload(tvbuff_t *decrypted, packet_info *pinfo,
 
     /* try to dissect decrypted data*/
     ssl_debug_printf("%s decrypted len %d\n", G_STRFUNC, record->data_len);
-    ssl_print_data("decrypted app data fragment", record->plain_data, record->data_len);
+    ssl_print_data("decrypted app data fragment", tvb_get_ptr(decrypted, 0, record->data_len), record->data_len);
 
     /* Can we desegment this segment? */
     if (tls_desegment_app_data) {
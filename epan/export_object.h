@@ -69,6 +69,22 @@ WS_DLL_PUBLIC int register_export_object(const int proto_id, tap_packet_cb expor
  */
 WS_DLL_PUBLIC int get_eo_proto_id(register_eo_t* eo);
 
+/** Mark the objects of a protocol as complete when they are added: its
+ * export object handler never changes or looks up an entry it has added.
+ * Users that only save the objects, such as tshark, may then save and free
+ * each object as soon as it is added rather than keep all of them.
+ *
+ * @param proto_id protocol passed to register_export_object
+ */
+WS_DLL_PUBLIC void set_eo_streamable(const int proto_id);
+
+/** Tells whether the objects of an Export Object are complete when added
+ *
+ * @param eo Registered Export Object
+ * @return TRUE if set_eo_streamable was called for its protocol
+ */
+WS_DLL_PUBLIC gboolean get_eo_streamable(register_eo_t* eo);
+
 /** Get string for register_tap_listener call.  Typically of the form <dissector_name>_eo
  *
  * @param eo Registered Export Object
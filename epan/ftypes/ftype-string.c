@@ -17,16 +17,24 @@
 #include <strutil.h>
 #include <wsutil/ws_assert.h>
 
+#define string_is_scoped	fvalue_gboolean1
+
 static void
 string_fvalue_new(fvalue_t *fv)
 {
 	fv->value.string = NULL;
+	fv->string_is_scoped = FALSE;
 }
 
 static void
 string_fvalue_free(fvalue_t *fv)
 {
-	g_free(fv->value.string);
+	/* A scoped string goes away with its wmem scope */
+	if (!fv->string_is_scoped) {
+		g_free(fv->value.string);
+	}
+	fv->value.string = NULL;
+	fv->string_is_scoped = FALSE;
 }
 
 static void
@@ -40,6 +48,18 @@ string_fvalue_set_string(fvalue_t *fv, const gchar *value)
 	fv->value.string = (gchar *)g_strdup(value);
 }
 
+void
+string_fvalue_set_string_scoped(fvalue_t *fv, wmem_allocator_t *scope, const gchar *value)
+{
+	DISSECTOR_ASSERT(value != NULL);
+
+	/* Free up the old value, if we have one */
+	string_fvalue_free(fv);
+
+	fv->value.string = wmem_strdup(scope, value);
+	fv->string_is_scoped = TRUE;
+}
+
 static int
 string_repr_len(fvalue_t *fv, ftrepr_t rtype, int field_display _U_)
 {
@@ -34,6 +34,8 @@ void ftype_register_time(void);
 void ftype_register_tvbuff(void);
 void ftype_register_pcre(void);
 
+void string_fvalue_set_string_scoped(fvalue_t *fv, wmem_allocator_t *scope, const gchar *value);
+
 typedef void (*FvalueNewFunc)(fvalue_t*);
 typedef void (*FvalueFreeFunc)(fvalue_t*);
 
@@ -118,6 +120,12 @@ struct _ftype_t {
 
 /* Free all memory used by an fvalue_t. With MSVC and a
  * libwireshark.dll, we need a special declaration.
+ *
+ * free_value releases only what the value owns outside of any wmem
+ * scope; it must do nothing for a value whose storage was allocated
+ * from a scope, such as a string set with fvalue_set_string_scoped(),
+ * as that goes away with the scope. The protocol tree relies on this
+ * to clean up only the values that need it when a packet is done.
  */
 
 #define FVALUE_CLEANUP(fv)					\
@@ -533,6 +533,14 @@ fvalue_set_string(fvalue_t *fv, const gchar *value)
 	fv->ftype->set_value.set_value_string(fv, value);
 }
 
+void
+fvalue_set_string_scoped(fvalue_t *fv, wmem_allocator_t *scope, const gchar *value)
+{
+	ws_assert(IS_FT_STRING(fv->ftype->ftype) ||
+			fv->ftype->ftype == FT_UINT_STRING);
+	string_fvalue_set_string_scoped(fv, scope, value);
+}
+
 void
 fvalue_set_protocol(fvalue_t *fv, tvbuff_t *value, const gchar *name)
 {
@@ -304,6 +304,12 @@ fvalue_set_time(fvalue_t *fv, const nstime_t *value);
 void
 fvalue_set_string(fvalue_t *fv, const gchar *value);
 
+/* Like fvalue_set_string(), but copies the string into the wmem scope.
+ * The fvalue then owns nothing that has to be cleaned up; the string
+ * lives until the scope is freed. */
+void
+fvalue_set_string_scoped(fvalue_t *fv, wmem_allocator_t *scope, const gchar *value);
+
 void
 fvalue_set_protocol(fvalue_t *fv, tvbuff_t *value, const gchar *name);
 
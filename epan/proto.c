@@ -49,6 +49,10 @@
 
 #include <wsutil/crash_info.h>
 #include <wsutil/epochs.h>
+#include <wsutil/privileges.h>
+#ifdef HAVE_PLUGINS
+#include <wsutil/plugins.h>
+#endif
 
 /* Ptvcursor limits */
 #define SUBTREE_ONCE_ALLOCATION_NUMBER 8
@@ -264,7 +268,7 @@ proto_tree_set_bytes_gbytearray(field_info *fi, const GByteArray *value);
 static void
 proto_tree_set_time(field_info *fi, const nstime_t *value_ptr);
 static void
-proto_tree_set_string(field_info *fi, const char* value);
+proto_tree_set_string(wmem_allocator_t *scope, field_info *fi, const char* value);
 static void
 proto_tree_set_ax25(field_info *fi, const guint8* value);
 static void
@@ -489,6 +493,397 @@ call_plugin_register_handoff(gpointer data, gpointer user_data _U_)
 	}
 }
 
+/*
+ * Registry snapshot.
+ *
+ * Registration enters every field in gpa_name_map, some 200,000 of them
+ * at each start. When WIRESHARK_REGISTRY_SNAPSHOT names a file, the name
+ * map built by the registration in proto_init() is written there, and
+ * the next start uses it from the memory-mapped file instead of filling
+ * the hash table again.
+ *
+ * Registration itself still runs: it sets the hf variables of the
+ * dissectors and fills the dissector tables with handles and function
+ * pointers, none of which can be restored from a file. Every field
+ * registered is compared with the snapshot by its position and name, so
+ * a snapshot that doesn't match the dissectors and plugins any more is
+ * only used up to the first difference. It is then written again. The
+ * fields registered after that, and after proto_init(), are entered in
+ * gpa_name_map, which is searched first.
+ *
+ * Layout (native byte order, the snapshot is only valid on the machine
+ * that wrote it):
+ *   header           proto_snapshot_header_t
+ *   key              version and plugins, NUL-terminated, padded to 4 bytes
+ *   name offsets     u32 per field id, offset of the name in the strings
+ *   same name prev   i32 per field id, id of the previous field with that
+ *                    name, -1 if none
+ *   buckets          u32 open addressing hash table of names, id + 1 of
+ *                    the last field with a name, 0 if empty
+ *   strings          NUL-terminated field names
+ */
+
+#define PROTO_SNAPSHOT_MAGIC "WSRS"
+/* Increase it whenever the layout changes. */
+#define PROTO_SNAPSHOT_VERSION 1
+#define PROTO_SNAPSHOT_BYTE_ORDER 0x01020304
+
+typedef struct {
+	char    magic[4];
+	guint32 version;
+	guint32 byte_order;
+	guint32 key_length;
+	guint32 field_count;
+	guint32 bucket_count;
+	guint32 strings_length;
+} proto_snapshot_header_t;
+
+typedef struct {
+	GMappedFile   *mapped;
+	guint32        field_count;
+	guint32        bucket_mask;
+	const guint32 *name_offsets;
+	const gint32  *same_name_prev;
+	const guint32 *buckets;
+	const char    *strings;
+	guint32        verified;  /* fields 0 to verified - 1 match the snapshot */
+	gboolean       verifying; /* still comparing registered fields with it */
+} proto_snapshot_t;
+
+static char *registry_snapshot_path = NULL;
+static proto_snapshot_t *registry_snapshot = NULL;
+
+/* FNV-1a, the snapshot must not depend on the hash function of GLib */
+static guint32
+proto_snapshot_hash(const char *name)
+{
+	guint32 hash = 2166136261U;
+
+	while (*name) {
+		hash ^= (guint8)*name++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+#ifdef HAVE_PLUGINS
+static void
+proto_snapshot_add_plugin(const char *name, const char *version,
+			  const char *types _U_, const char *filename _U_,
+			  void *user_data)
+{
+	g_string_append_printf((GString *)user_data, " %s/%s", name, version);
+}
+#endif
+
+/* The build and the set of plugins the snapshot was written for */
+static char *
+proto_snapshot_key(void)
+{
+	GString *key = g_string_new(VERSION);
+
+	g_string_append_printf(key, " %u", (guint)sizeof(header_field_info));
+#ifdef HAVE_PLUGINS
+	plugins_get_descriptions(proto_snapshot_add_plugin, key);
+#endif
+	return g_string_free(key, FALSE);
+}
+
+static guint32
+proto_snapshot_key_length(guint32 length)
+{
+	/* keeps the arrays after the key aligned */
+	return (length + 1 + 3) & ~3U;
+}
+
+/* Check the mapped snapshot and set up snapshot to use it */
+static gboolean
+proto_snapshot_check(proto_snapshot_t *snapshot)
+{
+	const char *data = g_mapped_file_get_contents(snapshot->mapped);
+	gsize length = g_mapped_file_get_length(snapshot->mapped);
+	proto_snapshot_header_t header;
+	char *key;
+	guint64 offset;
+	guint32 used;
+	guint32 i;
+
+	if (data == NULL || length < sizeof header) {
+		return FALSE;
+	}
+
+	memcpy(&header, data, sizeof header);
+	if (memcmp(header.magic, PROTO_SNAPSHOT_MAGIC, sizeof header.magic) != 0
+	    || header.version != PROTO_SNAPSHOT_VERSION
+	    || header.byte_order != PROTO_SNAPSHOT_BYTE_ORDER
+	    || header.bucket_count == 0
+	    || (header.bucket_count & (header.bucket_count - 1)) != 0
+	    || header.strings_length == 0) {
+		return FALSE;
+	}
+
+	offset = sizeof header + (guint64)proto_snapshot_key_length(header.key_length)
+		+ (guint64)header.field_count * 8 + (guint64)header.bucket_count * 4;
+	if (offset + header.strings_length != length) {
+		return FALSE;
+	}
+
+	key = proto_snapshot_key();
+	if (strlen(key) != header.key_length
+	    || memcmp(data + sizeof header, key, header.key_length + 1) != 0) {
+		g_free(key);
+		return FALSE;
+	}
+	g_free(key);
+
+	snapshot->field_count = header.field_count;
+	snapshot->bucket_mask = header.bucket_count - 1;
+	snapshot->name_offsets = (const guint32 *)(data + sizeof header + proto_snapshot_key_length(header.key_length));
+	snapshot->same_name_prev = (const gint32 *)(snapshot->name_offsets + header.field_count);
+	snapshot->buckets = (const guint32 *)(snapshot->same_name_prev + header.field_count);
+	snapshot->strings = (const char *)(snapshot->buckets + header.bucket_count);
+
+	/* Everything used by proto_snapshot_lookup() must be in bounds */
+	if (snapshot->strings[header.strings_length - 1] != '\0') {
+		return FALSE;
+	}
+	for (i = 0; i < header.field_count; i++) {
+		if (snapshot->name_offsets[i] >= header.strings_length
+		    || snapshot->same_name_prev[i] < -1
+		    || snapshot->same_name_prev[i] >= (gint32)i) {
+			return FALSE;
+		}
+	}
+	used = 0;
+	for (i = 0; i < header.bucket_count; i++) {
+		if (snapshot->buckets[i] > header.field_count) {
+			return FALSE;
+		}
+		if (snapshot->buckets[i] != 0) {
+			used++;
+		}
+	}
+	/* the probing in proto_snapshot_lookup() needs an empty bucket */
+	return used < header.bucket_count;
+}
+
+static void
+proto_snapshot_open(void)
+{
+	const char *path = g_getenv("WIRESHARK_REGISTRY_SNAPSHOT");
+	proto_snapshot_t *snapshot;
+
+	if (path == NULL || path[0] == '\0' || started_with_special_privs()) {
+		return;
+	}
+	registry_snapshot_path = g_strdup(path);
+
+	snapshot = g_new0(proto_snapshot_t, 1);
+	snapshot->mapped = g_mapped_file_new(path, FALSE, NULL);
+	if (snapshot->mapped == NULL || !proto_snapshot_check(snapshot)) {
+		/* missing or written for something else, it will be replaced */
+		if (snapshot->mapped) {
+			g_mapped_file_unref(snapshot->mapped);
+		}
+		g_free(snapshot);
+		return;
+	}
+	snapshot->verifying = TRUE;
+	registry_snapshot = snapshot;
+}
+
+/* Find the last field registered with a name among the ones verified */
+static header_field_info *
+proto_snapshot_lookup(const char *field_name)
+{
+	proto_snapshot_t *snapshot = registry_snapshot;
+	guint32 i = proto_snapshot_hash(field_name) & snapshot->bucket_mask;
+	gint32 id;
+
+	while (snapshot->buckets[i] != 0) {
+		id = (gint32)snapshot->buckets[i] - 1;
+		if (strcmp(snapshot->strings + snapshot->name_offsets[id], field_name) == 0) {
+			while (id != -1 && (guint32)id >= snapshot->verified) {
+				id = snapshot->same_name_prev[id];
+			}
+			return (id == -1) ? NULL : gpa_hfinfo.hfi[id];
+		}
+		i = (i + 1) & snapshot->bucket_mask;
+	}
+	return NULL;
+}
+
+/* Called by proto_register_field_init() for a field that was just given
+ * its id. Returns TRUE, with same_name_hfinfo set to the field registered
+ * before it under the same name, if the snapshot has the field. */
+static gboolean
+proto_snapshot_verify(const header_field_info *hfinfo)
+{
+	proto_snapshot_t *snapshot = registry_snapshot;
+	gint32 prev;
+
+	if (snapshot == NULL || !snapshot->verifying) {
+		return FALSE;
+	}
+
+	if ((guint32)hfinfo->id != snapshot->verified
+	    || snapshot->verified >= snapshot->field_count
+	    || strcmp(snapshot->strings + snapshot->name_offsets[hfinfo->id], hfinfo->abbrev) != 0) {
+		/* Stale; the fields verified so far are still found in it */
+		snapshot->verifying = FALSE;
+		return FALSE;
+	}
+
+	prev = snapshot->same_name_prev[hfinfo->id];
+	same_name_hfinfo = (prev == -1) ? NULL : gpa_hfinfo.hfi[prev];
+	snapshot->verified++;
+	return TRUE;
+}
+
+/* Look up a field name in gpa_name_map and then in the snapshot */
+static header_field_info *
+proto_name_map_lookup(const char *field_name)
+{
+	header_field_info *hfinfo;
+
+	hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
+	if (hfinfo == NULL && registry_snapshot) {
+		hfinfo = proto_snapshot_lookup(field_name);
+	}
+	return hfinfo;
+}
+
+/* Enter the fields found in the snapshot in gpa_name_map and close it.
+ * Done before a field is deregistered, which the snapshot can't follow. */
+static void
+proto_snapshot_release(void)
+{
+	proto_snapshot_t *snapshot = registry_snapshot;
+	header_field_info *hfinfo;
+	header_field_info *existing;
+	guint32 id;
+
+	if (snapshot == NULL) {
+		return;
+	}
+
+	for (id = 0; id < snapshot->verified; id++) {
+		hfinfo = gpa_hfinfo.hfi[id];
+		if (hfinfo == NULL) {
+			continue;
+		}
+		/* Fields in gpa_name_map were registered after these */
+		existing = (header_field_info *)g_hash_table_lookup(gpa_name_map, hfinfo->abbrev);
+		if (existing == NULL || (guint32)existing->id < snapshot->verified) {
+			g_hash_table_insert(gpa_name_map, (gpointer) (hfinfo->abbrev), hfinfo);
+		}
+	}
+	same_name_hfinfo = NULL;
+
+	g_mapped_file_unref(snapshot->mapped);
+	g_free(snapshot);
+	registry_snapshot = NULL;
+}
+
+/* Write the name map of the fields registered so far, unless the
+ * snapshot already has exactly them */
+static void
+proto_snapshot_save(void)
+{
+	proto_snapshot_header_t header;
+	header_field_info *hfinfo;
+	GByteArray *strings;
+	guint32 *name_offsets;
+	gint32 *same_name_prev;
+	guint32 *buckets;
+	guint32 bucket_count;
+	guint32 i, id;
+	char *key;
+	GByteArray *buf;
+
+	if (registry_snapshot_path == NULL) {
+		return;
+	}
+
+	if (registry_snapshot) {
+		if (registry_snapshot->verifying && registry_snapshot->verified == gpa_hfinfo.len
+		    && registry_snapshot->verified == registry_snapshot->field_count) {
+			/* up to date */
+			registry_snapshot->verifying = FALSE;
+			return;
+		}
+		/* the old file can not be replaced while it is mapped on some systems */
+		proto_snapshot_release();
+	}
+
+	/* The chains of same name fields changed */
+	if (deregistered_fields->len != 0) {
+		return;
+	}
+
+	for (id = 0; id < gpa_hfinfo.len; id++) {
+		hfinfo = gpa_hfinfo.hfi[id];
+		if (hfinfo == NULL || hfinfo->name[0] == 0 || hfinfo->abbrev[0] == 0) {
+			/* not in gpa_name_map */
+			return;
+		}
+	}
+
+	bucket_count = 2;
+	while (bucket_count < 2 * gpa_hfinfo.len) {
+		bucket_count *= 2;
+	}
+
+	name_offsets = g_new(guint32, gpa_hfinfo.len);
+	same_name_prev = g_new(gint32, gpa_hfinfo.len);
+	buckets = g_new0(guint32, bucket_count);
+	strings = g_byte_array_new();
+
+	for (id = 0; id < gpa_hfinfo.len; id++) {
+		hfinfo = gpa_hfinfo.hfi[id];
+		name_offsets[id] = strings->len;
+		g_byte_array_append(strings, (const guint8 *)hfinfo->abbrev, (guint)strlen(hfinfo->abbrev) + 1);
+		same_name_prev[id] = hfinfo->same_name_prev_id;
+
+		i = proto_snapshot_hash(hfinfo->abbrev) & (bucket_count - 1);
+		while (buckets[i] != 0
+		       && strcmp((const char *)strings->data + name_offsets[buckets[i] - 1], hfinfo->abbrev) != 0) {
+			i = (i + 1) & (bucket_count - 1);
+		}
+		buckets[i] = id + 1;
+	}
+
+	key = proto_snapshot_key();
+	memcpy(header.magic, PROTO_SNAPSHOT_MAGIC, sizeof header.magic);
+	header.version = PROTO_SNAPSHOT_VERSION;
+	header.byte_order = PROTO_SNAPSHOT_BYTE_ORDER;
+	header.key_length = (guint32)strlen(key);
+	header.field_count = gpa_hfinfo.len;
+	header.bucket_count = bucket_count;
+	header.strings_length = strings->len;
+
+	buf = g_byte_array_new();
+	g_byte_array_append(buf, (const guint8 *)&header, sizeof header);
+	g_byte_array_set_size(buf, (guint)(sizeof header + proto_snapshot_key_length(header.key_length)));
+	memset(buf->data + sizeof header, 0, proto_snapshot_key_length(header.key_length));
+	memcpy(buf->data + sizeof header, key, header.key_length);
+	g_byte_array_append(buf, (const guint8 *)name_offsets, gpa_hfinfo.len * 4);
+	g_byte_array_append(buf, (const guint8 *)same_name_prev, gpa_hfinfo.len * 4);
+	g_byte_array_append(buf, (const guint8 *)buckets, bucket_count * 4);
+	g_byte_array_append(buf, strings->data, strings->len);
+
+	if (!g_file_set_contents(registry_snapshot_path, (const gchar *)buf->data, buf->len, NULL)) {
+		ws_warning("Can't write the registry snapshot %s", registry_snapshot_path);
+	}
+
+	g_byte_array_free(buf, TRUE);
+	g_free(key);
+	g_byte_array_free(strings, TRUE);
+	g_free(buckets);
+	g_free(same_name_prev);
+	g_free(name_offsets);
+}
+
 /* initialize data structures and register protocols and fields */
 void
 proto_init(GSList *register_all_plugin_protocols_list,
@@ -511,6 +906,9 @@ proto_init(GSList *register_all_plugin_protocols_list,
 	deregistered_data        = g_ptr_array_new();
 	deregistered_slice       = g_ptr_array_new();
 
+	/* Use the name map of the last registration, if there is one */
+	proto_snapshot_open();
+
 	/* Initialize the ftype subsystem */
 	ftypes_initialize();
 
@@ -560,6 +958,9 @@ proto_init(GSList *register_all_plugin_protocols_list,
 		(*cb)(RA_PLUGIN_HANDOFF, NULL, client_data);
 	g_slist_foreach(dissector_plugins, call_plugin_register_handoff, NULL);
 
+	/* Fields registered from now on depend on the preferences and such */
+	proto_snapshot_save();
+
 	/* sort the protocols by protocol name */
 	protocols = g_list_sort(protocols, proto_compare_name);
 
@@ -579,6 +980,13 @@ proto_cleanup_base(void)
 		g_hash_table_destroy(gpa_name_map);
 		gpa_name_map = NULL;
 	}
+	if (registry_snapshot) {
+		g_mapped_file_unref(registry_snapshot->mapped);
+		g_free(registry_snapshot);
+		registry_snapshot = NULL;
+	}
+	g_free(registry_snapshot_path);
+	registry_snapshot_path = NULL;
 	if (gpa_protocol_aliases) {
 		g_hash_table_destroy(gpa_protocol_aliases);
 		gpa_protocol_aliases = NULL;
@@ -755,14 +1163,20 @@ free_GPtrArray_value(gpointer key, gpointer value, gpointer user_data _U_)
 	g_ptr_array_free(ptrs, TRUE);
 }
 
+/* Clean up the field values that own memory outside of the packet pool.
+ * The nodes, their field_infos and the strings of string fields are all
+ * allocated from the pool and go with it, so the tree isn't walked. */
 static void
-proto_tree_free_node(proto_node *node, gpointer data _U_)
+proto_tree_cleanup_fvalues(tree_data_t *tree_data)
 {
-	field_info *finfo  = PNODE_FINFO(node);
+	guint i;
 
-	proto_tree_children_foreach(node, proto_tree_free_node, NULL);
+	for (i = 0; i < tree_data->owned_fvalues->len; i++) {
+		fvalue_t *fv = (fvalue_t *)g_ptr_array_index(tree_data->owned_fvalues, i);
 
-	FVALUE_CLEANUP(&finfo->value);
+		FVALUE_CLEANUP(fv);
+	}
+	g_ptr_array_set_size(tree_data->owned_fvalues, 0);
 }
 
 void
@@ -770,7 +1184,7 @@ proto_tree_reset(proto_tree *tree)
 {
 	tree_data_t *tree_data = PTREE_DATA(tree);
 
-	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
+	proto_tree_cleanup_fvalues(tree_data);
 
 	/* free tree data */
 	if (tree_data->interesting_hfids) {
@@ -794,7 +1208,7 @@ proto_tree_free(proto_tree *tree)
 {
 	tree_data_t *tree_data = PTREE_DATA(tree);
 
-	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
+	proto_tree_cleanup_fvalues(tree_data);
 
 	/* free tree data */
 	if (tree_data->interesting_hfids) {
@@ -806,6 +1220,8 @@ proto_tree_free(proto_tree *tree)
 		g_hash_table_destroy(tree_data->interesting_hfids);
 	}
 
+	g_ptr_array_free(tree_data->owned_fvalues, TRUE);
+
 	g_slice_free(tree_data_t, tree_data);
 
 	g_slice_free(proto_tree, tree);
@@ -961,7 +1377,7 @@ proto_registrar_get_byname(const char *field_name)
 		return last_hfinfo;
 	}
 
-	hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
+	hfinfo = proto_name_map_lookup(field_name);
 
 	if (hfinfo) {
 		g_free(last_field_name);
@@ -980,7 +1396,7 @@ proto_registrar_get_byname(const char *field_name)
 		return NULL;
 	}
 
-	hfinfo = (header_field_info *)g_hash_table_lookup(gpa_name_map, field_name);
+	hfinfo = proto_name_map_lookup(field_name);
 
 	if (hfinfo) {
 		g_free(last_field_name);
@@ -2852,7 +3268,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 		case FT_STRING:
 			stringval = get_string_value(PNODE_POOL(tree),
 			    tvb, start, length, &length, encoding);
-			proto_tree_set_string(new_fi, stringval);
+			proto_tree_set_string(PNODE_POOL(tree), new_fi, stringval);
 
 			/* Instead of calling proto_item_set_len(), since we
 			 * don't yet have a proto_item, we set the
@@ -2869,7 +3285,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 		case FT_STRINGZ:
 			stringval = get_stringz_value(PNODE_POOL(tree),
 			    tree, tvb, start, length, &length, encoding);
-			proto_tree_set_string(new_fi, stringval);
+			proto_tree_set_string(PNODE_POOL(tree), new_fi, stringval);
 
 			/* Instead of calling proto_item_set_len(),
 			 * since we don't yet have a proto_item, we
@@ -2900,7 +3316,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 				encoding = ENC_ASCII|ENC_LITTLE_ENDIAN;
 			stringval = get_uint_string_value(PNODE_POOL(tree),
 			    tree, tvb, start, length, &length, encoding);
-			proto_tree_set_string(new_fi, stringval);
+			proto_tree_set_string(PNODE_POOL(tree), new_fi, stringval);
 
 			/* Instead of calling proto_item_set_len(), since we
 			 * don't yet have a proto_item, we set the
@@ -2917,7 +3333,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 		case FT_STRINGZPAD:
 			stringval = get_stringzpad_value(PNODE_POOL(tree),
 			    tvb, start, length, &length, encoding);
-			proto_tree_set_string(new_fi, stringval);
+			proto_tree_set_string(PNODE_POOL(tree), new_fi, stringval);
 
 			/* Instead of calling proto_item_set_len(), since we
 			 * don't yet have a proto_item, we set the
@@ -2934,7 +3350,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 		case FT_STRINGZTRUNC:
 			stringval = get_stringztrunc_value(PNODE_POOL(tree),
 			    tvb, start, length, &length, encoding);
-			proto_tree_set_string(new_fi, stringval);
+			proto_tree_set_string(PNODE_POOL(tree), new_fi, stringval);
 
 			/* Instead of calling proto_item_set_len(), since we
 			 * don't yet have a proto_item, we set the
@@ -3723,7 +4139,7 @@ proto_tree_add_item_ret_string_and_length(proto_tree *tree, int hfindex,
 
 	new_fi = new_field_info(tree, hfinfo, tvb, start, *lenretval);
 
-	proto_tree_set_string(new_fi, value);
+	proto_tree_set_string(PNODE_POOL(tree), new_fi, value);
 
 	new_fi->flags |= (encoding & ENC_LITTLE_ENDIAN) ? FI_LITTLE_ENDIAN : FI_BIG_ENDIAN;
 
@@ -3825,7 +4241,7 @@ proto_tree_add_item_ret_display_string_and_length(proto_tree *tree, int hfindex,
 	case FT_UINT_STRING:
 	case FT_STRINGZPAD:
 	case FT_STRINGZTRUNC:
-		proto_tree_set_string(new_fi, value);
+		proto_tree_set_string(PNODE_POOL(tree), new_fi, value);
 		break;
 
 	case FT_BYTES:
@@ -4965,7 +5381,7 @@ proto_tree_add_string(proto_tree *tree, int hfindex, tvbuff_t *tvb, gint start,
 
 	pi = proto_tree_add_pi(tree, hfinfo, tvb, start, &length);
 	DISSECTOR_ASSERT(length >= 0);
-	proto_tree_set_string(PNODE_FINFO(pi), value);
+	proto_tree_set_string(PNODE_POOL(tree), PNODE_FINFO(pi), value);
 
 	return pi;
 }
@@ -5011,16 +5427,16 @@ proto_tree_add_string_format(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 
 /* Set the FT_STRING value */
 static void
-proto_tree_set_string(field_info *fi, const char* value)
+proto_tree_set_string(wmem_allocator_t *scope, field_info *fi, const char* value)
 {
 	if (value) {
-		fvalue_set_string(&fi->value, value);
+		fvalue_set_string_scoped(&fi->value, scope, value);
 	} else {
 		/*
 		 * XXX - why is a null value for a string field
 		 * considered valid?
 		 */
-		fvalue_set_string(&fi->value, "[ Null ]");
+		fvalue_set_string_scoped(&fi->value, scope, "[ Null ]");
 	}
 }
 
@@ -6269,6 +6685,13 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 	fvalue_init(&fi->value, fi->hfinfo->type);
 	fi->rep        = NULL;
 
+	/* Strings are set in the packet pool by proto_tree_set_string();
+	 * other values that may own memory, like byte arrays and protocol
+	 * names, are cleaned up when the tree is reset. */
+	if (fi->value.ftype->free_value &&
+	    !(IS_FT_STRING(hfinfo->type) || hfinfo->type == FT_UINT_STRING))
+		g_ptr_array_add(PTREE_DATA(tree)->owned_fvalues, &fi->value);
+
 	/* add the data source tvbuff */
 	fi->ds_tvb = tvb ? tvb_get_ds_tvb(tvb) : NULL;
 
@@ -6382,6 +6805,8 @@ hfinfo_remove_from_gpa_name_map(const header_field_info *hfinfo)
 	g_free(last_field_name);
 	last_field_name = NULL;
 
+	proto_snapshot_release();
+
 	if (!hfinfo->same_name_next && hfinfo->same_name_prev_id == -1) {
 		/* No hfinfo with the same name */
 		g_hash_table_steal(gpa_name_map, hfinfo->abbrev);
@@ -7174,6 +7599,8 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Keep track of the number of children */
 	pnode->tree_data->count = 0;
 
+	pnode->tree_data->owned_fvalues = g_ptr_array_new();
+
 	return (proto_tree *)pnode;
 }
 
@@ -7564,6 +7991,7 @@ proto_deregister_protocol(const char *short_name)
 	protocols = g_list_remove(protocols, protocol);
 
 	g_ptr_array_add(deregistered_fields, gpa_hfinfo.hfi[proto_id]);
+	proto_snapshot_release();
 	g_hash_table_steal(gpa_name_map, protocol->filter_name);
 
 	g_free(last_field_name);
@@ -8058,6 +8486,7 @@ proto_deregister_field (const int parent, gint hf_id)
 		hfi = (header_field_info *)g_ptr_array_index(proto->fields, i);
 		if (hfi->id == hf_id) {
 			/* Found the hf_id in this protocol */
+			proto_snapshot_release();
 			g_hash_table_steal(gpa_name_map, hfi->abbrev);
 			g_ptr_array_remove_index_fast(proto->fields, i);
 			g_ptr_array_add(deregistered_fields, gpa_hfinfo.hfi[hf_id]);
@@ -8936,10 +9365,14 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 
 		same_name_hfinfo = NULL;
 
-		g_hash_table_insert(gpa_name_map, (gpointer) (hfinfo->abbrev), hfinfo);
-		/* GLIB 2.x - if it is already present
-		 * the previous hfinfo with the same name is saved
-		 * to same_name_hfinfo by value destroy callback */
+		if (!proto_snapshot_verify(hfinfo)) {
+			g_hash_table_insert(gpa_name_map, (gpointer) (hfinfo->abbrev), hfinfo);
+			/* GLIB 2.x - if it is already present
+			 * the previous hfinfo with the same name is saved
+			 * to same_name_hfinfo by value destroy callback */
+			if (!same_name_hfinfo && registry_snapshot)
+				same_name_hfinfo = proto_snapshot_lookup(hfinfo->abbrev);
+		}
 		if (same_name_hfinfo) {
 			/* There's already a field with this name.
 			 * Put the current field *before* that field
@@ -10490,8 +10923,8 @@ proto_check_for_protocol_or_field(const proto_tree* tree, const int id)
 /* Return GPtrArray* of field_info pointers for all hfindex that appear in tree.
  * This only works if the hfindex was "primed" before the dissection
  * took place, as we just pass back the already-created GPtrArray*.
- * The caller should *not* free the GPtrArray*; proto_tree_free_node()
- * handles that. */
+ * The caller should *not* free the GPtrArray*; proto_tree_reset() and
+ * proto_tree_free() handle that. */
 GPtrArray *
 proto_get_finfo_ptr_array(const proto_tree *tree, const int id)
 {
@@ -13025,7 +13458,7 @@ proto_tree_add_ts_23_038_7bits_packed_item(proto_tree *tree, const int hfindex,
 
 	pi = proto_tree_add_pi(tree, hfinfo, tvb, byte_offset, &byte_length);
 	DISSECTOR_ASSERT(byte_length >= 0);
-	proto_tree_set_string(PNODE_FINFO(pi), string);
+	proto_tree_set_string(PNODE_POOL(tree), PNODE_FINFO(pi), string);
 
 	return pi;
 }
@@ -13057,7 +13490,7 @@ proto_tree_add_ascii_7bits_item(proto_tree *tree, const int hfindex, tvbuff_t *t
 
 	pi = proto_tree_add_pi(tree, hfinfo, tvb, byte_offset, &byte_length);
 	DISSECTOR_ASSERT(byte_length >= 0);
-	proto_tree_set_string(PNODE_FINFO(pi), string);
+	proto_tree_set_string(PNODE_POOL(tree), PNODE_FINFO(pi), string);
 
 	return pi;
 }
@@ -866,6 +866,7 @@ typedef struct {
     gboolean             fake_protocols;
     guint                count;
     struct _packet_info *pinfo;
+    GPtrArray           *owned_fvalues; /**< values to clean up on reset */
 } tree_data_t;
 
 /** Each proto_tree, proto_item is one of these. */
@@ -45,6 +45,16 @@ pbw_load_proto_file(PbwDescriptorPool* pool, const char* filename) {
     }
 }
 
+void
+pbw_DescriptorPool_open_cache(PbwDescriptorPool* pool, const char* cache_path) {
+    pbl_descriptor_pool_open_cache((pbl_descriptor_pool_t*) pool, cache_path);
+}
+
+gboolean
+pbw_DescriptorPool_save_cache(PbwDescriptorPool* pool) {
+    return pbl_descriptor_pool_save_cache((pbl_descriptor_pool_t*) pool);
+}
+
 /* like DescriptorPool::FindMethodByName */
 const PbwMethodDescriptor*
 pbw_DescriptorPool_FindMethodByName(const PbwDescriptorPool* pool, const char* name) {
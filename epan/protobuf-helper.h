@@ -85,6 +85,18 @@ pbw_reinit_DescriptorPool(PbwDescriptorPool** pool, const char** directories, pb
 int
 pbw_load_proto_file(PbwDescriptorPool* pool, const char* filename);
 
+/**
+ Restore the .proto files that did not change since they were saved in a cache file, instead of parsing
+ them again, while loading files into the pool.
+ @param pool  The pool.
+ @param cache_path  The path of the cache file. It need not exist. */
+void
+pbw_DescriptorPool_open_cache(PbwDescriptorPool* pool, const char* cache_path);
+
+/* save all files loaded into the pool to the cache file and close it, return FALSE if the file could not be written */
+gboolean
+pbw_DescriptorPool_save_cache(PbwDescriptorPool* pool);
+
 /* like DescriptorPool::FindMethodByName */
 const PbwMethodDescriptor*
 pbw_DescriptorPool_FindMethodByName(const PbwDescriptorPool* pool, const char* name);
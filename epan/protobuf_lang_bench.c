@@ -0,0 +1,168 @@
+/* protobuf_lang_bench.c
+ * Standalone program to measure loading .proto files with and without the parse cache.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* Usage: protobuf_lang_bench <directory of .proto files> [<iterations>]
+ *
+ * Every iteration loads all .proto files in the directory three times:
+ *   parse  without a cache, like before the cache was added
+ *   cold   parsing everything and writing a new cache file
+ *   warm   restoring everything from the cache file written by the cold start
+ * and checks that the warm start finds the same messages as parsing.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+#include <ws_attributes.h>
+
+#include "protobuf-helper.h"
+
+static PbwDescriptorPool* bench_pool = NULL;
+static gboolean failed = FALSE;
+
+static void
+report_error(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
+
+static gboolean
+load_all_files_in_dir(PbwDescriptorPool* pool, const gchar* dir_path)
+{
+    WS_DIR *dir;
+    WS_DIRENT *file;
+    const gchar *name;
+    const gchar *dot;
+    gchar *path;
+    gboolean ok = TRUE;
+
+    if ((dir = ws_dir_open(dir_path, 0, NULL)) == NULL) {
+        return TRUE;
+    }
+
+    while (ok && (file = ws_dir_read_name(dir)) != NULL) {
+        name = ws_dir_get_name(file);
+        path = g_build_filename(dir_path, name, NULL);
+        dot = strrchr(name, '.');
+        if (dot && g_ascii_strcasecmp(dot + 1, "proto") == 0) {
+            ok = pbw_load_proto_file(pool, path) == 0;
+        } else if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+            ok = load_all_files_in_dir(pool, path);
+        }
+        g_free(path);
+    }
+    ws_dir_close(dir);
+    return ok;
+}
+
+static void
+count_message(const PbwDescriptor* message _U_, void* userdata)
+{
+    (*(guint*)userdata)++;
+}
+
+/* Load the directory into a new pool, return the time it took in microseconds */
+static gint64
+load(const char* dir_path, const char* cache_path, guint* message_count)
+{
+    const char* dirs[] = { dir_path, NULL };
+    gint64 start = g_get_monotonic_time();
+    gint64 elapsed;
+
+    pbw_reinit_DescriptorPool(&bench_pool, dirs, report_error);
+    if (cache_path) {
+        pbw_DescriptorPool_open_cache(bench_pool, cache_path);
+    }
+    if (!load_all_files_in_dir(bench_pool, dir_path)) {
+        report_error("Loading .proto files stopped!\n");
+        failed = TRUE;
+    }
+    if (cache_path && !pbw_DescriptorPool_save_cache(bench_pool)) {
+        report_error("Writing cache file %s failed!\n", cache_path);
+        failed = TRUE;
+    }
+    elapsed = g_get_monotonic_time() - start;
+
+    *message_count = 0;
+    pbw_foreach_message(bench_pool, count_message, message_count);
+    return elapsed;
+}
+
+int
+main(int argc, char **argv)
+{
+    gchar* cache_path;
+    int fd;
+    int iterations = 3;
+    int i;
+    guint parse_count, cold_count, warm_count;
+    gint64 parse_time = 0, cold_time = 0, warm_time = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <directory of .proto files> [<iterations>]\n", argv[0]);
+        return 2;
+    }
+    if (argc > 2) {
+        iterations = MAX(atoi(argv[2]), 1);
+    }
+
+    fd = g_file_open_tmp("protobuf_lang_bench_XXXXXX", &cache_path, NULL);
+    if (fd == -1) {
+        fprintf(stderr, "Could not create a temporary cache file\n");
+        return 2;
+    }
+    ws_close(fd);
+
+    for (i = 0; i < iterations; i++) {
+        parse_time += load(argv[1], NULL, &parse_count);
+
+        ws_unlink(cache_path);
+        cold_time += load(argv[1], cache_path, &cold_count);
+        warm_time += load(argv[1], cache_path, &warm_count);
+
+        if (cold_count != parse_count || warm_count != parse_count) {
+            report_error("Found %u messages by parsing, %u in a cold start and %u in a warm start\n",
+                parse_count, cold_count, warm_count);
+            failed = TRUE;
+        }
+    }
+    ws_unlink(cache_path);
+    g_free(cache_path);
+
+    printf("%u messages, average of %d iterations:\n", parse_count, iterations);
+    printf("  parse without cache: %10.3f ms\n", parse_time / 1000.0 / iterations);
+    printf("  cold start:          %10.3f ms\n", cold_time / 1000.0 / iterations);
+    printf("  warm start:          %10.3f ms\n", warm_time / 1000.0 / iterations);
+
+    return failed ? 1 : 0;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
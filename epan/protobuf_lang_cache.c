@@ -0,0 +1,680 @@
+/* protobuf_lang_cache.c
+ *
+ * On-disk cache of the parse results of Protocol Buffers Language files.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* Parsing thousands of .proto files takes seconds, and it is done again every time the
+ * search paths are changed. The cache keeps the tree built from each file, keyed by the
+ * absolute path, modification time and size of the file, so that only files changed since
+ * the cache was written are parsed again.
+ *
+ * The cache file is memory-mapped. It is validated incrementally: the directory is checked
+ * when the file is opened, but the record of a .proto file is only checked and decoded when
+ * that file is loaded.
+ *
+ * Layout (native byte order, the cache is only valid on the machine that wrote it):
+ *   header      magic "PBLC", format version, byte order mark, number of files
+ *   directory   one pbl_cache_dir_entry_t per file
+ *   data        NUL-terminated paths and the records they point to
+ *
+ * Record of a file:
+ *   u32 syntax version, i32 line number of the package statement,
+ *   u32 number of imports, the imports as strings, the package node
+ *
+ * Node:
+ *   u8 node type, string name, i32 line number, type specific data (see pbl_cache_write_node()),
+ *   u32 number of children, the children
+ *
+ * String: u32 length (G_MAXUINT32 for NULL) followed by the characters and a NUL.
+ *
+ * Only the information found by the parser is kept. Things looked up lazily from the whole
+ * pool, like the types of fields referring to messages or enums, and default enum values,
+ * are still resolved after loading.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <wsutil/file_util.h>
+
+#include "protobuf_lang_tree.h"
+
+#define PBL_CACHE_MAGIC "PBLC"
+/* Increase it whenever the layout or the trees built by the parser change. */
+#define PBL_CACHE_VERSION 1
+#define PBL_CACHE_BYTE_ORDER 0x01020304
+/* Limits the recursion of decoding a damaged cache file. */
+#define PBL_CACHE_MAX_DEPTH 256
+
+#define PBL_CACHE_NULL_STRING G_MAXUINT32
+
+#define PBL_CACHE_METHOD_IN_STREAM 0x01
+#define PBL_CACHE_METHOD_OUT_STREAM 0x02
+#define PBL_CACHE_FIELD_REPEATED 0x01
+#define PBL_CACHE_FIELD_REQUIRED 0x02
+#define PBL_CACHE_FIELD_OPTIONS 0x04
+
+typedef struct {
+    char magic[4];
+    guint32 version;
+    guint32 byte_order;
+    guint32 entry_count;
+} pbl_cache_header_t;
+
+typedef struct {
+    gint64 mtime;
+    gint64 size;
+    guint32 path_offset; /* path is followed by a NUL */
+    guint32 path_length;
+    guint32 data_offset;
+    guint32 data_length;
+} pbl_cache_dir_entry_t;
+
+/* a file loaded into the pool */
+typedef struct {
+    gchar* path;
+    gint64 mtime;
+    gint64 size;
+    const guint8* cached; /* record in the mapped cache file, if restored from it */
+    guint32 cached_length;
+    GByteArray* imports; /* imports found while parsing the file */
+    guint32 import_count;
+    GByteArray* record; /* record of the parsed file, NULL until parsing succeeded */
+} pbl_cache_entry_t;
+
+typedef struct _pbl_cache_t {
+    gchar* path;
+    GMappedFile* mapped; /* NULL if there was no valid cache file */
+    GHashTable* index; /* paths in the mapped file -> pbl_cache_dir_entry_t in the mapped file */
+    GPtrArray* entries; /* pbl_cache_entry_t of all files loaded into the pool, in loading order */
+    GHashTable* entries_by_path;
+    gboolean changed; /* the cache file has to be written again */
+} pbl_cache_t;
+
+typedef struct {
+    const guint8* p;
+    const guint8* end;
+    gboolean error;
+} pbl_cache_reader_t;
+
+static void
+pbl_cache_entry_free(gpointer data)
+{
+    pbl_cache_entry_t* entry = (pbl_cache_entry_t*) data;
+
+    g_free(entry->path);
+    if (entry->imports) {
+        g_byte_array_free(entry->imports, TRUE);
+    }
+    if (entry->record) {
+        g_byte_array_free(entry->record, TRUE);
+    }
+    g_free(entry);
+}
+
+/* Check the header and directory of the mapped cache file, and index it by path */
+static gboolean
+pbl_cache_index_mapped_file(pbl_cache_t* cache)
+{
+    const guint8* data = (const guint8*) g_mapped_file_get_contents(cache->mapped);
+    gsize length = g_mapped_file_get_length(cache->mapped);
+    pbl_cache_header_t header;
+    pbl_cache_dir_entry_t dir_entry;
+    const guint8* p;
+    guint32 i;
+
+    if (data == NULL || length < sizeof header) {
+        return FALSE;
+    }
+
+    memcpy(&header, data, sizeof header);
+    if (memcmp(header.magic, PBL_CACHE_MAGIC, sizeof header.magic) != 0
+        || header.version != PBL_CACHE_VERSION
+        || header.byte_order != PBL_CACHE_BYTE_ORDER
+        || header.entry_count > (length - sizeof header) / sizeof dir_entry) {
+        return FALSE;
+    }
+
+    p = data + sizeof header;
+    for (i = 0; i < header.entry_count; i++, p += sizeof dir_entry) {
+        memcpy(&dir_entry, p, sizeof dir_entry);
+        if ((guint64)dir_entry.path_offset + dir_entry.path_length >= length
+            || data[dir_entry.path_offset + dir_entry.path_length] != '\0'
+            || (guint64)dir_entry.data_offset + dir_entry.data_length > length) {
+            return FALSE;
+        }
+        g_hash_table_insert(cache->index, (gpointer)(data + dir_entry.path_offset), (gpointer)p);
+    }
+
+    return TRUE;
+}
+
+void
+pbl_descriptor_pool_open_cache(pbl_descriptor_pool_t* pool, const char* path)
+{
+    pbl_cache_t* cache;
+
+    pbl_descriptor_pool_close_cache(pool);
+
+    cache = g_new0(pbl_cache_t, 1);
+    cache->path = g_strdup(path);
+    cache->index = g_hash_table_new(g_str_hash, g_str_equal);
+    cache->entries = g_ptr_array_new_with_free_func(pbl_cache_entry_free);
+    cache->entries_by_path = g_hash_table_new(g_str_hash, g_str_equal);
+
+    cache->mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (cache->mapped && !pbl_cache_index_mapped_file(cache)) {
+        /* not a cache file of this version, it will be replaced */
+        g_hash_table_remove_all(cache->index);
+        g_mapped_file_unref(cache->mapped);
+        cache->mapped = NULL;
+    }
+
+    pool->cache = cache;
+}
+
+void
+pbl_descriptor_pool_close_cache(pbl_descriptor_pool_t* pool)
+{
+    pbl_cache_t* cache = pool->cache;
+
+    if (cache == NULL) return;
+
+    g_hash_table_destroy(cache->entries_by_path);
+    g_ptr_array_free(cache->entries, TRUE);
+    g_hash_table_destroy(cache->index);
+    if (cache->mapped) {
+        g_mapped_file_unref(cache->mapped);
+    }
+    g_free(cache->path);
+    g_free(cache);
+    pool->cache = NULL;
+}
+
+static void
+pbl_cache_write_u32(GByteArray* buf, guint32 value)
+{
+    g_byte_array_append(buf, (const guint8*) &value, sizeof value);
+}
+
+static void
+pbl_cache_write_i32(GByteArray* buf, gint32 value)
+{
+    g_byte_array_append(buf, (const guint8*) &value, sizeof value);
+}
+
+static void
+pbl_cache_write_string(GByteArray* buf, const char* str)
+{
+    guint32 length;
+
+    if (str == NULL) {
+        pbl_cache_write_u32(buf, PBL_CACHE_NULL_STRING);
+        return;
+    }
+
+    length = (guint32) strlen(str);
+    pbl_cache_write_u32(buf, length);
+    g_byte_array_append(buf, (const guint8*) str, length + 1);
+}
+
+static void
+pbl_cache_write_node(GByteArray* buf, const pbl_node_t* node)
+{
+    const pbl_method_descriptor_t* method;
+    const pbl_field_descriptor_t* field;
+    GSList* it;
+    guint8 type = (guint8) node->nodetype;
+    guint8 flags = 0;
+
+    g_byte_array_append(buf, &type, 1);
+    pbl_cache_write_string(buf, node->name);
+    pbl_cache_write_i32(buf, node->lineno);
+
+    switch (node->nodetype) {
+    case PBL_METHOD:
+        method = (const pbl_method_descriptor_t*) node;
+        pbl_cache_write_string(buf, method->in_msg_type);
+        pbl_cache_write_string(buf, method->out_msg_type);
+        flags = (method->in_is_stream ? PBL_CACHE_METHOD_IN_STREAM : 0)
+              | (method->out_is_stream ? PBL_CACHE_METHOD_OUT_STREAM : 0);
+        g_byte_array_append(buf, &flags, 1);
+        break;
+    case PBL_FIELD:
+    case PBL_MAP_FIELD:
+        /* the type and default value are determined again from the type name and options */
+        field = (const pbl_field_descriptor_t*) node;
+        pbl_cache_write_i32(buf, field->number);
+        pbl_cache_write_string(buf, field->type_name);
+        flags = (field->is_repeated ? PBL_CACHE_FIELD_REPEATED : 0)
+              | (field->is_required ? PBL_CACHE_FIELD_REQUIRED : 0)
+              | (field->options_node ? PBL_CACHE_FIELD_OPTIONS : 0);
+        g_byte_array_append(buf, &flags, 1);
+        if (field->options_node) {
+            pbl_cache_write_node(buf, field->options_node);
+        }
+        break;
+    case PBL_ENUM_VALUE:
+        pbl_cache_write_i32(buf, ((const pbl_enum_value_descriptor_t*) node)->number);
+        break;
+    case PBL_OPTION:
+        pbl_cache_write_string(buf, ((const pbl_option_descriptor_t*) node)->value);
+        break;
+    default:
+        break;
+    }
+
+    pbl_cache_write_u32(buf, g_slist_length(node->children));
+    for (it = node->children; it; it = it->next) {
+        pbl_cache_write_node(buf, (const pbl_node_t*) it->data);
+    }
+}
+
+static const guint8*
+pbl_cache_read_bytes(pbl_cache_reader_t* r, gsize length)
+{
+    const guint8* p = r->p;
+
+    if (r->error || (gsize)(r->end - r->p) < length) {
+        r->error = TRUE;
+        return NULL;
+    }
+    r->p += length;
+    return p;
+}
+
+static guint32
+pbl_cache_read_u32(pbl_cache_reader_t* r)
+{
+    guint32 value = 0;
+    const guint8* p = pbl_cache_read_bytes(r, sizeof value);
+
+    if (p) {
+        memcpy(&value, p, sizeof value);
+    }
+    return value;
+}
+
+static gint32
+pbl_cache_read_i32(pbl_cache_reader_t* r)
+{
+    gint32 value = 0;
+    const guint8* p = pbl_cache_read_bytes(r, sizeof value);
+
+    if (p) {
+        memcpy(&value, p, sizeof value);
+    }
+    return value;
+}
+
+static guint8
+pbl_cache_read_u8(pbl_cache_reader_t* r)
+{
+    const guint8* p = pbl_cache_read_bytes(r, 1);
+    return p ? *p : 0;
+}
+
+/* return a string in the mapped cache file */
+static const char*
+pbl_cache_read_string(pbl_cache_reader_t* r)
+{
+    guint32 length = pbl_cache_read_u32(r);
+    const guint8* p;
+
+    if (r->error || length == PBL_CACHE_NULL_STRING) {
+        return NULL;
+    }
+
+    p = pbl_cache_read_bytes(r, (gsize)length + 1);
+    if (p && p[length] != '\0') {
+        r->error = TRUE;
+        return NULL;
+    }
+    return (const char*) p;
+}
+
+/* Check that a damaged record does not build a tree the parser never builds */
+static gboolean
+pbl_cache_is_valid_child(pbl_node_type_t parent, pbl_node_type_t child)
+{
+    switch (parent) {
+    case PBL_PACKAGE:
+        return child == PBL_MESSAGE || child == PBL_ENUM || child == PBL_SERVICE;
+    case PBL_MESSAGE:
+        return child == PBL_FIELD || child == PBL_MAP_FIELD || child == PBL_MESSAGE || child == PBL_ENUM;
+    case PBL_ENUM:
+        return child == PBL_ENUM_VALUE;
+    case PBL_SERVICE:
+        return child == PBL_METHOD;
+    case PBL_OPTIONS:
+        return child == PBL_OPTION;
+    default:
+        return FALSE;
+    }
+}
+
+/* Build a node like the parser did. Return NULL if the record is damaged. */
+static pbl_node_t*
+pbl_cache_read_node(pbl_cache_reader_t* r, pbl_file_descriptor_t* file, int depth)
+{
+    pbl_node_type_t nodetype;
+    const char* name;
+    const char* str1;
+    const char* str2;
+    int lineno;
+    int number;
+    guint8 flags;
+    guint32 child_count, i;
+    pbl_node_t* node = NULL;
+    pbl_node_t* options = NULL;
+    pbl_node_t* child;
+
+    if (depth > PBL_CACHE_MAX_DEPTH) {
+        r->error = TRUE;
+        return NULL;
+    }
+
+    nodetype = (pbl_node_type_t) pbl_cache_read_u8(r);
+    name = pbl_cache_read_string(r);
+    lineno = pbl_cache_read_i32(r);
+    if (r->error || name == NULL || nodetype == PBL_UNKNOWN || nodetype == PBL_ONEOF || nodetype > PBL_OPTION) {
+        r->error = TRUE;
+        return NULL;
+    }
+
+    switch (nodetype) {
+    case PBL_METHOD:
+        str1 = pbl_cache_read_string(r);
+        str2 = pbl_cache_read_string(r);
+        flags = pbl_cache_read_u8(r);
+        if (r->error) {
+            return NULL;
+        }
+        node = pbl_create_method_node(file, lineno, name, str1, (flags & PBL_CACHE_METHOD_IN_STREAM) != 0,
+                                      str2, (flags & PBL_CACHE_METHOD_OUT_STREAM) != 0);
+        break;
+    case PBL_FIELD:
+    case PBL_MAP_FIELD:
+        number = pbl_cache_read_i32(r);
+        str1 = pbl_cache_read_string(r);
+        flags = pbl_cache_read_u8(r);
+        if (!r->error && (flags & PBL_CACHE_FIELD_OPTIONS)) {
+            options = pbl_cache_read_node(r, file, depth + 1);
+            if (options && options->nodetype != PBL_OPTIONS) {
+                r->error = TRUE;
+            }
+        }
+        if (r->error) {
+            pbl_free_node(options);
+            return NULL;
+        }
+        if (nodetype == PBL_MAP_FIELD) {
+            node = pbl_create_map_field_node(file, lineno, name, number, options);
+        } else {
+            node = pbl_create_field_node(file, lineno,
+                (flags & PBL_CACHE_FIELD_REPEATED) ? "repeated" : ((flags & PBL_CACHE_FIELD_REQUIRED) ? "required" : NULL),
+                str1, name, number, options);
+        }
+        break;
+    case PBL_ENUM_VALUE:
+        number = pbl_cache_read_i32(r);
+        if (r->error) {
+            return NULL;
+        }
+        node = pbl_create_enum_value_node(file, lineno, name, number);
+        break;
+    case PBL_OPTION:
+        str1 = pbl_cache_read_string(r);
+        if (r->error) {
+            return NULL;
+        }
+        node = pbl_create_option_node(file, lineno, name, str1);
+        break;
+    default:
+        node = pbl_create_node(file, lineno, nodetype, name);
+        break;
+    }
+
+    child_count = pbl_cache_read_u32(r);
+    for (i = 0; i < child_count && !r->error; i++) {
+        child = pbl_cache_read_node(r, file, depth + 1);
+        if (child && !pbl_cache_is_valid_child(nodetype, child->nodetype)) {
+            pbl_free_node(child);
+            r->error = TRUE;
+        } else if (child) {
+            pbl_restore_child(node, child);
+        }
+    }
+
+    if (r->error) {
+        pbl_free_node(node);
+        return NULL;
+    }
+    return node;
+}
+
+static pbl_cache_entry_t*
+pbl_cache_add_entry(pbl_cache_t* cache, const char* path, gint64 mtime, gint64 size)
+{
+    pbl_cache_entry_t* entry = g_new0(pbl_cache_entry_t, 1);
+
+    entry->path = g_strdup(path);
+    entry->mtime = mtime;
+    entry->size = size;
+    g_ptr_array_add(cache->entries, entry);
+    g_hash_table_insert(cache->entries_by_path, entry->path, entry);
+    return entry;
+}
+
+/* Decode the record of a file. Nothing is added to the pool if the record is damaged. */
+static gboolean
+pbl_cache_restore_record(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file,
+                         const guint8* data, guint32 length)
+{
+    pbl_cache_reader_t r = { data, data + length, FALSE };
+    int syntax_version;
+    int package_name_lineno;
+    guint32 import_count, i;
+    const char** imports;
+    pbl_node_t* package;
+
+    syntax_version = (int) pbl_cache_read_u32(&r);
+    package_name_lineno = pbl_cache_read_i32(&r);
+    import_count = pbl_cache_read_u32(&r);
+    if (r.error || import_count > length) {
+        return FALSE;
+    }
+
+    imports = g_new(const char*, import_count);
+    for (i = 0; i < import_count; i++) {
+        imports[i] = pbl_cache_read_string(&r);
+    }
+
+    package = pbl_cache_read_node(&r, file, 0);
+    if (package == NULL || package->nodetype != PBL_PACKAGE || r.p != r.end) {
+        pbl_free_node(package);
+        g_free(imports);
+        return FALSE;
+    }
+
+    file->syntax_version = syntax_version;
+    file->package_name_lineno = package_name_lineno;
+
+    for (i = 0; i < import_count; i++) {
+        if (imports[i]) {
+            pbl_add_proto_file_to_be_parsed(pool, imports[i]);
+        }
+    }
+    g_free(imports);
+
+    file->package_name = pbl_get_node_name(pbl_add_package(pool, package));
+    return TRUE;
+}
+
+gboolean
+pbl_cache_restore_file(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file)
+{
+    pbl_cache_t* cache = pool->cache;
+    ws_statb64 st;
+    pbl_cache_dir_entry_t dir_entry;
+    const guint8* p;
+    pbl_cache_entry_t* entry;
+    const guint8* data;
+
+    if (cache == NULL || file == NULL
+        || g_hash_table_lookup(cache->entries_by_path, file->filename)
+        || ws_stat64(file->filename, &st) != 0) {
+        return FALSE;
+    }
+
+    p = (const guint8*) g_hash_table_lookup(cache->index, file->filename);
+    if (p) {
+        memcpy(&dir_entry, p, sizeof dir_entry);
+        data = (const guint8*) g_mapped_file_get_contents(cache->mapped) + dir_entry.data_offset;
+
+        if (dir_entry.mtime == (gint64) st.st_mtime && dir_entry.size == (gint64) st.st_size
+            && pbl_cache_restore_record(pool, file, data, dir_entry.data_length)) {
+            entry = pbl_cache_add_entry(cache, file->filename, dir_entry.mtime, dir_entry.size);
+            entry->cached = data;
+            entry->cached_length = dir_entry.data_length;
+            return TRUE;
+        }
+    }
+
+    /* the file will be parsed, pbl_cache_add_file() completes the entry */
+    pbl_cache_add_entry(cache, file->filename, (gint64) st.st_mtime, (gint64) st.st_size);
+    cache->changed = TRUE;
+    return FALSE;
+}
+
+void
+pbl_cache_add_import(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file, const char* import)
+{
+    pbl_cache_entry_t* entry;
+
+    if (pool->cache == NULL || file == NULL
+        || (entry = (pbl_cache_entry_t*) g_hash_table_lookup(pool->cache->entries_by_path, file->filename)) == NULL) {
+        return;
+    }
+
+    if (entry->imports == NULL) {
+        entry->imports = g_byte_array_new();
+    }
+    pbl_cache_write_string(entry->imports, import);
+    entry->import_count++;
+}
+
+void
+pbl_cache_add_file(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file, const pbl_node_t* package)
+{
+    pbl_cache_entry_t* entry;
+
+    if (pool->cache == NULL || file == NULL
+        || (entry = (pbl_cache_entry_t*) g_hash_table_lookup(pool->cache->entries_by_path, file->filename)) == NULL
+        || entry->cached) {
+        return;
+    }
+
+    entry->record = g_byte_array_new();
+    pbl_cache_write_u32(entry->record, (guint32) file->syntax_version);
+    pbl_cache_write_i32(entry->record, file->package_name_lineno);
+    pbl_cache_write_u32(entry->record, entry->import_count);
+    if (entry->imports) {
+        g_byte_array_append(entry->record, entry->imports->data, entry->imports->len);
+    }
+    pbl_cache_write_node(entry->record, package);
+}
+
+gboolean
+pbl_descriptor_pool_save_cache(pbl_descriptor_pool_t* pool)
+{
+    pbl_cache_t* cache = pool->cache;
+    pbl_cache_header_t header;
+    pbl_cache_dir_entry_t dir_entry;
+    pbl_cache_entry_t* entry;
+    GByteArray* buf;
+    guint32 count = 0;
+    guint i;
+    gboolean ok = TRUE;
+
+    if (cache == NULL) return TRUE;
+
+    /* files that are no longer loaded are dropped */
+    if (cache->changed || g_hash_table_size(cache->index) != cache->entries->len) {
+        for (i = 0; i < cache->entries->len; i++) {
+            entry = (pbl_cache_entry_t*) g_ptr_array_index(cache->entries, i);
+            if (entry->cached || entry->record) {
+                count++;
+            }
+        }
+
+        memcpy(header.magic, PBL_CACHE_MAGIC, sizeof header.magic);
+        header.version = PBL_CACHE_VERSION;
+        header.byte_order = PBL_CACHE_BYTE_ORDER;
+        header.entry_count = count;
+
+        buf = g_byte_array_new();
+        g_byte_array_append(buf, (const guint8*) &header, sizeof header);
+        g_byte_array_set_size(buf, (guint)(sizeof header + count * sizeof dir_entry));
+
+        count = 0;
+        for (i = 0; i < cache->entries->len; i++) {
+            entry = (pbl_cache_entry_t*) g_ptr_array_index(cache->entries, i);
+            if (!entry->cached && !entry->record) {
+                continue; /* parsing failed */
+            }
+
+            dir_entry.mtime = entry->mtime;
+            dir_entry.size = entry->size;
+            dir_entry.path_offset = buf->len;
+            dir_entry.path_length = (guint32) strlen(entry->path);
+            g_byte_array_append(buf, (const guint8*) entry->path, dir_entry.path_length + 1);
+            dir_entry.data_offset = buf->len;
+            if (entry->cached) {
+                dir_entry.data_length = entry->cached_length;
+                g_byte_array_append(buf, entry->cached, entry->cached_length);
+            } else {
+                dir_entry.data_length = entry->record->len;
+                g_byte_array_append(buf, entry->record->data, entry->record->len);
+            }
+            memcpy(buf->data + sizeof header + count * sizeof dir_entry, &dir_entry, sizeof dir_entry);
+            count++;
+        }
+
+        /* the old cache file can not be replaced while it is mapped on some systems */
+        g_hash_table_remove_all(cache->index);
+        for (i = 0; i < cache->entries->len; i++) {
+            ((pbl_cache_entry_t*) g_ptr_array_index(cache->entries, i))->cached = NULL;
+        }
+        if (cache->mapped) {
+            g_mapped_file_unref(cache->mapped);
+            cache->mapped = NULL;
+        }
+
+        ok = g_file_set_contents(cache->path, (const gchar*) buf->data, buf->len, NULL);
+        g_byte_array_free(buf, TRUE);
+    }
+
+    pbl_descriptor_pool_close_cache(pool);
+    return ok;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
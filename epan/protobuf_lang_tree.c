@@ -114,6 +114,7 @@ pbl_free_pool(pbl_descriptor_pool_t* pool)
 {
     if (pool == NULL) return;
 
+    pbl_descriptor_pool_close_cache(pool);
     g_slist_free_full(pool->source_paths, g_free);
     g_hash_table_destroy(pool->packages);
     g_slist_free(pool->proto_files_to_be_parsed); /* elements will be removed in p->proto_files */
@@ -982,6 +983,33 @@ pbl_node_t* pbl_create_option_node(pbl_file_descriptor_t* file, int lineno,
     return (pbl_node_t*)node;
 }
 
+/* add child to the fields or values tables of its message or enum parent */
+static void
+pbl_index_child(pbl_node_t* parent, pbl_node_t* child)
+{
+    if (parent->nodetype == PBL_MESSAGE) {
+        pbl_message_descriptor_t* msg = (pbl_message_descriptor_t*) parent;
+        /* add child to fields_by_number table */
+        if (child->nodetype == PBL_FIELD || child->nodetype == PBL_MAP_FIELD) {
+            msg->fields = g_slist_append(msg->fields, child);
+            if (msg->fields_by_number == NULL) {
+                msg->fields_by_number = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+            }
+            g_hash_table_insert(msg->fields_by_number,
+                                GINT_TO_POINTER(((pbl_field_descriptor_t*)child)->number), child);
+        }
+    } else if (parent->nodetype == PBL_ENUM && child->nodetype == PBL_ENUM_VALUE) {
+        pbl_enum_descriptor_t* anEnum = (pbl_enum_descriptor_t*) parent;
+        anEnum->values = g_slist_append(anEnum->values, child);
+        /* add child to values_by_number table */
+        if (anEnum->values_by_number == NULL) {
+            anEnum->values_by_number = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+        }
+        g_hash_table_insert(anEnum->values_by_number,
+                            GINT_TO_POINTER(((pbl_enum_value_descriptor_t*)child)->number), child);
+    }
+}
+
 /* add a node as a child of parent node, and return the parent pointer */
 pbl_node_t*
 pbl_add_child(pbl_node_t* parent, pbl_node_t* child)
@@ -1027,32 +1055,48 @@ pbl_add_child(pbl_node_t* parent, pbl_node_t* child)
     }
 
     g_hash_table_insert(parent->children_by_name, child->name, child);
+    pbl_index_child(parent, child);
 
-    if (parent->nodetype == PBL_MESSAGE) {
-        pbl_message_descriptor_t* msg = (pbl_message_descriptor_t*) parent;
-        /* add child to fields_by_number table */
-        if (child->nodetype == PBL_FIELD || child->nodetype == PBL_MAP_FIELD) {
-            msg->fields = g_slist_append(msg->fields, child);
-            if (msg->fields_by_number == NULL) {
-                msg->fields_by_number = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
-            }
-            g_hash_table_insert(msg->fields_by_number,
-                                GINT_TO_POINTER(((pbl_field_descriptor_t*)child)->number), child);
-        }
-    } else if (parent->nodetype == PBL_ENUM && child->nodetype == PBL_ENUM_VALUE) {
-        pbl_enum_descriptor_t* anEnum = (pbl_enum_descriptor_t*) parent;
-        anEnum->values = g_slist_append(anEnum->values, child);
-        /* add child to values_by_number table */
-        if (anEnum->values_by_number == NULL) {
-            anEnum->values_by_number = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
-        }
-        g_hash_table_insert(anEnum->values_by_number,
-                            GINT_TO_POINTER(((pbl_enum_value_descriptor_t*)child)->number), child);
+    return parent;
+}
+
+/* append a node restored from the parse cache as a child of the parent node, and return the parent pointer.
+   Unlike pbl_add_child(), MapEntry messages and merged options are already part of the restored tree,
+   and redefinitions were reported when the file was parsed. */
+pbl_node_t*
+pbl_restore_child(pbl_node_t* parent, pbl_node_t* child)
+{
+    if (child == NULL || parent == NULL) {
+        return parent;
+    }
+
+    child->parent = parent;
+    parent->children = g_slist_append(parent->children, child);
+
+    if (parent->children_by_name == NULL) {
+        parent->children_by_name = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, NULL);
     }
+    g_hash_table_insert(parent->children_by_name, child->name, child);
+    pbl_index_child(parent, child);
 
     return parent;
 }
 
+/* put the package node of a parsed file into the packages table of the pool, and return the package node of the pool */
+pbl_node_t*
+pbl_add_package(pbl_descriptor_pool_t* pool, pbl_node_t* package)
+{
+    pbl_node_t* packnode = (pbl_node_t*) g_hash_table_lookup(pool->packages, package->name);
+    if (packnode) {
+        pbl_merge_children(packnode, package);
+        pbl_free_node(package);
+        return packnode;
+    }
+
+    g_hash_table_insert(pool->packages, g_strdup(package->name), package);
+    return package;
+}
+
 /* merge one('from') node's children to another('to') node, and return the 'to' pointer */
 pbl_node_t*
 pbl_merge_children(pbl_node_t* to, pbl_node_t* from)
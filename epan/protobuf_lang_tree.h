@@ -51,6 +51,7 @@ typedef struct {
     GHashTable* proto_files; /* all proto files that are parsed or to be parsed */
     GSList* proto_files_to_be_parsed; /* files is to be parsed */
     struct _protobuf_lang_state_t *parser_state; /* current parser state */
+    struct _pbl_cache_t *cache; /* parse results of files restored from or to be saved to the cache file */
 } pbl_descriptor_pool_t;
 
 /* file descriptor */
@@ -425,6 +426,47 @@ pbl_create_option_node(pbl_file_descriptor_t* file, int lineno, const char* name
 void
 pbl_free_node(gpointer anode);
 
+/* append a node restored from the parse cache as a child of the parent node, and return the parent pointer */
+pbl_node_t*
+pbl_restore_child(pbl_node_t* parent, pbl_node_t* child);
+
+/* put the package node of a parsed file into the packages table of the pool, and return the package node of the pool */
+pbl_node_t*
+pbl_add_package(pbl_descriptor_pool_t* pool, pbl_node_t* package);
+
+/*
+ * Following are functions of the parse cache (protobuf_lang_cache.c).
+ */
+
+/**
+ Restore the parse results of .proto files that have not changed since they were written to a cache file,
+ instead of parsing them again. A file is unchanged if its path, modification time and size match.
+ @param pool The pool in which following loaded files are restored from the cache.
+ @param path The path of the cache file. It is ok if it does not exist or is invalid. */
+void
+pbl_descriptor_pool_open_cache(pbl_descriptor_pool_t* pool, const char* path);
+
+/* Write the parse results of all files loaded into the pool back to the cache file if any of them
+   changed, and close the cache. Return FALSE if the cache file could not be written. */
+gboolean
+pbl_descriptor_pool_save_cache(pbl_descriptor_pool_t* pool);
+
+/* close the cache of the pool without writing it */
+void
+pbl_descriptor_pool_close_cache(pbl_descriptor_pool_t* pool);
+
+/* Restore the parse result of a file from the cache. Return FALSE if it must be parsed. */
+gboolean
+pbl_cache_restore_file(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file);
+
+/* keep an 'import' of the file being parsed for the cache */
+void
+pbl_cache_add_import(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file, const char* import);
+
+/* keep the package node of the file just parsed for the cache. Must be called before merging it into the pool. */
+void
+pbl_cache_add_file(pbl_descriptor_pool_t* pool, pbl_file_descriptor_t* file, const pbl_node_t* package);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
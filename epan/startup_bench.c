@@ -0,0 +1,199 @@
+/* startup_bench.c
+ * Standalone program to measure the startup of libwireshark with and without
+ * the registry snapshot.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* Usage: startup_bench [<runs>]
+ *
+ * Starts itself <runs> times in each of the modes
+ *   full   without a snapshot, like before the snapshot was added
+ *   cold   registering everything and writing a new snapshot
+ *   warm   using the snapshot written by the cold start
+ * and prints the average time taken by epan_init() and by looking up every
+ * registered field by name. It checks that the lookups find the same
+ * fields in all modes.
+ *
+ * The snapshot is written to a temporary file, which is removed at the end.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+#include <wiretap/wtap.h>
+
+#include "epan.h"
+#include "proto.h"
+
+#define SNAPSHOT_ENV "WIRESHARK_REGISTRY_SNAPSHOT"
+
+typedef struct {
+	gint64 init_time;
+	gint64 lookup_time;
+	guint field_count;
+	guint checksum;
+} run_result_t;
+
+/* Started by the parent: initialize, look up all fields and report */
+static int
+run_child(const char *progname)
+{
+	char *init_progfile_dir_error;
+	header_field_info *hfinfo;
+	header_field_info *found;
+	gint64 start, init_time, lookup_time;
+	guint checksum = 0;
+	guint count;
+	guint id;
+
+	init_process_policies();
+	init_progfile_dir_error = init_progfile_dir(progname);
+	if (init_progfile_dir_error != NULL) {
+		fprintf(stderr, "startup_bench: Can't get pathname of directory containing the program: %s.\n",
+			init_progfile_dir_error);
+		g_free(init_progfile_dir_error);
+	}
+
+	wtap_init(TRUE);
+
+	start = g_get_monotonic_time();
+	if (!epan_init(NULL, NULL, TRUE)) {
+		return 2;
+	}
+	init_time = g_get_monotonic_time() - start;
+
+	count = (guint)proto_registrar_n();
+	start = g_get_monotonic_time();
+	for (id = 0; id < count; id++) {
+		hfinfo = proto_registrar_get_nth(id);
+		if (hfinfo == NULL) {
+			continue;
+		}
+		found = proto_registrar_get_byname(hfinfo->abbrev);
+		checksum = checksum * 31 + (found ? (guint)found->id + 1 : 0);
+	}
+	lookup_time = g_get_monotonic_time() - start;
+
+	printf("%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %u %u\n", init_time, lookup_time, count, checksum);
+
+	epan_cleanup();
+	wtap_cleanup();
+	return 0;
+}
+
+static gboolean
+spawn_child(const char *progname, const char *snapshot_path, run_result_t *result)
+{
+	gchar *argv[] = { (gchar *)progname, (gchar *)"--child", NULL };
+	gchar **envp = g_get_environ();
+	gchar *out = NULL;
+	GError *err = NULL;
+	gint status;
+	gboolean ok;
+
+	if (snapshot_path) {
+		envp = g_environ_setenv(envp, SNAPSHOT_ENV, snapshot_path, TRUE);
+	} else {
+		envp = g_environ_unsetenv(envp, SNAPSHOT_ENV);
+	}
+
+	ok = g_spawn_sync(NULL, argv, envp, G_SPAWN_SEARCH_PATH, NULL, NULL, &out, NULL, &status, &err)
+		&& status == 0
+		&& sscanf(out, "%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %u %u",
+			&result->init_time, &result->lookup_time, &result->field_count, &result->checksum) == 4;
+	if (err) {
+		fprintf(stderr, "startup_bench: %s\n", err->message);
+		g_error_free(err);
+	}
+	g_free(out);
+	g_strfreev(envp);
+	return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+	static const char *modes[] = { "full", "cold", "warm" };
+	run_result_t result;
+	run_result_t expected = { 0, 0, 0, 0 };
+	gint64 init_time[3] = { 0, 0, 0 };
+	gint64 lookup_time[3] = { 0, 0, 0 };
+	gboolean failed = FALSE;
+	char *snapshot_path;
+	int runs = 3;
+	int mode, n;
+	int fd;
+
+	if (argc > 1 && strcmp(argv[1], "--child") == 0) {
+		return run_child(argv[0]);
+	}
+	if (argc > 1) {
+		runs = MAX(atoi(argv[1]), 1);
+	}
+
+	fd = g_file_open_tmp("startup_bench_XXXXXX", &snapshot_path, NULL);
+	if (fd == -1) {
+		fprintf(stderr, "startup_bench: Can't create a temporary file\n");
+		return 1;
+	}
+	ws_close(fd);
+
+	for (n = 0; n < runs && !failed; n++) {
+		for (mode = 0; mode < 3 && !failed; mode++) {
+			if (mode == 1) {
+				ws_unlink(snapshot_path);
+			}
+			if (!spawn_child(argv[0], mode == 0 ? NULL : snapshot_path, &result)) {
+				failed = TRUE;
+				break;
+			}
+			if (n == 0 && mode == 0) {
+				expected = result;
+			} else if (result.field_count != expected.field_count || result.checksum != expected.checksum) {
+				printf("%s start: %u fields, lookups differ from a full registration\n",
+					modes[mode], result.field_count);
+				failed = TRUE;
+			}
+			init_time[mode] += result.init_time;
+			lookup_time[mode] += result.lookup_time;
+		}
+	}
+	ws_unlink(snapshot_path);
+	g_free(snapshot_path);
+
+	if (!failed) {
+		printf("%u fields, average of %d runs:\n", expected.field_count, runs);
+		for (mode = 0; mode < 3; mode++) {
+			printf("  %s  epan_init %10.3f ms  lookups %10.3f ms\n", modes[mode],
+				init_time[mode] / 1000.0 / runs, lookup_time[mode] / 1000.0 / runs);
+		}
+	}
+
+	return failed ? 1 : 0;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
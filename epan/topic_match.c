@@ -0,0 +1,562 @@
+/* topic_match.c
+ * Matching message topics against a table of patterns
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "topic_match.h"
+
+/*
+ * Every structure yields the lowest matching entry number, so the first
+ * matching entry of the table wins, as it would with a linear scan of the
+ * table. Structures that cannot beat the best entry found so far are not
+ * looked at.
+ */
+
+/* Node of a trie of bytes, for "starts with" and (reversed) "ends with" */
+typedef struct _topic_trie_node {
+    struct _topic_trie_node *child;     /* first child */
+    struct _topic_trie_node *sibling;
+    guint entry;                        /* entry + 1 of the pattern ending here, 0 if none */
+    guint8 byte;
+} topic_trie_node;
+
+/* Node of a trie of topic levels, for MQTT topic filters */
+typedef struct _topic_filter_node {
+    GHashTable *levels;                 /* topic_span -> topic_filter_node */
+    struct _topic_filter_node *single;  /* "+" */
+    guint entry;                        /* entry + 1 of the filter ending here, 0 if none */
+    guint multi_entry;                  /* entry + 1 of the filter ending with "#" here */
+} topic_filter_node;
+
+/* "contains" or regular expression entry, one alternative of the combined regex */
+typedef struct {
+    guint entry;
+    char *contains;                     /* pattern of a "contains" entry */
+    GRegex *regex;                      /* compiled pattern of a regular expression entry */
+    gint group;                         /* capture group marking it in the combined regex */
+    gboolean alone;                     /* matched on its own, not in the combined regex */
+} topic_match_alternative;
+
+typedef struct {
+    const char *str;
+    gsize len;
+} topic_span;
+
+struct _topic_matcher_t {
+    guint num_entries;
+    GHashTable *equal;                  /* topic_span -> entry + 1 */
+    topic_trie_node prefixes;
+    topic_trie_node suffixes;
+    topic_filter_node filters;
+    GArray *alternatives;               /* topic_match_alternative in entry order */
+    GRegex *combined;                   /* NULL if all alternatives are matched one by one */
+};
+
+#define MQTT_LEVEL_SEPARATOR '/'
+
+static guint
+topic_span_hash(gconstpointer key)
+{
+    const topic_span *span = (const topic_span *)key;
+    guint hash = 5381;
+    gsize i;
+
+    for (i = 0; i < span->len; i++)
+        hash = (hash << 5) + hash + (guint8)span->str[i];
+    return hash;
+}
+
+static gboolean
+topic_span_equal(gconstpointer a, gconstpointer b)
+{
+    const topic_span *span_a = (const topic_span *)a;
+    const topic_span *span_b = (const topic_span *)b;
+
+    return span_a->len == span_b->len && memcmp(span_a->str, span_b->str, span_a->len) == 0;
+}
+
+/* Returns a topic_span holding a copy of str, freed with g_free */
+static topic_span *
+topic_span_new(const char *str, gsize len)
+{
+    topic_span *span;
+    char *copy;
+
+    span = (topic_span *)g_malloc(sizeof(topic_span) + len + 1);
+    copy = (char *)(span + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    span->str = copy;
+    span->len = len;
+    return span;
+}
+
+static void
+topic_filter_node_free(gpointer data)
+{
+    topic_filter_node *node = (topic_filter_node *)data;
+
+    if (node->levels)
+        g_hash_table_destroy(node->levels);
+    if (node->single) {
+        topic_filter_node_free(node->single);
+        g_free(node->single);
+    }
+}
+
+static void
+topic_filter_node_destroy(gpointer data)
+{
+    topic_filter_node_free(data);
+    g_free(data);
+}
+
+static void
+topic_trie_node_free(topic_trie_node *node)
+{
+    topic_trie_node *child;
+    topic_trie_node *next;
+
+    for (child = node->child; child; child = next) {
+        next = child->sibling;
+        topic_trie_node_free(child);
+        g_free(child);
+    }
+}
+
+/* Checks that a filter only has + and # as whole levels, and # as the last one */
+static gboolean
+topic_match_check_filter(const char *pattern)
+{
+    const char *level = pattern;
+    const char *end;
+    gsize len;
+
+    for (;;) {
+        end = strchr(level, MQTT_LEVEL_SEPARATOR);
+        len = end ? (gsize)(end - level) : strlen(level);
+        if (len == 1 && level[0] == '#')
+            return end == NULL;
+        if (!(len == 1 && level[0] == '+') &&
+            (memchr(level, '+', len) != NULL || memchr(level, '#', len) != NULL))
+            return FALSE;
+        if (!end)
+            return TRUE;
+        level = end + 1;
+    }
+}
+
+gboolean
+topic_match_check_pattern(guint criteria, const char *pattern, char **error)
+{
+    GRegex *regex;
+
+    switch (criteria) {
+    case TOPIC_MATCH_REGEX:
+        regex = g_regex_new(pattern, (GRegexCompileFlags) G_REGEX_OPTIMIZE, (GRegexMatchFlags) 0, NULL);
+        if (!regex) {
+            *error = g_strdup_printf("Invalid regex: %s", pattern);
+            return FALSE;
+        }
+        g_regex_unref(regex);
+        break;
+    case TOPIC_MATCH_MQTT_FILTER:
+        if (!topic_match_check_filter(pattern)) {
+            *error = g_strdup_printf("Invalid topic filter: %s", pattern);
+            return FALSE;
+        }
+        break;
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+topic_matcher_t *
+topic_matcher_new(void)
+{
+    topic_matcher_t *matcher = g_new0(topic_matcher_t, 1);
+
+    matcher->equal = g_hash_table_new_full(topic_span_hash, topic_span_equal, g_free, NULL);
+    matcher->alternatives = g_array_new(FALSE, FALSE, sizeof(topic_match_alternative));
+    return matcher;
+}
+
+static void
+topic_trie_add(topic_trie_node *root, const char *pattern, gboolean reversed, guint entry)
+{
+    topic_trie_node *node = root;
+    topic_trie_node *child;
+    gsize len = strlen(pattern);
+    gsize i;
+    guint8 byte;
+
+    for (i = 0; i < len; i++) {
+        byte = (guint8)pattern[reversed ? len - 1 - i : i];
+        for (child = node->child; child; child = child->sibling) {
+            if (child->byte == byte)
+                break;
+        }
+        if (!child) {
+            child = g_new0(topic_trie_node, 1);
+            child->byte = byte;
+            child->sibling = node->child;
+            node->child = child;
+        }
+        node = child;
+    }
+    /* an earlier entry with the same pattern takes precedence */
+    if (!node->entry)
+        node->entry = entry + 1;
+}
+
+static void
+topic_filter_add(topic_filter_node *root, const char *pattern, guint entry)
+{
+    topic_filter_node *node = root;
+    topic_filter_node *child;
+    const char *level = pattern;
+    const char *end;
+    topic_span span;
+
+    for (;;) {
+        end = strchr(level, MQTT_LEVEL_SEPARATOR);
+        span.str = level;
+        span.len = end ? (gsize)(end - level) : strlen(level);
+        if (span.len == 1 && level[0] == '#') {
+            if (!node->multi_entry)
+                node->multi_entry = entry + 1;
+            return;
+        }
+        if (span.len == 1 && level[0] == '+') {
+            if (!node->single)
+                node->single = g_new0(topic_filter_node, 1);
+            child = node->single;
+        } else {
+            if (!node->levels)
+                node->levels = g_hash_table_new_full(topic_span_hash, topic_span_equal, g_free, topic_filter_node_destroy);
+            child = (topic_filter_node *)g_hash_table_lookup(node->levels, &span);
+            if (!child) {
+                child = g_new0(topic_filter_node, 1);
+                g_hash_table_insert(node->levels, topic_span_new(span.str, span.len), child);
+            }
+        }
+        node = child;
+        if (!end)
+            break;
+        level = end + 1;
+    }
+    if (!node->entry)
+        node->entry = entry + 1;
+}
+
+/*
+ * Tells whether a regex refers to its capture groups by number, or to the
+ * whole pattern: back references, subroutine calls, recursion and
+ * conditions. Those would point elsewhere once the pattern is one of the
+ * alternatives of the combined regex. Relative calls like (?-1) and named
+ * groups keep working there.
+ */
+static gboolean
+topic_match_regex_refers_to_groups(const GRegex *regex)
+{
+    const char *p;
+
+    if (g_regex_get_max_backref(regex) > 0)
+        return TRUE;
+
+    for (p = g_regex_get_pattern(regex); *p != '\0'; p++) {
+        if (p[0] == '\\') {
+            /* \g<n> and \g'n' are calls, \gn and \g{n} back references
+             * that g_regex_get_max_backref() counts */
+            if (p[1] == 'g' && (p[2] == '<' || p[2] == '\''))
+                return TRUE;
+            if (p[1] != '\0')
+                p++;
+            continue;
+        }
+        /* (?n), (?R) and conditions like (?(n)...) */
+        if (p[0] == '(' && p[1] == '?' &&
+            (g_ascii_isdigit(p[2]) || p[2] == 'R' || p[2] == '('))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+gboolean
+topic_matcher_add(topic_matcher_t *matcher, guint criteria, const char *pattern)
+{
+    topic_match_alternative alternative;
+    guint entry = matcher->num_entries++;
+    topic_span span;
+
+    if (pattern == NULL)
+        return FALSE;
+
+    switch (criteria) {
+    case TOPIC_MATCH_EQUAL:
+        span.str = pattern;
+        span.len = strlen(pattern);
+        if (!g_hash_table_contains(matcher->equal, &span))
+            g_hash_table_insert(matcher->equal, topic_span_new(span.str, span.len), GUINT_TO_POINTER(entry + 1));
+        return TRUE;
+    case TOPIC_MATCH_STARTS_WITH:
+        topic_trie_add(&matcher->prefixes, pattern, FALSE, entry);
+        return TRUE;
+    case TOPIC_MATCH_ENDS_WITH:
+        topic_trie_add(&matcher->suffixes, pattern, TRUE, entry);
+        return TRUE;
+    case TOPIC_MATCH_MQTT_FILTER:
+        if (!topic_match_check_filter(pattern))
+            return FALSE;
+        topic_filter_add(&matcher->filters, pattern, entry);
+        return TRUE;
+    case TOPIC_MATCH_CONTAINS:
+        memset(&alternative, 0, sizeof(alternative));
+        alternative.entry = entry;
+        alternative.contains = g_strdup(pattern);
+        g_array_append_val(matcher->alternatives, alternative);
+        return TRUE;
+    case TOPIC_MATCH_REGEX:
+        memset(&alternative, 0, sizeof(alternative));
+        alternative.entry = entry;
+        alternative.regex = g_regex_new(pattern, (GRegexCompileFlags) G_REGEX_OPTIMIZE, (GRegexMatchFlags) 0, NULL);
+        if (!alternative.regex)
+            return FALSE;
+        alternative.alone = topic_match_regex_refers_to_groups(alternative.regex);
+        g_array_append_val(matcher->alternatives, alternative);
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+void
+topic_matcher_compile(topic_matcher_t *matcher)
+{
+    topic_match_alternative *alternative;
+    GString *combined;
+    gchar *escaped;
+    gchar *name;
+    gboolean first = TRUE;
+    guint i;
+
+    if (matcher->combined) {
+        g_regex_unref(matcher->combined);
+        matcher->combined = NULL;
+    }
+
+    /* each alternative tries the whole subject before the next one, so the
+     * first alternative that matches anywhere is the one reported. The
+     * groups marking the alternatives renumber the groups of the patterns,
+     * so patterns referring to them are left out and matched on their own. */
+    combined = g_string_new("^(?:");
+    for (i = 0; i < matcher->alternatives->len; i++) {
+        alternative = &g_array_index(matcher->alternatives, topic_match_alternative, i);
+        alternative->group = -1;
+        if (alternative->alone)
+            continue;
+        if (alternative->contains) {
+            escaped = g_regex_escape_string(alternative->contains, -1);
+            g_string_append_printf(combined, "%s[\\s\\S]*?(?:%s)(?<m%u>)", first ? "" : "|", escaped, i);
+            g_free(escaped);
+        } else {
+            g_string_append_printf(combined, "%s[\\s\\S]*?(?:%s)(?<m%u>)", first ? "" : "|",
+                                   g_regex_get_pattern(alternative->regex), i);
+        }
+        first = FALSE;
+    }
+    g_string_append(combined, ")");
+    if (first) {
+        g_string_free(combined, TRUE);
+        return;
+    }
+
+    matcher->combined = g_regex_new(combined->str, (GRegexCompileFlags) G_REGEX_OPTIMIZE, (GRegexMatchFlags) 0, NULL);
+    if (matcher->combined) {
+        for (i = 0; i < matcher->alternatives->len; i++) {
+            alternative = &g_array_index(matcher->alternatives, topic_match_alternative, i);
+            if (alternative->alone)
+                continue;
+            name = g_strdup_printf("m%u", i);
+            alternative->group = g_regex_get_string_number(matcher->combined, name);
+            g_free(name);
+        }
+    }
+    /* else a pattern does not survive being combined (a group named like
+     * a marker, for instance), and all alternatives are matched one by one */
+    g_string_free(combined, TRUE);
+}
+
+static void
+topic_trie_lookup(const topic_trie_node *root, const char *topic, gsize len, gboolean reversed, guint *best)
+{
+    const topic_trie_node *node = root;
+    gsize i;
+    guint8 byte;
+
+    for (i = 0; i < len; i++) {
+        byte = (guint8)topic[reversed ? len - 1 - i : i];
+        for (node = node->child; node; node = node->sibling) {
+            if (node->byte == byte)
+                break;
+        }
+        if (!node)
+            return;
+        if (node->entry && node->entry - 1 < *best)
+            *best = node->entry - 1;
+    }
+}
+
+/* Matches the levels of a topic from level on, NULL past the last level.
+ * Wildcards in the first level do not match topics starting with $. */
+static void
+topic_filter_lookup(const topic_filter_node *node, const char *level, gboolean first, guint *best)
+{
+    const topic_filter_node *child;
+    const char *end;
+    const char *next;
+    topic_span span;
+    gboolean wildcards = !(first && level && level[0] == '$');
+
+    /* "#" also matches the parent level */
+    if (node->multi_entry && wildcards && node->multi_entry - 1 < *best)
+        *best = node->multi_entry - 1;
+    if (!level) {
+        if (node->entry && node->entry - 1 < *best)
+            *best = node->entry - 1;
+        return;
+    }
+
+    end = strchr(level, MQTT_LEVEL_SEPARATOR);
+    next = end ? end + 1 : NULL;
+    if (node->levels) {
+        span.str = level;
+        span.len = end ? (gsize)(end - level) : strlen(level);
+        child = (const topic_filter_node *)g_hash_table_lookup(node->levels, &span);
+        if (child)
+            topic_filter_lookup(child, next, FALSE, best);
+    }
+    if (node->single && wildcards)
+        topic_filter_lookup(node->single, next, FALSE, best);
+}
+
+gboolean
+topic_matcher_lookup(const topic_matcher_t *matcher, const char *topic, guint *entry)
+{
+    const topic_match_alternative *alternative;
+    topic_span span;
+    guint best = G_MAXUINT;
+    guint idx;
+    guint i;
+
+    if (matcher == NULL || topic == NULL)
+        return FALSE;
+
+    span.str = topic;
+    span.len = strlen(topic);
+    idx = GPOINTER_TO_UINT(g_hash_table_lookup(matcher->equal, &span));
+    if (idx)
+        best = idx - 1;
+
+    topic_trie_lookup(&matcher->prefixes, topic, span.len, FALSE, &best);
+    topic_trie_lookup(&matcher->suffixes, topic, span.len, TRUE, &best);
+    if (matcher->filters.levels || matcher->filters.single || matcher->filters.multi_entry)
+        topic_filter_lookup(&matcher->filters, topic, TRUE, &best);
+
+    /* the alternatives only matter if they come before the best so far */
+    if (matcher->alternatives->len > 0 &&
+        g_array_index(matcher->alternatives, topic_match_alternative, 0).entry < best) {
+        if (matcher->combined) {
+            GMatchInfo *match_info = NULL;
+
+            if (g_regex_match(matcher->combined, topic, (GRegexMatchFlags) 0, &match_info)) {
+                for (i = 0; i < matcher->alternatives->len; i++) {
+                    gint start = -1;
+                    gint end = -1;
+
+                    alternative = &g_array_index(matcher->alternatives, topic_match_alternative, i);
+                    if (alternative->group < 0)
+                        continue;
+                    if (g_match_info_fetch_pos(match_info, alternative->group, &start, &end) && start >= 0) {
+                        if (alternative->entry < best)
+                            best = alternative->entry;
+                        break;
+                    }
+                }
+            }
+            g_match_info_free(match_info);
+        }
+
+        /* the alternatives left out of the combined regex, or all of them */
+        for (i = 0; i < matcher->alternatives->len; i++) {
+            gboolean match_found;
+
+            alternative = &g_array_index(matcher->alternatives, topic_match_alternative, i);
+            if (alternative->entry >= best)
+                break;
+            if (matcher->combined && !alternative->alone)
+                continue;
+            if (alternative->contains)
+                match_found = (strstr(topic, alternative->contains) != NULL);
+            else
+                match_found = g_regex_match(alternative->regex, topic, (GRegexMatchFlags) 0, NULL);
+            if (match_found) {
+                best = alternative->entry;
+                break;
+            }
+        }
+    }
+
+    if (best == G_MAXUINT)
+        return FALSE;
+    *entry = best;
+    return TRUE;
+}
+
+void
+topic_matcher_free(topic_matcher_t *matcher)
+{
+    topic_match_alternative *alternative;
+    guint i;
+
+    if (matcher == NULL)
+        return;
+
+    g_hash_table_destroy(matcher->equal);
+    topic_trie_node_free(&matcher->prefixes);
+    topic_trie_node_free(&matcher->suffixes);
+    topic_filter_node_free(&matcher->filters);
+    for (i = 0; i < matcher->alternatives->len; i++) {
+        alternative = &g_array_index(matcher->alternatives, topic_match_alternative, i);
+        g_free(alternative->contains);
+        if (alternative->regex)
+            g_regex_unref(alternative->regex);
+    }
+    g_array_free(matcher->alternatives, TRUE);
+    if (matcher->combined)
+        g_regex_unref(matcher->combined);
+    g_free(matcher);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
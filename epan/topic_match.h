@@ -0,0 +1,108 @@
+/* topic_match.h
+ * Definitions for matching message topics against a table of patterns
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __TOPIC_MATCH_H__
+#define __TOPIC_MATCH_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * Dissectors of message brokers such as AMQP and MQTT let the user pick the
+ * dissector of a message payload by its topic, in a table of patterns where
+ * the first matching entry wins. A topic_matcher_t compiles such a table
+ * into one structure, so that looking up a topic does not depend on the
+ * number of entries:
+ *
+ * - "equal to" patterns are kept in a hash table,
+ * - "starts with" and "ends with" patterns in a trie each, walked once
+ *   along the topic,
+ * - MQTT topic filters in a trie of topic levels with the + and #
+ *   wildcards,
+ * - "contains" and regular expression patterns are folded into a single
+ *   regular expression.
+ */
+
+/** How the pattern of an entry matches a topic. The values are stored in
+ * the message decoding tables of the dissectors and must not change. */
+typedef enum {
+    TOPIC_MATCH_EQUAL       = 0,
+    TOPIC_MATCH_CONTAINS    = 1,
+    TOPIC_MATCH_STARTS_WITH = 2,
+    TOPIC_MATCH_ENDS_WITH   = 3,
+    TOPIC_MATCH_REGEX       = 4,
+    TOPIC_MATCH_MQTT_FILTER = 5     /**< MQTT topic filter, levels separated by /, + and # wildcards */
+} topic_match_criteria_e;
+
+typedef struct _topic_matcher_t topic_matcher_t;
+
+/** Checks a pattern before it is added to a matcher, e.g. from the update
+ * callback of a UAT.
+ *
+ * @param criteria A topic_match_criteria_e.
+ * @param pattern The pattern.
+ * @param[out] error Set to a g_malloc'ed description of the problem if the
+ * pattern is not valid.
+ * @return TRUE if the pattern is valid.
+ */
+WS_DLL_PUBLIC gboolean topic_match_check_pattern(guint criteria, const char *pattern, char **error);
+
+/** Creates an empty matcher. */
+WS_DLL_PUBLIC topic_matcher_t *topic_matcher_new(void);
+
+/** Adds the next entry of the table to a matcher. Entries are numbered
+ * from 0 in the order they are added, including those that are not valid
+ * and never match.
+ *
+ * @param matcher The matcher, not yet compiled.
+ * @param criteria A topic_match_criteria_e.
+ * @param pattern The pattern, copied by the matcher.
+ * @return FALSE if the pattern is not valid.
+ */
+WS_DLL_PUBLIC gboolean topic_matcher_add(topic_matcher_t *matcher, guint criteria, const char *pattern);
+
+/** Prepares a matcher for lookups once all entries are added. */
+WS_DLL_PUBLIC void topic_matcher_compile(topic_matcher_t *matcher);
+
+/** Looks up the first entry matching a topic.
+ *
+ * @param matcher A compiled matcher.
+ * @param topic The topic, in UTF-8 if regular expressions are used.
+ * @param[out] entry The number of the first matching entry.
+ * @return TRUE if an entry matches.
+ */
+WS_DLL_PUBLIC gboolean topic_matcher_lookup(const topic_matcher_t *matcher, const char *topic, guint *entry);
+
+/** Frees a matcher, which may be NULL. */
+WS_DLL_PUBLIC void topic_matcher_free(topic_matcher_t *matcher);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TOPIC_MATCH_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
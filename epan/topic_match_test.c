@@ -0,0 +1,171 @@
+/* topic_match_test.c
+ * Topic matcher tests
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#undef G_DISABLE_ASSERT
+
+#include <glib.h>
+
+#include "topic_match.h"
+
+static gint
+lookup(const topic_matcher_t *matcher, const char *topic)
+{
+    guint entry;
+
+    return topic_matcher_lookup(matcher, topic, &entry) ? (gint)entry : -1;
+}
+
+static void
+topic_match_test_first_entry_wins(void)
+{
+    topic_matcher_t *matcher = topic_matcher_new();
+
+    topic_matcher_add(matcher, TOPIC_MATCH_STARTS_WITH, "sensors/");    /* 0 */
+    topic_matcher_add(matcher, TOPIC_MATCH_EQUAL, "sensors/a");         /* 1 */
+    topic_matcher_add(matcher, TOPIC_MATCH_ENDS_WITH, ".json");         /* 2 */
+    topic_matcher_add(matcher, TOPIC_MATCH_CONTAINS, "orders");         /* 3 */
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^queue\\.[0-9]+$");  /* 4 */
+    topic_matcher_add(matcher, TOPIC_MATCH_EQUAL, "orders");            /* 5 */
+    topic_matcher_add(matcher, TOPIC_MATCH_STARTS_WITH, "sen");         /* 6 */
+    topic_matcher_compile(matcher);
+
+    g_assert_cmpint(lookup(matcher, "sensors/a"), ==, 0);
+    g_assert_cmpint(lookup(matcher, "sensors"), ==, 6);
+    g_assert_cmpint(lookup(matcher, "se"), ==, -1);
+    g_assert_cmpint(lookup(matcher, "x.json"), ==, 2);
+    g_assert_cmpint(lookup(matcher, "sensors/orders.json"), ==, 0);
+    g_assert_cmpint(lookup(matcher, "orders"), ==, 3);
+    g_assert_cmpint(lookup(matcher, "new-orders.json"), ==, 2);
+    g_assert_cmpint(lookup(matcher, "queue.42"), ==, 4);
+    g_assert_cmpint(lookup(matcher, "queue.x"), ==, -1);
+    g_assert_cmpint(lookup(matcher, NULL), ==, -1);
+
+    topic_matcher_free(matcher);
+}
+
+static void
+topic_match_test_mqtt_filter(void)
+{
+    topic_matcher_t *matcher = topic_matcher_new();
+
+    topic_matcher_add(matcher, TOPIC_MATCH_MQTT_FILTER, "home/+/temp");  /* 0 */
+    topic_matcher_add(matcher, TOPIC_MATCH_MQTT_FILTER, "home/#");       /* 1 */
+    topic_matcher_add(matcher, TOPIC_MATCH_MQTT_FILTER, "+/x");          /* 2 */
+    topic_matcher_add(matcher, TOPIC_MATCH_MQTT_FILTER, "#");            /* 3 */
+    topic_matcher_compile(matcher);
+
+    g_assert_cmpint(lookup(matcher, "home/kitchen/temp"), ==, 0);
+    g_assert_cmpint(lookup(matcher, "home/kitchen/humidity"), ==, 1);
+    g_assert_cmpint(lookup(matcher, "home/kitchen/temp/max"), ==, 1);
+    g_assert_cmpint(lookup(matcher, "home"), ==, 1);
+    g_assert_cmpint(lookup(matcher, "garden/x"), ==, 2);
+    g_assert_cmpint(lookup(matcher, "garden"), ==, 3);
+    /* wildcards in the first level do not match topics starting with $ */
+    g_assert_cmpint(lookup(matcher, "$SYS/x"), ==, -1);
+
+    topic_matcher_free(matcher);
+}
+
+static void
+topic_match_test_check_pattern(void)
+{
+    topic_matcher_t *matcher = topic_matcher_new();
+    char *error = NULL;
+
+    g_assert_true(topic_match_check_pattern(TOPIC_MATCH_MQTT_FILTER, "+/+/#", &error));
+    g_assert_false(topic_match_check_pattern(TOPIC_MATCH_MQTT_FILTER, "a/#/b", &error));
+    g_assert_nonnull(error);
+    g_free(error);
+    error = NULL;
+    g_assert_false(topic_match_check_pattern(TOPIC_MATCH_MQTT_FILTER, "a+/b", &error));
+    g_free(error);
+    error = NULL;
+    g_assert_false(topic_match_check_pattern(TOPIC_MATCH_REGEX, "(", &error));
+    g_free(error);
+
+    /* entries that are not valid keep their number but never match */
+    g_assert_false(topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "("));
+    g_assert_true(topic_matcher_add(matcher, TOPIC_MATCH_CONTAINS, "("));
+    topic_matcher_compile(matcher);
+    g_assert_cmpint(lookup(matcher, "a(b"), ==, 1);
+
+    topic_matcher_free(matcher);
+}
+
+static void
+topic_match_test_back_reference(void)
+{
+    topic_matcher_t *matcher = topic_matcher_new();
+
+    /* does not survive being combined with other alternatives */
+    topic_matcher_add(matcher, TOPIC_MATCH_CONTAINS, "zz");
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^(a+)-\\1$");
+    topic_matcher_compile(matcher);
+
+    g_assert_cmpint(lookup(matcher, "aa-aa"), ==, 1);
+    g_assert_cmpint(lookup(matcher, "aa-a"), ==, -1);
+    g_assert_cmpint(lookup(matcher, "azz"), ==, 0);
+
+    topic_matcher_free(matcher);
+}
+
+static void
+topic_match_test_subroutine_call(void)
+{
+    topic_matcher_t *matcher = topic_matcher_new();
+
+    /* only the entries referring to their groups are left out of the
+     * combined regex */
+    topic_matcher_add(matcher, TOPIC_MATCH_CONTAINS, "zz");                 /* 0 */
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^(a|b)-(?1)$");          /* 1 */
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^x(?:(y)|z)(?(1)y|z)$"); /* 2 */
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^(q)(?-1)$");            /* 3 */
+    topic_matcher_add(matcher, TOPIC_MATCH_REGEX, "^r");                    /* 4 */
+    topic_matcher_compile(matcher);
+
+    g_assert_cmpint(lookup(matcher, "a-b"), ==, 1);
+    g_assert_cmpint(lookup(matcher, "a-"), ==, -1);
+    g_assert_cmpint(lookup(matcher, "xyy"), ==, 2);
+    g_assert_cmpint(lookup(matcher, "xzz"), ==, 0);
+    g_assert_cmpint(lookup(matcher, "xz"), ==, -1);
+    g_assert_cmpint(lookup(matcher, "qq"), ==, 3);
+    g_assert_cmpint(lookup(matcher, "rzz"), ==, 0);
+    g_assert_cmpint(lookup(matcher, "r-"), ==, 4);
+
+    topic_matcher_free(matcher);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/topic_match/first_entry_wins", topic_match_test_first_entry_wins);
+    g_test_add_func("/topic_match/mqtt_filter", topic_match_test_mqtt_filter);
+    g_test_add_func("/topic_match/check_pattern", topic_match_test_check_pattern);
+    g_test_add_func("/topic_match/back_reference", topic_match_test_back_reference);
+    g_test_add_func("/topic_match/subroutine_call", topic_match_test_subroutine_call);
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,188 @@
+/* tvb_composite_bench.c
+ * Standalone program to measure reading composite tvbuffs of many members.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* Usage: tvb_composite_bench [<members> [<member size> [<iterations>]]]
+ *
+ * Builds a composite of <members> subsets of one real tvbuff, like a
+ * PDU reassembled from as many TCP segments, and times
+ *   sequential   tvb_get_guint8() of every byte
+ *   random       tvb_get_ntohl() at pseudo random offsets
+ *   wide copies  tvb_memcpy() of ranges spanning several members,
+ *                with and without tvb_composite_set_flatten()
+ * checking every value read against the backing data.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "tvbuff.h"
+#include "exceptions.h"
+#include "wsutil/pint.h"
+
+static gboolean failed = FALSE;
+
+static tvbuff_t *
+new_composite(tvbuff_t *parent, guint members, guint member_size, gboolean flatten)
+{
+	tvbuff_t *tvb = tvb_new_composite();
+	guint i;
+
+	for (i = 0; i < members; i++) {
+		tvb_composite_append(tvb, tvb_new_subset_length(parent, i * member_size, member_size));
+	}
+	tvb_composite_set_flatten(tvb, flatten);
+	tvb_composite_finalize(tvb);
+	return tvb;
+}
+
+static gint64
+read_sequential(tvbuff_t *tvb, const guint8 *data)
+{
+	gint64 start = g_get_monotonic_time();
+	guint length = tvb_captured_length(tvb);
+	guint offset;
+
+	for (offset = 0; offset < length; offset++) {
+		if (tvb_get_guint8(tvb, offset) != data[offset]) {
+			printf("Sequential read at %u differs\n", offset);
+			failed = TRUE;
+			break;
+		}
+	}
+	return g_get_monotonic_time() - start;
+}
+
+static gint64
+read_random(tvbuff_t *tvb, const guint8 *data, guint count)
+{
+	gint64 start = g_get_monotonic_time();
+	guint length = tvb_captured_length(tvb);
+	guint32 seed = 1;
+	guint offset;
+	guint i;
+
+	for (i = 0; i < count; i++) {
+		seed = seed * 1103515245 + 12345;
+		offset = (seed >> 8) % (length - 3);
+		if (tvb_get_ntohl(tvb, offset) != pntoh32(&data[offset])) {
+			printf("Random read at %u differs\n", offset);
+			failed = TRUE;
+			break;
+		}
+	}
+	return g_get_monotonic_time() - start;
+}
+
+static gint64
+copy_wide(tvbuff_t *tvb, const guint8 *data, guint width, guint count)
+{
+	gint64 start = g_get_monotonic_time();
+	guint length = tvb_captured_length(tvb);
+	guint8 *buf = (guint8 *)g_malloc(width);
+	guint offset = 0;
+	guint i;
+
+	for (i = 0; i < count; i++) {
+		if (offset + width > length) {
+			offset = 0;
+		}
+		tvb_memcpy(tvb, buf, offset, width);
+		if (memcmp(buf, &data[offset], width) != 0) {
+			printf("Copy of %u bytes at %u differs\n", width, offset);
+			failed = TRUE;
+			break;
+		}
+		offset += width / 2 + 1;
+	}
+	g_free(buf);
+	return g_get_monotonic_time() - start;
+}
+
+static void
+run_bench(guint members, guint member_size, int iterations)
+{
+	guint length = members * member_size;
+	guint8 *data = (guint8 *)g_malloc(length);
+	guint width = MIN(8 * member_size, length);
+	guint count = MAX(length / 4, 1);
+	gint64 sequential_time = 0, random_time = 0, copy_time = 0, flatten_time = 0;
+	tvbuff_t *parent;
+	tvbuff_t *tvb;
+	guint i;
+	int n;
+
+	for (i = 0; i < length; i++) {
+		data[i] = (guint8)(i * 7 + (i >> 8));
+	}
+	parent = tvb_new_real_data(data, length, length);
+
+	for (n = 0; n < iterations; n++) {
+		tvb = new_composite(parent, members, member_size, FALSE);
+		sequential_time += read_sequential(tvb, data);
+		random_time += read_random(tvb, data, count);
+
+		/* A fresh composite, as reads spanning two members flatten it */
+		tvb = new_composite(parent, members, member_size, FALSE);
+		copy_time += copy_wide(tvb, data, width, 1000);
+
+		tvb = new_composite(parent, members, member_size, TRUE);
+		flatten_time += copy_wide(tvb, data, width, 1000);
+	}
+	tvb_free_chain(parent);
+	g_free(data);
+
+	printf("%u members of %u bytes, average of %d iterations:\n", members, member_size, iterations);
+	printf("  sequential %7u x 1 byte:    %10.3f ms\n", length, sequential_time / 1000.0 / iterations);
+	printf("  random     %7u x 4 bytes:   %10.3f ms\n", count, random_time / 1000.0 / iterations);
+	printf("  wide copy     1000 x %u bytes: %10.3f ms\n", width, copy_time / 1000.0 / iterations);
+	printf("  flattened     1000 x %u bytes: %10.3f ms\n", width, flatten_time / 1000.0 / iterations);
+}
+
+int
+main(int argc, char **argv)
+{
+	guint members = 1000;
+	guint member_size = 1460;
+	int iterations = 3;
+
+	if (argc > 1) {
+		members = MAX(atoi(argv[1]), 1);
+	}
+	if (argc > 2) {
+		member_size = MAX(atoi(argv[2]), 4);
+	}
+	if (argc > 3) {
+		iterations = MAX(atoi(argv[3]), 1);
+	}
+
+	except_init();
+	run_bench(members, member_size, iterations);
+	except_deinit();
+
+	return failed ? 1 : 0;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -402,10 +402,10 @@ run_tests(void)
 	guint		subset_length[6];
 	guint		subset_reported_length[6];
 	guint8		temp;
-	guint8		*comp[6];
-	tvbuff_t	*tvb_comp[6];
-	guint		comp_length[6];
-	guint		comp_reported_length[6];
+	guint8		*comp[7];
+	tvbuff_t	*tvb_comp[7];
+	guint		comp_length[7];
+	guint		comp_reported_length[7];
 	tvbuff_t	*tvb_comp_subset;
 	guint		comp_subset_length;
 	guint		comp_subset_reported_length;
@@ -577,6 +577,34 @@ run_tests(void)
 	tvb_composite_append(tvb_comp[5], tvb_comp[3]);
 	tvb_composite_finalize(tvb_comp[5]);
 
+	/* 6 reals, some of them prepended, flattened on the first wide copy */
+	printf("Making Composite 6\n");
+	tvb_comp[6]		= tvb_new_composite();
+	comp_length[6]		= 0;
+	comp_reported_length[6]	= 0;
+	for (i = 0; i < 3; i++) {
+		comp_length[6] += small_length[i] + large_length[i];
+		comp_reported_length[6] += small_reported_length[i] + large_reported_length[i];
+	}
+	comp[6]			= (guint8*)g_malloc(comp_length[6]);
+
+	len = 0;
+	for (i = 0; i < 3; i++) {
+		memcpy(&comp[6][len], small[i], small_length[i]);
+		len += small_length[i];
+		memcpy(&comp[6][len], large[i], large_length[i]);
+		len += large_length[i];
+	}
+
+	tvb_composite_append(tvb_comp[6], tvb_small[1]);
+	tvb_composite_append(tvb_comp[6], tvb_large[1]);
+	tvb_composite_prepend(tvb_comp[6], tvb_large[0]);
+	tvb_composite_prepend(tvb_comp[6], tvb_small[0]);
+	tvb_composite_append(tvb_comp[6], tvb_small[2]);
+	tvb_composite_append(tvb_comp[6], tvb_large[2]);
+	tvb_composite_set_flatten(tvb_comp[6], TRUE);
+	tvb_composite_finalize(tvb_comp[6]);
+
 	/* A subset of one of the composites. */
 	tvb_comp_subset = tvb_new_subset_remaining(tvb_comp[1], 1);
 	comp_subset = &comp[1][1];
@@ -590,6 +618,7 @@ run_tests(void)
 	test(tvb_comp[3], "Composite 3", comp[3], comp_length[3], comp_reported_length[3]);
 	test(tvb_comp[4], "Composite 4", comp[4], comp_length[4], comp_reported_length[4]);
 	test(tvb_comp[5], "Composite 5", comp[5], comp_length[5], comp_reported_length[5]);
+	test(tvb_comp[6], "Composite 6", comp[6], comp_length[6], comp_reported_length[6]);
 
 	/* Test the subset of the composite. */
 	test(tvb_comp_subset, "Subset of Composite", comp_subset, comp_subset_length, comp_subset_reported_length);
@@ -601,6 +630,7 @@ run_tests(void)
 	g_free(comp[3]);
 	g_free(comp[4]);
 	g_free(comp[5]);
+	g_free(comp[6]);
 
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
@@ -205,11 +205,18 @@ WS_DLL_PUBLIC tvbuff_t *tvb_new_subset_remaining(tvbuff_t *backing,
 WS_DLL_PUBLIC void tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member);
 
 /** Prepend to the list of tvbuffs that make up this composite tvbuff */
-extern void tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member);
+WS_DLL_PUBLIC void tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member);
 
 /** Create an empty composite tvbuff. */
 WS_DLL_PUBLIC tvbuff_t *tvb_new_composite(void);
 
+/** Have a composite tvbuff copy all of its members into one buffer the
+ * first time a tvb_memcpy() spans more than one of them, instead of
+ * gathering the pieces again on every such copy. Worth it for composites
+ * of many members that are read as a whole more than once, at the cost of
+ * a copy of the data. */
+WS_DLL_PUBLIC void tvb_composite_set_flatten(tvbuff_t *tvb, gboolean flatten);
+
 /** Mark a composite tvbuff as initialized. No further appends or prepends
  * occur, data access can finally happen after this finalization. */
 WS_DLL_PUBLIC void tvb_composite_finalize(tvbuff_t *tvb);
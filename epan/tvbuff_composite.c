@@ -11,12 +11,19 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "tvbuff.h"
 #include "tvbuff-int.h"
 #include "proto.h"	/* XXX - only used for DISSECTOR_ASSERT, probably a new header file? */
 
 typedef struct {
-	GSList		*tvbs;
+	/* The member tvbuffs, in order. They are kept in an array rather
+	 * than a list so that the member holding an offset can be found
+	 * with a binary search over end_offsets. */
+	tvbuff_t	**tvbs;
+	guint		num_members;
+	guint		alloc_members;
 
 	/* Used for quick testing to see if this
 	 * is the tvbuff that a COMPOSITE is
@@ -24,6 +31,14 @@ typedef struct {
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* Member of the last access, tried first as dissectors mostly
+	 * read sequentially. */
+	guint		last_member;
+
+	/* Copy all members into real_data the first time an access
+	 * spans more than one member. */
+	gboolean	flatten;
+
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -38,7 +53,7 @@ composite_free(tvbuff_t *tvb)
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
 
-	g_slist_free(composite->tvbs);
+	g_free(composite->tvbs);
 
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
@@ -51,37 +66,75 @@ composite_offset(const tvbuff_t *tvb _U_, const guint counter)
 	return counter;
 }
 
+/* Returns the index of the member holding abs_offset, or num_members
+ * if abs_offset is the end of the composite. */
+static guint
+composite_find_member(tvb_comp_t *composite, guint abs_offset)
+{
+	guint i = composite->last_member;
+	guint low, high, mid;
+
+	if (abs_offset >= composite->start_offsets[i]) {
+		if (abs_offset <= composite->end_offsets[i]) {
+			return i;
+		}
+		/* The next member, when reading past the end of the last one */
+		if (i + 1 < composite->num_members && abs_offset <= composite->end_offsets[i + 1]) {
+			composite->last_member = i + 1;
+			return i + 1;
+		}
+	}
+
+	low = 0;
+	high = composite->num_members;
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (composite->end_offsets[mid] < abs_offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low < composite->num_members) {
+		composite->last_member = low;
+	}
+	return low;
+}
+
+static const guint8*
+composite_flatten(tvbuff_t *tvb)
+{
+	/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
+	void *real_data = g_malloc(tvb->length);
+	tvb_memcpy(tvb, real_data, 0, tvb->length);
+	tvb->real_data = (const guint8 *)real_data;
+	return tvb->real_data;
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = composite->tvbs[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
@@ -92,11 +145,7 @@ composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
 	else {
-		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
-		void *real_data = g_malloc(tvb->length);
-		tvb_memcpy(tvb, real_data, 0, tvb->length);
-		tvb->real_data = (const guint8 *)real_data;
-		return tvb->real_data + abs_offset;
+		return composite_flatten(tvb) + abs_offset;
 	}
 
 	DISSECTOR_ASSERT_NOT_REACHED();
@@ -108,58 +157,67 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
+	member_tvb = composite->tvbs[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
 	}
+	else if (composite->flatten && abs_length < tvb->length) {
+		/* Every later access is served from the flattened copy. (Copying
+		 * the whole composite is how it gets flattened, so that is left
+		 * to the loop below.) */
+		return memcpy(target, composite_flatten(tvb) + abs_offset, abs_length);
+	}
 	else {
 		/* The requested data is non-contiguous inside
 		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
+		 * then iterate across the following member tvb's, copying their portions
 		 * until we have copied all data.
 		 */
-		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
-
-		/* composite_memcpy() can't handle a member_length of zero. */
-		DISSECTOR_ASSERT(member_length > 0);
-
-		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
-		abs_length	-= member_length;
-
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
+		guint8 *dst = target;
+
+		for (;;) {
+			member_length = tvb_captured_length_remaining(member_tvb, member_offset);
+
+			/* composite_memcpy() can't handle a member_length of zero. */
+			DISSECTOR_ASSERT(member_length > 0);
+
+			if (member_length > abs_length) {
+				member_length = abs_length;
+			}
+			tvb_memcpy(member_tvb, dst, member_offset, member_length);
+			dst        += member_length;
+			abs_length -= member_length;
+
+			if (abs_length == 0) {
+				break;
+			}
+			i++;
+			DISSECTOR_ASSERT(i < composite->num_members);
+			member_tvb = composite->tvbs[i];
+			member_offset = 0;
 		}
+		composite->last_member = i;
 
 		return target;
 	}
@@ -199,14 +257,18 @@ tvb_new_composite(void)
 	tvb_comp_t *composite = &composite_tvb->composite;
 
 	composite->tvbs		 = NULL;
+	composite->num_members	 = 0;
+	composite->alloc_members = 0;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
+	composite->last_member	 = 0;
+	composite->flatten	 = FALSE;
 
 	return tvb;
 }
 
-void
-tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
+static void
+composite_add_member(tvbuff_t *tvb, tvbuff_t *member, gboolean prepend)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite;
@@ -219,47 +281,56 @@ tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
 	 */
 	DISSECTOR_ASSERT(member->length);
 
-	composite       = &composite_tvb->composite;
-	composite->tvbs = g_slist_append(composite->tvbs, member);
+	composite = &composite_tvb->composite;
+	if (composite->num_members == composite->alloc_members) {
+		composite->alloc_members = composite->alloc_members ? 2 * composite->alloc_members : 4;
+		composite->tvbs = g_renew(tvbuff_t *, composite->tvbs, composite->alloc_members);
+	}
+
+	if (prepend) {
+		memmove(&composite->tvbs[1], &composite->tvbs[0], composite->num_members * sizeof(tvbuff_t *));
+		composite->tvbs[0] = member;
+	} else {
+		composite->tvbs[composite->num_members] = member;
+	}
+	composite->num_members++;
 
 	/* Attach the composite TVB to the first TVB only. */
-	if (!composite->tvbs->next) {
-		tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb);
+	if (composite->num_members == 1) {
+		tvb_add_to_chain(member, tvb);
 	}
 }
 
 void
-tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
+tvb_composite_append(tvbuff_t *tvb, tvbuff_t *member)
 {
-	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	tvb_comp_t *composite;
+	composite_add_member(tvb, member, FALSE);
+}
 
-	DISSECTOR_ASSERT(tvb && !tvb->initialized);
-	DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops);
+void
+tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
+{
+	composite_add_member(tvb, member, TRUE);
+}
 
-	/* Don't allow zero-length TVBs: composite_memcpy() can't handle them
-	 * and anyway it makes no sense.
-	 */
-	DISSECTOR_ASSERT(member->length);
+void
+tvb_composite_set_flatten(tvbuff_t *tvb, gboolean flatten)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 
-	composite       = &composite_tvb->composite;
-	composite->tvbs = g_slist_prepend(composite->tvbs, member);
+	DISSECTOR_ASSERT(tvb && tvb->ops == &tvb_composite_ops);
 
-	/* Attach the composite TVB to the first TVB only. */
-	if (!composite->tvbs->next) {
-		tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb);
-	}
+	composite_tvb->composite.flatten = flatten;
 }
 
 void
 tvb_composite_finalize(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	GSList	   *slist;
 	guint	    num_members;
 	tvbuff_t   *member_tvb;
 	tvb_comp_t *composite;
-	int	    i = 0;
+	guint	    i;
 
 	DISSECTOR_ASSERT(tvb && !tvb->initialized);
 	DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops);
@@ -268,7 +339,7 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	DISSECTOR_ASSERT(tvb->contained_length == 0);
 
 	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
+	num_members = composite->num_members;
 
 	/* Dissectors should not create composite TVBs if they're not going to
 	 * put at least one TVB in them.
@@ -279,15 +350,13 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
-	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
-		DISSECTOR_ASSERT((guint) i < num_members);
-		member_tvb = (tvbuff_t *)slist->data;
+	for (i = 0; i < num_members; i++) {
+		member_tvb = composite->tvbs[i];
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
 		tvb->contained_length += member_tvb->contained_length;
 		composite->end_offsets[i] = tvb->length - 1;
-		i++;
 	}
 
 	tvb->initialized = TRUE;
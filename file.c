@@ -284,6 +284,12 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   cf->provider.wth = wth;
   cf->f_datalen = 0;
 
+  /* Have cf_read_record_mapped() dissect packets where they are in the
+     file. A temporary file is being written by a capture in progress,
+     so it isn't mapped. */
+  if (!is_tempfile)
+    wtap_map_file(wth);
+
   /* Set the file name because we need it to set the follow stream filter.
      XXX - is that still true?  We need it for other reasons, though,
      in any case. */
@@ -1602,6 +1608,24 @@ cf_read_record_no_alert(capture_file *cf, const frame_data *fdata,
   return TRUE;
 }
 
+gboolean
+cf_read_record_mapped(capture_file *cf, const frame_data *fdata,
+                      wtap_rec *rec, Buffer *buf, const guint8 **data,
+                      gboolean show_alert)
+{
+  int    err;
+  gchar *err_info;
+
+  if (!wtap_seek_read_mapped(cf->provider.wth, fdata->file_off, rec, buf, data, &err, &err_info)) {
+    if (show_alert)
+      cfile_read_failure_alert_box(cf->filename, err, err_info);
+    else
+      g_free(err_info);
+    return FALSE;
+  }
+  return TRUE;
+}
+
 gboolean
 cf_read_current_record(capture_file *cf)
 {
@@ -166,6 +166,25 @@ gboolean cf_read_record(capture_file *cf, const frame_data *fdata,
 gboolean cf_read_record_no_alert(capture_file *cf, const frame_data *fdata,
                                  wtap_rec *rec, Buffer *buf);
 
+/**
+ * Same as cf_read_record(), but the record's data might be left in the
+ * mapped capture file rather than read into buf; *data points to it
+ * either way. *data must not be kept after the record is dissected.
+ *
+ * @param cf the capture file from which to read the record
+ * @param fdata the frame_data structure for the record in question
+ * @param rec pointer to a wtap_rec structure to contain the
+ * record's metadata
+ * @param buf a Buffer into which to read the record's raw data if
+ * it isn't used from the mapped file
+ * @param data set to the record's raw data
+ * @param show_alert TRUE to pop up an alert box on error
+ * @return TRUE if the read succeeded, FALSE if there was an error
+ */
+gboolean cf_read_record_mapped(capture_file *cf, const frame_data *fdata,
+                               wtap_rec *rec, Buffer *buf,
+                               const guint8 **data, gboolean show_alert);
+
 
 /**
  * Read the metadata and raw data for the current record into a
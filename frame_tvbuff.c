@@ -241,7 +241,9 @@ frame_clone(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 
 	cloned_tvb = tvb_new(&tvb_frame_ops);
 
-	/* data will be read when needed */
+	/* data will be read when needed, into a buffer of its own even if
+	 * the frame's data is in the mapped file (see wtap_seek_read_mapped()),
+	 * as a clone can be kept longer than the mapping is valid */
 	cloned_tvb->real_data        = NULL;
 	cloned_tvb->length           = abs_length;
 	cloned_tvb->reported_length  = abs_length; /* XXX? */
@@ -19,6 +19,8 @@
 extern "C" {
 #endif /* __cplusplus */
 
+/* buf is used in place, so it can be the data returned by
+ * wtap_seek_read_mapped() in the mapped capture file. */
 extern tvbuff_t *frame_tvbuff_new(const struct packet_provider_data *prov,
     const frame_data *fd, const guint8 *buf);
 
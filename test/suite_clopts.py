@@ -306,3 +306,26 @@ class case_tshark_extcap(subprocesstest.SubprocessTestCase):
         # Ensure tshark lists 2 interfaces in the preferences
         self.assertRun((cmd_tshark, '-G', 'currentprefs'), env=test_env)
         self.assertEqual(2, self.countOutput('extcap.sampleif.test'))
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_tshark_registry_snapshot(subprocesstest.SubprocessTestCase):
+    def test_tshark_registry_snapshot(self, cmd_tshark, capture_file, test_env, home_path):
+        '''Fields found through the registry snapshot filter like registered ones'''
+        snapshot_file = os.path.join(home_path, 'registry_snapshot')
+        tshark_args = (cmd_tshark, '-r', capture_file('http.pcap'),
+            '-Y', 'http.request.method == "HEAD" && tcp.flags.str == "·······AP···"',
+            '-T', 'fields', '-e', 'frame.number', '-e', 'http.request.uri')
+        expected = self.assertRun(tshark_args, env=test_env).stdout_str
+        self.assertTrue('/v4/iuident.cab' in expected)
+        test_env['WIRESHARK_REGISTRY_SNAPSHOT'] = snapshot_file
+        # the first run writes the snapshot, the second one uses it
+        self.assertEqual(self.assertRun(tshark_args, env=test_env).stdout_str, expected)
+        self.assertTrue(os.path.isfile(snapshot_file))
+        self.assertEqual(self.assertRun(tshark_args, env=test_env).stdout_str, expected)
+        # a damaged snapshot is ignored and replaced
+        with open(snapshot_file, 'r+b') as f:
+            f.truncate(100)
+        self.assertEqual(self.assertRun(tshark_args, env=test_env).stdout_str, expected)
+        self.assertGreater(os.path.getsize(snapshot_file), 100)
@@ -596,6 +596,19 @@ class case_decrypt_tls(subprocesstest.SubprocessTestCase):
             )).stdout_str
         self.assertEqual('example.com\t\n\t200\nexample.net\t\n\t200\n', output)
 
+    def test_tls12_spilled_records(self, cmd_tshark, capture_file):
+        '''Decrypted records over the memory limit are read back from disk on the second pass.'''
+        output = self.assertRun((cmd_tshark,
+                '-r', capture_file('tls12-dsb.pcapng'),
+                '-2',
+                '-o', 'tls.record_cache_limit:1',
+                '-Tfields',
+                '-e', 'http.host',
+                '-e', 'http.response.code',
+                '-Y', 'http',
+            )).stdout_str
+        self.assertEqual('example.com\t\n\t200\nexample.net\t\n\t200\n', output)
+
 
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
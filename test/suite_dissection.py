@@ -13,6 +13,235 @@ import subprocesstest
 import unittest
 import fixtures
 import sys
+import tempfile
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_dissect_amqp(subprocesstest.SubprocessTestCase):
+    def test_amqp_large_prefetch_acks(self, cmd_tshark, capture_file):
+        # 50000 basic.deliver frames in windows of 5000 unacked messages,
+        # 100 per frame. The first nine windows are acknowledged one by one,
+        # 50 frames later; the last one with a single multiple ack.
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-large-prefetch.pcap.gz'),
+                '-2',
+                '-Tfields', '-eframe.number', '-eamqp.ack_in', '-eamqp.message_in',
+            ))
+        ack_in = {}
+        message_in = {}
+        for line in proc.stdout_str.splitlines():
+            fields = line.split('\t')
+            frame = int(fields[0])
+            ack_in[frame] = [int(f) for f in fields[1].split(',') if f]
+            message_in[frame] = [int(f) for f in fields[2].split(',') if f]
+        for window in range(9):
+            for n in range(50):
+                deliver_frame = 5 + 100 * window + n
+                ack_frame = deliver_frame + 50
+                self.assertEqual(ack_in[deliver_frame], [ack_frame] * 100)
+                self.assertEqual(message_in[ack_frame], [deliver_frame] * 100)
+        for deliver_frame in range(905, 955):
+            self.assertEqual(ack_in[deliver_frame], [955] * 100)
+        self.assertEqual(sorted(message_in[955]),
+                [frame for frame in range(905, 955) for _ in range(100)])
+
+    def test_amqp_max_unacked_deliveries(self, cmd_tshark, capture_file):
+        # Only the last 1000 deliveries of each window of 5000 stay tracked
+        # and are matched to their ack.
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-large-prefetch.pcap.gz'),
+                '-2', '-o', 'amqp.max_unacked_deliveries:1000',
+                '-Tfields', '-eamqp.message_in',
+            ))
+        message_in = []
+        for line in proc.stdout_str.splitlines():
+            message_in += [f for f in line.split(',') if f]
+        self.assertEqual(len(message_in), 10000)
+
+    def test_amqp_channel_close(self, cmd_tshark, capture_file):
+        # Channel 1 is closed with two deliveries unacked, then reopened;
+        # the connection is closed with the three deliveries of channel 2
+        # unacked.
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-channel-close.pcap'),
+                '-2',
+                '-Tfields', '-eframe.number', '-eamqp.unacked_at_close', '-eamqp.message_in',
+            ))
+        lines = proc.stdout_str.splitlines()
+        self.assertEqual(lines[7], '8\t2\t')
+        self.assertEqual(lines[9], '10\t\t9')
+        self.assertEqual(lines[11], '12\t3\t')
+
+    def test_amqp_queue_depth(self, cmd_tshark, capture_file):
+        # queue.declare-ok reports 5 messages, two are published directly
+        # and through a topic binding, two delivered, one acked and one
+        # nacked back into the queue.
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-queue-depth.pcap'),
+                '-Tfields', '-eframe.number', '-eamqp.queue_state.ready',
+                '-eamqp.queue_state.unacked', '-eamqp.queue_state.depth',
+            ))
+        lines = proc.stdout_str.splitlines()
+        self.assertEqual(lines[5], '6\t5\t0\t5')
+        self.assertEqual(lines[9], '10\t7\t0\t7')
+        self.assertEqual(lines[10], '11\t\t\t')
+        self.assertEqual(lines[14], '15\t5\t2\t7')
+        self.assertEqual(lines[16], '17\t6\t0\t6')
+
+    def test_amqp_close_requeue(self, cmd_tshark, capture_file):
+        # queue.declare-ok reports 4 messages and two are delivered on
+        # channel 1. One is acked and the other goes back to the queue
+        # when the channel is closed. Channel 2 gets one more, which
+        # basic.recover requeues.
+        proc = self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-close-requeue.pcap'),
+                '-Tfields', '-eframe.number', '-eamqp.queue_state.ready',
+                '-eamqp.queue_state.unacked', '-eamqp.queue_state.depth',
+                '-eamqp.unacked_at_close',
+            ))
+        lines = proc.stdout_str.splitlines()
+        self.assertEqual(lines[5], '6\t4\t0\t4\t')
+        self.assertEqual(lines[9], '10\t2\t1\t3\t')
+        self.assertEqual(lines[11], '12\t3\t0\t3\t1')
+        self.assertEqual(lines[14], '15\t2\t1\t3\t')
+        self.assertEqual(lines[15], '16\t3\t0\t3\t')
+
+    def test_amqp_queues(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-queue-depth.pcap'),
+                '-q', '-z', 'amqp,queues,2',
+            ))
+        # ready, unacked, depth, max depth, its time and consumers
+        self.assertTrue(self.grepOutput(r'^orders\s+6\s+0\s+6\s+7\s+4\.500\s+0$'))
+        self.assertTrue(self.grepOutput(r'^6\.000\s+5\s+1\s+6\s+7$'))
+
+    def test_amqp_stats_tree(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-large-prefetch.pcap.gz'),
+                '-q', '-z', 'amqp,tree',
+            ))
+        self.assertTrue(self.grepOutput(r'Acked\s+50000\s'))
+        self.assertTrue(self.grepOutput(r'Consumer Acks by Queue\s+50000\s'))
+
+    def test_amqp_ack_latency(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-large-prefetch.pcap.gz'),
+                '-q', '-z', 'amqp,latency', '-z', 'amqp,rtd',
+            ))
+        # stream 0, channel 1, queue taken from the routing key
+        self.assertTrue(self.grepOutput(r'^0\s+1\s+q\s+50000\s'))
+        self.assertTrue(self.grepOutput(r'Consumer Ack\s+\|\s+50000\s'))
+
+    def test_amqp_1_0_link_credit(self, cmd_tshark, capture_file):
+        # A link granted 2 credits sends 3 transfers, is starved of credit
+        # and gets 5 more credits half a second later.
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp1-credit.pcap'),
+                '-Tfields', '-eframe.number', '-eamqp.link.credit',
+                '-eamqp.session.window', '-eamqp.link.blocked_in',
+                '-eamqp.link.blocked_time',
+            ))
+        self.assertTrue(self.grepOutput(r'^15\t-1\t0\t\t$'))
+        self.assertTrue(self.grepOutput(r'^16\t0\t3\t\t$'))
+        self.assertTrue(self.grepOutput(r'^17\t5\t10\t14\t0\.5002'))
+        self.assertTrue(self.grepOutput(r'^18\t4\t9\t\t$'))
+
+    def test_amqp_midstream_resync(self, cmd_tshark, capture_file):
+        # The capture starts in the tail of a content body that looks like
+        # the header of a 1 MB frame, followed by basic.deliver frames.
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-midstream.pcap'),
+                '-2',
+                '-Tfields', '-eframe.number',
+                '-eamqp.method.arguments.delivery_tag', '-e_ws.col.Info',
+            ))
+        self.assertTrue(self.grepOutput(r'^1\t1,2\t\[Continuation\] '))
+        self.assertTrue(self.grepOutput(r'^2\t3,4\t'))
+        self.assertTrue(self.grepOutput(r'^3\t4\t'))
+
+    def test_amqp_0_10_command_ids(self, cmd_tshark, capture_file):
+        # The client sends queue.declare, message.transfer and execution.sync,
+        # completed together a quarter of a second later, then a queue.query
+        # answered by an execution.result and completed on its own.
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp0-10-commands.pcap'),
+                '-2',
+                '-Tfields', '-eframe.number', '-eamqp.command.id',
+                '-eamqp.command.completed_in', '-eamqp.command.result_in',
+                '-eamqp.command.completed', '-eamqp.command.command_in',
+            ))
+        self.assertTrue(self.grepOutput(r'^9\t0\t12\t\t\t$'))
+        self.assertTrue(self.grepOutput(r'^10\t1\t12\t\t\t$'))
+        self.assertTrue(self.grepOutput(r'^11\t2\t12\t\t\t$'))
+        self.assertTrue(self.grepOutput(r'^12\t\t\t\t0,1,2\t9,10,11$'))
+        self.assertTrue(self.grepOutput(r'^13\t3\t15\t14\t\t$'))
+        self.assertTrue(self.grepOutput(r'^14\t0\t\t\t\t13$'))
+        self.assertTrue(self.grepOutput(r'^15\t\t\t\t3\t13$'))
+
+    def test_amqp_0_10_command_srt(self, cmd_tshark, capture_file):
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp0-10-commands.pcap'),
+                '-q', '-z', 'srt,amqp',
+            ))
+        self.assertTrue(self.grepOutput(r'execution\.sync\s+1\s+0\.250000\s'))
+        self.assertTrue(self.grepOutput(r'queue\.query\s+1\s'))
+
+    def test_amqp_frame_summary_cache(self, cmd_tshark, capture_file):
+        # The second pass of -2 builds no tree for the summary lines and
+        # takes the Info column and the taps from the cached summaries.
+        for capture in ('amqp-large-prefetch.pcap.gz', 'amqp1-credit.pcap'):
+            outputs = []
+            for cache in ('TRUE', 'FALSE'):
+                outputs.append(self.assertRun((cmd_tshark,
+                        '-r', capture_file(capture),
+                        '-2',
+                        '-o', 'amqp.cache_frame_summaries:' + cache,
+                        '-z', 'amqp,tree',
+                    )).stdout_str)
+            self.assertEqual(outputs[0], outputs[1])
+
+    def test_amqp_export_objects(self, cmd_tshark, capture_file):
+        # Four 1.0 transfers, each carrying "hi" in a data section, are
+        # written out named after the frame and the delivery tag.
+        with tempfile.TemporaryDirectory(prefix='amqp-export-') as export_dir:
+            self.assertRun((cmd_tshark,
+                    '-r', capture_file('amqp1-credit.pcap'),
+                    '-Q', '--export-objects', 'amqp,' + export_dir,
+                ))
+            names = sorted(os.listdir(export_dir))
+            self.assertEqual([name.split('-', 1)[1] for name in names],
+                    ['13-00', '14-01', '15-02', '18-03'])
+            for name in names:
+                with open(os.path.join(export_dir, name), 'rb') as f:
+                    self.assertEqual(f.read(), b'hi')
+        # A request published and a reply delivered on the same channel,
+        # their bodies split over two frames each and interleaved.
+        with tempfile.TemporaryDirectory(prefix='amqp-export-') as export_dir:
+            self.assertRun((cmd_tshark,
+                    '-r', capture_file('amqp-rpc-bodies.pcap'),
+                    '-Q', '--export-objects', 'amqp,' + export_dir,
+                ))
+            self.assertEqual(sorted(os.listdir(export_dir)),
+                    ['replies-8-1', 'requests-7'])
+            with open(os.path.join(export_dir, 'requests-7'), 'rb') as f:
+                self.assertEqual(f.read(), b'request body')
+            with open(os.path.join(export_dir, 'replies-8-1'), 'rb') as f:
+                self.assertEqual(f.read(), b'reply body')
+
+    def test_amqp_interleaved_bodies(self, cmd_tshark, capture_file):
+        # The bodies published and delivered on one channel are reassembled
+        # separately.
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('amqp-rpc-bodies.pcap'),
+                '-2',
+                '-Tfields', '-eframe.number', '-eamqp.reassembled.in',
+                '-eamqp.reassembled.length',
+            ))
+        self.assertTrue(self.grepOutput(r'^5\t7\t$'))
+        self.assertTrue(self.grepOutput(r'^6\t8\t$'))
+        self.assertTrue(self.grepOutput(r'^7\t\t12$'))
+        self.assertTrue(self.grepOutput(r'^8\t\t10$'))
 
 
 @fixtures.mark_usefixtures('test_env')
@@ -296,6 +525,25 @@ class case_dissect_protobuf(subprocesstest.SubprocessTestCase):
             ))
         self.assertTrue(self.grepOutput('PB[(]test.map.MapMaster[)]'))
 
+    def test_protobuf_packed_repeated_fields(self, cmd_tshark, features, dirs, capture_file):
+        '''Test Protobuf packed repeated fields, and field numbers looked up by binary search'''
+        well_know_types_dir = os.path.join(dirs.protobuf_lang_files_dir, 'well_know_types').replace('\\', '/')
+        user_defined_types_dir = os.path.join(dirs.protobuf_lang_files_dir, 'user_defined_types').replace('\\', '/')
+        self.assertRun((cmd_tshark,
+                '-r', capture_file('protobuf_test_packed_repeated.pcapng'),
+                '-o', 'uat:protobuf_search_paths: "{}","{}"'.format(well_know_types_dir, 'FALSE'),
+                '-o', 'uat:protobuf_search_paths: "{}","{}"'.format(user_defined_types_dir, 'TRUE'),
+                '-o', 'uat:protobuf_udp_message_types: "8129","test.packed.PackedMaster"',
+                '-o', 'protobuf.preload_protos: TRUE',
+                '-o', 'protobuf.pbf_as_hf: TRUE',
+                '-Y', 'pbf.test.packed.PackedMaster.param1 == 1 && pbf.test.packed.PackedMaster.param1 == 10'
+                      ' && pbf.test.packed.PackedMaster.param2 == 300 && pbf.test.packed.PackedMaster.param2 == 1099511627776'
+                      ' && pbf.test.packed.PackedMaster.param3 == -64 && pbf.test.packed.PackedMaster.param4 == 2'
+                      ' && pbf.test.packed.PackedMaster.param5 == 8 && pbf.test.packed.PackedMaster.param6 == "packed"'
+                      ' && count(pbf.test.packed.PackedMaster.param1) == 10',
+            ))
+        self.assertTrue(self.grepOutput('PB[(]test.packed.PackedMaster[)]'))
+
     def test_protobuf_default_value(self, cmd_tshark, features, dirs, capture_file):
         '''Test Protobuf feature adding missing fields with default values'''
         well_know_types_dir = os.path.join(dirs.protobuf_lang_files_dir, 'well_know_types').replace('\\', '/')
@@ -321,6 +569,34 @@ class case_dissect_protobuf(subprocesstest.SubprocessTestCase):
         self.assertTrue(self.grepOutput('floatWithDefaultValue_0point23: 0.23')) # another default value will be displayed
         self.assertTrue(self.grepOutput('missing required field \'missingRequiredField\'')) # check the missing required field export warn
 
+    def test_protobuf_parse_cache(self, cmd_tshark, features, dirs, capture_file, conf_path):
+        '''Test Protobuf types restored from the parse cache match parsed ones'''
+        well_know_types_dir = os.path.join(dirs.protobuf_lang_files_dir, 'well_know_types').replace('\\', '/')
+        user_defined_types_dir = os.path.join(dirs.protobuf_lang_files_dir, 'user_defined_types').replace('\\', '/')
+        cache_file = os.path.join(conf_path, 'protobuf_cache')
+        tshark_args = (cmd_tshark,
+                '-r', capture_file('protobuf_test_default_value.pcapng'),
+                '-o', 'uat:protobuf_search_paths: "{}","{}"'.format(well_know_types_dir, 'FALSE'),
+                '-o', 'uat:protobuf_search_paths: "{}","{}"'.format(user_defined_types_dir, 'TRUE'),
+                '-o', 'uat:protobuf_udp_message_types: "8128","wireshark.protobuf.test.TestDefaultValueMessage"',
+                '-o', 'protobuf.preload_protos: TRUE',
+                '-o', 'protobuf.pbf_as_hf: TRUE',
+                '-o', 'protobuf.add_default_value: all',
+                '-O', 'protobuf',
+                '-Y', 'pbf.wireshark.protobuf.test.TestDefaultValueMessage.enumFooWithDefaultValue_Fouth == -4'
+                      ' && pbf.wireshark.protobuf.test.TestDefaultValueMessage.stringWithDefaultValue_SymbolPi contains "Pi."',
+            )
+        # the first run parses all files and writes the cache
+        self.assertRun(tshark_args)
+        self.assertTrue(os.path.isfile(cache_file))
+        self.assertTrue(self.grepOutput('floatWithDefaultValue_0point23: 0.23'))
+        self.assertFalse(self.grepOutput('Protobuf: Error'))
+        # the second run restores all files from the cache
+        self.assertRun(tshark_args)
+        self.assertTrue(self.grepOutput('floatWithDefaultValue_0point23: 0.23'))
+        self.assertTrue(self.grepOutput('missing required field \'missingRequiredField\''))
+        self.assertFalse(self.grepOutput('Protobuf: Error'))
+
     def test_protobuf_field_subdissector(self, cmd_tshark, features, dirs, capture_file):
         '''Test "protobuf_field" subdissector table'''
         if not features.have_lua:
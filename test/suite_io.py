@@ -70,6 +70,35 @@ class case_tshark_io(subprocesstest.SubprocessTestCase):
         check_io_4_packets(self, capture_file, cmd=cmd_tshark)
 
 
+def check_io_two_pass(self, cmd_tshark, capture_file, in_file):
+    # The second pass reads uncompressed pcap and pcapng files from memory
+    # mapped files and compressed ones into a buffer; either way, the
+    # packets written and dissected must be those of a single pass.
+    testout_file = self.filename_from_id(testout_pcap)
+    self.assertRun((cmd_tshark, '-2', '-r', capture_file(in_file), '-w', testout_file))
+    original_proc = self.assertRun((cmd_tshark, '-r', capture_file(in_file), '-x'))
+    two_pass_proc = self.assertRun((cmd_tshark, '-r', testout_file, '-x'))
+    self.assertEqual(original_proc.stdout_str, two_pass_proc.stdout_str)
+    dissected_proc = self.assertRun((cmd_tshark, '-2', '-r', capture_file(in_file), '-x'))
+    self.assertEqual(original_proc.stdout_str, dissected_proc.stdout_str)
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_tshark_io_two_pass(subprocesstest.SubprocessTestCase):
+    def test_tshark_io_two_pass_pcap(self, cmd_tshark, capture_file):
+        '''Two-pass read and write of a pcap file'''
+        check_io_two_pass(self, cmd_tshark, capture_file, 'dhcp.pcap')
+
+    def test_tshark_io_two_pass_pcapng(self, cmd_tshark, capture_file):
+        '''Two-pass read and write of a pcapng file'''
+        check_io_two_pass(self, cmd_tshark, capture_file, 'dhcp.pcapng')
+
+    def test_tshark_io_two_pass_compressed(self, cmd_tshark, capture_file):
+        '''Two-pass read and write of a compressed file'''
+        check_io_two_pass(self, cmd_tshark, capture_file, 'icmp.pcapng.gz')
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_rawshark_io(subprocesstest.SubprocessTestCase):
@@ -31,6 +31,10 @@ class case_unittests(subprocesstest.SubprocessTestCase):
         '''reassemble_test'''
         self.assertRun(program('reassemble_test'), env=base_env)
 
+    def test_unit_topic_match_test(self, program, base_env):
+        '''topic_match_test'''
+        self.assertRun(program('topic_match_test'), env=base_env)
+
     def test_unit_tvbtest(self, program, base_env):
         '''tvbtest'''
         self.assertRun(program('tvbtest'), env=base_env)
@@ -3202,7 +3202,7 @@ process_cap_file_first_pass(capture_file *cf, int max_packet_count,
 static gboolean
 process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
                            frame_data *fdata, wtap_rec *rec,
-                           Buffer *buf, guint tap_flags)
+                           const guint8 *pd, guint tap_flags)
 {
   column_info    *cinfo;
   gboolean        passed;
@@ -3249,7 +3249,7 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
     }
 
     epan_dissect_run_with_taps(edt, cf->cd_t, rec,
-                               frame_tvbuff_new_buffer(&cf->provider, fdata, buf),
+                               frame_tvbuff_new(&cf->provider, fdata, pd),
                                fdata, cinfo);
 
     /* Run the read/display filter if we have one. */
@@ -3316,6 +3316,7 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
 {
   wtap_rec        rec;
   Buffer          buf;
+  const guint8   *pd;
   guint32         framenum;
   frame_data     *fdata;
   gboolean        filtering_tap_listeners;
@@ -3377,26 +3378,32 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
    */
   set_resolution_synchrony(TRUE);
 
+  /*
+   * If the file can be mapped into memory, dissect the packet data
+   * where it is in the file rather than reading it into a buffer.
+   */
+  wtap_map_file(cf->provider.wth);
+
   for (framenum = 1; framenum <= cf->count; framenum++) {
     if (read_interrupted) {
       status = PASS_INTERRUPTED;
       break;
     }
     fdata = frame_data_sequence_find(cf->provider.frames, framenum);
-    if (!wtap_seek_read(cf->provider.wth, fdata->file_off, &rec, &buf, err,
-                        err_info)) {
+    if (!wtap_seek_read_mapped(cf->provider.wth, fdata->file_off, &rec, &buf,
+                               &pd, err, err_info)) {
       /* Error reading from the input file. */
       status = PASS_READ_ERROR;
       break;
     }
     ws_debug("tshark: invoking process_packet_second_pass() for frame #%d", framenum);
-    if (process_packet_second_pass(cf, edt, fdata, &rec, &buf, tap_flags)) {
+    if (process_packet_second_pass(cf, edt, fdata, &rec, pd, tap_flags)) {
       /* Either there's no read filtering or this packet passed the
          filter, so, if we're writing to a capture file, write
          this packet out. */
       if (pdh != NULL) {
         ws_debug("tshark: writing packet #%d to outfile", framenum);
-        if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+        if (!wtap_dump(pdh, &rec, pd, err, err_info)) {
           /* Error writing to the output file. */
           ws_debug("tshark: error writing to a capture file (%d)", *err);
           *err_framenum = framenum;
@@ -0,0 +1,571 @@
+/* tap-amqpstat.c
+ * AMQP ack latency and queue depth statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* This module provides AMQP publish-to-ack and deliver-to-ack latency
+ * percentiles per channel and consumer queue to tshark.
+ *
+ * Latencies are counted in log-bucketed histograms: every power of two is
+ * split into 16 linear buckets, so a percentile is known to within 1/16 of
+ * its value while the memory used does not depend on the number of acks.
+ *
+ * It also reports the queue depth and consumer lag the AMQP dissector
+ * estimates for each queue, optionally by time interval.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissectors/packet-amqp.h>
+
+#include <ui/cmdarg_err.h>
+
+void register_tap_listener_amqpstat(void);
+
+#define LATENCY_SUB_BUCKETS 16
+/* values below 16 ns each have their own bucket, the 60 powers of two
+ * from 2^4 to 2^63 are split into 16 buckets each */
+#define LATENCY_NUM_BUCKETS (LATENCY_SUB_BUCKETS * 61)
+
+typedef struct _amqp_latency_hist_t {
+    guint64 count;
+    guint64 min_ns;
+    guint64 max_ns;
+    double tot_ns;
+    guint32 buckets[LATENCY_NUM_BUCKETS];
+} amqp_latency_hist_t;
+
+/* latencies of one channel, or of one consumer queue on a channel */
+typedef struct _amqp_latency_row_t {
+    guint32 stream;
+    guint16 channel;
+    char *queue;                /* NULL for publisher confirms */
+    amqp_latency_hist_t hist;
+} amqp_latency_row_t;
+
+/* used to keep track of the AMQP latency statistics */
+typedef struct _amqpstat_t {
+    char *filter;
+    GHashTable *confirms;       /* publisher confirms by stream and channel */
+    GHashTable *consumers;      /* consumer acks by stream, channel and queue */
+} amqpstat_t;
+
+static guint
+latency_bucket(guint64 ns)
+{
+    guint shift = 0;
+
+    if (ns < LATENCY_SUB_BUCKETS)
+        return (guint)ns;
+
+    /* scale ns into [16, 32) */
+    while ((ns >> shift) >= 2 * LATENCY_SUB_BUCKETS)
+        shift++;
+    return LATENCY_SUB_BUCKETS * (shift + 1) + (guint)((ns >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+/* Returns the middle of the range of values counted in a bucket */
+static guint64
+latency_bucket_value(guint idx)
+{
+    guint shift;
+    guint64 lower;
+
+    if (idx < LATENCY_SUB_BUCKETS)
+        return idx;
+
+    shift = idx / LATENCY_SUB_BUCKETS - 1;
+    lower = (guint64)(LATENCY_SUB_BUCKETS + idx % LATENCY_SUB_BUCKETS) << shift;
+    return lower + (((guint64)1 << shift) - 1) / 2;
+}
+
+static void
+latency_hist_add(amqp_latency_hist_t *hist, const nstime_t *latency)
+{
+    guint64 ns;
+
+    /* a negative latency means the capture was not in time order */
+    if (latency->secs < 0 || latency->nsecs < 0)
+        ns = 0;
+    else
+        ns = (guint64)latency->secs * 1000000000 + (guint64)latency->nsecs;
+
+    if (hist->count == 0 || ns < hist->min_ns)
+        hist->min_ns = ns;
+    if (ns > hist->max_ns)
+        hist->max_ns = ns;
+    hist->count++;
+    hist->tot_ns += (double)ns;
+    hist->buckets[latency_bucket(ns)]++;
+}
+
+/* Returns the latency below which the fraction p of the samples lie */
+static guint64
+latency_hist_percentile(const amqp_latency_hist_t *hist, double p)
+{
+    guint64 rank;
+    guint64 seen = 0;
+    guint64 value;
+    guint idx;
+
+    if (hist->count == 0)
+        return 0;
+
+    rank = (guint64)ceil(p * (double)hist->count);
+    if (rank < 1)
+        rank = 1;
+
+    for (idx = 0; idx < LATENCY_NUM_BUCKETS; idx++) {
+        seen += hist->buckets[idx];
+        if (seen >= rank)
+            break;
+    }
+
+    value = latency_bucket_value(idx);
+    if (value < hist->min_ns)
+        value = hist->min_ns;
+    if (value > hist->max_ns)
+        value = hist->max_ns;
+    return value;
+}
+
+static void
+amqp_latency_row_free(gpointer data)
+{
+    amqp_latency_row_t *row = (amqp_latency_row_t *)data;
+
+    g_free(row->queue);
+    g_free(row);
+}
+
+static amqp_latency_row_t *
+amqp_latency_row_get(GHashTable *rows, guint32 stream, guint16 channel, const char *queue)
+{
+    amqp_latency_row_t *row;
+    char *key;
+
+    key = g_strdup_printf("%u/%u/%s", stream, channel, queue ? queue : "");
+    row = (amqp_latency_row_t *)g_hash_table_lookup(rows, key);
+    if (row == NULL) {
+        row = g_new0(amqp_latency_row_t, 1);
+        row->stream = stream;
+        row->channel = channel;
+        row->queue = g_strdup(queue);
+        g_hash_table_insert(rows, key, row);
+    } else {
+        g_free(key);
+    }
+    return row;
+}
+
+static void
+amqpstat_reset(void *tapdata)
+{
+    amqpstat_t *amqpstat = (amqpstat_t *)tapdata;
+
+    g_hash_table_remove_all(amqpstat->confirms);
+    g_hash_table_remove_all(amqpstat->consumers);
+}
+
+static tap_packet_status
+amqpstat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *data)
+{
+    amqpstat_t *amqpstat = (amqpstat_t *)tapdata;
+    const amqp_tap_info_t *ai = (const amqp_tap_info_t *)data;
+    amqp_latency_row_t *row;
+    guint i;
+
+    switch (ai->event) {
+    case AMQP_TAP_ACK:
+    case AMQP_TAP_NACK:
+    case AMQP_TAP_REJECT:
+        break;
+    default:
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    for (i = 0; i < ai->settled_count; i++) {
+        const amqp_tap_settled_t *msg = &ai->settled_msgs[i];
+
+        if (msg->confirm) {
+            row = amqp_latency_row_get(amqpstat->confirms, ai->stream, ai->channel, NULL);
+        } else {
+            /* queue unknown if basic.consume was not captured */
+            row = amqp_latency_row_get(amqpstat->consumers, ai->stream, ai->channel,
+                msg->queue ? msg->queue : msg->routing_key);
+        }
+        latency_hist_add(&row->hist, &msg->latency);
+    }
+
+    return ai->settled_count ? TAP_PACKET_REDRAW : TAP_PACKET_DONT_REDRAW;
+}
+
+static gint
+amqp_latency_row_compare(gconstpointer a, gconstpointer b)
+{
+    const amqp_latency_row_t *ra = (const amqp_latency_row_t *)a;
+    const amqp_latency_row_t *rb = (const amqp_latency_row_t *)b;
+
+    if (ra->stream != rb->stream)
+        return ra->stream < rb->stream ? -1 : 1;
+    if (ra->channel != rb->channel)
+        return ra->channel < rb->channel ? -1 : 1;
+    return g_strcmp0(ra->queue, rb->queue);
+}
+
+static void
+amqpstat_draw_rows(GHashTable *rows, gboolean with_queue)
+{
+    GList *list, *item;
+
+    if (with_queue)
+        printf("Stream  Channel Queue                    ");
+    else
+        printf("Stream  Channel ");
+    printf("Count      Min        Avg        p50        p99        p99.9      Max\n");
+
+    list = g_list_sort(g_hash_table_get_values(rows), amqp_latency_row_compare);
+    for (item = list; item; item = g_list_next(item)) {
+        const amqp_latency_row_t *row = (const amqp_latency_row_t *)item->data;
+        const amqp_latency_hist_t *hist = &row->hist;
+
+        printf("%-8u%-8u", row->stream, row->channel);
+        if (with_queue)
+            printf("%-25s", row->queue ? row->queue : "<unknown>");
+        printf("%-11" G_GUINT64_FORMAT "%-11.3f%-11.3f%-11.3f%-11.3f%-11.3f%.3f\n",
+            hist->count,
+            hist->min_ns / 1000000.0,
+            hist->tot_ns / (double)hist->count / 1000000.0,
+            latency_hist_percentile(hist, 0.50) / 1000000.0,
+            latency_hist_percentile(hist, 0.99) / 1000000.0,
+            latency_hist_percentile(hist, 0.999) / 1000000.0,
+            hist->max_ns / 1000000.0);
+    }
+    g_list_free(list);
+}
+
+static void
+amqpstat_draw(void *tapdata)
+{
+    amqpstat_t *amqpstat = (amqpstat_t *)tapdata;
+
+    printf("\n");
+    printf("===================================================================================================\n");
+    printf("AMQP Ack Latency Statistics (all times in ms):\n");
+    printf("Filter: %s\n", amqpstat->filter ? amqpstat->filter : "<none>");
+    printf("Percentiles are accurate to within 1/16 of their value.\n");
+    printf("\nPublisher confirms (basic.publish to basic.ack):\n");
+    amqpstat_draw_rows(amqpstat->confirms, FALSE);
+    printf("\nConsumer acks (basic.deliver to basic.ack):\n");
+    amqpstat_draw_rows(amqpstat->consumers, TRUE);
+    printf("===================================================================================================\n");
+}
+
+static void
+amqpstat_finish(void *tapdata)
+{
+    amqpstat_t *amqpstat = (amqpstat_t *)tapdata;
+
+    g_hash_table_destroy(amqpstat->confirms);
+    g_hash_table_destroy(amqpstat->consumers);
+    g_free(amqpstat->filter);
+    g_free(amqpstat);
+}
+
+static void
+amqpstat_init(const char *opt_arg, void *userdata _U_)
+{
+    amqpstat_t *amqpstat;
+    const char *filter = NULL;
+    GString *error_string;
+
+    if (strstr(opt_arg, "amqp,latency,"))
+        filter = opt_arg + strlen("amqp,latency,");
+
+    amqpstat = g_new0(amqpstat_t, 1);
+    amqpstat->filter = g_strdup(filter);
+    amqpstat->confirms = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, amqp_latency_row_free);
+    amqpstat->consumers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, amqp_latency_row_free);
+
+    error_string = register_tap_listener("amqp", amqpstat, amqpstat->filter,
+        TL_REQUIRES_NOTHING, amqpstat_reset, amqpstat_packet, amqpstat_draw,
+        amqpstat_finish);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        amqpstat_finish(amqpstat);
+
+        cmdarg_err("Couldn't register amqp,latency tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+/* estimated state of a queue within an interval */
+typedef struct _amqp_queue_interval_t {
+    guint64 idx;                /* number of the interval */
+    gint64 ready;               /* state at the end of the interval */
+    gint64 unacked;
+    gint64 max_depth;           /* largest depth within the interval */
+} amqp_queue_interval_t;
+
+/* estimated state of a queue over the capture */
+typedef struct _amqp_queue_row_t {
+    char *name;
+    gint64 ready;               /* state after the last event */
+    gint64 unacked;
+    gint32 consumers;
+    gboolean anchored;
+    gint64 max_depth;
+    double max_depth_time;      /* time of the largest depth, relative to the first packet */
+    GArray *intervals;          /* amqp_queue_interval_t in time order, NULL without interval */
+} amqp_queue_row_t;
+
+/* used to keep track of the AMQP queue depth estimates */
+typedef struct _amqpqueues_t {
+    char *filter;
+    double interval;            /* length of an interval in seconds, 0 for none */
+    GHashTable *queues;         /* amqp_queue_row_t by queue name */
+} amqpqueues_t;
+
+static void
+amqp_queue_row_free(gpointer data)
+{
+    amqp_queue_row_t *row = (amqp_queue_row_t *)data;
+
+    if (row->intervals)
+        g_array_free(row->intervals, TRUE);
+    g_free(row->name);
+    g_free(row);
+}
+
+static void
+amqpqueues_reset(void *tapdata)
+{
+    amqpqueues_t *amqpqueues = (amqpqueues_t *)tapdata;
+
+    g_hash_table_remove_all(amqpqueues->queues);
+}
+
+static tap_packet_status
+amqpqueues_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    amqpqueues_t *amqpqueues = (amqpqueues_t *)tapdata;
+    const amqp_tap_info_t *ai = (const amqp_tap_info_t *)data;
+    double rel_time = nstime_to_sec(&pinfo->rel_ts);
+    guint i;
+
+    for (i = 0; i < ai->queue_count; i++) {
+        const amqp_tap_queue_t *queue = &ai->queues[i];
+        amqp_queue_row_t *row;
+        gint64 depth = queue->ready + queue->unacked;
+
+        row = (amqp_queue_row_t *)g_hash_table_lookup(amqpqueues->queues, queue->name);
+        if (row == NULL) {
+            row = g_new0(amqp_queue_row_t, 1);
+            row->name = g_strdup(queue->name);
+            row->max_depth = depth;
+            row->max_depth_time = rel_time;
+            if (amqpqueues->interval > 0)
+                row->intervals = g_array_new(FALSE, FALSE, sizeof(amqp_queue_interval_t));
+            g_hash_table_insert(amqpqueues->queues, row->name, row);
+        }
+        row->ready = queue->ready;
+        row->unacked = queue->unacked;
+        row->consumers = queue->consumers;
+        row->anchored = queue->anchored;
+        if (depth > row->max_depth) {
+            row->max_depth = depth;
+            row->max_depth_time = rel_time;
+        }
+
+        if (row->intervals) {
+            amqp_queue_interval_t *last = NULL;
+            guint64 idx = rel_time > 0 ? (guint64)(rel_time / amqpqueues->interval) : 0;
+
+            if (row->intervals->len > 0)
+                last = &g_array_index(row->intervals, amqp_queue_interval_t, row->intervals->len - 1);
+            /* a packet out of time order counts in the last interval */
+            if (last == NULL || idx > last->idx) {
+                amqp_queue_interval_t interval = { idx, 0, 0, depth };
+
+                g_array_append_val(row->intervals, interval);
+                last = &g_array_index(row->intervals, amqp_queue_interval_t, row->intervals->len - 1);
+            }
+            last->ready = queue->ready;
+            last->unacked = queue->unacked;
+            if (depth > last->max_depth)
+                last->max_depth = depth;
+        }
+    }
+
+    return ai->queue_count ? TAP_PACKET_REDRAW : TAP_PACKET_DONT_REDRAW;
+}
+
+static gint
+amqp_queue_row_compare(gconstpointer a, gconstpointer b)
+{
+    const amqp_queue_row_t *ra = (const amqp_queue_row_t *)a;
+    const amqp_queue_row_t *rb = (const amqp_queue_row_t *)b;
+
+    return g_strcmp0(ra->name, rb->name);
+}
+
+static void
+amqpqueues_draw(void *tapdata)
+{
+    amqpqueues_t *amqpqueues = (amqpqueues_t *)tapdata;
+    GList *list, *item;
+    guint i;
+
+    list = g_list_sort(g_hash_table_get_values(amqpqueues->queues), amqp_queue_row_compare);
+
+    printf("\n");
+    printf("===================================================================================================\n");
+    printf("AMQP Queue Depth Estimates:\n");
+    printf("Filter: %s\n", amqpqueues->filter ? amqpqueues->filter : "<none>");
+    printf("Ready messages wait for a consumer (consumer lag), depth is ready plus unacked messages.\n");
+    printf("Queues marked * had no message count from the broker, their ready messages count from 0.\n");
+    printf("\nQueue                    Ready      Unacked    Depth      Max depth  At (s)     Consumers\n");
+    for (item = list; item; item = g_list_next(item)) {
+        const amqp_queue_row_t *row = (const amqp_queue_row_t *)item->data;
+        char *name = g_strconcat(row->name, row->anchored ? "" : "*", NULL);
+
+        printf("%-25s%-11" G_GINT64_FORMAT "%-11" G_GINT64_FORMAT "%-11" G_GINT64_FORMAT
+            "%-11" G_GINT64_FORMAT "%-11.3f",
+            name, row->ready, row->unacked, row->ready + row->unacked,
+            row->max_depth, row->max_depth_time);
+        if (row->consumers >= 0)
+            printf("%d\n", row->consumers);
+        else
+            printf("-\n");
+        g_free(name);
+    }
+
+    for (item = list; item && amqpqueues->interval > 0; item = g_list_next(item)) {
+        const amqp_queue_row_t *row = (const amqp_queue_row_t *)item->data;
+
+        printf("\nQueue %s by intervals of %.3f s, at their end (intervals without change are left out):\n",
+            row->name, amqpqueues->interval);
+        printf("Start (s)   Ready      Unacked    Depth      Max depth\n");
+        for (i = 0; i < row->intervals->len; i++) {
+            const amqp_queue_interval_t *interval = &g_array_index(row->intervals, amqp_queue_interval_t, i);
+
+            printf("%-12.3f%-11" G_GINT64_FORMAT "%-11" G_GINT64_FORMAT "%-11" G_GINT64_FORMAT
+                "%" G_GINT64_FORMAT "\n",
+                interval->idx * amqpqueues->interval,
+                interval->ready, interval->unacked, interval->ready + interval->unacked,
+                interval->max_depth);
+        }
+    }
+    printf("===================================================================================================\n");
+    g_list_free(list);
+}
+
+static void
+amqpqueues_finish(void *tapdata)
+{
+    amqpqueues_t *amqpqueues = (amqpqueues_t *)tapdata;
+
+    g_hash_table_destroy(amqpqueues->queues);
+    g_free(amqpqueues->filter);
+    g_free(amqpqueues);
+}
+
+/* amqp,queues[,interval[,filter]] */
+static void
+amqpqueues_init(const char *opt_arg, void *userdata _U_)
+{
+    amqpqueues_t *amqpqueues;
+    const char *args = opt_arg + strlen("amqp,queues");
+    const char *filter = NULL;
+    double interval = 0;
+    int pos = 0;
+    GString *error_string;
+
+    if (*args == ',') {
+        args++;
+        if (sscanf(args, "%lf%n", &interval, &pos) == 1 && (args[pos] == ',' || args[pos] == '\0')) {
+            args += pos;
+            if (*args == ',')
+                args++;
+        } else {
+            interval = 0;
+        }
+        if (*args)
+            filter = args;
+    }
+    if (interval < 0 || isnan(interval) || isinf(interval)) {
+        cmdarg_err("amqp,queues: invalid interval \"%s\"", opt_arg + strlen("amqp,queues,"));
+        exit(1);
+    }
+
+    amqpqueues = g_new0(amqpqueues_t, 1);
+    amqpqueues->filter = g_strdup(filter);
+    amqpqueues->interval = interval;
+    amqpqueues->queues = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, amqp_queue_row_free);
+
+    error_string = register_tap_listener("amqp", amqpqueues, amqpqueues->filter,
+        TL_REQUIRES_NOTHING, amqpqueues_reset, amqpqueues_packet, amqpqueues_draw,
+        amqpqueues_finish);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        amqpqueues_finish(amqpqueues);
+
+        cmdarg_err("Couldn't register amqp,queues tap: %s", error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui amqpstat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "amqp,latency",
+    amqpstat_init,
+    0,
+    NULL
+};
+
+static stat_tap_ui amqpqueues_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "amqp,queues",
+    amqpqueues_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_amqpstat(void)
+{
+    register_stat_tap_ui(&amqpstat_ui, NULL);
+    register_stat_tap_ui(&amqpqueues_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
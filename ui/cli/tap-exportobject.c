@@ -29,6 +29,7 @@
 typedef struct _export_object_list_gui_t {
     GSList *entries;
     register_eo_t* eo;
+    const gchar *save_in_path;
 } export_object_list_gui_t;
 
 static GHashTable* eo_opts = NULL;
@@ -82,6 +83,49 @@ gboolean eo_tap_opt_add(const char *option_string)
     return FALSE;
 }
 
+/* If the destination directory (or its parents) do not exist, create them. */
+static gboolean
+eo_make_save_dir(const gchar *save_in_path)
+{
+    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
+        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
+            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
+                    save_in_path, g_strerror(errno));
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Writes an object to a file in save_in_path that does not exist yet */
+static void
+eo_save_entry(const gchar *save_in_path, export_object_entry_t *entry)
+{
+    GString *safe_filename = NULL;
+    gchar *save_as_fullpath = NULL;
+    guint count = 0;
+
+    do {
+        g_free(save_as_fullpath);
+        if (entry->filename) {
+            safe_filename = eo_massage_str(entry->filename,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        } else {
+            char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
+            const char *ext;
+            ext = eo_ct2ext(entry->content_type);
+            g_snprintf(generic_name, sizeof(generic_name),
+                "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
+            safe_filename = eo_massage_str(generic_name,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        }
+        save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
+        g_string_free(safe_filename, TRUE);
+    } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
+    write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
+    g_free(save_as_fullpath);
+}
+
 static void
 object_list_add_entry(void *gui_data, export_object_entry_t *entry)
 {
@@ -90,6 +134,17 @@ object_list_add_entry(void *gui_data, export_object_entry_t *entry)
     object_list->entries = g_slist_append(object_list->entries, entry);
 }
 
+/* Objects of a streamable protocol are complete when added, so they are
+ * written right away rather than kept until the end of the capture */
+static void
+object_list_save_entry(void *gui_data, export_object_entry_t *entry)
+{
+    export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
+
+    eo_save_entry(object_list->save_in_path, entry);
+    eo_free_entry(entry);
+}
+
 static export_object_entry_t*
 object_list_get_entry(void *gui_data, int row) {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
@@ -104,50 +159,18 @@ eo_draw(void *tapdata)
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
     GSList *slist = object_list->entries;
-    export_object_entry_t *entry;
-    gchar* save_in_path = (gchar*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
-    GString *safe_filename = NULL;
-    gchar *save_as_fullpath = NULL;
-    guint count = 0;
 
-    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
-        /* If the destination directory (or its parents) do not exist, create them. */
-        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
-            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
-                    save_in_path, g_strerror(errno));
-            return;
-        }
-    }
+    if (!eo_make_save_dir(object_list->save_in_path))
+        return;
 
     while (slist) {
-        entry = (export_object_entry_t *)slist->data;
-        do {
-            g_free(save_as_fullpath);
-            if (entry->filename) {
-                safe_filename = eo_massage_str(entry->filename,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            } else {
-                char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
-                const char *ext;
-                ext = eo_ct2ext(entry->content_type);
-                g_snprintf(generic_name, sizeof(generic_name),
-                    "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
-                safe_filename = eo_massage_str(generic_name,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            }
-            save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
-            g_string_free(safe_filename, TRUE);
-        } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
-        count = 0;
-        write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
-        g_free(save_as_fullpath);
-        save_as_fullpath = NULL;
+        eo_save_entry(object_list->save_in_path, (export_object_entry_t *)slist->data);
         slist = slist->next;
     }
 }
 
 static void
-exportobject_handler(gpointer key, gpointer value _U_, gpointer user_data _U_)
+exportobject_handler(gpointer key, gpointer value, gpointer user_data _U_)
 {
     GString *error_msg;
     export_object_list_t *tap_data;
@@ -161,18 +184,22 @@ exportobject_handler(gpointer key, gpointer value _U_, gpointer user_data _U_)
         return;
     }
 
+    if (get_eo_streamable(eo) && !eo_make_save_dir((const gchar*)value))
+        return;
+
     tap_data = g_new0(export_object_list_t,1);
     object_list = g_new0(export_object_list_gui_t,1);
 
-    tap_data->add_entry = object_list_add_entry;
+    tap_data->add_entry = get_eo_streamable(eo) ? object_list_save_entry : object_list_add_entry;
     tap_data->get_entry = object_list_get_entry;
     tap_data->gui_data = (void*)object_list;
 
     object_list->eo = eo;
+    object_list->save_in_path = (const gchar*)value;
 
     /* Data will be gathered via a tap callback */
     error_msg = register_tap_listener(get_eo_tap_listener_name(eo), tap_data, NULL, 0,
-                      NULL, get_eo_packet_func(eo), eo_draw, NULL);
+                      NULL, get_eo_packet_func(eo), get_eo_streamable(eo) ? NULL : eo_draw, NULL);
 
     if (error_msg) {
         cmdarg_err("Can't register %s tap: %s", (const char*)key, error_msg->str);
@@ -116,6 +116,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     gboolean create_proto_tree;
     wtap_rec rec; /* Record metadata */
     Buffer buf;   /* Record data */
+    const guint8 *pd;
 
     gboolean dissect_columns = col_text_.isEmpty() || data_ver_ != col_data_ver_;
 
@@ -129,11 +130,8 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
 
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
-    if (read_failed_) {
-        read_failed_ = !cf_read_record_no_alert(cap_file, fdata_, &rec, &buf);
-    } else {
-        read_failed_ = !cf_read_record(cap_file, fdata_, &rec, &buf);
-    }
+    // Don't pop up an alert again for a record that couldn't be read before
+    read_failed_ = !cf_read_record_mapped(cap_file, fdata_, &rec, &buf, &pd, !read_failed_);
 
     if (read_failed_) {
         /*
@@ -193,7 +191,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
      * attempt to recover from it.
      */
     epan_dissect_run(&edt, cap_file->cd_t, &rec,
-                     frame_tvbuff_new_buffer(&cap_file->provider, fdata_, &buf),
+                     frame_tvbuff_new(&cap_file->provider, fdata_, pd),
                      fdata_, cinfo);
 
     if (dissect_columns) {
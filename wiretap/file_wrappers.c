@@ -24,6 +24,16 @@
 #include <wsutil/file_util.h>
 #include <wsutil/ws_assert.h>
 
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 #ifdef HAVE_ZLIB
 #define ZLIB_CONST
 #include <zlib.h>
@@ -203,6 +213,10 @@ struct wtap_reader {
 #ifdef USE_LZ4
     LZ4F_dctx *lz4_dctx;
 #endif
+    /* the whole file mapped into memory, see file_map() */
+    const guint8 *map;
+    gint64 map_size;
+    volatile gboolean map_truncated;    /* file got shorter than the mapping */
 };
 
 /* Current read offset within a buffer. */
@@ -1882,6 +1896,171 @@ file_clearerr(FILE_T stream)
     stream->eof = FALSE;
 }
 
+#ifndef _WIN32
+/*
+ * Reading a page of a mapping that lies past the end of the file raises
+ * SIGBUS. That happens if a mapped file is truncated or rewritten while
+ * pointers into it are in use, e.g. by a dissection that is under way,
+ * so checking the size of the file beforehand can't rule it out.
+ *
+ * Instead, a SIGBUS handler looks up the faulting address in the
+ * mapped files, puts zero-filled pages over the rest of that mapping
+ * and returns, so the access is retried and reads zeroes. The mapping
+ * isn't used for further records; they're read from the file, which
+ * reports an error if the data is gone. A SIGBUS for any other address
+ * is handed to the previous handler.
+ *
+ * The table is filled and cleared by the thread that maps and unmaps
+ * files, and read by the handler, so it has a fixed size; further
+ * files aren't mapped.
+ */
+#define MAX_MAPPED_FILES 16
+
+static FILE_T volatile mapped_files[MAX_MAPPED_FILES];
+static struct sigaction old_sigbus_action;
+static gboolean sigbus_handler_installed;
+static size_t map_page_size;
+
+static void
+map_sigbus_handler(int sig, siginfo_t *info, void *context _U_)
+{
+    const guint8 *addr = (const guint8 *)info->si_addr;
+    guint i;
+
+    for (i = 0; i < MAX_MAPPED_FILES; i++) {
+        FILE_T stream = mapped_files[i];
+        const guint8 *page, *end;
+
+        if (stream == NULL || addr < stream->map ||
+            addr >= stream->map + stream->map_size)
+            continue;
+        page = stream->map + ((size_t)(addr - stream->map) & ~(map_page_size - 1));
+        end = stream->map + stream->map_size;
+        if (mmap((void *)page, (size_t)(end - page), PROT_READ,
+                 MAP_PRIVATE|MAP_ANONYMOUS|MAP_FIXED, -1, 0) == MAP_FAILED)
+            break;
+        stream->map_truncated = TRUE;
+        return;
+    }
+
+    /*
+     * Not a mapped file, or it couldn't be patched up; returning
+     * retries the access, which now goes to the previous handler.
+     */
+    sigaction(sig, &old_sigbus_action, NULL);
+}
+
+static gboolean
+map_register(FILE_T stream)
+{
+    struct sigaction action;
+    guint i;
+
+    if (!sigbus_handler_installed) {
+        memset(&action, 0, sizeof action);
+        action.sa_sigaction = map_sigbus_handler;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGBUS, &action, &old_sigbus_action) == -1)
+            return FALSE;
+        map_page_size = (size_t)sysconf(_SC_PAGESIZE);
+        sigbus_handler_installed = TRUE;
+    }
+    for (i = 0; i < MAX_MAPPED_FILES; i++) {
+        if (mapped_files[i] == NULL) {
+            mapped_files[i] = stream;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void
+map_unregister(FILE_T stream)
+{
+    guint i;
+
+    for (i = 0; i < MAX_MAPPED_FILES; i++) {
+        if (mapped_files[i] == stream)
+            mapped_files[i] = NULL;
+    }
+}
+#endif
+
+/*
+ * Map the whole file into memory, so that file_map_ptr() can hand out
+ * pointers to data in it without reading it. The caller makes sure
+ * that the file is not compressed; offsets in a mapped file are
+ * offsets in the raw file.
+ *
+ * Returns FALSE, and nothing changes, if the file isn't a regular file
+ * or can't be mapped. Files aren't mapped on Windows; they're read as
+ * before.
+ */
+gboolean
+file_map(FILE_T stream)
+{
+#ifndef _WIN32
+    ws_statb64 statb;
+    void *map;
+
+    if (stream->map != NULL)
+        return TRUE;
+    if (stream->fd == -1 || ws_fstat64(stream->fd, &statb) == -1)
+        return FALSE;
+    if (!S_ISREG(statb.st_mode) || statb.st_size <= 0 ||
+        (guint64)statb.st_size > G_MAXSIZE)
+        return FALSE;
+
+    map = mmap(NULL, (size_t)statb.st_size, PROT_READ, MAP_SHARED, stream->fd, 0);
+    if (map == MAP_FAILED)
+        return FALSE;
+
+    /* set up the mapping before the SIGBUS handler can see it */
+    stream->map = (const guint8 *)map;
+    stream->map_size = statb.st_size;
+    if (!map_register(stream)) {
+        munmap(map, (size_t)statb.st_size);
+        stream->map = NULL;
+        stream->map_size = 0;
+        return FALSE;
+    }
+    return TRUE;
+#else
+    (void)stream;
+    return FALSE;
+#endif
+}
+
+static void
+file_unmap(FILE_T stream)
+{
+#ifndef _WIN32
+    if (stream->map != NULL) {
+        map_unregister(stream);
+        munmap((void *)stream->map, (size_t)stream->map_size);
+        stream->map = NULL;
+        stream->map_size = 0;
+        stream->map_truncated = FALSE;
+    }
+#endif
+}
+
+/*
+ * Return a pointer to length bytes at offset in the mapped file, or
+ * NULL if the file isn't mapped, the bytes are past the end of the
+ * mapping (e.g., because they were appended after it was made), or
+ * the file was found to be shorter than the mapping.
+ */
+const guint8 *
+file_map_ptr(FILE_T stream, gint64 offset, guint length)
+{
+    if (stream->map == NULL || stream->map_truncated || offset < 0 ||
+        offset > stream->map_size || length > stream->map_size - offset)
+        return NULL;
+    return stream->map + offset;
+}
+
 void
 file_fdclose(FILE_T file)
 {
@@ -1897,6 +2076,9 @@ file_fdreopen(FILE_T file, const char *path)
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return FALSE;
     file->fd = fd;
+
+    /* The mapping might be of a file that has been replaced since */
+    file_unmap(file);
     return TRUE;
 }
 
@@ -1920,6 +2102,7 @@ file_close(FILE_T file)
         g_free(file->in.buf);
     }
     g_free(file->fast_seek_cur);
+    file_unmap(file);
     file->err = 0;
     file->err_info = NULL;
     g_free(file);
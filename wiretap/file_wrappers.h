@@ -30,6 +30,8 @@ WS_DLL_PUBLIC char *file_getsp(char *buf, int len, FILE_T stream);
 WS_DLL_PUBLIC int file_eof(FILE_T stream);
 WS_DLL_PUBLIC int file_error(FILE_T fh, gchar **err_info);
 extern void file_clearerr(FILE_T stream);
+extern gboolean file_map(FILE_T stream);
+extern const guint8 *file_map_ptr(FILE_T stream, gint64 offset, guint length);
 extern void file_fdclose(FILE_T file);
 extern int file_fdreopen(FILE_T file, const char *path);
 extern void file_close(FILE_T file);
@@ -66,8 +66,12 @@ static gboolean libpcap_read(wtap *wth, wtap_rec *rec, Buffer *buf,
     int *err, gchar **err_info, gint64 *data_offset);
 static gboolean libpcap_seek_read(wtap *wth, gint64 seek_off,
     wtap_rec *rec, Buffer *buf, int *err, gchar **err_info);
+static gboolean libpcap_seek_read_mapped(wtap *wth, gint64 seek_off,
+    wtap_rec *rec, Buffer *buf, const guint8 **data, int *err,
+    gchar **err_info);
 static gboolean libpcap_read_packet(wtap *wth, FILE_T fh,
-    wtap_rec *rec, Buffer *buf, int *err, gchar **err_info);
+    wtap_rec *rec, Buffer *buf, const guint8 **data, int *err,
+    gchar **err_info);
 static int libpcap_read_header(wtap *wth, FILE_T fh, int *err, gchar **err_info,
     struct pcaprec_ss990915_hdr *hdr);
 static void libpcap_close(wtap *wth);
@@ -343,6 +347,7 @@ wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
 	wth->priv = (void *)libpcap;
 	wth->subtype_read = libpcap_read;
 	wth->subtype_seek_read = libpcap_seek_read;
+	wth->subtype_seek_read_mapped = libpcap_seek_read_mapped;
 	wth->subtype_close = libpcap_close;
 	wth->file_encap = file_encap;
 	wth->snapshot_length = hdr.snaplen;
@@ -812,17 +817,25 @@ static gboolean libpcap_read(wtap *wth, wtap_rec *rec, Buffer *buf,
 {
 	*data_offset = file_tell(wth->fh);
 
-	return libpcap_read_packet(wth, wth->fh, rec, buf, err, err_info);
+	return libpcap_read_packet(wth, wth->fh, rec, buf, NULL, err, err_info);
 }
 
 static gboolean
 libpcap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec,
     Buffer *buf, int *err, gchar **err_info)
+{
+	return libpcap_seek_read_mapped(wth, seek_off, rec, buf, NULL, err,
+	    err_info);
+}
+
+static gboolean
+libpcap_seek_read_mapped(wtap *wth, gint64 seek_off, wtap_rec *rec,
+    Buffer *buf, const guint8 **data, int *err, gchar **err_info)
 {
 	if (file_seek(wth->random_fh, seek_off, SEEK_SET, err) == -1)
 		return FALSE;
 
-	if (!libpcap_read_packet(wth, wth->random_fh, rec, buf, err,
+	if (!libpcap_read_packet(wth, wth->random_fh, rec, buf, data, err,
 	    err_info)) {
 		if (*err == 0)
 			*err = WTAP_ERR_SHORT_READ;
@@ -833,7 +846,7 @@ libpcap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec,
 
 static gboolean
 libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
-    Buffer *buf, int *err, gchar **err_info)
+    Buffer *buf, const guint8 **data, int *err, gchar **err_info)
 {
 	struct pcaprec_ss990915_hdr hdr;
 	guint packet_size;
@@ -841,6 +854,7 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	int phdr_len;
 	libpcap_t *libpcap = (libpcap_t *)wth->priv;
 	gboolean is_nokia;
+	guint8 *pd;
 
 	if (!libpcap_read_header(wth, fh, err, err_info, &hdr))
 		return FALSE;
@@ -920,13 +934,26 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	rec->rec_header.packet_header.len = orig_size;
 
 	/*
-	 * Read the packet data.
+	 * Read the packet data, or refer to it in the mapped file if
+	 * it is used as it is.
 	 */
-	if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
-		return FALSE;	/* failed */
+	if (data == NULL || pcap_read_post_process_changes_data(wth->file_encap,
+	    libpcap->byte_swapped)) {
+		if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
+			return FALSE;	/* failed */
+		pd = ws_buffer_start_ptr(buf);
+		if (data != NULL)
+			*data = pd;
+	} else {
+		if (!wtap_read_packet_bytes_mapped(fh, buf, packet_size, data,
+		    err, err_info))
+			return FALSE;	/* failed */
+		/* Not changed, see pcap_read_post_process_changes_data() */
+		pd = (guint8 *)*data;
+	}
 
 	pcap_read_post_process(is_nokia, wth->file_encap, rec,
-	    ws_buffer_start_ptr(buf), libpcap->byte_swapped, -1);
+	    pd, libpcap->byte_swapped, -1);
 	return TRUE;
 }
 
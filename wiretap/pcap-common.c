@@ -2325,6 +2325,27 @@ pcap_process_pseudo_header(FILE_T fh, gboolean is_nokia, int wtap_encap,
 	return phdr_len;
 }
 
+/*
+ * Does pcap_read_post_process() change the packet data, so that it can't
+ * be used in place in a mapped file?
+ */
+gboolean
+pcap_read_post_process_changes_data(int wtap_encap, gboolean bytes_swapped)
+{
+	switch (wtap_encap) {
+
+	case WTAP_ENCAP_SLL:
+	case WTAP_ENCAP_SLL2:
+	case WTAP_ENCAP_USB_LINUX:
+	case WTAP_ENCAP_USB_LINUX_MMAPPED:
+	case WTAP_ENCAP_NFLOG:
+		return bytes_swapped;
+
+	default:
+		return FALSE;
+	}
+}
+
 void
 pcap_read_post_process(gboolean is_nokia, int wtap_encap,
     wtap_rec *rec, guint8 *pd, gboolean bytes_swapped, int fcs_len)
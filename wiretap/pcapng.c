@@ -46,6 +46,10 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
 static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
                  wtap_rec *rec, Buffer *buf, int *err, gchar **err_info);
+static gboolean
+pcapng_seek_read_mapped(wtap *wth, gint64 seek_off,
+                        wtap_rec *rec, Buffer *buf, const guint8 **data,
+                        int *err, gchar **err_info);
 static void
 pcapng_close(wtap *wth);
 
@@ -1795,6 +1799,19 @@ pcapng_process_packet_block_option(wtapng_block_t *wblock,
     return TRUE;
 }
 
+/*
+ * The packet data just read, in the mapped file or in the frame buffer.
+ * It's only in the mapped file if pcap_read_post_process() doesn't change
+ * it, so handing it over as non-const is safe.
+ */
+static guint8 *
+pcapng_frame_data(wtapng_block_t *wblock)
+{
+    if (wblock->frame_data != NULL && *wblock->frame_data != NULL)
+        return (guint8 *)*wblock->frame_data;
+    return ws_buffer_start_ptr(wblock->frame_buffer);
+}
+
 static gboolean
 pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
                          section_info_t *section_info,
@@ -1981,8 +1998,10 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     wblock->rec->ts.nsecs = (int)(((ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second);
 
     /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                packet.cap_len - pseudo_header_len, err, err_info))
+    if (!wtap_read_packet_bytes_mapped(fh, wblock->frame_buffer,
+                                       packet.cap_len - pseudo_header_len,
+                                       pcap_read_post_process_changes_data(iface_info.wtap_encap, section_info->byte_swapped) ? NULL : wblock->frame_data,
+                                       err, err_info))
         return FALSE;
     block_read += packet.cap_len - pseudo_header_len;
 
@@ -2023,7 +2042,7 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     }
 
     pcap_read_post_process(FALSE, iface_info.wtap_encap,
-                           wblock->rec, ws_buffer_start_ptr(wblock->frame_buffer),
+                           wblock->rec, pcapng_frame_data(wblock),
                            section_info->byte_swapped, fcslen);
 
     /*
@@ -2162,8 +2181,10 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     memset((void *)&wblock->rec->rec_header.packet_header.pseudo_header, 0, sizeof(union wtap_pseudo_header));
 
     /* "Simple Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                simple_packet.cap_len, err, err_info))
+    if (!wtap_read_packet_bytes_mapped(fh, wblock->frame_buffer,
+                                       simple_packet.cap_len,
+                                       pcap_read_post_process_changes_data(iface_info.wtap_encap, section_info->byte_swapped) ? NULL : wblock->frame_data,
+                                       err, err_info))
         return FALSE;
 
     /* jump over potential padding bytes at end of the packet data */
@@ -2173,7 +2194,7 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     }
 
     pcap_read_post_process(FALSE, iface_info.wtap_encap,
-                           wblock->rec, ws_buffer_start_ptr(wblock->frame_buffer),
+                           wblock->rec, pcapng_frame_data(wblock),
                            section_info->byte_swapped, iface_info.fcslen);
 
     /*
@@ -3398,6 +3419,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
     wblock.block = NULL;
     /* we don't expect any packet blocks yet */
     wblock.frame_buffer = NULL;
+    wblock.frame_data = NULL;
     wblock.rec = NULL;
 
     switch (pcapng_read_section_header_block(wth->fh, &bh, &first_section,
@@ -3491,6 +3513,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 
     wth->subtype_read = pcapng_read;
     wth->subtype_seek_read = pcapng_seek_read;
+    wth->subtype_seek_read_mapped = pcapng_seek_read_mapped;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = pcapng_file_type_subtype;
 
@@ -3567,6 +3590,7 @@ pcapng_read(wtap *wth, wtap_rec *rec, Buffer *buf, int *err,
     wtapng_if_descr_mandatory_t *wtapng_if_descr_mand;
 
     wblock.frame_buffer  = buf;
+    wblock.frame_data = NULL;
     wblock.rec = rec;
 
     pcapng->add_new_ipv4 = wth->add_new_ipv4;
@@ -3717,6 +3741,14 @@ static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
                  wtap_rec *rec, Buffer *buf,
                  int *err, gchar **err_info)
+{
+    return pcapng_seek_read_mapped(wth, seek_off, rec, buf, NULL, err, err_info);
+}
+
+static gboolean
+pcapng_seek_read_mapped(wtap *wth, gint64 seek_off,
+                        wtap_rec *rec, Buffer *buf, const guint8 **data,
+                        int *err, gchar **err_info)
 {
     pcapng_t *pcapng = (pcapng_t *)wth->priv;
     section_info_t *section_info, new_section;
@@ -3761,7 +3793,10 @@ pcapng_seek_read(wtap *wth, gint64 seek_off,
     }
 
     wblock.frame_buffer = buf;
+    wblock.frame_data = data;
     wblock.rec = rec;
+    if (data != NULL)
+        *data = NULL;
 
     /* read the block */
     if (!pcapng_read_block(wth, wth->random_fh, pcapng, section_info,
@@ -3780,6 +3815,10 @@ pcapng_seek_read(wtap *wth, gint64 seek_off,
     }
 
     wtap_block_unref(wblock.block);
+
+    /* Blocks other than packet blocks always read into the buffer */
+    if (data != NULL && *data == NULL)
+        *data = ws_buffer_start_ptr(buf);
     return TRUE;
 }
 
@@ -52,6 +52,7 @@ typedef struct wtapng_block_s {
     wtap_block_t block;
     wtap_rec     *rec;
     Buffer       *frame_buffer;
+    const guint8 **frame_data;   /* if not NULL, set to the packet data, which might be in the mapped file rather than in frame_buffer */
 } wtapng_block_t;
 
 /* Section data in private struct */
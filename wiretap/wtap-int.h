@@ -30,6 +30,8 @@ typedef gboolean (*subtype_read_func)(struct wtap*, wtap_rec *,
                                       Buffer *, int *, char **, gint64 *);
 typedef gboolean (*subtype_seek_read_func)(struct wtap*, gint64, wtap_rec *,
                                            Buffer *, int *, char **);
+typedef gboolean (*subtype_seek_read_mapped_func)(struct wtap*, gint64, wtap_rec *,
+                                                  Buffer *, const guint8 **, int *, char **);
 
 /**
  * Struct holding data of the currently read file.
@@ -53,6 +55,7 @@ struct wtap {
 
     subtype_read_func           subtype_read;
     subtype_seek_read_func      subtype_seek_read;
+    subtype_seek_read_mapped_func subtype_seek_read_mapped; /**< NULL if records can't be returned from a mapped file */
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
     int                         file_encap;    /* per-file, for those
@@ -320,6 +323,20 @@ gboolean
 wtap_read_packet_bytes(FILE_T fh, Buffer *buf, guint length, int *err,
     gchar **err_info);
 
+/*
+ * Same as wtap_read_packet_bytes(), but if data is not NULL and the
+ * file is mapped, point *data at the packet data in the mapped file
+ * and skip it rather than reading it into the Buffer. Otherwise, the
+ * data is read into the Buffer and *data, if data is not NULL, points
+ * to its start.
+ *
+ * Callers that change the packet data after reading it must pass a
+ * NULL data.
+ */
+gboolean
+wtap_read_packet_bytes_mapped(FILE_T fh, Buffer *buf, guint length,
+    const guint8 **data, int *err, gchar **err_info);
+
 /*
  * Implementation of wth->subtype_read that reads the full file contents
  * as a single packet.
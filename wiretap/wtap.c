@@ -1658,6 +1658,28 @@ wtap_read_packet_bytes(FILE_T fh, Buffer *buf, guint length, int *err,
 	    err_info);
 }
 
+gboolean
+wtap_read_packet_bytes_mapped(FILE_T fh, Buffer *buf, guint length,
+    const guint8 **data, int *err, gchar **err_info)
+{
+	const guint8 *mapped;
+
+	if (data != NULL) {
+		mapped = file_map_ptr(fh, file_tell(fh), length);
+		if (mapped != NULL) {
+			if (file_seek(fh, length, SEEK_CUR, err) == -1)
+				return FALSE;
+			*data = mapped;
+			return TRUE;
+		}
+	}
+	if (!wtap_read_packet_bytes(fh, buf, length, err, err_info))
+		return FALSE;
+	if (data != NULL)
+		*data = ws_buffer_start_ptr(buf);
+	return TRUE;
+}
+
 /*
  * Return an approximation of the amount of data we've read sequentially
  * from the file so far.  (gint64, in case that's 64 bits.)
@@ -1697,10 +1719,12 @@ wtap_rec_cleanup(wtap_rec *rec)
 	ws_buffer_free(&rec->options_buf);
 }
 
-gboolean
-wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
-    int *err, gchar **err_info)
+static gboolean
+wtap_seek_read_data(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
+    const guint8 **data, int *err, gchar **err_info)
 {
+	gboolean ok;
+
 	/*
 	 * Initialize the record to default values.
 	 */
@@ -1708,7 +1732,14 @@ wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
 
 	*err = 0;
 	*err_info = NULL;
-	if (!wth->subtype_seek_read(wth, seek_off, rec, buf, err, err_info)) {
+	if (data != NULL && wth->subtype_seek_read_mapped != NULL) {
+		ok = wth->subtype_seek_read_mapped(wth, seek_off, rec, buf, data, err, err_info);
+	} else {
+		ok = wth->subtype_seek_read(wth, seek_off, rec, buf, err, err_info);
+		if (ok && data != NULL)
+			*data = ws_buffer_start_ptr(buf);
+	}
+	if (!ok) {
 		if (rec->block != NULL) {
 			/*
 			 * Unreference any block created for this record.
@@ -1742,6 +1773,37 @@ wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
 	return TRUE;
 }
 
+gboolean
+wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
+    int *err, gchar **err_info)
+{
+	return wtap_seek_read_data(wth, seek_off, rec, buf, NULL, err, err_info);
+}
+
+gboolean
+wtap_map_file(wtap *wth)
+{
+	if (wth->random_fh == NULL || wth->ispipe ||
+	    wth->subtype_seek_read_mapped == NULL)
+		return FALSE;
+
+	/*
+	 * Offsets in a mapped file are raw file offsets, so only
+	 * uncompressed files can be mapped.
+	 */
+	if (wtap_get_compression_type(wth) != WTAP_UNCOMPRESSED)
+		return FALSE;
+
+	return file_map(wth->random_fh);
+}
+
+gboolean
+wtap_seek_read_mapped(wtap *wth, gint64 seek_off, wtap_rec *rec, Buffer *buf,
+    const guint8 **data, int *err, gchar **err_info)
+{
+	return wtap_seek_read_data(wth, seek_off, rec, buf, data, err, err_info);
+}
+
 static gboolean
 wtap_full_file_read_file(wtap *wth, FILE_T fh, wtap_rec *rec, Buffer *buf, int *err, gchar **err_info)
 {
@@ -1758,6 +1758,37 @@ WS_DLL_PUBLIC
 gboolean wtap_seek_read(wtap *wth, gint64 seek_off, wtap_rec *rec,
     Buffer *buf, int *err, gchar **err_info);
 
+/** Map a file opened for random access into memory, so that
+ * wtap_seek_read_mapped() can return packet data without copying it.
+ *
+ * Only uncompressed pcap and pcapng files that are regular files can be
+ * mapped, and not on Windows; for anything else, including compressed
+ * files and pipes, this returns FALSE and wtap_seek_read_mapped() reads
+ * into the buffer as wtap_seek_read() does. If the file is truncated
+ * while it's mapped, the data handed out from past its new end reads
+ * as zeroes rather than crashing, the mapping is no longer used, and
+ * later records are read into the buffer as well.
+ *
+ * @wth a wtap * returned by a call that opened a file for random-access
+ * reading.
+ * @return TRUE if the file is mapped.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_map_file(wtap *wth);
+
+/** Same as wtap_seek_read(), but also sets *data to the record's data.
+ *
+ * If the file is mapped with wtap_map_file() and the record's data is
+ * used as it is in the file, *data points into the mapped file and buf
+ * is left alone; otherwise the data is read into buf and *data points
+ * to its start. A pointer into the mapped file stays valid until the
+ * file is closed or reopened, so it must not be kept beyond the
+ * dissection of the record.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_seek_read_mapped(wtap *wth, gint64 seek_off, wtap_rec *rec,
+    Buffer *buf, const guint8 **data, int *err, gchar **err_info);
+
 /*** initialize a wtap_rec structure ***/
 WS_DLL_PUBLIC
 void wtap_rec_init(wtap_rec *rec);